@@ -117,6 +117,7 @@ static void linphone_carddav_vcards_pulled(LinphoneCardDavContext *cdc, bctbx_li
 	bctbx_list_t *vCards_remember = vCards;
 	if (vCards != NULL && bctbx_list_size(vCards) > 0) {
 		bctbx_list_t *friends = cdc->friend_list->friends;
+		linphone_core_friends_storage_begin_batch(cdc->friend_list->lc);
 		while (vCards) {
 			LinphoneCardDavResponse *vCard = (LinphoneCardDavResponse *)vCards->data;
 			if (vCard) {
@@ -168,6 +169,7 @@ static void linphone_carddav_vcards_pulled(LinphoneCardDavContext *cdc, bctbx_li
 			}
 			vCards = bctbx_list_next(vCards);
 		}
+		linphone_core_friends_storage_end_batch(cdc->friend_list->lc);
 		bctbx_list_free_with_data(vCards_remember, (void (*)(void *))linphone_carddav_response_free);
 	}
 	linphone_carddav_server_to_client_sync_done(cdc, TRUE, NULL);
@@ -252,6 +254,7 @@ static void linphone_carddav_vcards_fetched(LinphoneCardDavContext *cdc, bctbx_l
 			friends = bctbx_list_next(friends);
 		}
 		friends_to_remove = temp_list;
+		linphone_core_friends_storage_begin_batch(cdc->friend_list->lc);
 		while(friends_to_remove) {
 			LinphoneFriend *lf = (LinphoneFriend *)friends_to_remove->data;
 			if (lf) {
@@ -262,6 +265,7 @@ static void linphone_carddav_vcards_fetched(LinphoneCardDavContext *cdc, bctbx_l
 			}
 			friends_to_remove = bctbx_list_next(friends_to_remove);
 		}
+		linphone_core_friends_storage_end_batch(cdc->friend_list->lc);
 		temp_list = bctbx_list_free_with_data(temp_list, (void (*)(void *))linphone_friend_unref);
 
 		linphone_carddav_pull_vcards(cdc, vCards);
@@ -199,10 +199,12 @@ void __linphone_friend_do_subscribe(LinphoneFriend *fr){
 				fr->lc->vtable.notify_recv(fr->lc,(LinphoneFriend*)fr);
 			*/
 		}else{
+			linphone_friend_list_remove_subscription_from_index(fr, fr->outsub, FALSE);
 			fr->outsub->release();
 			fr->outsub=NULL;
 		}
 		fr->outsub=new SalPresenceOp(lc->sal.get());
+		linphone_friend_list_add_subscription_to_index(fr, fr->outsub, FALSE);
 		linphone_configure_op(lc,fr->outsub,addr,NULL,TRUE);
 		fr->outsub->subscribe(linphone_config_get_int(lc->config,"sip","subscribe_expires",600));
 		fr->subscribe_active=TRUE;
@@ -391,6 +393,7 @@ LinphoneStatus linphone_friend_set_address(LinphoneFriend *lf, const LinphoneAdd
 	}
 
 	ms_free(address);
+	linphone_friend_update_indexes(lf);
 	return 0;
 }
 
@@ -417,6 +420,7 @@ void linphone_friend_add_address(LinphoneFriend *lf, const LinphoneAddress *addr
 		else linphone_address_unref(fr);
 	}
 	ms_free(uri);
+	linphone_friend_update_indexes(lf);
 }
 
 const bctbx_list_t* linphone_friend_get_addresses(const LinphoneFriend *lf) {
@@ -444,6 +448,7 @@ void linphone_friend_remove_address(LinphoneFriend *lf, const LinphoneAddress *a
 		linphone_vcard_remove_sip_address(lf->vcard, address);
 	}
 	ms_free(address);
+	linphone_friend_update_indexes(lf);
 }
 
 void linphone_friend_add_phone_number(LinphoneFriend *lf, const char *phone) {
@@ -460,6 +465,7 @@ void linphone_friend_add_phone_number(LinphoneFriend *lf, const char *phone) {
 		}
 		linphone_vcard_add_phone_number(lf->vcard, phone);
 	}
+	linphone_friend_update_indexes(lf);
 }
 
 void linphone_friend_add_phone_number_with_label(LinphoneFriend *lf, LinphoneFriendPhoneNumber *phoneNumber) {
@@ -479,6 +485,7 @@ void linphone_friend_add_phone_number_with_label(LinphoneFriend *lf, LinphoneFri
 		}
 		linphone_vcard_add_phone_number_with_label(lf->vcard, phoneNumber);
 	}
+	linphone_friend_update_indexes(lf);
 }
 
 bctbx_list_t* linphone_friend_get_phone_numbers(const LinphoneFriend *lf) {
@@ -552,6 +559,7 @@ void linphone_friend_remove_phone_number(LinphoneFriend *lf, const char *phone)
 	if (linphone_core_vcard_supported()) {
 		linphone_vcard_remove_phone_number(lf->vcard, phone);
 	}
+	linphone_friend_update_indexes(lf);
 }
 
 void linphone_friend_remove_phone_number_with_label(LinphoneFriend *lf, const LinphoneFriendPhoneNumber *phoneNumber) {
@@ -570,6 +578,7 @@ void linphone_friend_remove_phone_number_with_label(LinphoneFriend *lf, const Li
 	if (linphone_core_vcard_supported()) {
 		linphone_vcard_remove_phone_number_with_label(lf->vcard, phoneNumber);
 	}
+	linphone_friend_update_indexes(lf);
 }
 
 LinphoneStatus linphone_friend_set_name(LinphoneFriend *lf, const char *name) {
@@ -583,6 +592,7 @@ LinphoneStatus linphone_friend_set_name(LinphoneFriend *lf, const char *name) {
 		}
 		linphone_address_set_display_name(lf->uri, name);
 	}
+	linphone_friend_update_indexes(lf);
 	return 0;
 }
 
@@ -615,10 +625,12 @@ void linphone_friend_notify(LinphoneFriend *lf, LinphonePresenceModel *presence)
 void linphone_friend_add_incoming_subscription(LinphoneFriend *lf, SalOp *op){
 	/*ownership of the op is transfered from sal to the LinphoneFriend*/
 	lf->insubs = bctbx_list_append(lf->insubs, op);
+	linphone_friend_list_add_subscription_to_index(lf, op, TRUE);
 }
 
 void linphone_friend_remove_incoming_subscription(LinphoneFriend *lf, SalOp *op){
 	if (bctbx_list_find(lf->insubs, op)){
+		linphone_friend_list_remove_subscription_from_index(lf, op, TRUE);
 		op->release();
 		lf->insubs = bctbx_list_remove(lf->insubs, op);
 	}
@@ -637,6 +649,7 @@ void linphone_friend_invalidate_subscription(LinphoneFriend *lf){
 	LinphoneCore *lc = lf->lc;
 
 	if (lf->outsub!=NULL) {
+		linphone_friend_list_remove_subscription_from_index(lf, lf->outsub, FALSE);
 		lf->outsub->release();
 		lf->outsub=NULL;
 	}
@@ -670,6 +683,8 @@ static void release_sal_op(SalOp *op) {
 }
 
 static void linphone_friend_close_incoming_subscriptions(LinphoneFriend *lf) {
+	for (const bctbx_list_t *elem = lf->insubs; elem != NULL; elem = bctbx_list_next(elem))
+		linphone_friend_list_remove_subscription_from_index(lf, (SalOp *)bctbx_list_get_data(elem), TRUE);
 	bctbx_list_for_each(lf->insubs, (MSIterateFunc) close_presence_notification);
 	lf->insubs = bctbx_list_free_with_data(lf->insubs, (MSIterateFunc)release_sal_op);
 }
@@ -873,6 +888,7 @@ void linphone_friend_set_presence_model_for_uri_or_tel(LinphoneFriend *lf, const
 	} else {
 		add_presence_model_for_uri_or_tel(lf, uri_or_tel, presence);
 	}
+	linphone_friend_update_indexes(lf);
 }
 
 bool_t linphone_friend_is_presence_received(const LinphoneFriend *lf) {
@@ -961,6 +977,7 @@ void linphone_friend_apply(LinphoneFriend *fr, LinphoneCore *lc) {
 
 	ms_debug("linphone_friend_apply() done.");
 	lc->bl_refresh=TRUE;
+	linphone_core_wake_up_iterate(lc);
 	fr->commit=FALSE;
 }
 
@@ -985,6 +1002,7 @@ void linphone_friend_done(LinphoneFriend *fr) {
 	}
 	linphone_friend_apply(fr, fr->lc);
 	linphone_friend_save(fr, fr->lc);
+	linphone_friend_update_indexes(fr);
 }
 
 #if __clang__ || ((__GNUC__ == 4 && __GNUC_MINOR__ >= 6) || __GNUC__ > 4)
@@ -1283,6 +1301,7 @@ void linphone_friend_set_vcard(LinphoneFriend *fr, LinphoneVcard *vcard) {
 	if (fr->vcard) linphone_vcard_unref(fr->vcard);
 	if (vcard) fr->vcard = linphone_vcard_ref(vcard);
 	linphone_friend_save(fr, fr->lc);
+	linphone_friend_update_indexes(fr);
 }
 
 bool_t linphone_friend_create_vcard(LinphoneFriend *fr, const char *name) {
@@ -1354,6 +1373,8 @@ LinphoneFriend *linphone_friend_new_from_vcard(LinphoneVcard *vcard) {
 /*drops all references to the core and unref*/
 void _linphone_friend_release(LinphoneFriend *lf){
 	lf->lc = NULL;
+	// Called by the list that holds the friend, whose indexes must not keep the released ops.
+	if (lf->friend_list) linphone_friend_list_remove_friend_from_indexes(lf->friend_list, lf);
 	_linphone_friend_release_ops(lf);
 	linphone_friend_unref(lf);
 }
@@ -1400,6 +1421,26 @@ void linphone_friend_add_addresses_and_numbers_into_maps(LinphoneFriend *lf, Lin
 		}
 		iterator = bctbx_list_next(iterator);
 	}
+
+	linphone_friend_update_indexes(lf);
+}
+
+void linphone_friend_update_indexes(LinphoneFriend *lf) {
+	if (!lf || !lf->friend_list) return;
+	linphone_friend_list_update_friend_indexes(lf->friend_list, lf);
+	linphone_core_update_friend_search_index(lf->lc, lf);
+}
+
+void linphone_core_update_friend_search_index(LinphoneCore *lc, LinphoneFriend *lf) {
+	// Only the friends of the lists of the core are searched, they are indexed again at the next search.
+	// The index references them until they are removed, friends of other lists are left alone.
+	if (!lc || !lf || !lf->friend_list || !bctbx_list_find(lc->friends_lists, lf->friend_list)) return;
+	L_GET_PRIVATE_FROM_C_OBJECT(lc)->contactSearchIndex.updateFriend(lf);
+}
+
+void linphone_core_remove_friend_from_search_index(LinphoneCore *lc, LinphoneFriend *lf) {
+	if (!lc || !lf) return;
+	L_GET_PRIVATE_FROM_C_OBJECT(lc)->contactSearchIndex.removeFriend(lf);
 }
 
 /*******************************************************************************
@@ -1524,6 +1565,13 @@ static int linphone_sql_request_generic(sqlite3* db, const char *stmt) {
 	return ret;
 }
 
+/* Runs a write on the friends database, a failure makes the current batch roll back. */
+int linphone_core_friends_storage_request(LinphoneCore *lc, const char *stmt) {
+	int ret = linphone_sql_request_generic(lc->friends_db, stmt);
+	if (ret != SQLITE_OK && lc->friends_db_batch_depth > 0) lc->friends_db_batch_failed = TRUE;
+	return ret;
+}
+
 int linphone_core_friends_storage_resync_friends_lists(LinphoneCore *lc) {
 	bctbx_list_t *friends_lists = NULL;
 	int synced_friends_lists = 0;
@@ -1532,13 +1580,19 @@ int linphone_core_friends_storage_resync_friends_lists(LinphoneCore *lc) {
 	 * First lets remove all the orphan friends from the DB
 	 */
 	char *buf = sqlite3_mprintf("delete from friends where friend_list_id not in (select id from friends_lists)");
-	linphone_sql_request_generic(lc->friends_db, buf);
+	linphone_core_friends_storage_request(lc, buf);
 	sqlite3_free(buf);
 
 	friends_lists = linphone_core_fetch_friends_lists_from_db(lc);
 	if (friends_lists) {
 		const bctbx_list_t *it;
 		ms_warning("Replacing current default friend list by the one(s) from the database");
+		for (it = lc->friends_lists; it != NULL; it = bctbx_list_next(it)) {
+			const bctbx_list_t *friend_it;
+			LinphoneFriendList *list = (LinphoneFriendList *)bctbx_list_get_data(it);
+			for (friend_it = list->friends; friend_it != NULL; friend_it = bctbx_list_next(friend_it))
+				linphone_core_remove_friend_from_search_index(lc, (LinphoneFriend *)bctbx_list_get_data(friend_it));
+		}
 		lc->friends_lists = bctbx_list_free_with_data(lc->friends_lists, (bctbx_list_free_func)linphone_friend_list_unref);
 
 		const char *url = linphone_config_get_string(lc->config, "misc", "contacts-vcard-list", NULL);
@@ -1559,8 +1613,73 @@ int linphone_core_friends_storage_resync_friends_lists(LinphoneCore *lc) {
 	return synced_friends_lists;
 }
 
+static sqlite3_stmt *linphone_core_friends_storage_prepare(LinphoneCore *lc, sqlite3_stmt **stmt, const char *sql) {
+	if (*stmt == NULL && sqlite3_prepare_v2(lc->friends_db, sql, -1, stmt, NULL) != SQLITE_OK) {
+		ms_error("linphone_sql_request: statement %s -> error sqlite3_prepare_v2(): %s.", sql, sqlite3_errmsg(lc->friends_db));
+		sqlite3_finalize(*stmt);
+		*stmt = NULL;
+	}
+	return *stmt;
+}
+
+static int linphone_core_friends_storage_step(LinphoneCore *lc, sqlite3_stmt *stmt) {
+	int ret = sqlite3_step(stmt);
+	if (ret != SQLITE_DONE) {
+		if (lc->friends_db_batch_depth > 0) lc->friends_db_batch_failed = TRUE;
+		ms_error("linphone_sql_request: statement %s -> error sqlite3_step(): %s.", sqlite3_sql(stmt), sqlite3_errmsg(lc->friends_db));
+	}
+	sqlite3_reset(stmt);
+	sqlite3_clear_bindings(stmt);
+	return ret;
+}
+
+static void linphone_core_friends_storage_finalize_statements(LinphoneCore *lc) {
+	sqlite3_finalize(lc->friends_insert_stmt);
+	lc->friends_insert_stmt = NULL;
+	sqlite3_finalize(lc->friends_update_stmt);
+	lc->friends_update_stmt = NULL;
+	sqlite3_finalize(lc->friends_delete_stmt);
+	lc->friends_delete_stmt = NULL;
+}
+
+void linphone_core_friends_storage_begin_batch(LinphoneCore *lc) {
+	if (!lc || !lc->friends_db) return;
+	if (lc->friends_db_batch_depth++ == 0) {
+		lc->friends_db_batch_failed = FALSE;
+		linphone_sql_request_generic(lc->friends_db, "BEGIN TRANSACTION;");
+	}
+}
+
+static void linphone_core_friends_storage_finish_batch(LinphoneCore *lc) {
+	lc->friends_db_batch_depth = 0;
+	if (lc->friends_db_batch_failed) {
+		ms_error("A write of the friends storage batch failed, rolling it back");
+		linphone_sql_request_generic(lc->friends_db, "ROLLBACK;");
+	} else if (linphone_sql_request_generic(lc->friends_db, "COMMIT;") != SQLITE_OK) {
+		linphone_sql_request_generic(lc->friends_db, "ROLLBACK;");
+	}
+	lc->friends_db_batch_failed = FALSE;
+}
+
+void linphone_core_friends_storage_end_batch(LinphoneCore *lc) {
+	if (!lc || !lc->friends_db || lc->friends_db_batch_depth == 0) return;
+	if (lc->friends_db_batch_depth == 1)
+		linphone_core_friends_storage_finish_batch(lc);
+	else
+		lc->friends_db_batch_depth--;
+}
+
+sqlite3 *linphone_core_get_friends_db(LinphoneCore *lc) {
+	return lc->friends_db;
+}
+
 void linphone_core_friends_storage_close(LinphoneCore *lc) {
 	if (lc->friends_db) {
+		if (lc->friends_db_batch_depth > 0) {
+			ms_warning("Closing friends database with a batch still open, ending it");
+			linphone_core_friends_storage_finish_batch(lc);
+		}
+		linphone_core_friends_storage_finalize_statements(lc);
 		sqlite3_close(lc->friends_db);
 		lc->friends_db = NULL;
 	}
@@ -1671,7 +1790,7 @@ static int linphone_sql_request_friends_list(sqlite3* db, const char *stmt, bctb
 
 void linphone_core_store_friend_in_db(LinphoneCore *lc, LinphoneFriend *lf) {
 	if (lc && lc->friends_db) {
-		char *buf;
+		sqlite3_stmt *stmt;
 		int store_friends = linphone_config_get_int(lc->config, "misc", "store_friends", 1);
 		LinphoneVcard *vcard = NULL;
 		const LinphoneAddress *addr;
@@ -1697,39 +1816,33 @@ void linphone_core_store_friend_in_db(LinphoneCore *lc, LinphoneFriend *lf) {
 			linphone_core_store_friends_list_in_db(lc, lf->friend_list);
 		}
 
-		if (linphone_core_vcard_supported()) vcard = linphone_friend_get_vcard(lf);
-		addr = linphone_friend_get_address(lf);
-		if (addr != NULL) addr_str = linphone_address_as_string(addr);
 		if (lf->storage_id > 0) {
-			buf = sqlite3_mprintf("UPDATE friends SET friend_list_id=%u,sip_uri=%Q,subscribe_policy=%i,send_subscribe=%i,ref_key=%Q,vCard=%Q,vCard_etag=%Q,vCard_url=%Q,presence_received=%i WHERE (id = %u);",
-				lf->friend_list->storage_id,
-				addr_str,
-				lf->pol,
-				lf->subscribe,
-				lf->refkey,
-				vcard ? linphone_vcard_as_vcard4_string(vcard) : NULL,
-				vcard ? linphone_vcard_get_etag(vcard) : NULL,
-				vcard ? linphone_vcard_get_url(vcard): NULL,
-				lf->presence_received,
-				lf->storage_id
-			);
+			stmt = linphone_core_friends_storage_prepare(lc, &lc->friends_update_stmt,
+				"UPDATE friends SET friend_list_id=?1,sip_uri=?2,subscribe_policy=?3,send_subscribe=?4,ref_key=?5,vCard=?6,vCard_etag=?7,vCard_url=?8,presence_received=?9 WHERE (id = ?10);");
 		} else {
-			buf = sqlite3_mprintf("INSERT INTO friends VALUES(NULL,%u,%Q,%i,%i,%Q,%Q,%Q,%Q,%i);",
-				lf->friend_list->storage_id,
-				addr_str,
-				lf->pol,
-				lf->subscribe,
-				lf->refkey,
-				vcard ? linphone_vcard_as_vcard4_string(vcard) : NULL,
-				vcard ? linphone_vcard_get_etag(vcard) : NULL,
-				vcard ? linphone_vcard_get_url(vcard) : NULL,
-				lf->presence_received
-			);
+			stmt = linphone_core_friends_storage_prepare(lc, &lc->friends_insert_stmt,
+				"INSERT INTO friends VALUES(NULL,?1,?2,?3,?4,?5,?6,?7,?8,?9);");
 		}
-		if (addr_str != NULL) ms_free(addr_str);
+		if (!stmt) return;
 
-		linphone_sql_request_generic(lc->friends_db, buf);
-		sqlite3_free(buf);
+		if (linphone_core_vcard_supported()) vcard = linphone_friend_get_vcard(lf);
+		addr = linphone_friend_get_address(lf);
+		if (addr != NULL) addr_str = linphone_address_as_string(addr);
+
+		/* Bound values are only read by sqlite3_step(), which runs before any of them is released. */
+		sqlite3_bind_int64(stmt, 1, lf->friend_list->storage_id);
+		sqlite3_bind_text(stmt, 2, addr_str, -1, SQLITE_STATIC);
+		sqlite3_bind_int(stmt, 3, lf->pol);
+		sqlite3_bind_int(stmt, 4, lf->subscribe);
+		sqlite3_bind_text(stmt, 5, lf->refkey, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 6, vcard ? linphone_vcard_as_vcard4_string(vcard) : NULL, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 7, vcard ? linphone_vcard_get_etag(vcard) : NULL, -1, SQLITE_STATIC);
+		sqlite3_bind_text(stmt, 8, vcard ? linphone_vcard_get_url(vcard) : NULL, -1, SQLITE_STATIC);
+		sqlite3_bind_int(stmt, 9, lf->presence_received);
+		if (lf->storage_id > 0) sqlite3_bind_int64(stmt, 10, lf->storage_id);
+
+		linphone_core_friends_storage_step(lc, stmt);
+		if (addr_str != NULL) ms_free(addr_str);
 
 		if (lf->storage_id == 0) {
 			lf->storage_id = (unsigned int)sqlite3_last_insert_rowid(lc->friends_db);
@@ -1762,7 +1875,7 @@ void linphone_core_store_friends_list_in_db(LinphoneCore *lc, LinphoneFriendList
 				list->revision
 			);
 		}
-		linphone_sql_request_generic(lc->friends_db, buf);
+		linphone_core_friends_storage_request(lc, buf);
 		sqlite3_free(buf);
 
 		if (list->storage_id == 0) {
@@ -1773,15 +1886,17 @@ void linphone_core_store_friends_list_in_db(LinphoneCore *lc, LinphoneFriendList
 
 void linphone_core_remove_friend_from_db(LinphoneCore *lc, LinphoneFriend *lf) {
 	if (lc && lc->friends_db) {
-		char *buf;
+		sqlite3_stmt *stmt;
 		if (lf->storage_id == 0) {
 			ms_error("Friend doesn't have a storage_id !");
 			return;
 		}
 
-		buf = sqlite3_mprintf("DELETE FROM friends WHERE id = %u", lf->storage_id);
-		linphone_sql_request_generic(lc->friends_db, buf);
-		sqlite3_free(buf);
+		stmt = linphone_core_friends_storage_prepare(lc, &lc->friends_delete_stmt, "DELETE FROM friends WHERE id = ?1");
+		if (stmt) {
+			sqlite3_bind_int64(stmt, 1, lf->storage_id);
+			linphone_core_friends_storage_step(lc, stmt);
+		}
 
 		lf->storage_id = 0;
 	}
@@ -1796,11 +1911,11 @@ void linphone_core_remove_friends_list_from_db(LinphoneCore *lc, LinphoneFriendL
 		}
 
 		buf = sqlite3_mprintf("DELETE FROM friends WHERE friend_list_id in (select id from friends_lists where id = %u)", list->storage_id);
-		linphone_sql_request_generic(lc->friends_db, buf);
+		linphone_core_friends_storage_request(lc, buf);
 		sqlite3_free(buf);
 
 		buf = sqlite3_mprintf("DELETE FROM friends_lists WHERE id = %u", list->storage_id);
-		linphone_sql_request_generic(lc->friends_db, buf);
+		linphone_core_friends_storage_request(lc, buf);
 		sqlite3_free(buf);
 
 		list->storage_id = 0;
@@ -1888,6 +2003,16 @@ void linphone_core_friends_storage_init(LinphoneCore *lc){
 void linphone_core_friends_storage_close(LinphoneCore *lc){
 }
 
+void linphone_core_friends_storage_begin_batch(LinphoneCore *lc){
+}
+
+void linphone_core_friends_storage_end_batch(LinphoneCore *lc){
+}
+
+sqlite3 *linphone_core_get_friends_db(LinphoneCore *lc){
+	return NULL;
+}
+
 void linphone_core_store_friend_in_db(LinphoneCore *lc, LinphoneFriend *lf){
 	ms_warning("linphone_core_store_friend_in_db(): stubbed");
 }
@@ -2136,6 +2261,7 @@ void linphone_friend_set_organization(LinphoneFriend *lf, const char *organizati
 	if (linphone_core_vcard_supported() && lf->vcard) {
 		linphone_vcard_set_organization(lf->vcard, organization);
 	}
+	linphone_friend_update_indexes(lf);
 }
 
 const char * linphone_friend_get_organization(const LinphoneFriend *lf) {
@@ -18,12 +18,19 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
 #include <bctoolbox/crypto.h>
 
 #include "linphone/api/c-content.h"
 #include "linphone/core.h"
 
 #include "c-wrapper/c-wrapper.h"
+#include "xml/xml-pull-parser.h"
 
 // TODO: From coreapi. Remove me later.
 #include "private.h"
@@ -278,189 +285,336 @@ static void linphone_friend_presence_received(LinphoneFriendList *list, Linphone
 	linphone_core_notify_notify_presence_received(list->lc, lf);
 }
 
+using LinphonePrivate::XmlPullParser;
+
+static const std::string RlmiNamespace = "urn:ietf:params:xml:ns:rlmi";
+
+namespace {
+	struct StreamedRlmiResource {
+		std::string uri;
+		std::string name;
+		std::string cid;
+		bool hasName = false;
+		bool hasActiveInstance = false;
+	};
+} // namespace
+
+static bool_t linphone_friend_list_check_rlmi_list(LinphoneFriendList *list, const char *version_str,
+												   const char *full_state_str) {
+	bool_t full_state = FALSE;
+	int version;
+
+	if (!version_str) {
+		ms_warning("rlmi+xml: No version attribute in list");
+		return FALSE;
+	}
+	version = atoi(version_str);
+	if (version < list->expected_notification_version) { /*no longuer an error as dialog may be silently restarting
+															by the refresher*/
+		ms_warning("rlmi+xml: Received notification with version %d expected was %d, dialog may have been reseted",
+				   version, list->expected_notification_version);
+	}
+
+	if (!full_state_str) {
+		ms_warning("rlmi+xml: No fullState attribute in list");
+		return FALSE;
+	}
+	if ((strcmp(full_state_str, "true") == 0) || (strcmp(full_state_str, "1") == 0)) {
+		bctbx_list_t *l = list->friends;
+		for (; l != NULL; l = bctbx_list_next(l)) {
+			LinphoneFriend *lf = (LinphoneFriend *)bctbx_list_get_data(l);
+			linphone_friend_clear_presence_models(lf);
+		}
+		full_state = TRUE;
+	}
+	if ((list->expected_notification_version == 0) && !full_state) {
+		ms_warning("rlmi+xml: Notification with version 0 is not full state, this is not valid");
+		return FALSE;
+	}
+	list->expected_notification_version = version + 1;
+	return TRUE;
+}
+
+static void linphone_friend_list_rlmi_resource_named(LinphoneFriendList *list, const char *uri, const char *name) {
+	LinphoneAddress *addr = linphone_address_new(uri);
+	if (!addr)
+		return;
+	LinphoneFriend *lf = linphone_friend_list_find_friend_by_address(list, addr);
+	linphone_address_unref(addr);
+	if (!lf && list->bodyless_subscription) {
+		lf = linphone_core_create_friend_with_address(list->lc, uri);
+		linphone_friend_list_add_friend(list, lf);
+		linphone_friend_unref(lf);
+	}
+	if (lf && name)
+		linphone_friend_set_name(lf, name);
+}
+
+// Parts of the multipart/related body by Content-Id, the first one wins when several parts share an id.
+static std::unordered_map<std::string, LinphoneContent *> linphone_friend_list_index_rlmi_parts(const bctbx_list_t *parts) {
+	std::unordered_map<std::string, LinphoneContent *> partsByCid;
+	for (const bctbx_list_t *it = parts; it != nullptr; it = bctbx_list_next(it)) {
+		LinphoneContent *content = (LinphoneContent *)bctbx_list_get_data(it);
+		const char *header = linphone_content_get_custom_header(content, "Content-Id");
+		if (header)
+			partsByCid.emplace(header, content);
+	}
+	return partsByCid;
+}
+
+static void linphone_friend_list_rlmi_resource_active(LinphoneFriendList *list,
+													  const std::unordered_map<std::string, LinphoneContent *> &partsByCid,
+													  const char *cid, const char *resource_uri,
+													  bctbx_list_t **list_friends_presence_received) {
+	const auto part = partsByCid.find(cid);
+	if (part == partsByCid.end()) {
+		ms_warning("rlmi+xml: Cannot find part with Content-Id: %s", cid);
+		return;
+	}
+
+	LinphoneContent *presence_part = part->second;
+	SalPresenceModel *presence = NULL;
+	linphone_notify_parse_presence(list->lc, linphone_content_get_type(presence_part),
+								   linphone_content_get_subtype(presence_part),
+								   linphone_content_get_utf8_text(presence_part), &presence);
+	if (!presence)
+		return;
+
+	// Try to reduce CPU cost of linphone_address_new and find_friend_by_address by only doing
+	// it when we know for sure we have a presence to notify
+	LinphoneAddress *addr = resource_uri ? linphone_address_new(resource_uri) : NULL;
+	if (!addr) {
+		linphone_presence_model_unref((LinphonePresenceModel *)presence);
+		return;
+	}
+
+	// Clean the URI
+	if (linphone_address_has_uri_param(addr, "gr")) {
+		linphone_address_remove_uri_param(addr, "gr");
+	}
+	char *uri = linphone_address_as_string_uri_only(addr);
+	linphone_address_unref(addr);
+
+	LinphoneFriend *lf;
+	bctbx_iterator_t *it = bctbx_map_cchar_find_key(list->friends_map_uri, uri);
+	bctbx_iterator_t *end = bctbx_map_cchar_end(list->friends_map_uri);
+	if (bctbx_iterator_cchar_equals(it, end)) {
+		if (list->bodyless_subscription) {
+			lf = linphone_core_create_friend_with_address(list->lc, uri);
+			linphone_friend_list_add_friend(list, lf);
+			linphone_friend_unref(lf);
+
+			linphone_friend_presence_received(list, lf, uri, (LinphonePresenceModel *)presence);
+			*list_friends_presence_received = bctbx_list_prepend(*list_friends_presence_received, lf);
+		}
+	} else {
+		// Map is sorted, check if next entry matches key otherwise stop
+		while (!bctbx_iterator_cchar_equals(it, end)) {
+			bctbx_pair_t *pair = bctbx_iterator_cchar_get_pair(it);
+			const char *key = bctbx_pair_cchar_get_first(reinterpret_cast<bctbx_pair_cchar_t *>(pair));
+			if (!key || strcmp(uri, key) != 0)
+				break;
+			lf = (LinphoneFriend *)bctbx_pair_cchar_get_second(pair);
+			if (lf) {
+				linphone_friend_presence_received(list, lf, uri, (LinphonePresenceModel *)presence);
+				*list_friends_presence_received = bctbx_list_prepend(*list_friends_presence_received, lf);
+			}
+			it = bctbx_iterator_cchar_get_next(it);
+		}
+	}
+	bctbx_iterator_cchar_delete(it);
+	bctbx_iterator_cchar_delete(end);
+
+	linphone_presence_model_unref((LinphonePresenceModel *)presence);
+	ms_free(uri);
+}
+
+static void linphone_friend_list_notify_rlmi_presence_received(LinphoneFriendList *list,
+															   bctbx_list_t *list_friends_presence_received) {
+	// Notify list with all friends for which we received presence information
+	if (bctbx_list_size(list_friends_presence_received) > 0) {
+		LinphoneFriendListCbs *list_cbs = linphone_friend_list_get_callbacks(list);
+		if (list_cbs && linphone_friend_list_cbs_get_presence_received(list_cbs)) {
+			linphone_friend_list_cbs_get_presence_received(list_cbs)(list, list_friends_presence_received);
+		}
+
+		NOTIFY_IF_EXIST(PresenceReceived, presence_received, list, list_friends_presence_received)
+	}
+	bctbx_list_free(list_friends_presence_received);
+}
+
+/*
+ * Reads the rlmi+xml part in a single pass instead of evaluating XPath expressions per resource, then applies the
+ * resources in the same order as the XPath based parser: names first, then active instances.
+ * Returns FALSE if the pull parser could not read the document, the caller then falls back on libxml2.
+ */
+static bool_t linphone_friend_list_parse_multipart_related_body_streamed(LinphoneFriendList *list,
+																		  const LinphoneContent *body,
+																		  const char *first_part_body) {
+	const std::string document(first_part_body);
+	XmlPullParser parser(document);
+	std::vector<StreamedRlmiResource> resources;
+	StreamedRlmiResource resource;
+	std::string version;
+	std::string fullState;
+	std::string state;
+	bool hasVersion = false;
+	bool hasFullState = false;
+	bool inList = false;
+	bool inResource = false;
+	bool inName = false;
+	bool done = false;
+
+	while (!done) {
+		switch (parser.next()) {
+			case XmlPullParser::Event::StartElement:
+				if (parser.getDepth() == 1) {
+					inList = (parser.getNamespace() == RlmiNamespace) && (parser.getLocalName() == "list");
+					if (inList) {
+						hasVersion = parser.getAttribute("version", version);
+						hasFullState = parser.getAttribute("fullState", fullState);
+					}
+				} else if (inList && (parser.getDepth() == 2)) {
+					inResource = (parser.getNamespace() == RlmiNamespace) && (parser.getLocalName() == "resource");
+					if (inResource) {
+						resource = StreamedRlmiResource();
+						parser.getAttribute("uri", resource.uri);
+					}
+				} else if (inResource && (parser.getDepth() == 3) && (parser.getNamespace() == RlmiNamespace)) {
+					if (parser.getLocalName() == "name") {
+						inName = true;
+						resource.hasName = true;
+						resource.name.clear();
+					} else if (parser.getLocalName() == "instance") {
+						// Same selection as the XPath parser: the resource needs an active instance, and its cid is the
+						// last non empty one among all its instances, whatever their state.
+						std::string cid;
+						if (parser.getAttribute("cid", cid) && !cid.empty())
+							resource.cid = cid;
+						if (parser.getAttribute("state", state) && (state == "active"))
+							resource.hasActiveInstance = true;
+					}
+				}
+				break;
+
+			case XmlPullParser::Event::Text:
+				if (inName && (parser.getDepth() == 3))
+					resource.name += parser.getText();
+				break;
+
+			case XmlPullParser::Event::EndElement:
+				// The depth is the one of the parent of the closed element.
+				if (inName && (parser.getDepth() == 2)) {
+					inName = false;
+				} else if (inResource && (parser.getDepth() == 1)) {
+					resources.push_back(resource);
+					inResource = false;
+				}
+				break;
+
+			case XmlPullParser::Event::EndDocument:
+				done = true;
+				break;
+
+			case XmlPullParser::Event::Error:
+				return FALSE;
+		}
+	}
+
+	if (!linphone_friend_list_check_rlmi_list(list, (inList && hasVersion) ? version.c_str() : NULL,
+											  (inList && hasFullState) ? fullState.c_str() : NULL))
+		return TRUE;
+
+	for (const auto &namedResource : resources) {
+		if (namedResource.hasName && !namedResource.uri.empty())
+			linphone_friend_list_rlmi_resource_named(list, namedResource.uri.c_str(),
+													 namedResource.name.empty() ? NULL : namedResource.name.c_str());
+	}
+
+	bctbx_list_t *parts = linphone_content_get_parts(body);
+	const auto partsByCid = linphone_friend_list_index_rlmi_parts(parts);
+	bctbx_list_t *list_friends_presence_received = NULL;
+	for (const auto &activeResource : resources) {
+		if (activeResource.hasActiveInstance && !activeResource.cid.empty())
+			linphone_friend_list_rlmi_resource_active(list, partsByCid, activeResource.cid.c_str(),
+													  activeResource.uri.empty() ? NULL : activeResource.uri.c_str(),
+													  &list_friends_presence_received);
+	}
+	linphone_friend_list_notify_rlmi_presence_received(list, list_friends_presence_received);
+	bctbx_list_free_with_data(parts, (void (*)(void *))linphone_content_unref);
+	return TRUE;
+}
+
 static void linphone_friend_list_parse_multipart_related_body(LinphoneFriendList *list, const LinphoneContent *body,
 															  const char *first_part_body) {
+	if (first_part_body && linphone_presence_streaming_parser_enabled(list->lc) &&
+		linphone_friend_list_parse_multipart_related_body_streamed(list, body, first_part_body))
+		return;
+
 	xmlparsing_context_t *xml_ctx = linphone_xmlparsing_context_new();
 	xmlSetGenericErrorFunc(xml_ctx, linphone_xmlparsing_genericxml_error);
 	xml_ctx->doc = xmlReadDoc((const unsigned char *)first_part_body, 0, NULL, 0);
 	if (xml_ctx->doc) {
-		LinphoneFriend *lf;
-		LinphoneContent *presence_part;
 		xmlXPathObjectPtr resource_object;
 		xmlXPathObjectPtr name_object;
 		char *version_str = NULL;
 		char *full_state_str = NULL;
-		char *uri = NULL;
-		bool_t full_state = FALSE;
-		int version;
+		bool_t valid_list;
 		int i;
-		bctbx_list_t *list_friends_presence_received = NULL;
-		LinphoneFriendListCbs *list_cbs = linphone_friend_list_get_callbacks(list);
 
 		if (linphone_create_xml_xpath_context(xml_ctx) < 0)
 			goto end;
 		xmlXPathRegisterNs(xml_ctx->xpath_ctx, (const xmlChar *)"rlmi", (const xmlChar *)"urn:ietf:params:xml:ns:rlmi");
 
 		version_str = linphone_get_xml_attribute_text_content(xml_ctx, "/rlmi:list", "version");
-		if (!version_str) {
-			ms_warning("rlmi+xml: No version attribute in list");
-			goto end;
-		}
-		version = atoi(version_str);
-		linphone_free_xml_text_content(version_str);
-		if (version < list->expected_notification_version) { /*no longuer an error as dialog may be silently restarting
-																by the refresher*/
-			ms_warning("rlmi+xml: Received notification with version %d expected was %d, dialog may have been reseted",
-					   version, list->expected_notification_version);
-		}
-
-		full_state_str = linphone_get_xml_attribute_text_content(xml_ctx, "/rlmi:list", "fullState");
-		if (!full_state_str) {
-			ms_warning("rlmi+xml: No fullState attribute in list");
+		full_state_str = version_str ? linphone_get_xml_attribute_text_content(xml_ctx, "/rlmi:list", "fullState") : NULL;
+		valid_list = linphone_friend_list_check_rlmi_list(list, version_str, full_state_str);
+		if (version_str)
+			linphone_free_xml_text_content(version_str);
+		if (full_state_str)
+			linphone_free_xml_text_content(full_state_str);
+		if (!valid_list)
 			goto end;
-		}
-		if ((strcmp(full_state_str, "true") == 0) || (strcmp(full_state_str, "1") == 0)) {
-			bctbx_list_t *l = list->friends;
-			for (; l != NULL; l = bctbx_list_next(l)) {
-				lf = (LinphoneFriend *)bctbx_list_get_data(l);
-				linphone_friend_clear_presence_models(lf);
-			}
-			full_state = TRUE;
-		}
-		linphone_free_xml_text_content(full_state_str);
-		if ((list->expected_notification_version == 0) && !full_state) {
-			ms_warning("rlmi+xml: Notification with version 0 is not full state, this is not valid");
-			goto end;
-		}
-		list->expected_notification_version = version + 1;
 
 		name_object = linphone_get_xml_xpath_object_for_node_list(xml_ctx, "/rlmi:list/rlmi:resource/rlmi:name/..");
 		if (name_object && name_object->nodesetval) {
 			for (i = 1; i <= name_object->nodesetval->nodeNr; i++) {
 				char *name = NULL;
-				LinphoneAddress *addr;
+				char *uri = NULL;
 				linphone_xml_xpath_context_set_node(xml_ctx, xmlXPathNodeSetItem(name_object->nodesetval, i - 1));
 				name = linphone_get_xml_text_content(xml_ctx, "./rlmi:name");
 				uri = linphone_get_xml_text_content(xml_ctx, "./@uri");
-				if (!uri)
-					continue;
-				addr = linphone_address_new(uri);
-				if (!addr)
-					continue;
-				lf = linphone_friend_list_find_friend_by_address(list, addr);
-				linphone_address_unref(addr);
-				if (!lf && list->bodyless_subscription) {
-					lf = linphone_core_create_friend_with_address(list->lc, uri);
-					linphone_friend_list_add_friend(list, lf);
-					linphone_friend_unref(lf);
+				if (uri) {
+					linphone_friend_list_rlmi_resource_named(list, uri, name);
+					linphone_free_xml_text_content(uri);
 				}
-				if (name) {
-					linphone_friend_set_name(lf, name);
+				if (name)
 					linphone_free_xml_text_content(name);
-				}
 			}
 		}
 		if (name_object)
 			xmlXPathFreeObject(name_object);
 
 		bctbx_list_t *parts = linphone_content_get_parts(body);
+		const auto partsByCid = linphone_friend_list_index_rlmi_parts(parts);
 
 		resource_object = linphone_get_xml_xpath_object_for_node_list(
 			xml_ctx, "/rlmi:list/rlmi:resource/rlmi:instance[@state=\"active\"]/..");
 		if (resource_object && resource_object->nodesetval) {
+			bctbx_list_t *list_friends_presence_received = NULL;
 			for (i = 1; i <= resource_object->nodesetval->nodeNr; i++) {
 				char *cid = NULL;
 				linphone_xml_xpath_context_set_node(xml_ctx, xmlXPathNodeSetItem(resource_object->nodesetval, i - 1));
 				cid = linphone_get_xml_text_content(xml_ctx, "./rlmi:instance/@cid");
 				if (cid) {
-					presence_part = nullptr;
-					bctbx_list_t *it = parts;
-					while (it != nullptr) {
-						LinphoneContent *content = (LinphoneContent *)it->data;
-						const char *header = linphone_content_get_custom_header(content, "Content-Id");
-						if (header && strcmp(header, cid) == 0) {
-							presence_part = linphone_content_ref(content);
-							break;
-						}
-						it = bctbx_list_next(it);
-					}
-
-					if (!presence_part) {
-						ms_warning("rlmi+xml: Cannot find part with Content-Id: %s", cid);
-					} else {
-						SalPresenceModel *presence = NULL;
-						linphone_notify_parse_presence(linphone_content_get_type(presence_part),
-													   linphone_content_get_subtype(presence_part),
-													   linphone_content_get_utf8_text(presence_part), &presence);
-						if (presence) {
-							// Try to reduce CPU cost of linphone_address_new and find_friend_by_address by only doing
-							// it when we know for sure we have a presence to notify
-							LinphoneAddress *addr;
-							uri = linphone_get_xml_text_content(xml_ctx, "./@uri");
-							if (!uri)
-								continue;
-							addr = linphone_address_new(uri);
-							if (!addr)
-								continue;
-							linphone_free_xml_text_content(uri);
-
-							// Clean the URI
-							if (linphone_address_has_uri_param(addr, "gr")) {
-								linphone_address_remove_uri_param(addr, "gr");
-							}
-							uri = linphone_address_as_string_uri_only(addr);
-							linphone_address_unref(addr);
-
-							bctbx_iterator_t *it = bctbx_map_cchar_find_key(list->friends_map_uri, uri);
-							bctbx_iterator_t *end = bctbx_map_cchar_end(list->friends_map_uri);
-							if (bctbx_iterator_cchar_equals(it, end)) {
-								if (list->bodyless_subscription) {
-									lf = linphone_core_create_friend_with_address(list->lc, uri);
-									linphone_friend_list_add_friend(list, lf);
-									linphone_friend_unref(lf);
-
-									linphone_friend_presence_received(list, lf, uri, (LinphonePresenceModel *)presence);
-									list_friends_presence_received =
-										bctbx_list_prepend(list_friends_presence_received, lf);
-								}
-							} else {
-								// Map is sorted, check if next entry matches key otherwise stop
-								while (!bctbx_iterator_cchar_equals(it, end)) {
-									bctbx_pair_t *pair = bctbx_iterator_cchar_get_pair(it);
-									const char *key =
-										bctbx_pair_cchar_get_first(reinterpret_cast<bctbx_pair_cchar_t *>(pair));
-									if (!key || strcmp(uri, key) != 0)
-										break;
-									lf = (LinphoneFriend *)bctbx_pair_cchar_get_second(pair);
-									if (lf) {
-										linphone_friend_presence_received(list, lf, uri,
-																		  (LinphonePresenceModel *)presence);
-										list_friends_presence_received =
-											bctbx_list_prepend(list_friends_presence_received, lf);
-									}
-									it = bctbx_iterator_cchar_get_next(it);
-								}
-							}
-							bctbx_iterator_cchar_delete(it);
-							bctbx_iterator_cchar_delete(end);
-
-							linphone_content_unref(presence_part);
-							linphone_presence_model_unref((LinphonePresenceModel *)presence);
-							ms_free(uri);
-						}
-					}
+					char *uri = linphone_get_xml_text_content(xml_ctx, "./@uri");
+					linphone_friend_list_rlmi_resource_active(list, partsByCid, cid, uri, &list_friends_presence_received);
+					if (uri)
+						linphone_free_xml_text_content(uri);
 					linphone_free_xml_text_content(cid);
 				}
 			}
-			// Notify list with all friends for which we received presence information
-			if (bctbx_list_size(list_friends_presence_received) > 0) {
-				if (list_cbs && linphone_friend_list_cbs_get_presence_received(list_cbs)) {
-					linphone_friend_list_cbs_get_presence_received(list_cbs)(list, list_friends_presence_received);
-				}
-
-				NOTIFY_IF_EXIST(PresenceReceived, presence_received, list, list_friends_presence_received)
-			}
-			bctbx_list_free(list_friends_presence_received);
+			linphone_friend_list_notify_rlmi_presence_received(list, list_friends_presence_received);
 		}
 
 		bctbx_list_free_with_data(parts, (void (*)(void *))linphone_content_unref);
@@ -506,12 +660,184 @@ static bool_t linphone_friend_list_has_subscribe_inactive(const LinphoneFriendLi
 	return has_subscribe_inactive;
 }
 
+/*
+ * Indexes kept alongside friends_map_uri for the lookups done on each incoming presence NOTIFY and SUBSCRIBE.
+ * The subscription indexes may hold entries of ops that were released: hits are checked against the friend.
+ */
+struct _LinphoneFriendListIndexes {
+	/* One entry per distinct way the core's accounts normalize phone numbers, see phone_number_normalizations(). */
+	std::vector<std::string> normalizations;
+	/* "<normalization index>:<normalized number>" -> friends having this number. Built at the first lookup. */
+	std::unordered_multimap<std::string, LinphoneFriend *> phoneNumbers;
+	std::unordered_map<const LinphoneFriend *, std::vector<std::string>> phoneNumberKeys;
+	bool phoneNumbersBuilt = false;
+
+	std::unordered_map<const LinphonePrivate::SalOp *, LinphoneFriend *> incomingSubscriptions;
+	std::unordered_map<const LinphonePrivate::SalOp *, LinphoneFriend *> outgoingSubscriptions;
+	/* Call-ID of the outgoing subscriptions, to find the friend of a forked subscription. Built on demand because
+	 * the Call-ID is only known once the SUBSCRIBE is sent. */
+	std::unordered_map<std::string, LinphoneFriend *> outgoingSubscriptionCallIds;
+	bool outgoingSubscriptionCallIdsBuilt = false;
+};
+
+/* Accounts normalize phone numbers according to their international prefix and dial escape plus settings only:
+ * returns one representative account per distinct setting, in account list order. */
+static std::vector<std::pair<std::string, LinphoneAccount *>> phone_number_normalizations(LinphoneCore *lc) {
+	std::vector<std::pair<std::string, LinphoneAccount *>> normalizations;
+	for (const bctbx_list_t *elem = linphone_core_get_account_list(lc); elem != NULL; elem = bctbx_list_next(elem)) {
+		LinphoneAccount *account = (LinphoneAccount *)bctbx_list_get_data(elem);
+		const LinphoneAccountParams *params = linphone_account_get_params(account);
+		const char *prefix = linphone_account_params_get_international_prefix(params);
+		std::string key = prefix ? std::string("+") + prefix : std::string("-");
+		key += linphone_account_params_get_dial_escape_plus_enabled(params) ? "|1" : "|0";
+		bool known = false;
+		for (const auto &normalization : normalizations) {
+			if (normalization.first == key) {
+				known = true;
+				break;
+			}
+		}
+		if (!known) normalizations.emplace_back(key, account);
+	}
+	return normalizations;
+}
+
+static bool phone_number_normalizations_match(const LinphoneFriendListIndexes *indexes,
+											  const std::vector<std::pair<std::string, LinphoneAccount *>> &normalizations) {
+	if (indexes->normalizations.size() != normalizations.size()) return false;
+	for (size_t i = 0; i < normalizations.size(); i++) {
+		if (indexes->normalizations[i] != normalizations[i].first) return false;
+	}
+	return true;
+}
+
+static void linphone_friend_list_unindex_phone_numbers(LinphoneFriendList *list, const LinphoneFriend *lf) {
+	LinphoneFriendListIndexes *indexes = list->indexes;
+	auto keysIt = indexes->phoneNumberKeys.find(lf);
+	if (keysIt == indexes->phoneNumberKeys.end()) return;
+	for (const auto &key : keysIt->second) {
+		auto range = indexes->phoneNumbers.equal_range(key);
+		for (auto it = range.first; it != range.second; ++it) {
+			if (it->second == lf) {
+				indexes->phoneNumbers.erase(it);
+				break;
+			}
+		}
+	}
+	indexes->phoneNumberKeys.erase(keysIt);
+}
+
+static void linphone_friend_list_index_phone_numbers(LinphoneFriendList *list, LinphoneFriend *lf,
+													 const std::vector<std::pair<std::string, LinphoneAccount *>> &normalizations) {
+	LinphoneFriendListIndexes *indexes = list->indexes;
+	std::vector<std::string> keys;
+	bctbx_list_t *numbers = linphone_friend_get_phone_numbers(lf);
+	for (const bctbx_list_t *elem = numbers; elem != NULL; elem = bctbx_list_next(elem)) {
+		const char *number = (const char *)bctbx_list_get_data(elem);
+		for (size_t i = 0; i < normalizations.size(); i++) {
+			char *normalized = linphone_account_normalize_phone_number(normalizations[i].second, number);
+			if (!normalized) continue;
+			std::string key = std::to_string(i) + ":" + normalized;
+			ms_free(normalized);
+			if (std::find(keys.begin(), keys.end(), key) != keys.end()) continue;
+			indexes->phoneNumbers.emplace(key, lf);
+			keys.push_back(std::move(key));
+		}
+	}
+	bctbx_list_free(numbers);
+	if (!keys.empty()) indexes->phoneNumberKeys[lf] = std::move(keys);
+}
+
+static void linphone_friend_list_build_phone_numbers_index(LinphoneFriendList *list,
+														   const std::vector<std::pair<std::string, LinphoneAccount *>> &normalizations) {
+	LinphoneFriendListIndexes *indexes = list->indexes;
+	uint64_t begin = bctbx_get_cur_time_ms();
+	indexes->phoneNumbers.clear();
+	indexes->phoneNumberKeys.clear();
+	indexes->normalizations.clear();
+	for (const auto &normalization : normalizations)
+		indexes->normalizations.push_back(normalization.first);
+	if (linphone_core_vcard_supported()) {
+		for (const bctbx_list_t *elem = list->friends; elem != NULL; elem = bctbx_list_next(elem))
+			linphone_friend_list_index_phone_numbers(list, (LinphoneFriend *)bctbx_list_get_data(elem), normalizations);
+	}
+	indexes->phoneNumbersBuilt = true;
+	ms_message("Phone numbers of friend list [%p] indexed in %i ms", list, (int)(bctbx_get_cur_time_ms() - begin));
+}
+
+static void linphone_friend_list_index_subscriptions(LinphoneFriendList *list, LinphoneFriend *lf) {
+	for (const bctbx_list_t *elem = lf->insubs; elem != NULL; elem = bctbx_list_next(elem))
+		list->indexes->incomingSubscriptions[(const LinphonePrivate::SalOp *)bctbx_list_get_data(elem)] = lf;
+	if (lf->outsub) {
+		list->indexes->outgoingSubscriptions[lf->outsub] = lf;
+		list->indexes->outgoingSubscriptionCallIdsBuilt = false;
+	}
+}
+
+static void linphone_friend_list_unindex_subscriptions(LinphoneFriendList *list, const LinphoneFriend *lf) {
+	for (const bctbx_list_t *elem = lf->insubs; elem != NULL; elem = bctbx_list_next(elem)) {
+		auto it = list->indexes->incomingSubscriptions.find((const LinphonePrivate::SalOp *)bctbx_list_get_data(elem));
+		if (it != list->indexes->incomingSubscriptions.end() && it->second == lf)
+			list->indexes->incomingSubscriptions.erase(it);
+	}
+	if (lf->outsub) {
+		auto it = list->indexes->outgoingSubscriptions.find(lf->outsub);
+		if (it != list->indexes->outgoingSubscriptions.end() && it->second == lf) {
+			list->indexes->outgoingSubscriptions.erase(it);
+			list->indexes->outgoingSubscriptionCallIdsBuilt = false;
+		}
+	}
+}
+
+void linphone_friend_list_update_friend_indexes(LinphoneFriendList *list, LinphoneFriend *lf) {
+	if (!list || !list->indexes || !lf) return;
+	if (list->indexes->phoneNumbersBuilt) {
+		linphone_friend_list_unindex_phone_numbers(list, lf);
+		std::vector<std::pair<std::string, LinphoneAccount *>> normalizations;
+		if (list->lc) normalizations = phone_number_normalizations(list->lc);
+		if (!list->lc || !phone_number_normalizations_match(list->indexes, normalizations))
+			list->indexes->phoneNumbersBuilt = false; /* Rebuilt at the next lookup. */
+		else if (linphone_core_vcard_supported())
+			linphone_friend_list_index_phone_numbers(list, lf, normalizations);
+	}
+	linphone_friend_list_index_subscriptions(list, lf);
+}
+
+void linphone_friend_list_remove_friend_from_indexes(LinphoneFriendList *list, LinphoneFriend *lf) {
+	if (!list || !list->indexes || !lf) return;
+	linphone_friend_list_unindex_phone_numbers(list, lf);
+	linphone_friend_list_unindex_subscriptions(list, lf);
+}
+
+void linphone_friend_list_add_subscription_to_index(LinphoneFriend *lf, LinphonePrivate::SalOp *op, bool_t incoming) {
+	LinphoneFriendList *list = lf->friend_list;
+	if (!list || !list->indexes || !op) return;
+	if (incoming) {
+		list->indexes->incomingSubscriptions[op] = lf;
+	} else {
+		list->indexes->outgoingSubscriptions[op] = lf;
+		list->indexes->outgoingSubscriptionCallIdsBuilt = false;
+	}
+}
+
+void linphone_friend_list_remove_subscription_from_index(LinphoneFriend *lf, LinphonePrivate::SalOp *op, bool_t incoming) {
+	LinphoneFriendList *list = lf->friend_list;
+	if (!list || !list->indexes || !op) return;
+	auto &subscriptions = incoming ? list->indexes->incomingSubscriptions : list->indexes->outgoingSubscriptions;
+	auto it = subscriptions.find(op);
+	if (it != subscriptions.end() && it->second == lf) {
+		subscriptions.erase(it);
+		if (!incoming) list->indexes->outgoingSubscriptionCallIdsBuilt = false;
+	}
+}
+
 static LinphoneFriendList *linphone_friend_list_new(void) {
 	LinphoneFriendList *list = belle_sip_object_new(LinphoneFriendList);
 	list->cbs = linphone_friend_list_cbs_new();
 	list->enable_subscriptions = FALSE;
 	list->friends_map = bctbx_mmap_cchar_new();
 	list->friends_map_uri = bctbx_mmap_cchar_new();
+	list->indexes = new LinphoneFriendListIndexes();
 	list->bodyless_subscription = FALSE;
 	list->type = LinphoneFriendListTypeCardDAV;
 	return list;
@@ -546,6 +872,7 @@ static void linphone_friend_list_destroy(LinphoneFriendList *list) {
 		bctbx_mmap_cchar_delete_with_data(list->friends_map, (void (*)(void *))linphone_friend_unref);
 	if (list->friends_map_uri)
 		bctbx_mmap_cchar_delete_with_data(list->friends_map_uri, (void (*)(void *))linphone_friend_unref);
+	delete list->indexes;
 }
 
 BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(LinphoneFriendList);
@@ -849,6 +1176,8 @@ static LinphoneFriendListStatus _linphone_friend_list_remove_friend(LinphoneFrie
 		iterator = bctbx_list_next(iterator);
 	}
 
+	linphone_core_remove_friend_from_search_index(lf->lc, lf);
+	linphone_friend_list_remove_friend_from_indexes(list, lf);
 	lf->friend_list = NULL;
 	linphone_friend_unref(lf);
 	return LinphoneFriendListOK;
@@ -927,6 +1256,10 @@ static void carddav_updated(LinphoneCardDavContext *cdc, LinphoneFriend *lf_new,
 			elem->data = linphone_friend_ref(lf_new);
 		}
 		linphone_core_store_friend_in_db(lf_new->lc, lf_new);
+		linphone_core_remove_friend_from_search_index(list->lc, lf_old);
+		linphone_friend_list_remove_friend_from_indexes(list, lf_old);
+		linphone_friend_list_update_friend_indexes(list, lf_new);
+		linphone_core_update_friend_search_index(list->lc, lf_new);
 
 		if (cdc->friend_list->cbs->contact_updated_cb) {
 			cdc->friend_list->cbs->contact_updated_cb(list, lf_new, lf_old);
@@ -936,17 +1269,6 @@ static void carddav_updated(LinphoneCardDavContext *cdc, LinphoneFriend *lf_new,
 	}
 }
 
-static int linphone_sql_request_generic(sqlite3* db, const char *stmt) {
-	char* errmsg = NULL;
-	int ret;
-	ret = sqlite3_exec(db, stmt, NULL, NULL, &errmsg);
-	if (ret != SQLITE_OK) {
-		ms_error("linphone_sql_request: statement %s -> error sqlite3_exec(): %s.", stmt, errmsg);
-		sqlite3_free(errmsg);
-	}
-	return ret;
-}
-
 void linphone_friend_list_synchronize_friends_from_server(LinphoneFriendList *list) {
 	if (!list || !list->lc) {
 		ms_error("FATAL ?");
@@ -979,6 +1301,11 @@ void linphone_friend_list_synchronize_friends_from_server(LinphoneFriendList *li
 				const char *url = linphone_config_get_string(list->lc->config, "misc", "contacts-vcard-list", NULL);
 
 				char *buf;
+				/**
+				 * The whole replacement of the list is stored in a single transaction.
+				 */
+				linphone_core_friends_storage_begin_batch(list->lc);
+
 				/**
 				 * We directly remove from the SQLite database the friends, then the friends_lists
 				 * - Because we doesn't have a foreign key between the two tables
@@ -988,11 +1315,11 @@ void linphone_friend_list_synchronize_friends_from_server(LinphoneFriendList *li
 				 */
 
 				buf = sqlite3_mprintf("delete from friends where friend_list_id in (select id from friends_lists where display_name = %Q)", url);
-				linphone_sql_request_generic(list->lc->friends_db, buf);
+				linphone_core_friends_storage_request(list->lc, buf);
 				sqlite3_free(buf);
 
 				buf = sqlite3_mprintf("delete from friends_lists where display_name = %Q", url);
-				linphone_sql_request_generic(list->lc->friends_db, buf);
+				linphone_core_friends_storage_request(list->lc, buf);
 				sqlite3_free(buf);
 
 				/**
@@ -1011,6 +1338,7 @@ void linphone_friend_list_synchronize_friends_from_server(LinphoneFriendList *li
 				linphone_friend_list_import_friends_from_vcard4_buffer(list, body);
 
 				linphone_core_add_friend_list(list->lc, list);
+				linphone_core_friends_storage_end_batch(list->lc);
 
 				NOTIFY_IF_EXIST(SyncStateChanged, sync_status_changed, list, LinphoneFriendListSyncSuccessful, NULL)
 			}
@@ -1102,12 +1430,48 @@ LinphoneFriend *linphone_friend_list_find_friend_by_phone_number(const LinphoneF
 																 const char *phoneNumber) {
 	LinphoneFriend *result = NULL;
 
-	const bctbx_list_t *elem;
-	for (elem = list->friends; elem != NULL; elem = bctbx_list_next(elem)) {
-		LinphoneFriend *lf = (LinphoneFriend *)bctbx_list_get_data(elem);
-		if (linphone_friend_has_phone_number(lf, phoneNumber)) {
-			result = lf;
-			break;
+	if (!phoneNumber || !list->friends) return NULL;
+	if (!list->lc) {
+		/* Phone numbers are normalized with the accounts of the core. */
+		const bctbx_list_t *elem;
+		for (elem = list->friends; elem != NULL; elem = bctbx_list_next(elem)) {
+			LinphoneFriend *lf = (LinphoneFriend *)bctbx_list_get_data(elem);
+			if (linphone_friend_has_phone_number(lf, phoneNumber)) {
+				result = lf;
+				break;
+			}
+		}
+		return result;
+	}
+
+	LinphoneAccount *account = linphone_core_get_default_account(list->lc);
+	if (!linphone_account_is_phone_number(account, phoneNumber)) {
+		ms_warning("Phone number [%s] isn't valid", phoneNumber);
+		return NULL;
+	}
+
+	auto normalizations = phone_number_normalizations(list->lc);
+	if (!list->indexes->phoneNumbersBuilt || !phone_number_normalizations_match(list->indexes, normalizations))
+		linphone_friend_list_build_phone_numbers_index(const_cast<LinphoneFriendList *>(list), normalizations);
+
+	std::unordered_set<const LinphoneFriend *> candidates;
+	for (size_t i = 0; i < normalizations.size(); i++) {
+		char *normalized = linphone_account_normalize_phone_number(normalizations[i].second, phoneNumber);
+		if (!normalized) continue;
+		auto range = list->indexes->phoneNumbers.equal_range(std::to_string(i) + ":" + normalized);
+		ms_free(normalized);
+		for (auto it = range.first; it != range.second; ++it) {
+			result = it->second;
+			candidates.insert(it->second);
+		}
+	}
+	if (candidates.size() > 1) {
+		/* Several friends have this number: return the first one of the list, as a walk through the list would. */
+		for (const bctbx_list_t *elem = list->friends; elem != NULL; elem = bctbx_list_next(elem)) {
+			if (candidates.count((const LinphoneFriend *)bctbx_list_get_data(elem))) {
+				result = (LinphoneFriend *)bctbx_list_get_data(elem);
+				break;
+			}
 		}
 	}
 
@@ -1178,21 +1542,44 @@ LinphoneFriend *linphone_friend_list_find_friend_by_ref_key(const LinphoneFriend
 
 LinphoneFriend *linphone_friend_list_find_friend_by_inc_subscribe(const LinphoneFriendList *list,
 																  LinphonePrivate::SalOp *op) {
-	const bctbx_list_t *elem;
-	for (elem = list->friends; elem != NULL; elem = bctbx_list_next(elem)) {
-		LinphoneFriend *lf = (LinphoneFriend *)bctbx_list_get_data(elem);
-		if (bctbx_list_find(lf->insubs, op))
-			return lf;
-	}
+	auto it = list->indexes->incomingSubscriptions.find(op);
+	if (it == list->indexes->incomingSubscriptions.end()) return NULL;
+	LinphoneFriend *lf = it->second;
+	if (lf->friend_list == list && bctbx_list_find(lf->insubs, op))
+		return lf;
 	return NULL;
 }
 
 LinphoneFriend *linphone_friend_list_find_friend_by_out_subscribe(const LinphoneFriendList *list,
 																  LinphonePrivate::SalOp *op) {
-	const bctbx_list_t *elem;
-	for (elem = list->friends; elem != NULL; elem = bctbx_list_next(elem)) {
-		LinphoneFriend *lf = (LinphoneFriend *)bctbx_list_get_data(elem);
-		if (lf->outsub && ((lf->outsub == op) || lf->outsub->isForkedOf(op)))
+	LinphoneFriendListIndexes *indexes = list->indexes;
+	auto it = indexes->outgoingSubscriptions.find(op);
+	if (it != indexes->outgoingSubscriptions.end()) {
+		LinphoneFriend *lf = it->second;
+		if (lf->friend_list == list && lf->outsub == op)
+			return lf;
+	}
+
+	/* Not one of our ops: it may be a fork of one of them, which shares its Call-ID. */
+	if (op->getCallId().empty() || indexes->outgoingSubscriptions.empty()) return NULL;
+	if (!indexes->outgoingSubscriptionCallIdsBuilt) {
+		indexes->outgoingSubscriptionCallIds.clear();
+		indexes->outgoingSubscriptionCallIdsBuilt = true;
+		for (const auto &subscription : indexes->outgoingSubscriptions) {
+			const LinphoneFriend *lf = subscription.second;
+			if (lf->outsub != subscription.first) continue;
+			if (lf->outsub->getCallId().empty()) {
+				/* Not sent yet: look its Call-ID up again next time. */
+				indexes->outgoingSubscriptionCallIdsBuilt = false;
+				continue;
+			}
+			indexes->outgoingSubscriptionCallIds[lf->outsub->getCallId()] = subscription.second;
+		}
+	}
+	auto callIdIt = indexes->outgoingSubscriptionCallIds.find(op->getCallId());
+	if (callIdIt != indexes->outgoingSubscriptionCallIds.end()) {
+		LinphoneFriend *lf = callIdIt->second;
+		if (lf->friend_list == list && lf->outsub && lf->outsub->isForkedOf(op))
 			return lf;
 	}
 	return NULL;
@@ -1465,6 +1852,7 @@ static LinphoneStatus linphone_friend_list_import_friends_from_vcard4(LinphoneFr
 
 	vcards_iterator = vcards;
 
+	linphone_core_friends_storage_begin_batch(list->lc);
 	while (vcards_iterator != NULL && bctbx_list_get_data(vcards_iterator) != NULL) {
 		LinphoneVcard *vcard = (LinphoneVcard *)bctbx_list_get_data(vcards_iterator);
 		LinphoneFriend *lf = linphone_friend_new_from_vcard(vcard);
@@ -1480,6 +1868,7 @@ static LinphoneStatus linphone_friend_list_import_friends_from_vcard4(LinphoneFr
 	}
 	bctbx_list_free(vcards);
 	linphone_core_store_friends_list_in_db(list->lc, list);
+	linphone_core_friends_storage_end_batch(list->lc);
 	return count;
 }
 LinphoneStatus linphone_friend_list_import_friends_from_vcard4_file(LinphoneFriendList *list, const char *vcard_file) {
@@ -2397,6 +2397,9 @@ static void misc_config_read (LinphoneCore *lc) {
 
 	lc->send_call_stats_periodical_updates = !!linphone_config_get_int(config, "misc", "send_call_stats_periodical_updates", 0);
 
+	/* Optionally keep the blocking file writes out of linphone_core_iterate(). */
+	linphone_config_enable_background_sync(config, linphone_config_get_bool(config, "misc", "config_background_sync", FALSE));
+
 	const char *contacts_vcard_list_uri = linphone_config_get_string(lc->config, "misc", "contacts-vcard-list", NULL);
 	if (contacts_vcard_list_uri) {
 		lc->base_contacts_list_for_synchronization = linphone_core_get_friend_list_by_name(lc, contacts_vcard_list_uri);
@@ -3499,6 +3502,8 @@ void linphone_core_remove_friend_list(LinphoneCore *lc, LinphoneFriendList *list
 	if (elem == NULL) return;
 	linphone_core_remove_friends_list_from_db(lc, list);
 	linphone_core_notify_friend_list_removed(lc, list);
+	for (const bctbx_list_t *it = list->friends; it; it = bctbx_list_next(it))
+		linphone_core_remove_friend_from_search_index(lc, (LinphoneFriend *)bctbx_list_get_data(it));
 	list->lc = NULL;
 	linphone_friend_list_unref(list);
 	lc->friends_lists = bctbx_list_erase_link(lc->friends_lists, elem);
@@ -3519,6 +3524,9 @@ void linphone_core_add_friend_list(LinphoneCore *lc, LinphoneFriendList *list) {
 		list->lc = lc;
 	}
 	lc->friends_lists = bctbx_list_append(lc->friends_lists, linphone_friend_list_ref(list));
+	// Friends imported before the list was given to the core were not indexed.
+	for (const bctbx_list_t *it = list->friends; it; it = bctbx_list_next(it))
+		linphone_core_update_friend_search_index(lc, (LinphoneFriend *)bctbx_list_get_data(it));
 	linphone_core_store_friends_list_in_db(lc, list);
 	linphone_core_notify_friend_list_created(lc, list);
 }
@@ -4124,6 +4132,18 @@ static void linphone_core_do_plugin_tasks(LinphoneCore *lc){
 	}
 }
 
+/* Whether linphone_core_do_plugin_tasks() has something to do at next iterate. */
+static bool_t linphone_core_has_plugin_tasks(LinphoneCore *lc){
+	LinphoneProxyConfig *cfg=linphone_core_get_default_proxy_config(lc);
+	if (!cfg) return FALSE;
+	if (lc->bl_reqs) return TRUE;
+	if (lc->bl_refresh){
+		SipSetupContext *ctx=linphone_proxy_config_get_sip_setup_context(cfg);
+		return ctx && (sip_setup_context_get_capabilities(ctx) & SIP_SETUP_CAP_BUDDY_LOOKUP);
+	}
+	return FALSE;
+}
+
 void linphone_core_iterate(LinphoneCore *lc){
 	uint64_t curtime_ms = ms_get_cur_time_ms(); /*monotonic time*/
 	time_t current_real_time = ms_time(NULL);
@@ -4230,6 +4250,70 @@ void linphone_core_iterate(LinphoneCore *lc){
 	}
 }
 
+/* Period at which linphone_core_iterate() keeps being called while calls, previews, rings, hooks or tasks fed by other
+ * threads are active: these are polled, not driven by the SIP stack main loop. The media events pumped from msevq are
+ * only posted by the filters of these running graphs. */
+#define LINPHONE_CORE_BUSY_ITERATE_PERIOD_MS 20
+
+static bool_t linphone_core_needs_periodic_iterate(LinphoneCore *lc) {
+	LinphoneGlobalState state = linphone_core_get_global_state(lc);
+	return state == LinphoneGlobalConfiguring || state == LinphoneGlobalShutdown
+		|| L_GET_PRIVATE_FROM_C_OBJECT(lc)->hasCalls()
+		|| lc->hooks.hooks != NULL
+		|| lc->ecc != NULL
+		|| lc->previewstream != NULL || linphone_core_video_preview_enabled(lc)
+		|| (lc->ringtoneplayer && linphone_ringtoneplayer_is_started(lc->ringtoneplayer))
+		|| L_GET_PRIVATE_FROM_C_OBJECT(lc)->getToneManager().hasRingStream()
+		|| linphone_core_has_plugin_tasks(lc)
+		|| liblinphone_serialize_logs;
+}
+
+int linphone_core_get_next_iterate_delay(LinphoneCore *lc) {
+	int64_t delay = -1;
+	bool_t one_second_work = FALSE;
+	const bctbx_list_t *elem;
+
+	if (lc->preview_finished || lc->network_reachable_to_be_notified) return 0;
+	if (linphone_core_needs_periodic_iterate(lc)) return LINPHONE_CORE_BUSY_ITERATE_PERIOD_MS;
+
+	for (elem = lc->sip_conf.proxies; elem != NULL; elem = elem->next) {
+		Account *account = Account::toCpp(((LinphoneProxyConfig *)elem->data)->account);
+		if (account->needsUpdate()) return 0;
+		/* Waiting for the network or for a registration: checked again at each one second tick. */
+		if (account->hasPendingUpdate()) one_second_work = TRUE;
+	}
+	if (lc->sip_conf.deleted_proxies != NULL || linphone_config_needs_commit(lc->config)) one_second_work = TRUE;
+	for (elem = lc->friends_lists; elem != NULL && !one_second_work; elem = elem->next) {
+		LinphoneFriendList *list = (LinphoneFriendList *)elem->data;
+		if (list->dirty_friends_to_update && list->type == LinphoneFriendListTypeCardDAV) one_second_work = TRUE;
+	}
+
+	if (lc->sip_network_state.global_state && lc->netup_time != 0 && !lc->initial_subscribes_sent) {
+		delay = MAX((int64_t)(lc->netup_time + 2 - ms_time(NULL)) * 1000, 0);
+	}
+	if (one_second_work) {
+		int64_t tick = 0;
+		if (lc->prevtime_ms != 0) tick = MAX((int64_t)(lc->prevtime_ms + 1000 - ms_get_cur_time_ms()), 0);
+		delay = (delay < 0) ? tick : MIN(delay, tick);
+	}
+	return (int)delay;
+}
+
+void linphone_core_wait_for_events(LinphoneCore *lc, int max_wait_ms) {
+	int delay = linphone_core_get_next_iterate_delay(lc);
+	if (delay < 0 || delay > max_wait_ms) delay = max_wait_ms;
+	if (delay > 0 && lc->sal) {
+		lc->iterate_waiting = TRUE;
+		lc->sal->wait(delay);
+		lc->iterate_waiting = FALSE;
+	}
+	linphone_core_iterate(lc);
+}
+
+void linphone_core_wake_up_iterate(LinphoneCore *lc) {
+	if (lc->iterate_waiting && lc->sal) lc->sal->wakeUp();
+}
+
 LinphoneAddress * linphone_core_interpret_url(LinphoneCore *lc, const char *url) {
 	return linphone_core_interpret_url_2(lc, url, TRUE);
 }
@@ -7420,6 +7504,8 @@ void _linphone_core_stop_async_end(LinphoneCore *lc) {
 	L_GET_PRIVATE_FROM_C_OBJECT(lc)->disconnectMainDb();
 
 	if (linphone_config_needs_commit(lc->config)) linphone_core_config_sync(lc);
+	/* Write the last snapshot before returning: the application may exit or reuse the file right after. */
+	linphone_config_enable_background_sync(lc->config, FALSE);
 
 	bctbx_list_for_each(lc->call_logs,(void (*)(void*))linphone_call_log_unref);
 	lc->call_logs=bctbx_list_free(lc->call_logs);
@@ -7602,6 +7688,7 @@ static void set_sip_network_reachable(LinphoneCore* lc,bool_t is_sip_reachable,
 
 	if (lc->sip_network_state.global_state==is_sip_reachable) return; // no change, ignore.
 	lc->network_reachable_to_be_notified=TRUE;
+	linphone_core_wake_up_iterate(lc);
 
 	if (is_sip_reachable) {
 		if (lc->sip_conf.guess_hostname) update_primary_contact(lc);
@@ -44,6 +44,12 @@
 #include <stdlib.h>
 #include <string.h>
 #include <assert.h>
+#include <atomic>
+#include <condition_variable>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <unordered_map>
 #if !defined(_WIN32_WCE)
 #include <errno.h>
 #include <sys/types.h>
@@ -81,8 +87,32 @@ typedef struct _LpItem{
 	int is_comment;
 	bool_t overwrite; // If set to true, will add overwrite=true when converted to xml
 	bool_t skip; // If set to true, won't be dumped when converted to xml
+	bool_t int_value_cached; // Set once value has been parsed by linphone_config_get_int(), reset when value changes
+	int int_value;
 } LpItem;
 
+/* Sections and items are indexed by their name, pointing to the string owned by the indexed element:
+ * lookups are done from the C string given by the caller, without any copy. */
+struct LpNameHash {
+	size_t operator()(const char *name) const {
+		/* FNV-1a */
+		size_t hash = (size_t)2166136261U;
+		for (; *name != '\0'; name++) {
+			hash ^= (unsigned char)*name;
+			hash *= (size_t)16777619U;
+		}
+		return hash;
+	}
+};
+
+struct LpNameEqual {
+	bool operator()(const char *a, const char *b) const {
+		return strcmp(a, b) == 0;
+	}
+};
+
+typedef std::unordered_map<const char *, LpItem *, LpNameHash, LpNameEqual> LpItemIndex;
+
 typedef struct _LpSectionParam{
 	char *key;
 	char *value;
@@ -90,22 +120,29 @@ typedef struct _LpSectionParam{
 
 typedef struct _LpSection{
 	char *name;
-	bctbx_list_t *items;
+	bctbx_list_t *items; // Kept in file order for serialization, items_index is used for lookups
+	LpItemIndex *items_index;
 	bctbx_list_t *params;
 	bool_t overwrite; // If set to true, will add overwrite=true to all items of this section when converted to xml
 	bool_t skip; // If set to true, won't be dumped when converted to xml
 } LpSection;
 
+typedef std::unordered_map<const char *, LpSection *, LpNameHash, LpNameEqual> LpSectionIndex;
+
+class LpConfigWriter;
+
 struct _LpConfig{
 	belle_sip_object_t base;
 	bctbx_vfs_file_t* pFile;
 	char *filename;
 	char *tmpfilename;
 	char *factory_filename;
-	bctbx_list_t *sections;
+	bctbx_list_t *sections; // Kept in file order for serialization, sections_index is used for lookups
+	LpSectionIndex *sections_index;
 	bool_t modified;
 	bool_t readonly;
 	bctbx_vfs_t* g_bctbx_vfs;
+	LpConfigWriter *writer; // Set when the background sync is enabled
 };
 
 BELLE_SIP_DECLARE_NO_IMPLEMENTED_INTERFACES(LinphoneConfig);
@@ -156,6 +193,7 @@ LpSectionParam *lp_section_param_new(const char *key, const char *value){
 LpSection *lp_section_new(const char *name){
 	LpSection *sec=lp_new0(LpSection,1);
 	sec->name=ortp_strdup(name);
+	sec->items_index=new LpItemIndex();
 	return sec;
 }
 
@@ -174,6 +212,7 @@ void lp_section_param_destroy(void *section_param){
 }
 
 void lp_section_destroy(LpSection *sec){
+	delete sec->items_index;
 	ortp_free(sec->name);
 	bctbx_list_for_each(sec->items,lp_item_destroy);
 	bctbx_list_for_each(sec->params,lp_section_param_destroy);
@@ -181,12 +220,19 @@ void lp_section_destroy(LpSection *sec){
 	free(sec);
 }
 
+void lp_item_set_value(LpItem *item, const char *value);
+
 void lp_section_add_item(LpSection *sec,LpItem *item){
 	sec->items=bctbx_list_append(sec->items,(void *)item);
+	/* Like the linear search it replaces, the index returns the first item having this key. */
+	if (!item->is_comment) sec->items_index->emplace(item->key, item);
 }
 
 void linphone_config_add_section(LpConfig *lpconfig, LpSection *section){
 	lpconfig->sections=bctbx_list_append(lpconfig->sections,(void *)section);
+	/* The config is allocated by belle_sip_object_new(), which does not run constructors. */
+	if (!lpconfig->sections_index) lpconfig->sections_index = new LpSectionIndex();
+	lpconfig->sections_index->emplace(section->name, section);
 }
 
 void linphone_config_add_section_param(LpSection *section, LpSectionParam *param){
@@ -195,11 +241,37 @@ void linphone_config_add_section_param(LpSection *section, LpSectionParam *param
 
 void linphone_config_remove_section(LpConfig *lpconfig, LpSection *section){
 	lpconfig->sections=bctbx_list_remove(lpconfig->sections,(void *)section);
+	auto it = lpconfig->sections_index->find(section->name);
+	if (it != lpconfig->sections_index->end() && it->second == section) {
+		lpconfig->sections_index->erase(it);
+		/* Another section may have the same name, the index then returns the first remaining one. */
+		for (bctbx_list_t *elem = lpconfig->sections; elem != NULL; elem = bctbx_list_next(elem)) {
+			LpSection *other = (LpSection *)bctbx_list_get_data(elem);
+			if (strcmp(other->name, section->name) == 0) {
+				lpconfig->sections_index->emplace(other->name, other);
+				break;
+			}
+		}
+	}
 	lp_section_destroy(section);
 }
 
 void lp_section_remove_item(LpSection *sec, LpItem *item){
 	sec->items=bctbx_list_remove(sec->items,(void *)item);
+	if (!item->is_comment) {
+		auto it = sec->items_index->find(item->key);
+		if (it != sec->items_index->end() && it->second == item) {
+			sec->items_index->erase(it);
+			/* Another item may have the same key, the index then returns the first remaining one. */
+			for (bctbx_list_t *elem = sec->items; elem != NULL; elem = bctbx_list_next(elem)) {
+				LpItem *other = (LpItem *)bctbx_list_get_data(elem);
+				if (!other->is_comment && strcmp(other->key, item->key) == 0) {
+					sec->items_index->emplace(other->key, other);
+					break;
+				}
+			}
+		}
+	}
 	lp_item_destroy(item);
 }
 
@@ -220,17 +292,9 @@ static int is_a_comment(const char *str){
 }
 
 LpSection *linphone_config_find_section(const LpConfig *lpconfig, const char *name){
-	LpSection *sec;
-	bctbx_list_t *elem = lpconfig->sections;
-	/*printf("Looking for section %s\n",name);*/
-	for (;elem!=NULL;elem=bctbx_list_next(elem)){
-		sec=(LpSection*)elem->data;
-		if (strcmp(sec->name,name)==0){
-			/*printf("Section %s found\n",name);*/
-			return sec;
-		}
-	}
-	return NULL;
+	if (lpconfig->sections_index == NULL) return NULL;
+	auto it = lpconfig->sections_index->find(name);
+	return it != lpconfig->sections_index->end() ? it->second : NULL;
 }
 
 LpSectionParam *lp_section_find_param(const LpSection *sec, const char *key){
@@ -260,17 +324,8 @@ LpItem *lp_section_find_comment(const LpSection *sec, const char *comment){
 }
 
 LpItem *lp_section_find_item(const LpSection *sec, const char *name){
-	bctbx_list_t *elem;
-	LpItem *item;
-	/*printf("Looking for item %s\n",name);*/
-	for (elem=sec->items;elem!=NULL;elem=bctbx_list_next(elem)){
-		item=(LpItem*)elem->data;
-		if (!item->is_comment && strcmp(item->key,name)==0) {
-			/*printf("Item %s found\n",name);*/
-			return item;
-		}
-	}
-	return NULL;
+	auto it = sec->items_index->find(name);
+	return it != sec->items_index->end() ? it->second : NULL;
 }
 
 bctbx_list_t *lp_section_get_items(const LpSection *sec){
@@ -377,8 +432,7 @@ static LpSection* linphone_config_parse_line(LpConfig* lpconfig, char* line, LpS
 							if (item==NULL){
 								lp_section_add_item(cur,lp_item_new(key,pos1));
 							}else{
-								ortp_free(item->value);
-								item->value=ortp_strdup(pos1);
+								lp_item_set_value(item, pos1);
 							}
 							/*ms_message("Found %s=%s",key,pos1);*/
 						}else{
@@ -629,15 +683,18 @@ void lp_item_set_value(LpItem *item, const char *value){
 		char *prev_value=item->value;
 		item->value=ortp_strdup(value);
 		ortp_free(prev_value);
+		item->int_value_cached=FALSE;
 	}
 }
 
 
 static void _linphone_config_uninit(LpConfig *lpconfig){
+	linphone_config_enable_background_sync(lpconfig, FALSE);
 	if (lpconfig->filename!=NULL) ortp_free(lpconfig->filename);
 	if (lpconfig->tmpfilename) ortp_free(lpconfig->tmpfilename);
 	if (lpconfig->factory_filename) bctbx_free(lpconfig->factory_filename);
 	if (lpconfig->sections) bctbx_list_free_with_data(lpconfig->sections, (bctbx_list_free_func)lp_section_destroy);
+	delete lpconfig->sections_index;
 }
 
 LpConfig *linphone_config_ref(LpConfig *lpconfig){
@@ -718,26 +775,36 @@ bool_t linphone_config_get_range(const LpConfig *lpconfig, const char *section,
 	}
 }
 
-int linphone_config_get_int(const LpConfig *lpconfig,const char *section, const char *key, int default_value){
-	const char *str=linphone_config_get_string(lpconfig,section,key,NULL);
-	if (str!=NULL) {
-		int ret=0;
+static LpItem *linphone_config_find_item(const LpConfig *lpconfig, const char *section, const char *key){
+	LpSection *sec=linphone_config_find_section(lpconfig,section);
+	return sec!=NULL ? lp_section_find_item(sec,key) : NULL;
+}
 
-		if (strstr(str,"0x")==str){
-			sscanf(str,"%x",&ret);
+/* Hot keys are read many times per call and per iteration: the parsed value is kept in the item until it changes. */
+static int lp_item_get_int_value(LpItem *item){
+	if (!item->int_value_cached) {
+		int ret=0;
+		if (strstr(item->value,"0x")==item->value){
+			sscanf(item->value,"%x",&ret);
 		}else
-			sscanf(str,"%i",&ret);
-		return ret;
+			sscanf(item->value,"%i",&ret);
+		item->int_value=ret;
+		item->int_value_cached=TRUE;
 	}
+	return item->int_value;
+}
+
+int linphone_config_get_int(const LpConfig *lpconfig,const char *section, const char *key, int default_value){
+	LpItem *item=linphone_config_find_item(lpconfig,section,key);
+	if (item!=NULL) return lp_item_get_int_value(item);
 	else return default_value;
 }
 
 bool_t linphone_config_get_bool(const LpConfig *lpconfig, const char *section, const char *key, bool_t default_value) {
-	const char *str = linphone_config_get_string(lpconfig, section, key, NULL);
-	if (str != NULL) {
-		int ret = 0;
-		sscanf(str, "%i", &ret);
-		return ret != 0;
+	LpItem *item = linphone_config_find_item(lpconfig, section, key);
+	if (item != NULL) {
+		/* "%i" also reads hexadecimal values: same zero test as linphone_config_get_int(). */
+		return lp_item_get_int_value(item) != 0;
 	}
 	return default_value;
 }
@@ -917,83 +984,199 @@ void linphone_config_set_skip_flag_for_section(LpConfig *lpconfig, const char *s
 	}
 }
 
-void lp_item_write(LpItem *item, LpConfig *lpconfig){
-	int ret =-1 ;
+void lp_item_write(LpItem *item, std::string *buffer){
 	if (item->is_comment){
-		ret = (int)bctbx_file_fprintf(lpconfig->pFile, 0, "%s\n",item->value);
-
+		buffer->append(item->value).append("\n");
 	}
 	else if (item->value && item->value[0] != '\0' ){
-		ret = (int)bctbx_file_fprintf(lpconfig->pFile, 0, "%s=%s\n",item->key,item->value);
+		buffer->append(item->key).append("=").append(item->value).append("\n");
 	}
-
 	else {
 		ms_warning("Not writing item %s to file, it is empty", item->key);
 	}
-	if (ret < 0){
-		ms_error("lp_item_write : not writing item to file" );
-	}
 }
 
-void lp_section_param_write(LpSectionParam *param, LpConfig *lpconfig){
+void lp_section_param_write(LpSectionParam *param, std::string *buffer){
 	if( param->value && param->value[0] != '\0') {
-		bctbx_file_fprintf(lpconfig->pFile, 0, " %s=%s", param->key, param->value);
-
+		buffer->append(" ").append(param->key).append("=").append(param->value);
 	} else {
 		ms_warning("Not writing param %s to file, it is empty", param->key);
 	}
 }
 
-void lp_section_write(LpSection *sec,LpConfig *lpconfig){
+void lp_section_write(LpSection *sec, std::string *buffer){
+	buffer->append("[").append(sec->name);
+	bctbx_list_for_each2(sec->params, (void (*)(void*, void*))lp_section_param_write, (void *)buffer);
+	buffer->append("]\n");
+	bctbx_list_for_each2(sec->items, (void (*)(void*, void*))lp_item_write, (void *)buffer);
+	buffer->append("\n");
+}
 
-	if (bctbx_file_fprintf(lpconfig->pFile, 0, "[%s",sec->name) < 0) ms_error("lp_section_write : write error on %s", sec->name);
-	bctbx_list_for_each2(sec->params, (void (*)(void*, void*))lp_section_param_write, (void *)lpconfig);
+/* Writes the serialized config in the temporary file, then renames it over the config file:
+ * a crash while writing never leaves a truncated config file. */
+static int lp_config_write_file(bctbx_vfs_t *vfs, const char *filename, const char *tmpfilename, const std::string &content){
+	bctbx_vfs_file_t *pFile = bctbx_file_open(vfs, tmpfilename, "w");
+	if (pFile == NULL){
+		ms_warning("Could not write %s ! Maybe it is read-only. Configuration will not be saved.", filename);
+		return -1;
+	}
+	if (bctbx_file_write(pFile, content.c_str(), content.size(), 0) != (ssize_t)content.size()){
+		ms_error("lp_config_write_file : write error on %s", tmpfilename);
+	}
+	bctbx_file_close(pFile);
 
-	if (bctbx_file_fprintf(lpconfig->pFile, 0, "]\n")< 0) ms_error("lp_section_write : write error ");
-	bctbx_list_for_each2(sec->items, (void (*)(void*, void*))lp_item_write, (void *)lpconfig);
+#ifdef RENAME_REQUIRES_NONEXISTENT_NEW_PATH
+	/* On windows, rename() does not accept that the newpath is an existing file, while it is accepted on Unix.
+	 * As a result, we are forced to first delete the linphonerc file, and then rename.*/
+	if (remove(filename)!=0){
+		ms_error("Cannot remove %s: %s",filename, strerror(errno));
+	}
+#endif
+	if (rename(tmpfilename,filename)!=0){
+		ms_error("Cannot rename %s into %s: %s",tmpfilename,filename,strerror(errno));
+	}
+	return 0;
+}
 
-	if (bctbx_file_fprintf(lpconfig->pFile, 0, "\n")< 0) ms_error("lp_section_write : write error");
+/* Writes the snapshots given by linphone_config_sync() from its own thread. Only the last snapshot matters:
+ * a snapshot that has not been picked up yet is replaced by the next one. */
+class LpConfigWriter {
+public:
+	LpConfigWriter(bctbx_vfs_t *vfs, const char *filename, const char *tmpfilename)
+		: mVfs(vfs), mFilename(filename), mTmpFilename(tmpfilename) {
+		mThread = std::thread(&LpConfigWriter::run, this);
+	}
 
-}
+	~LpConfigWriter() {
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			mStopped = true;
+		}
+		mCondition.notify_all();
+		mThread.join();
+	}
+
+	void write(std::string &&content) {
+		{
+			std::lock_guard<std::mutex> lock(mMutex);
+			if (mHasPending) mCoalescedCount++;
+			mPending = std::move(content);
+			mHasPending = true;
+		}
+		mCondition.notify_all();
+	}
+
+	void flush() {
+		std::unique_lock<std::mutex> lock(mMutex);
+		mCondition.wait(lock, [this] { return !mHasPending && !mWriting; });
+	}
+
+	bool hasFailed() const {
+		return mFailed;
+	}
+
+	int getCoalescedCount() {
+		std::lock_guard<std::mutex> lock(mMutex);
+		return mCoalescedCount;
+	}
+
+private:
+	void run() {
+		std::unique_lock<std::mutex> lock(mMutex);
+		for (;;) {
+			mCondition.wait(lock, [this] { return mHasPending || mStopped; });
+			/* Pending snapshots are written before stopping. */
+			if (!mHasPending) return;
+
+			std::string content = std::move(mPending);
+			mHasPending = false;
+			mWriting = true;
+			lock.unlock();
+			if (lp_config_write_file(mVfs, mFilename.c_str(), mTmpFilename.c_str(), content) != 0) mFailed = true;
+			lock.lock();
+			mWriting = false;
+			mCondition.notify_all();
+		}
+	}
+
+	bctbx_vfs_t *mVfs;
+	const std::string mFilename;
+	const std::string mTmpFilename;
+
+	std::thread mThread;
+	std::mutex mMutex;
+	std::condition_variable mCondition;
+	std::string mPending;
+	bool mHasPending = false;
+	bool mWriting = false;
+	bool mStopped = false;
+	int mCoalescedCount = 0;
+	std::atomic<bool> mFailed{false};
+};
 
 LinphoneStatus linphone_config_sync(LpConfig *lpconfig){
-	bctbx_vfs_file_t *pFile = NULL;
 	if (lpconfig->filename==NULL) return -1;
 	if (lpconfig->readonly) return 0;
+	if (lpconfig->writer && lpconfig->writer->hasFailed()) {
+		/* The background writer could not write the file: the snapshots it had are not on disk, as with a failed synchronous sync. */
+		lpconfig->readonly = TRUE;
+		lpconfig->modified = TRUE;
+		return -1;
+	}
 
 #ifndef _WIN32
 	/* don't create group/world-accessible files */
 	(void) umask(S_IRWXG | S_IRWXO);
 #endif
-	pFile  = bctbx_file_open(lpconfig->g_bctbx_vfs,lpconfig->tmpfilename, "w");
-	lpconfig->pFile = pFile;
-	if (pFile == NULL){
-		ms_warning("Could not write %s ! Maybe it is read-only. Configuration will not be saved.",lpconfig->filename);
+	/* Serializing in memory is the snapshot: the background writer only does the blocking I/O. */
+	std::string content;
+	bctbx_list_for_each2(lpconfig->sections,(void (*)(void *,void*))lp_section_write,(void *)&content);
+	lpconfig->modified = FALSE;
+
+	if (lpconfig->writer) {
+		lpconfig->writer->write(std::move(content));
+		return 0;
+	}
+
+	if (lp_config_write_file(lpconfig->g_bctbx_vfs, lpconfig->filename, lpconfig->tmpfilename, content) != 0) {
 		lpconfig->readonly = TRUE;
+		lpconfig->modified = TRUE;
 		return -1;
 	}
+	return 0;
+}
 
-	bctbx_list_for_each2(lpconfig->sections,(void (*)(void *,void*))lp_section_write,(void *)lpconfig);
-	bctbx_file_close(pFile);
-
-#ifdef RENAME_REQUIRES_NONEXISTENT_NEW_PATH
-	/* On windows, rename() does not accept that the newpath is an existing file, while it is accepted on Unix.
-	 * As a result, we are forced to first delete the linphonerc file, and then rename.*/
-	if (remove(lpconfig->filename)!=0){
-		ms_error("Cannot remove %s: %s",lpconfig->filename, strerror(errno));
+void linphone_config_enable_background_sync(LinphoneConfig *lpconfig, bool_t enable) {
+	if (enable) {
+		if (!lpconfig->writer && lpconfig->filename && lpconfig->tmpfilename)
+			lpconfig->writer = new LpConfigWriter(lpconfig->g_bctbx_vfs, lpconfig->filename, lpconfig->tmpfilename);
+	} else if (lpconfig->writer) {
+		/* The writer writes its pending snapshot before its thread ends. */
+		delete lpconfig->writer;
+		lpconfig->writer = NULL;
 	}
-#endif
-	if (rename(lpconfig->tmpfilename,lpconfig->filename)!=0){
-		ms_error("Cannot rename %s into %s: %s",lpconfig->tmpfilename,lpconfig->filename,strerror(errno));
-	}
-	lpconfig->modified = FALSE;
-	return 0;
+}
+
+bool_t linphone_config_background_sync_enabled(const LinphoneConfig *lpconfig) {
+	return lpconfig->writer != NULL;
+}
+
+void linphone_config_flush(LinphoneConfig *lpconfig) {
+	if (!lpconfig->writer) return;
+	lpconfig->writer->flush();
+	if (lpconfig->writer->hasFailed()) lpconfig->modified = TRUE;
+}
+
+int linphone_config_get_coalesced_sync_count(const LinphoneConfig *lpconfig) {
+	return lpconfig->writer ? lpconfig->writer->getCoalescedCount() : 0;
 }
 
 void linphone_config_reload(LinphoneConfig *lpconfig) {
+	linphone_config_flush(lpconfig);
 	bctbx_list_for_each(lpconfig->sections, (void (*)(void*)) lp_section_destroy);
 	bctbx_list_free(lpconfig->sections);
 	lpconfig->sections = NULL;
+	if (lpconfig->sections_index) lpconfig->sections_index->clear();
 	linphone_config_read_file(lpconfig, lpconfig->filename);
 }
 
@@ -1033,7 +1216,8 @@ void linphone_config_clean_section(LpConfig *lpconfig, const char *section){
 }
 
 bool_t linphone_config_needs_commit(const LpConfig *lpconfig){
-	return lpconfig->modified;
+	/* A failed background write leaves changes that are not on disk, the next sync reports it. */
+	return lpconfig->modified || (lpconfig->writer && lpconfig->writer->hasFailed());
 }
 
 static const char *DEFAULT_VALUES_SUFFIX = "_default_values";
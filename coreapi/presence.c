@@ -19,6 +19,10 @@
  */
 
 #include <cmath>
+#include <functional>
+#include <string>
+#include <utility>
+#include <vector>
 
 #include <bctoolbox/map.h>
 
@@ -27,6 +31,7 @@
 #include "linphone/presence.h"
 
 #include "c-wrapper/c-wrapper.h"
+#include "xml/xml-pull-parser.h"
 
 // TODO: From coreapi. Remove me later.
 #include "private.h"
@@ -1712,6 +1717,271 @@ static LinphonePresenceModel * process_pidf_xml_presence_notification(xmlparsing
 	return model;
 }
 
+static const std::string PidfNamespace = "urn:ietf:params:xml:ns:pidf";
+static const std::string PidfDataModelNamespace = "urn:ietf:params:xml:ns:pidf:data-model";
+static const std::string PidfRpidNamespace = "urn:ietf:params:xml:ns:pidf:rpid";
+static const std::string PidfOnlineNamespace = "http://www.linphone.org/xsds/pidfonline.xsd";
+static const std::string PidfOmaPresNamespace = "urn:oma:xml:prs:pidf:oma-pres";
+
+namespace {
+	struct StreamedPresenceNote {
+		std::string content;
+		std::string lang;
+	};
+
+	struct StreamedPresenceService {
+		std::string id;
+		std::string basic;
+		std::string timestamp;
+		std::string contact;
+		bool online = false;
+		// Service id and version of every service-description.
+		std::vector<std::pair<std::string, std::string>> descriptions;
+		std::vector<StreamedPresenceNote> notes;
+	};
+
+	struct StreamedPresencePerson {
+		std::string id;
+		std::string timestamp;
+		std::vector<std::pair<LinphonePresenceActivityType, std::string>> activities;
+		std::vector<StreamedPresenceNote> activitiesNotes;
+		std::vector<StreamedPresenceNote> notes;
+	};
+
+	enum class StreamedPresenceField {
+		None,
+		Basic,
+		ServiceTimestamp,
+		Contact,
+		ServiceId,
+		ServiceVersion,
+		ServiceNote,
+		PersonTimestamp,
+		Activity,
+		ActivitiesNote,
+		PersonNote,
+		ModelNote
+	};
+}
+
+static const char *streamed_presence_text(const std::string &text) {
+	return text.empty() ? NULL : text.c_str();
+}
+
+static LinphonePresenceNote *streamed_presence_note_new(const StreamedPresenceNote &streamedNote) {
+	if (streamedNote.content.empty()) return NULL;
+	return linphone_presence_note_new(streamedNote.content.c_str(), streamed_presence_text(streamedNote.lang));
+}
+
+static void streamed_presence_add_notes(const std::vector<StreamedPresenceNote> &notes, const std::function<void (LinphonePresenceNote *)> &add) {
+	for (const auto &streamedNote : notes) {
+		LinphonePresenceNote *note = streamed_presence_note_new(streamedNote);
+		if (note) add(note);
+	}
+}
+
+static int streamed_presence_add_service(LinphonePresenceModel *model, const StreamedPresenceService &streamedService) {
+	LinphonePresenceBasicStatus basic_status;
+
+	if (streamedService.basic.empty())
+		return 0;
+	if (streamedService.basic == "open") {
+		basic_status = LinphonePresenceBasicStatusOpen;
+	} else if (streamedService.basic == "closed") {
+		basic_status = LinphonePresenceBasicStatusClosed;
+	} else {
+		/* Invalid value for basic status. */
+		return -1;
+	}
+	if (streamedService.online)
+		model->is_online = TRUE;
+
+	LinphonePresenceService *service = presence_service_new(streamed_presence_text(streamedService.id), basic_status);
+	bctbx_list_t *services = nullptr;
+	for (const auto &description : streamedService.descriptions) {
+		services = bctbx_list_append(services, ms_strdup(description.first.c_str()));
+		linphone_presence_service_add_capability(service, ms_strdup(description.first.c_str()), ms_strdup(streamed_presence_text(description.second)));
+	}
+	if (!streamedService.timestamp.empty()) presence_service_set_timestamp(service, parse_timestamp(streamedService.timestamp.c_str()));
+	if (!streamedService.contact.empty()) linphone_presence_service_set_contact(service, streamedService.contact.c_str());
+	if (services) linphone_presence_service_set_service_descriptions(service, services);
+	streamed_presence_add_notes(streamedService.notes, [service] (LinphonePresenceNote *note) {
+		presence_service_add_note(service, note);
+	});
+	linphone_presence_model_add_service(model, service);
+	linphone_presence_service_unref(service);
+	return 0;
+}
+
+static void streamed_presence_add_person(LinphonePresenceModel *model, const StreamedPresencePerson &streamedPerson) {
+	time_t timestamp = streamedPerson.timestamp.empty() ? time(NULL) : parse_timestamp(streamedPerson.timestamp.c_str());
+	LinphonePresencePerson *person = presence_person_new(streamed_presence_text(streamedPerson.id), timestamp);
+
+	for (const auto &streamedActivity : streamedPerson.activities) {
+		LinphonePresenceActivity *activity = linphone_presence_activity_new(streamedActivity.first, streamed_presence_text(streamedActivity.second));
+		linphone_presence_person_add_activity(person, activity);
+		linphone_presence_activity_unref(activity);
+	}
+	streamed_presence_add_notes(streamedPerson.activitiesNotes, [person] (LinphonePresenceNote *note) {
+		presence_person_add_activities_note(person, note);
+	});
+	streamed_presence_add_notes(streamedPerson.notes, [person] (LinphonePresenceNote *note) {
+		presence_person_add_note(person, note);
+	});
+	presence_model_add_person(model, person);
+	linphone_presence_person_unref(person);
+}
+
+/*
+ * Single pass counterpart of process_pidf_xml_presence_notification(). The XPath based functions above evaluate one
+ * expression per tuple, person and note, each of them walking the document from its root, which makes large bodies
+ * quadratic. The model built here is the same, text contents follow linphone_get_xml_text_content(): only the text
+ * children of an element are kept and an empty text is no text at all.
+ * Returns -1 if the pull parser could not read the document, the caller then falls back on libxml2.
+ */
+static int process_pidf_xml_presence_notification_streamed(const char *body, LinphonePresenceModel **result) {
+	const std::string document(body);
+	XmlPullParser parser(document);
+	LinphonePresenceModel *model = linphone_presence_model_new();
+	StreamedPresenceService service;
+	StreamedPresencePerson person;
+	StreamedPresenceNote note;
+	StreamedPresenceField field = StreamedPresenceField::None;
+	LinphonePresenceActivityType acttype = LinphonePresenceActivityUnknown;
+	std::string text;
+	std::string serviceId;
+	std::string serviceVersion;
+	bool inPresence = false;
+	bool inTuple = false;
+	bool inPerson = false;
+	bool inStatus = false;
+	bool inServiceDescription = false;
+	bool inActivities = false;
+	int fieldDepth = 0;
+
+	for (;;) {
+		const XmlPullParser::Event event = parser.next();
+		if (event == XmlPullParser::Event::Error) {
+			linphone_presence_model_unref(model);
+			return -1;
+		}
+		if (event == XmlPullParser::Event::EndDocument)
+			break;
+
+		const int depth = parser.getDepth();
+		if (event == XmlPullParser::Event::Text) {
+			// Activities keep the text of all their descendants, like xmlNodeGetContent() does.
+			if ((field != StreamedPresenceField::None)
+				&& ((depth == fieldDepth) || ((field == StreamedPresenceField::Activity) && (depth > fieldDepth))))
+				text += parser.getText();
+			continue;
+		}
+
+		const std::string &ns = parser.getNamespace();
+		const std::string &name = parser.getLocalName();
+		if (event == XmlPullParser::Event::StartElement) {
+			if (field != StreamedPresenceField::None)
+				continue;
+			StreamedPresenceField startedField = StreamedPresenceField::None;
+			if (depth == 1) {
+				inPresence = (ns == PidfNamespace) && (name == "presence");
+			} else if (!inPresence) {
+				continue;
+			} else if (depth == 2) {
+				if ((ns == PidfNamespace) && (name == "tuple")) {
+					inTuple = true;
+					service = StreamedPresenceService();
+					parser.getAttribute("id", service.id);
+				} else if ((ns == PidfDataModelNamespace) && (name == "person")) {
+					inPerson = true;
+					person = StreamedPresencePerson();
+					parser.getAttribute("id", person.id);
+				} else if ((ns == PidfNamespace) && (name == "note")) {
+					startedField = StreamedPresenceField::ModelNote;
+				}
+			} else if ((depth == 3) && inTuple) {
+				if (ns == PidfNamespace) {
+					if (name == "status") inStatus = true;
+					else if (name == "timestamp") startedField = StreamedPresenceField::ServiceTimestamp;
+					else if (name == "contact") startedField = StreamedPresenceField::Contact;
+					else if (name == "note") startedField = StreamedPresenceField::ServiceNote;
+				} else if ((ns == PidfOmaPresNamespace) && (name == "service-description")) {
+					inServiceDescription = true;
+					serviceId.clear();
+					serviceVersion.clear();
+				}
+			} else if ((depth == 3) && inPerson) {
+				if ((ns == PidfNamespace) && (name == "timestamp")) startedField = StreamedPresenceField::PersonTimestamp;
+				else if ((ns == PidfRpidNamespace) && (name == "activities")) inActivities = true;
+				else if ((ns == PidfDataModelNamespace) && (name == "note")) startedField = StreamedPresenceField::PersonNote;
+			} else if ((depth == 4) && inStatus) {
+				if ((ns == PidfNamespace) && (name == "basic")) startedField = StreamedPresenceField::Basic;
+				else if ((ns == PidfOnlineNamespace) && (name == "online")) service.online = true;
+			} else if ((depth == 4) && inServiceDescription && (ns == PidfOmaPresNamespace)) {
+				if (name == "service-id") startedField = StreamedPresenceField::ServiceId;
+				else if (name == "version") startedField = StreamedPresenceField::ServiceVersion;
+			} else if ((depth == 4) && inActivities && (ns == PidfRpidNamespace)) {
+				if (name == "note") startedField = StreamedPresenceField::ActivitiesNote;
+				else if (activity_name_to_presence_activity_type(name.c_str(), &acttype) == 0) startedField = StreamedPresenceField::Activity;
+			}
+
+			if (startedField != StreamedPresenceField::None) {
+				field = startedField;
+				fieldDepth = depth;
+				text.clear();
+				note = StreamedPresenceNote();
+				parser.getAttribute("xml:lang", note.lang);
+			}
+			continue;
+		}
+
+		// EndElement, the depth is the one of the parent element.
+		const int closedDepth = depth + 1;
+		if (field != StreamedPresenceField::None) {
+			if (closedDepth != fieldDepth)
+				continue;
+			note.content = text;
+			switch (field) {
+				case StreamedPresenceField::Basic: service.basic = text; break;
+				case StreamedPresenceField::ServiceTimestamp: service.timestamp = text; break;
+				case StreamedPresenceField::Contact: service.contact = text; break;
+				case StreamedPresenceField::ServiceId: serviceId = text; break;
+				case StreamedPresenceField::ServiceVersion: serviceVersion = text; break;
+				case StreamedPresenceField::ServiceNote: service.notes.push_back(note); break;
+				case StreamedPresenceField::PersonTimestamp: person.timestamp = text; break;
+				case StreamedPresenceField::Activity: person.activities.emplace_back(acttype, text); break;
+				case StreamedPresenceField::ActivitiesNote: person.activitiesNotes.push_back(note); break;
+				case StreamedPresenceField::PersonNote: person.notes.push_back(note); break;
+				case StreamedPresenceField::ModelNote: {
+					LinphonePresenceNote *modelNote = streamed_presence_note_new(note);
+					if (modelNote) presence_model_add_note(model, modelNote);
+					break;
+				}
+				case StreamedPresenceField::None:
+					break;
+			}
+			field = StreamedPresenceField::None;
+		} else if (closedDepth == 3) {
+			if (inServiceDescription && !serviceId.empty())
+				service.descriptions.emplace_back(serviceId, serviceVersion);
+			inStatus = inServiceDescription = inActivities = false;
+		} else if (closedDepth == 2) {
+			if (inTuple && (streamed_presence_add_service(model, service) < 0)) {
+				linphone_presence_model_unref(model);
+				*result = NULL;
+				return 0;
+			}
+			if (inPerson)
+				streamed_presence_add_person(model, person);
+			inTuple = inPerson = false;
+		}
+	}
+
+	*result = model;
+	return 0;
+}
+
+
 #endif
 
 
@@ -1805,9 +2075,13 @@ void linphone_subscription_new(LinphoneCore *lc, SalSubscribeOp *op, const char
 	ms_free(tmp);
 }
 
+bool_t linphone_presence_streaming_parser_enabled(const LinphoneCore *lc) {
+	return (lc == NULL) || !!linphone_config_get_bool(lc->config, "misc", "xml_streaming_codec", TRUE);
+}
+
 #ifdef HAVE_XML2
 
-void linphone_notify_parse_presence(const char *content_type, const char *content_subtype, const char *body, SalPresenceModel **result) {
+void linphone_notify_parse_presence(LinphoneCore *lc, const char *content_type, const char *content_subtype, const char *body, SalPresenceModel **result) {
 	xmlparsing_context_t *xml_ctx;
 	LinphonePresenceModel *model = NULL;
 
@@ -1817,6 +2091,11 @@ void linphone_notify_parse_presence(const char *content_type, const char *conten
 	}
 
 	if (strcmp(content_subtype, "pidf+xml") == 0) {
+		if (body && linphone_presence_streaming_parser_enabled(lc)
+			&& (process_pidf_xml_presence_notification_streamed(body, &model) == 0)) {
+			*result = (SalPresenceModel *)model;
+			return;
+		}
 		xml_ctx = linphone_xmlparsing_context_new();
 		xmlSetGenericErrorFunc(xml_ctx, linphone_xmlparsing_genericxml_error);
 		xml_ctx->doc = xmlReadDoc((const unsigned char*)body, 0, NULL, 0);
@@ -2135,7 +2414,7 @@ char *linphone_presence_model_to_xml(LinphonePresenceModel *model){
 	return NULL;
 }
 
-void linphone_notify_parse_presence(const char *content_type, const char *content_subtype, const char *body, SalPresenceModel **result){
+void linphone_notify_parse_presence(LinphoneCore *lc, const char *content_type, const char *content_subtype, const char *body, SalPresenceModel **result){
 	if (result) *result = NULL;
 	ms_warning("linphone_notify_parse_presence(): stubbed.");
 }
@@ -2206,6 +2485,7 @@ void linphone_notify_recv(LinphoneCore *lc, SalOp *op, SalSubscribeStatus ss, Sa
 				op->release();
 			}
 			if (lf->outsub){
+				linphone_friend_list_remove_subscription_from_index(lf, lf->outsub, FALSE);
 				lf->outsub->release();
 				lf->outsub=NULL;
 			}
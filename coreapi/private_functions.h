@@ -160,6 +160,8 @@ void linphone_auth_info_fill_belle_sip_event(const LinphoneAuthInfo *auth_info,
 void linphone_core_fill_belle_sip_auth_event(LinphoneCore *lc, belle_sip_auth_event *event, const char *username, const char *domain);
 
 void linphone_core_update_proxy_register(LinphoneCore *lc);
+/* Makes linphone_core_wait_for_events() return early, to process work created by a callback. */
+void linphone_core_wake_up_iterate(LinphoneCore *lc);
 const char *linphone_core_get_nat_address_resolved(LinphoneCore *lc);
 
 int linphone_proxy_config_send_publish(LinphoneProxyConfig *cfg, LinphonePresenceModel *presence);
@@ -182,7 +184,7 @@ LinphonePrivate::SalRegisterOp *linphone_proxy_config_get_op(const LinphoneProxy
 LINPHONE_PUBLIC LinphoneAddress * linphone_proxy_config_get_transport_contact(LinphoneProxyConfig *cfg);
 
 void linphone_friend_list_invalidate_subscriptions(LinphoneFriendList *list);
-void linphone_friend_list_notify_presence_received(LinphoneFriendList *list, LinphoneEvent *lev, const LinphoneContent *body);
+LINPHONE_PUBLIC void linphone_friend_list_notify_presence_received(LinphoneFriendList *list, LinphoneEvent *lev, const LinphoneContent *body);
 void linphone_friend_list_subscription_state_changed(LinphoneCore *lc, LinphoneEvent *lev, LinphoneSubscriptionState state);
 void linphone_friend_list_invalidate_friends_maps(LinphoneFriendList *list);
 
@@ -210,6 +212,10 @@ LinphoneFriend *linphone_friend_list_find_friend_by_inc_subscribe(const Linphone
 LinphoneFriend *linphone_friend_list_find_friend_by_out_subscribe(const LinphoneFriendList *list, LinphonePrivate::SalOp *op);
 LinphoneFriend *linphone_core_find_friend_by_out_subscribe(const LinphoneCore *lc, LinphonePrivate::SalOp *op);
 LinphoneFriend *linphone_core_find_friend_by_inc_subscribe(const LinphoneCore *lc, LinphonePrivate::SalOp *op);
+void linphone_friend_list_update_friend_indexes(LinphoneFriendList *list, LinphoneFriend *lf);
+void linphone_friend_list_remove_friend_from_indexes(LinphoneFriendList *list, LinphoneFriend *lf);
+void linphone_friend_list_add_subscription_to_index(LinphoneFriend *lf, LinphonePrivate::SalOp *op, bool_t incoming);
+void linphone_friend_list_remove_subscription_from_index(LinphoneFriend *lf, LinphonePrivate::SalOp *op, bool_t incoming);
 MSList *linphone_find_friend_by_address(MSList *fl, const LinphoneAddress *addr, LinphoneFriend **lf);
 bool_t linphone_core_should_subscribe_friends_only_when_registered(const LinphoneCore *lc);
 void linphone_core_update_friends_subscriptions(LinphoneCore *lc);
@@ -217,6 +223,7 @@ void _linphone_friend_list_update_subscriptions(LinphoneFriendList *list, Linpho
 void linphone_core_friends_storage_init(LinphoneCore *lc);
 LINPHONE_PUBLIC int linphone_core_friends_storage_resync_friends_lists(LinphoneCore *lc);
 void linphone_core_friends_storage_close(LinphoneCore *lc);
+int linphone_core_friends_storage_request(LinphoneCore *lc, const char *stmt);
 void linphone_core_store_friend_in_db(LinphoneCore *lc, LinphoneFriend *lf);
 void linphone_core_remove_friend_from_db(LinphoneCore *lc, LinphoneFriend *lf);
 void linphone_core_store_friends_list_in_db(LinphoneCore *lc, LinphoneFriendList *list);
@@ -227,6 +234,9 @@ LINPHONE_PUBLIC LinphoneFriendListStatus linphone_friend_list_import_friend(Linp
 LinphoneFriendListCbs * linphone_friend_list_cbs_new(void);
 void linphone_friend_list_set_current_callbacks(LinphoneFriendList *friend_list, LinphoneFriendListCbs *cbs);
 void linphone_friend_add_addresses_and_numbers_into_maps(LinphoneFriend *lf, LinphoneFriendList *list);
+void linphone_friend_update_indexes(LinphoneFriend *lf);
+void linphone_core_update_friend_search_index(LinphoneCore *lc, LinphoneFriend *lf);
+void linphone_core_remove_friend_from_search_index(LinphoneCore *lc, LinphoneFriend *lf);
 
 int linphone_parse_host_port(const char *input, char *host, size_t hostlen, int *port);
 int parse_hostname_to_addr(const char *server, struct sockaddr_storage *ss, socklen_t *socklen, int default_port);
@@ -252,7 +262,8 @@ void linphone_process_authentication(LinphoneCore* lc, LinphonePrivate::SalOp *o
 void linphone_authentication_ok(LinphoneCore *lc, LinphonePrivate::SalOp *op);
 void linphone_subscription_new(LinphoneCore *lc, LinphonePrivate::SalSubscribeOp *op, const char *from);
 void linphone_core_send_presence(LinphoneCore *lc, LinphonePresenceModel *presence);
-void linphone_notify_parse_presence(const char *content_type, const char *content_subtype, const char *body, SalPresenceModel **result);
+void linphone_notify_parse_presence(LinphoneCore *lc, const char *content_type, const char *content_subtype, const char *body, SalPresenceModel **result);
+bool_t linphone_presence_streaming_parser_enabled(const LinphoneCore *lc);
 void linphone_notify_convert_presence_to_xml(LinphonePrivate::SalOp *op, SalPresenceModel *presence, const char *contact, char **content);
 void linphone_notify_recv(LinphoneCore *lc, LinphonePrivate::SalOp *op, SalSubscribeStatus ss, SalPresenceModel *model);
 void linphone_proxy_config_process_authentication_failure(LinphoneCore *lc, LinphonePrivate::SalOp *op);
@@ -420,6 +431,7 @@ void _linphone_chat_message_notify_ephemeral_message_deleted(LinphoneChatMessage
 void _linphone_chat_message_clear_callbacks (LinphoneChatMessage *msg);
 
 void _linphone_magic_search_notify_search_results_received(LinphoneMagicSearch* magic_search);
+void _linphone_magic_search_notify_search_partial_results_received(LinphoneMagicSearch* magic_search, const bctbx_list_t *partial_results);
 void _linphone_magic_search_notify_ldap_have_more_results(LinphoneMagicSearch* magic_search, LinphoneLdap* ldap);
 
 
@@ -32,6 +32,7 @@
 
 #ifndef HAVE_SQLITE
 typedef struct _sqlite3 sqlite3;
+typedef struct _sqlite3_stmt sqlite3_stmt;
 #endif
 
 #include "carddav.h"
@@ -116,6 +117,8 @@ struct _LinphoneFriendListCbs {
 
 BELLE_SIP_DECLARE_VPTR_NO_EXPORT(LinphoneFriendListCbs);
 
+typedef struct _LinphoneFriendListIndexes LinphoneFriendListIndexes;
+
 struct _LinphoneFriendList {
 	belle_sip_object_t base;
 	void *user_data;
@@ -127,6 +130,7 @@ struct _LinphoneFriendList {
 	MSList *friends;
 	bctbx_map_t *friends_map;
 	bctbx_map_t *friends_map_uri;
+	LinphoneFriendListIndexes *indexes; // By phone number and by subscription op, see friendlist.c
 	unsigned char *content_digest;
 	int expected_notification_version;
 	unsigned int storage_id;
@@ -775,13 +779,19 @@ namespace LinphonePrivate {
 	bool_t auto_download_incoming_icalendars; \
 	unsigned long iterate_thread_id; \
 	bool_t record_aware; \
-	bool_t auto_send_ringing;
+	bool_t auto_send_ringing; \
+	bool_t iterate_waiting;
 
 #define LINPHONE_CORE_STRUCT_FIELDS \
 	LINPHONE_CORE_STRUCT_BASE_FIELDS \
 	sqlite3 *zrtp_cache_db; \
 	bctbx_mutex_t zrtp_cache_db_mutex; \
 	sqlite3 *friends_db; \
+	sqlite3_stmt *friends_insert_stmt; \
+	sqlite3_stmt *friends_update_stmt; \
+	sqlite3_stmt *friends_delete_stmt; \
+	int friends_db_batch_depth; \
+	bool_t friends_db_batch_failed; \
 	bool_t debug_storage; \
 	void *system_context; \
 	bool_t is_unreffing; \
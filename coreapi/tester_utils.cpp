@@ -25,6 +25,7 @@
 #include "tester_utils.h"
 #include "private.h"
 
+#include "address/identity-address-parser.h"
 #include "call/call.h"
 #include "chat/chat-room/chat-room-p.h"
 #include "chat/encryption/encryption-engine.h"
@@ -32,8 +33,12 @@
 #include "core/core-p.h"
 #include "c-wrapper/c-wrapper.h"
 #include "conference/session/media-session-p.h"
+#include "containers/sharded-lru-cache.h"
 #include "event-log/conference/conference-chat-message-event.h"
 #include "mediastreamer2/msanalysedisplay.h"
+#include "sal/call-op.h"
+#include "sal/offeranswer.h"
+#include "sal/sal_media_description.h"
 
 using namespace std;
 
@@ -229,6 +234,46 @@ void linphone_core_reset_tone_manager_stats(LinphoneCore *lc) {
 	L_GET_PRIVATE_FROM_C_OBJECT(lc)->getToneManager().resetStats();
 }
 
+const LinphoneCoreImdnSchedulerStats *linphone_core_get_imdn_scheduler_stats(LinphoneCore *lc) {
+	return L_GET_PRIVATE_FROM_C_OBJECT(lc)->getImdnScheduler().getStats();
+}
+
+void linphone_core_reset_imdn_scheduler_stats(LinphoneCore *lc) {
+	L_GET_PRIVATE_FROM_C_OBJECT(lc)->getImdnScheduler().resetStats();
+}
+
+const LinphoneCoreIceSchedulerStats *linphone_core_get_ice_scheduler_stats(LinphoneCore *lc) {
+	return L_GET_PRIVATE_FROM_C_OBJECT(lc)->getIceScheduler().getStats();
+}
+
+void linphone_core_reset_ice_scheduler_stats(LinphoneCore *lc) {
+	L_GET_PRIVATE_FROM_C_OBJECT(lc)->getIceScheduler().resetStats();
+}
+
+static void fill_address_cache_stats(LinphoneCoreAddressCacheStats *stats, const LinphonePrivate::ShardedLruCacheStats &cacheStats) {
+	if (!stats) return;
+	stats->size = cacheStats.size;
+	stats->capacity = cacheStats.capacity;
+	stats->hits = cacheStats.hits;
+	stats->misses = cacheStats.misses;
+	stats->evictions = cacheStats.evictions;
+}
+
+void linphone_core_get_address_cache_stats(LinphoneCore *lc, LinphoneCoreAddressCacheStats *sip_address_stats, LinphoneCoreAddressCacheStats *identity_address_stats) {
+	/* The address caches are shared by all the cores of the process. */
+	fill_address_cache_stats(sip_address_stats, LinphonePrivate::Address::getSipAddressesCacheStats());
+	fill_address_cache_stats(identity_address_stats, LinphonePrivate::IdentityAddressParser::getInstance()->getCacheStats());
+}
+
+void linphone_core_reset_address_cache_stats(LinphoneCore *lc) {
+	LinphonePrivate::Address::resetSipAddressesCacheStats();
+	LinphonePrivate::IdentityAddressParser::getInstance()->resetCacheStats();
+}
+
+int linphone_core_get_indexed_call_count(LinphoneCore *lc) {
+	return (int)L_GET_PRIVATE_FROM_C_OBJECT(lc)->getIndexedCallCount();
+}
+
 const char *linphone_core_get_tone_file(LinphoneCore *lc, LinphoneToneID id){
 	LinphoneToneDescription *tone = L_GET_PRIVATE_FROM_C_OBJECT(lc)->getToneManager().getToneFromId(id);
 	return tone ? tone->audiofile : NULL;
@@ -307,3 +352,24 @@ bool_t linphone_call_compare_video_color(LinphoneCall *call, MSMireControl cl, M
 	return false;
 }
 
+unsigned int linphone_call_replay_incoming_offer_answer(LinphoneCall *call, bool_t payload_match_cache_enabled, int iterations, bool_t *same_answers) {
+	SalCallOp *op = Call::toCpp(call)->getOp();
+	shared_ptr<SalMediaDescription> localDesc = op ? op->getLocalMediaDescription() : nullptr;
+	shared_ptr<SalMediaDescription> remoteDesc = op ? op->getRemoteMediaDescription() : nullptr;
+	unsigned int payloadMatchCount = 0;
+
+	*same_answers = FALSE;
+	if (!localDesc || !remoteDesc)
+		return 0;
+
+	MSFactory *factory = linphone_core_get_ms_factory(linphone_call_get_core(call));
+	const auto reference = OfferAnswerEngine::initiateIncoming(factory, localDesc, remoteDesc, false);
+	*same_answers = TRUE;
+	for (int i = 0; i < iterations; i++) {
+		const auto answer = OfferAnswerEngine::initiateIncoming(factory, localDesc, remoteDesc, false, !!payload_match_cache_enabled, payloadMatchCount);
+		if (answer->equal(*reference) != SAL_MEDIA_DESCRIPTION_UNCHANGED)
+			*same_answers = FALSE;
+	}
+	return payloadMatchCount;
+}
+
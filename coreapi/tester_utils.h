@@ -70,6 +70,35 @@ typedef struct _LinphoneCoreToneManagerStats {
 	int number_of_stopTone;
 } LinphoneCoreToneManagerStats;
 
+typedef struct _LinphoneCoreImdnSchedulerStats {
+	int number_of_queued; /* Delivery, display and error notifications queued */
+	int number_of_sent; /* MESSAGE transactions sent */
+	int number_of_coalesced; /* Notifications that did not need their own transaction */
+	int number_of_pending; /* Chat rooms currently waiting to send their notifications */
+} LinphoneCoreImdnSchedulerStats;
+
+/* Upper bounds in ms of the buckets of the ICE latency histograms, the last bucket has no bound */
+#define LINPHONE_ICE_LATENCY_HISTOGRAM_BOUNDS { 50, 100, 200, 500, 1000, 2000, 5000 }
+#define LINPHONE_ICE_LATENCY_HISTOGRAM_SIZE 8
+
+typedef struct _LinphoneCoreIceSchedulerStats {
+	int number_of_gatherings; /* Server-reflexive and relay candidates gatherings started */
+	int number_of_shared_gatherings; /* Gatherings served with recently observed server-reflexive addresses */
+	int number_of_checks; /* ICE sessions whose connectivity checks were started */
+	int number_of_deferred_checks; /* Connectivity checks delayed by the pacing */
+	int number_of_pending; /* ICE sessions currently waiting to start their connectivity checks */
+	int gathering_latency_histogram[LINPHONE_ICE_LATENCY_HISTOGRAM_SIZE]; /* From the gathering start to its end */
+	int checks_latency_histogram[LINPHONE_ICE_LATENCY_HISTOGRAM_SIZE]; /* From the checks request to the end of the ICE processing */
+} LinphoneCoreIceSchedulerStats;
+
+typedef struct _LinphoneCoreAddressCacheStats {
+	int size; /* Addresses currently cached */
+	int capacity; /* Maximum number of cached addresses, 0 when the cache is disabled */
+	unsigned long long hits;
+	unsigned long long misses;
+	unsigned long long evictions; /* Addresses removed to make room for new ones */
+} LinphoneCoreAddressCacheStats;
+
 typedef struct _LinphoneStreamInternalStats{
 	unsigned int number_of_starts;
 	unsigned int number_of_stops;
@@ -155,6 +184,10 @@ LINPHONE_PUBLIC reporting_session_report_t **linphone_quality_reporting_get_repo
 
 LINPHONE_PUBLIC bool_t linphone_call_compare_video_color(LinphoneCall *call, MSMireControl cl, MediaStreamDir dir, const char *label);
 LINPHONE_PUBLIC bool_t linphone_call_check_rtp_sessions(LinphoneCall *call);
+/* Runs again, iterations times, the offer/answer of an incoming call from its current local and remote media descriptions,
+ * with the payload match cache enabled or not. Returns the number of payload list matchings computed. same_answers is set
+ * to FALSE if an answer differs from the one computed with the default settings. */
+LINPHONE_PUBLIC unsigned int linphone_call_replay_incoming_offer_answer(LinphoneCall *call, bool_t payload_match_cache_enabled, int iterations, bool_t *same_answers);
 
 LINPHONE_PUBLIC void _linphone_chat_room_enable_migration(LinphoneChatRoom *cr, bool_t enable);
 LINPHONE_PUBLIC int _linphone_chat_room_get_transient_message_count (const LinphoneChatRoom *cr);
@@ -162,6 +195,11 @@ LINPHONE_PUBLIC LinphoneChatMessage * _linphone_chat_room_get_first_transient_me
 
 LINPHONE_PUBLIC MSList* linphone_core_fetch_friends_from_db(LinphoneCore *lc, LinphoneFriendList *list);
 LINPHONE_PUBLIC MSList* linphone_core_fetch_friends_lists_from_db(LinphoneCore *lc);
+/* Groups the friends stored until the matching end_batch call in a single transaction, calls can be nested.
+ * The whole batch is rolled back if one of its writes failed. */
+LINPHONE_PUBLIC void linphone_core_friends_storage_begin_batch(LinphoneCore *lc);
+LINPHONE_PUBLIC void linphone_core_friends_storage_end_batch(LinphoneCore *lc);
+LINPHONE_PUBLIC sqlite3 *linphone_core_get_friends_db(LinphoneCore *lc);
 LINPHONE_PUBLIC void linphone_friend_invalidate_subscription(LinphoneFriend *lf);
 LINPHONE_PUBLIC void linphone_friend_update_subscribes(LinphoneFriend *fr, bool_t only_when_registered);
 LINPHONE_PUBLIC const bctbx_list_t *linphone_friend_get_insubs(const LinphoneFriend *fr);
@@ -173,6 +211,7 @@ LINPHONE_PUBLIC LinphoneFriendList *linphone_friend_get_friend_list(const Linpho
 LINPHONE_PUBLIC bctbx_list_t **linphone_friend_list_get_friends_attribute(LinphoneFriendList *lfl);
 LINPHONE_PUBLIC const bctbx_list_t *linphone_friend_list_get_dirty_friends_to_update(const LinphoneFriendList *lfl);
 LINPHONE_PUBLIC int linphone_friend_list_get_revision(const LinphoneFriendList *lfl);
+LINPHONE_PUBLIC void linphone_friend_list_notify_presence_received(LinphoneFriendList *list, LinphoneEvent *lev, const LinphoneContent *body);
 
 LINPHONE_PUBLIC int linphone_remote_provisioning_load_file( LinphoneCore* lc, const char* file_path);
 
@@ -180,6 +219,14 @@ LINPHONE_PUBLIC char *linphone_core_get_device_identity(LinphoneCore *lc);
 
 LINPHONE_PUBLIC const LinphoneCoreToneManagerStats *linphone_core_get_tone_manager_stats(LinphoneCore *lc);
 LINPHONE_PUBLIC void linphone_core_reset_tone_manager_stats(LinphoneCore *lc);
+LINPHONE_PUBLIC const LinphoneCoreImdnSchedulerStats *linphone_core_get_imdn_scheduler_stats(LinphoneCore *lc);
+LINPHONE_PUBLIC void linphone_core_reset_imdn_scheduler_stats(LinphoneCore *lc);
+LINPHONE_PUBLIC const LinphoneCoreIceSchedulerStats *linphone_core_get_ice_scheduler_stats(LinphoneCore *lc);
+LINPHONE_PUBLIC void linphone_core_reset_ice_scheduler_stats(LinphoneCore *lc);
+LINPHONE_PUBLIC void linphone_core_get_address_cache_stats(LinphoneCore *lc, LinphoneCoreAddressCacheStats *sip_address_stats, LinphoneCoreAddressCacheStats *identity_address_stats);
+LINPHONE_PUBLIC void linphone_core_reset_address_cache_stats(LinphoneCore *lc);
+LINPHONE_PUBLIC int linphone_core_get_indexed_call_count(LinphoneCore *lc);
+LINPHONE_PUBLIC int linphone_config_get_coalesced_sync_count(const LinphoneConfig *config);
 LINPHONE_PUBLIC const char *linphone_core_get_tone_file(LinphoneCore *lc, LinphoneToneID id);
 
 /**
@@ -469,6 +469,15 @@ typedef void (*LinphoneChatRoomCbsChatMessageParticipantImdnStateChangedCb) (Lin
  */
 typedef void (*LinphoneMagicSearchCbsSearchResultsReceivedCb)(LinphoneMagicSearch* magic_search);
 
+/**
+ * Callback used to stream the results of an asynchronous search while some sources are still being searched.
+ * It is called each time a source ends, with the ranked results of all the sources that ended so far.
+ * The search results received callback is still called with the complete results.
+ * @param magic_search #LinphoneMagicSearch object @notnil
+ * @param partial_results The \bctbx_list{LinphoneSearchResult} list of partial results @maybenil
+ */
+typedef void (*LinphoneMagicSearchCbsSearchPartialResultsReceivedCb)(LinphoneMagicSearch* magic_search, const bctbx_list_t *partial_results);
+
 /**
  * Callback used to notify when LDAP have more results available.
  * @param magic_search #LinphoneMagicSearch object @notnil
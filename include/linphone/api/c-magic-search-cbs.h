@@ -78,6 +78,20 @@ LINPHONE_PUBLIC LinphoneMagicSearchCbsSearchResultsReceivedCb linphone_magic_sea
  */
 LINPHONE_PUBLIC void linphone_magic_search_cbs_set_search_results_received (LinphoneMagicSearchCbs *cbs, LinphoneMagicSearchCbsSearchResultsReceivedCb cb);
 
+/**
+ * Get the partial results callback.
+ * @param cbs #LinphoneMagicSearchCbs object. @notnil
+ * @return The current partial results callback.
+ */
+LINPHONE_PUBLIC LinphoneMagicSearchCbsSearchPartialResultsReceivedCb linphone_magic_search_cbs_get_search_partial_results_received (const LinphoneMagicSearchCbs *cbs);
+
+/**
+ * Set the partial results callback.
+ * @param cbs #LinphoneMagicSearchCbs object. @notnil
+ * @param cb The partial results callback to be used.
+ */
+LINPHONE_PUBLIC void linphone_magic_search_cbs_set_search_partial_results_received (LinphoneMagicSearchCbs *cbs, LinphoneMagicSearchCbsSearchPartialResultsReceivedCb cb);
+
 
 /**
  * Get the ldap callback on having more results.
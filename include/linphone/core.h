@@ -1299,6 +1299,32 @@ LINPHONE_PUBLIC void linphone_core_unref(LinphoneCore *core);
 **/
 LINPHONE_PUBLIC void linphone_core_iterate(LinphoneCore *core);
 
+/**
+ * Gets the delay before linphone_core_iterate() has work of its own to do.
+ *
+ * SIP traffic and SIP stack timers are not accounted for: they are handled while waiting in
+ * linphone_core_wait_for_events(). While calls, video preview or iterate hooks are active, the delay
+ * is the 20ms period that linphone_core_iterate() needs.
+ * @param core #LinphoneCore object @notnil
+ * @return The delay in milliseconds, 0 if linphone_core_iterate() must be called right away,
+ * -1 if the core has no deadline.
+ * @ingroup initializing
+**/
+LINPHONE_PUBLIC int linphone_core_get_next_iterate_delay(LinphoneCore *core);
+
+/**
+ * Event driven alternative to calling linphone_core_iterate() at a fixed period.
+ *
+ * Blocks in the SIP stack main loop, which receives SIP messages and runs its timers, until the core
+ * has work to do (see linphone_core_get_next_iterate_delay()), at most max_wait_ms, then calls linphone_core_iterate().
+ * An idle core is woken up only by SIP traffic, SIP timers and its own deadlines.
+ * Callbacks are invoked from this function, on the calling thread.
+ * @param core #LinphoneCore object @notnil
+ * @param max_wait_ms The maximum time to wait, in milliseconds.
+ * @ingroup initializing
+**/
+LINPHONE_PUBLIC void linphone_core_wait_for_events(LinphoneCore *core, int max_wait_ms);
+
 /**
  * @ingroup initializing
  * Add a listener in order to be notified of #LinphoneCore events. Once an event is received, registred #LinphoneCoreCbs are
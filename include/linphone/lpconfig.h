@@ -322,11 +322,40 @@ LINPHONE_PUBLIC void linphone_config_set_float(LinphoneConfig *config,const char
 
 /**
  * Writes the config file to disk.
+ * When the background sync is enabled, the config is serialized and the file is written later by a dedicated thread:
+ * use linphone_config_flush() to wait for it.
  * @param config The #LinphoneConfig object @notnil
  * @return 0 if successful, -1 otherwise
 **/
 LINPHONE_PUBLIC LinphoneStatus linphone_config_sync(LinphoneConfig *config);
 
+/**
+ * Enables or disables the background sync.
+ * When enabled, linphone_config_sync() no longer blocks on file I/O: the file is written by a dedicated thread, and
+ * successive syncs that happen before the previous one is written are coalesced.
+ * Disabling it waits for the pending write.
+ * @param config The #LinphoneConfig object @notnil
+ * @param enable TRUE to write the config file from a background thread
+ * @donotwrap
+**/
+LINPHONE_PUBLIC void linphone_config_enable_background_sync(LinphoneConfig *config, bool_t enable);
+
+/**
+ * Tells whether the config file is written from a background thread.
+ * @param config The #LinphoneConfig object @notnil
+ * @return TRUE if the background sync is enabled
+ * @donotwrap
+**/
+LINPHONE_PUBLIC bool_t linphone_config_background_sync_enabled(const LinphoneConfig *config);
+
+/**
+ * Waits until the last linphone_config_sync() has been written to disk.
+ * Does nothing when the background sync is disabled.
+ * @param config The #LinphoneConfig object @notnil
+ * @donotwrap
+**/
+LINPHONE_PUBLIC void linphone_config_flush(LinphoneConfig *config);
+
 /**
  * Reload the config from the file.
  * @param config The #LinphoneConfig object @notnil
@@ -247,7 +247,7 @@ namespace Private {
 // Macro.
 // -----------------------------------------------------------------------------
 
-#define EPHEMERAL_MESSAGE_TASKS_MAX_NB 10
+#define EPHEMERAL_MESSAGE_TASKS_MAX_NB 100
 
 // -----------------------------------------------------------------------------
 // Overload.
@@ -262,6 +262,7 @@ void Account::setSendPublish (bool sendPublish) {
 
 void Account::setNeedToRegister (bool needToRegister) {
 	mNeedToRegister = needToRegister;
+	if (mNeedToRegister && mCore) linphone_core_wake_up_iterate(mCore);
 }
 
 void Account::setDeletionDate (time_t deletionDate) {
@@ -401,6 +402,8 @@ void Account::setState (LinphoneRegistrationState state, const std::string& mess
 			// Compatibility with proxy config
 			linphone_core_notify_registration_state_changed(mCore, mConfig, state, message.c_str());
 		}
+		// A pending register or publish of this account or of a dependent one may now be possible.
+		if (mCore) linphone_core_wake_up_iterate(mCore);
 	} else {
 		/*state already reported*/
 	}
@@ -949,6 +952,7 @@ int Account::done () {
 
 	if (mCore) {
 		linphone_proxy_config_write_all_to_config_file(mCore); // TODO: change it when removing all proxy_config
+		if (hasPendingUpdate()) linphone_core_wake_up_iterate(mCore);
 	}
 
 	return 0;
@@ -967,6 +971,16 @@ void Account::update () {
 	}
 }
 
+bool Account::hasPendingUpdate () const {
+	return mNeedToRegister || mSendPublish;
+}
+
+// Whether update() has something to do right now, and not only once the network or the registration state changes.
+bool Account::needsUpdate () {
+	return (mNeedToRegister && canRegister())
+		|| (mSendPublish && (mState == LinphoneRegistrationOk || mState == LinphoneRegistrationCleared));
+}
+
 void Account::apply (LinphoneCore *lc) {
 	mOldParams = nullptr; // remove old params to make sure we will register since we only call apply when adding accounts to core
 	mCore = lc;
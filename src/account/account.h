@@ -106,6 +106,8 @@ public:
 	void unpublish ();
 	void unregister ();
 	void update ();
+	bool hasPendingUpdate () const;
+	bool needsUpdate ();
 	void addCustomParam(const std::string & key, const std::string & value);
 	const std::string & getCustomParam(const std::string & key) const;
 	void writeToConfigFile (int index);
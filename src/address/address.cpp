@@ -22,7 +22,7 @@
 
 #include "address.h"
 #include "c-wrapper/c-wrapper.h"
-#include "containers/lru-cache.h"
+#include "containers/sharded-lru-cache.h"
 #include "logger/logger.h"
 
 // TODO: delete after Addres is not derived anymore from ClonableObject
@@ -54,25 +54,27 @@ namespace {
 				sal_address_unref(mSalAddress);
 		}
 
-		const SalAddress *get () {
+		const SalAddress *get () const {
 			return mSalAddress;
 		}
 
 	private:
 		SalAddress *mSalAddress;
 	};
-	LruCache<string, SalAddressWrap> addressesCache;
+	ShardedLruCache<string, SalAddressWrap> addressesCache(Address::DefaultSipAddressesCacheCapacity);
 }
 
 static Owned<SalAddress> getSalAddressFromCache(const string &uri) {
-	SalAddressWrap *wrap = addressesCache[uri];
-	if (wrap)
-		return owned(sal_address_clone(wrap->get()));
+	// The cached address is cloned under the lock of its shard: it cannot be evicted by another thread meanwhile.
+	SalAddress *clone = nullptr;
+	if (addressesCache.visit(uri, [&clone] (const SalAddressWrap &wrap) { clone = sal_address_clone(wrap.get()); }))
+		return owned(clone);
 
 	SalAddress *address = sal_address_new(L_STRING_TO_C(uri));
 	if (address) {
+		clone = sal_address_clone(address);
 		addressesCache.insert(uri, SalAddressWrap(address));
-		return owned(sal_address_clone(address));
+		return owned(clone);
 	}
 
 	return nullptr;
@@ -145,6 +147,18 @@ void Address::clearSipAddressesCache () {
 	addressesCache.clear();
 }
 
+void Address::setSipAddressesCacheCapacity (int capacity) {
+	addressesCache.setCapacity(capacity);
+}
+
+ShardedLruCacheStats Address::getSipAddressesCacheStats () {
+	return addressesCache.getStats();
+}
+
+void Address::resetSipAddressesCacheStats () {
+	addressesCache.resetStats();
+}
+
 bool Address::isValid () const {
 	return !!internalAddress;
 }
@@ -38,6 +38,7 @@ LINPHONE_BEGIN_NAMESPACE
 
 class IdentityAddress;
 class ConferenceAddress;
+struct ShardedLruCacheStats;
 
 class LINPHONE_PUBLIC Address : public ClonableObject {
 	// TODO: Remove me later.
@@ -128,6 +129,12 @@ public:
 	// This method is necessary when creating static variables of type address as they canot be freed before the leak detector runs
 	void removeFromLeakDetector() const;
 	static void clearSipAddressesCache ();
+	// A capacity of 0 disables the cache of parsed addresses.
+	static void setSipAddressesCacheCapacity (int capacity);
+	static ShardedLruCacheStats getSipAddressesCacheStats ();
+	static void resetSipAddressesCacheStats ();
+
+	static constexpr int DefaultSipAddressesCacheCapacity = 1000;
 
 private:
 	struct AddressCache {
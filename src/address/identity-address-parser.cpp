@@ -19,13 +19,13 @@
  */
 
 #include <set>
-#include <unordered_map>
 
 #include <belr/abnf.h>
 #include <belr/grammarbuilder.h>
 
 #include "linphone/utils/utils.h"
 
+#include "containers/sharded-lru-cache.h"
 #include "logger/logger.h"
 #include "object/object-p.h"
 
@@ -46,7 +46,8 @@ namespace {
 class IdentityAddressParserPrivate : public ObjectPrivate {
 public:
 	shared_ptr<belr::Parser<shared_ptr<IdentityAddress> >> parser;
-    unordered_map<string, shared_ptr<IdentityAddress >> cache;
+	// Parsed addresses are never modified: they can be shared between threads.
+	ShardedLruCache<string, shared_ptr<const IdentityAddress>> cache{ IdentityAddressParser::DefaultCacheCapacity };
 };
 
 IdentityAddressParser::IdentityAddressParser () : Singleton(*new IdentityAddressParserPrivate) {
@@ -66,24 +67,38 @@ IdentityAddressParser::IdentityAddressParser () : Singleton(*new IdentityAddress
 
 // -----------------------------------------------------------------------------
 
-shared_ptr<IdentityAddress> IdentityAddressParser::parseAddress (const string &input) {
+shared_ptr<const IdentityAddress> IdentityAddressParser::parseAddress (const string &input) {
 	L_D();
 
-    auto it = d->cache.find(input);
-    if (it == d->cache.end()) {
-        size_t parsedSize;
-        shared_ptr<IdentityAddress> identityAddress = d->parser->parseInput("Address", input, &parsedSize);
-        if (!identityAddress) {
-            lDebug() << "Unable to parse identity address from " << input;
-            return nullptr;
-        }
-        // Remove identity address from leak detector as the IdentityAddressParser is a used as static variable
-        identityAddress->removeFromLeakDetector();
-        d->cache[input] = identityAddress;
-        return identityAddress;
-    } else {
-        return it->second;
-    }
+	shared_ptr<const IdentityAddress> cached;
+	if (d->cache.get(input, cached))
+		return cached;
+
+	size_t parsedSize;
+	shared_ptr<IdentityAddress> identityAddress = d->parser->parseInput("Address", input, &parsedSize);
+	if (!identityAddress) {
+		lDebug() << "Unable to parse identity address from " << input;
+		return nullptr;
+	}
+	// Remove identity address from leak detector as the IdentityAddressParser is a used as static variable
+	identityAddress->removeFromLeakDetector();
+	d->cache.insert(input, identityAddress);
+	return identityAddress;
+}
+
+void IdentityAddressParser::setCacheCapacity (int capacity) {
+	L_D();
+	d->cache.setCapacity(capacity);
+}
+
+ShardedLruCacheStats IdentityAddressParser::getCacheStats () const {
+	L_D();
+	return d->cache.getStats();
+}
+
+void IdentityAddressParser::resetCacheStats () {
+	L_D();
+	d->cache.resetStats();
 }
 
 LINPHONE_END_NAMESPACE
@@ -29,12 +29,20 @@
 LINPHONE_BEGIN_NAMESPACE
 
 class IdentityAddressParserPrivate;
+struct ShardedLruCacheStats;
 
-class IdentityAddressParser : public Singleton<IdentityAddressParser> {
+class LINPHONE_PUBLIC IdentityAddressParser : public Singleton<IdentityAddressParser> {
 	friend class Singleton<IdentityAddressParser>;
 
 public:
-	std::shared_ptr<IdentityAddress> parseAddress (const std::string &input);
+	std::shared_ptr<const IdentityAddress> parseAddress (const std::string &input);
+
+	// A capacity of 0 disables the cache of parsed addresses.
+	void setCacheCapacity (int capacity);
+	ShardedLruCacheStats getCacheStats () const;
+	void resetCacheStats ();
+
+	static constexpr int DefaultCacheCapacity = 10000;
 
 private:
 	IdentityAddressParser ();
@@ -37,7 +37,7 @@ LINPHONE_BEGIN_NAMESPACE
 
 IdentityAddress::IdentityAddress (const string &address) {
 	if (!address.empty()){
-		shared_ptr<IdentityAddress> parsedAddress = IdentityAddressParser::getInstance()->parseAddress(address);
+		shared_ptr<const IdentityAddress> parsedAddress = IdentityAddressParser::getInstance()->parseAddress(address);
 		if (parsedAddress != nullptr) {
 			char *tmp;
 			setScheme(parsedAddress->getScheme());
@@ -28,6 +28,7 @@ struct _LinphoneMagicSearchCbs {
 	belle_sip_object_t base;
 	void *userData;
 	LinphoneMagicSearchCbsSearchResultsReceivedCb search_results_received;
+	LinphoneMagicSearchCbsSearchPartialResultsReceivedCb search_partial_results_received;
 	LinphoneMagicSearchCbsLdapHaveMoreResultsCb ldap_have_more_results;
 };
 
@@ -77,6 +78,18 @@ void linphone_magic_search_cbs_set_search_results_received (
 	cbs->search_results_received = cb;
 }
 
+LinphoneMagicSearchCbsSearchPartialResultsReceivedCb linphone_magic_search_cbs_get_search_partial_results_received(
+	const LinphoneMagicSearchCbs *cbs
+) {
+	return cbs->search_partial_results_received;
+}
+void linphone_magic_search_cbs_set_search_partial_results_received (
+	LinphoneMagicSearchCbs *cbs,
+	LinphoneMagicSearchCbsSearchPartialResultsReceivedCb cb
+) {
+	cbs->search_partial_results_received = cb;
+}
+
 LinphoneMagicSearchCbsLdapHaveMoreResultsCb linphone_magic_search_cbs_get_ldap_have_more_results(
 	const LinphoneMagicSearchCbs *cbs
 ) {
@@ -107,6 +107,10 @@ void _linphone_magic_search_notify_search_results_received(LinphoneMagicSearch *
 	NOTIFY_IF_EXIST(SearchResultsReceived, search_results_received, magic_search)
 }
 
+void _linphone_magic_search_notify_search_partial_results_received(LinphoneMagicSearch *magic_search, const bctbx_list_t *partial_results) {
+	NOTIFY_IF_EXIST(SearchPartialResultsReceived, search_partial_results_received, magic_search, partial_results)
+}
+
 void _linphone_magic_search_notify_ldap_have_more_results(LinphoneMagicSearch *magic_search, LinphoneLdap *ldap) {
 	NOTIFY_IF_EXIST(LdapHaveMoreResults, ldap_have_more_results, magic_search, ldap)
 }
@@ -345,6 +345,12 @@ void Call::onCallSessionEarlyFailed (const shared_ptr<CallSession> &session, Lin
 	cleanupSessionAndUnrefCObjectCall();
 }
 
+void Call::onCallSessionLogUpdated (const shared_ptr<CallSession> &session) {
+	shared_ptr<Core> core = tryGetCore();
+	if (core)
+		core->getPrivate()->reindexCall(this);
+}
+
 void Call::onCallSessionSetReleased (const shared_ptr<CallSession> &session) {
 	cleanupSessionAndUnrefCObjectCall();
 }
@@ -270,6 +270,7 @@ public:
 	void onBackgroundTaskToBeStopped (const std::shared_ptr<CallSession> &session) override;
 	void onCallSessionAccepting (const std::shared_ptr<CallSession> &session) override;
 	void onCallSessionEarlyFailed (const std::shared_ptr<CallSession> &session, LinphoneErrorInfo *ei) override;
+	void onCallSessionLogUpdated (const std::shared_ptr<CallSession> &session) override;
 	void onCallSessionSetReleased (const std::shared_ptr<CallSession> &session) override;
 	void onCallSessionSetTerminated (const std::shared_ptr<CallSession> &session) override;
 	void onCallSessionStartReferred (const std::shared_ptr<CallSession> &session) override;
@@ -332,14 +332,14 @@ void ChatMessagePrivate::startEphemeralCountDown () {
 	unique_ptr<MainDb> &mainDb = q->getChatRoom()->getCore()->getPrivate()->mainDb;
 	q->getChatRoom()->getCore()->getPrivate()->mainDb->updateEphemeralMessageInfos(storageId, ephemeralExpireTime);
 
+	shared_ptr<LinphonePrivate::EventLog> event = LinphonePrivate::MainDb::getEvent(mainDb, q->getStorageId());
 	const shared_ptr<ChatMessage>& sharedMessage = q->getSharedFromThis();
-	q->getChatRoom()->getCore()->getPrivate()->updateEphemeralMessages(sharedMessage);
+	q->getChatRoom()->getCore()->getPrivate()->updateEphemeralMessages(sharedMessage, event);
 
 	lInfo() << "Starting ephemeral countdown with life time: " << ephemeralLifetime;
 
 	// notify start !
 	shared_ptr<AbstractChatRoom> chatRoom = q->getChatRoom();
-	shared_ptr<LinphonePrivate::EventLog> event = LinphonePrivate::MainDb::getEvent(mainDb, q->getStorageId());
 	if (chatRoom && event) {
 		_linphone_chat_room_notify_ephemeral_message_timer_started(L_GET_C_BACK_PTR(chatRoom), L_GET_C_BACK_PTR(event));
 		LinphoneChatMessage *msg = L_GET_C_BACK_PTR(q);
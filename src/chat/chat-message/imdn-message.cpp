@@ -21,6 +21,7 @@
 #include "chat/chat-message/imdn-message-p.h"
 #include "chat/chat-room/chat-room-p.h"
 #include "content/content-disposition.h"
+#include "core/core.h"
 #include "logger/logger.h"
 #include "sip-tools/sip-headers.h"
 
@@ -65,6 +66,7 @@ ImdnMessage::ImdnMessage (const std::shared_ptr<ImdnMessage> &message) : ImdnMes
 ImdnMessage::ImdnMessage (const Context &context) : NotificationMessage(*new ImdnMessagePrivate(context)) {
 	L_D();
 
+	const bool streamed = Imdn::isXmlStreamingEnabled(d->context.chatRoom->getCore()->getCCore());
 	for (const auto &message : d->context.deliveredMessages) {
 		// Don't send IMDN if the message we send it for has no Message-ID
 		const string& imdnMessageId = message->getImdnMessageId();
@@ -76,7 +78,7 @@ ImdnMessage::ImdnMessage (const Context &context) : NotificationMessage(*new Imd
 		Content *content = new Content();
 		content->setContentDisposition(ContentDisposition::Notification);
 		content->setContentType(ContentType::Imdn);
-		content->setBodyFromUtf8(Imdn::createXml(imdnMessageId, message->getTime(), Imdn::Type::Delivery, LinphoneReasonNone));
+		content->setBodyFromUtf8(Imdn::createXml(imdnMessageId, message->getTime(), Imdn::Type::Delivery, LinphoneReasonNone, streamed));
 		addContent(content);
 	}
 	for (const auto &message : d->context.displayedMessages) {
@@ -90,7 +92,7 @@ ImdnMessage::ImdnMessage (const Context &context) : NotificationMessage(*new Imd
 		Content *content = new Content();
 		content->setContentDisposition(ContentDisposition::Notification);
 		content->setContentType(ContentType::Imdn);
-		content->setBodyFromUtf8(Imdn::createXml(imdnMessageId, message->getTime(), Imdn::Type::Display, LinphoneReasonNone));
+		content->setBodyFromUtf8(Imdn::createXml(imdnMessageId, message->getTime(), Imdn::Type::Display, LinphoneReasonNone, streamed));
 		addContent(content);
 	}
 	for (const auto &mr : d->context.nonDeliveredMessages) {
@@ -104,7 +106,7 @@ ImdnMessage::ImdnMessage (const Context &context) : NotificationMessage(*new Imd
 		Content *content = new Content();
 		content->setContentDisposition(ContentDisposition::Notification);
 		content->setContentType(ContentType::Imdn);
-		content->setBodyFromUtf8(Imdn::createXml(imdnMessageId, mr.message->getTime(), Imdn::Type::Delivery, mr.reason));
+		content->setBodyFromUtf8(Imdn::createXml(imdnMessageId, mr.message->getTime(), Imdn::Type::Delivery, mr.reason, streamed));
 		addContent(content);
 	}
 
@@ -39,6 +39,7 @@
 
 LINPHONE_BEGIN_NAMESPACE
 
+class LocalConferenceEventHandler;
 class ParticipantDevice;
 
 
@@ -92,6 +93,7 @@ public:
 	void dispatchQueuedMessages ();
 
 	void subscriptionStateChanged (LinphoneEvent *event, LinphoneSubscriptionState state);
+	LocalConferenceEventHandler *getConferenceEventHandler () const;
 
 	bool initializeParticipants(const std::shared_ptr<Participant> & initiator, SalCallOp *op);
 	void resumeParticipant(const std::shared_ptr<Participant> &participant);
@@ -85,12 +85,12 @@ shared_ptr<Participant> ServerGroupChatRoomPrivate::addParticipant (const Identi
 	shared_ptr<Participant> participant = q->findCachedParticipant(addr);
 	if (!participant) {
 		participant = Participant::create(q->getConference().get(),addr);
-		q->cachedParticipants.push_back(participant);
+		q->addCachedParticipant(participant);
 	}
 	/* Case of participant that is still referenced in the chatroom, but no longer authorized because it has been removed
 	 * previously OR a totally new participant. */
-	if (q->findParticipant(addr) == nullptr){
-		q->getConference()->participants.push_back(participant);
+	if (!q->isParticipantAuthorized(participant)){
+		q->authorizeParticipant(participant);
 		shared_ptr<ConferenceParticipantEvent> event = q->getConference()->notifyParticipantAdded(time(nullptr), false, participant);
 		q->getCore()->getPrivate()->mainDb->addEvent(event);
 	}
@@ -252,6 +252,7 @@ void ServerGroupChatRoomPrivate::confirmJoining (SalCallOp *op) {
 		participant = addParticipant(IdentityAddress(op->getFrom()));
 		participant->setAdmin(true);
 		device = participant->addDevice(gruu);
+		q->indexCachedParticipantDevice(device);
 		session = device->getSession();
 		mInitiatorDevice = device;
 
@@ -277,6 +278,7 @@ void ServerGroupChatRoomPrivate::confirmJoining (SalCallOp *op) {
 			return;
 		}
 		device = participant->addDevice(gruu);
+		q->indexCachedParticipantDevice(device);
 		if (capabilities & ServerGroupChatRoom::Capabilities::OneToOne){
 			if (device->getState() == ParticipantDevice::State::Left){
 				lInfo() << q << " " << gruu << " is reconnected to the one to one chatroom.";
@@ -298,6 +300,7 @@ void ServerGroupChatRoomPrivate::confirmJoining (SalCallOp *op) {
 		//to force is focus to be added
 		session->getPrivate()->getOp()->setContactAddress(addr.getInternalAddress());
 		device->setSession(session);
+		q->indexCachedParticipantDevice(device);
 	}
 
 	// Changes are only allowed from admin participants
@@ -351,33 +354,45 @@ void ServerGroupChatRoomPrivate::declineSession (const shared_ptr<CallSession> &
 
 void ServerGroupChatRoomPrivate::dispatchQueuedMessages () {
 	L_Q();
-	for (const auto &participant : q->getParticipants()) {
-		/*
-		 * Dispatch messages for each device in Present state. In a one to one chatroom, if a device
-		 * is found is Left state, it must be invited first.
-		 */
+	/*
+	 * Only devices having queued messages are looked up, through the gruu index, instead of
+	 * walking every device of every participant.
+	 */
+	list<pair<shared_ptr<ParticipantDevice>, string>> devicesToDispatch;
+	for (const auto &entry : queuedMessages) {
+		if (entry.second.empty())
+			continue;
+		shared_ptr<ParticipantDevice> device = q->findCachedParticipantDevice(entry.first);
+		if (device)
+			devicesToDispatch.emplace_back(device, entry.first);
+	}
 
-		for (const auto &device : participant->getDevices()) {
-			string uri(device->getAddress().asString());
-			auto & msgQueue = queuedMessages[uri];
-
-			if (!msgQueue.empty()){
-				if ( (capabilities & ServerGroupChatRoom::Capabilities::OneToOne) && device->getState() == ParticipantDevice::State::Left){
-					// Happens only with protocol < 1.1
-					lInfo() << "There is a message to transmit to a participant in left state in a one to one chatroom, so inviting first.";
-					inviteDevice(device);
-					continue;
-				}
-				if (device->getState() != ParticipantDevice::State::Present)
-					continue;
-				size_t nbMessages = msgQueue.size();
-				lInfo() << q << ": Dispatching " << nbMessages << " queued message(s) for '" << uri << "'";
-				while (!msgQueue.empty()) {
-					shared_ptr<Message> msg = msgQueue.front();
-					sendMessage(msg, device->getAddress());
-					msgQueue.pop();
-				}
-			}
+	/*
+	 * Dispatch messages for each device in Present state. In a one to one chatroom, if a device
+	 * is found is Left state, it must be invited first.
+	 */
+	for (const auto &deviceToDispatch : devicesToDispatch) {
+		const auto &device = deviceToDispatch.first;
+		const string &uri = deviceToDispatch.second;
+		if (!q->isParticipantAuthorized(device->getParticipant()))
+			continue;
+		auto & msgQueue = queuedMessages[uri];
+		if (msgQueue.empty())
+			continue;
+		if ( (capabilities & ServerGroupChatRoom::Capabilities::OneToOne) && device->getState() == ParticipantDevice::State::Left){
+			// Happens only with protocol < 1.1
+			lInfo() << "There is a message to transmit to a participant in left state in a one to one chatroom, so inviting first.";
+			inviteDevice(device);
+			continue;
+		}
+		if (device->getState() != ParticipantDevice::State::Present)
+			continue;
+		size_t nbMessages = msgQueue.size();
+		lInfo() << q << ": Dispatching " << nbMessages << " queued message(s) for '" << uri << "'";
+		while (!msgQueue.empty()) {
+			shared_ptr<Message> msg = msgQueue.front();
+			sendMessage(msg, device->getAddress());
+			msgQueue.pop();
 		}
 	}
 }
@@ -394,12 +409,10 @@ void ServerGroupChatRoomPrivate::removeParticipant (const shared_ptr<Participant
 		updateParticipantDeviceSession(device);
 	}
 
-	for (const auto &p : q->getParticipants()) {
-		if (participant->getAddress() == p->getAddress()) {
-			lInfo() << q <<" 'participant ' "<< p->getAddress() <<" no more authorized'";
-			q->getConference()->removeParticipant(p);
-			break;
-		}
+	shared_ptr<Participant> p = q->findCachedParticipant(participant->getAddress());
+	if (p && q->isParticipantAuthorized(p)) {
+		lInfo() << q <<" 'participant ' "<< p->getAddress() <<" no more authorized'";
+		q->unauthorizeParticipant(p);
 	}
 
 	queuedMessages.erase(participant->getAddress().asString());
@@ -412,8 +425,12 @@ void ServerGroupChatRoomPrivate::removeParticipant (const shared_ptr<Participant
 }
 
 void ServerGroupChatRoomPrivate::subscriptionStateChanged (LinphoneEvent *event, LinphoneSubscriptionState state) {
+	getConferenceEventHandler()->subscriptionStateChanged(event, state);
+}
+
+LocalConferenceEventHandler *ServerGroupChatRoomPrivate::getConferenceEventHandler () const {
 	L_Q();
-	static_pointer_cast<LocalConference>(q->getConference())->eventHandler->subscriptionStateChanged(event, state);
+	return static_pointer_cast<LocalConference>(q->getConference())->eventHandler.get();
 }
 
 void ServerGroupChatRoomPrivate::handleSubjectChange(SalCallOp *op){
@@ -811,6 +828,7 @@ void ServerGroupChatRoomPrivate::addParticipantDevice (const shared_ptr<Particip
 		 * This is a really new device.
 		 */
 		device = participant->addDevice(deviceInfo->getAddress(), deviceInfo->getName());
+		q->indexCachedParticipantDevice(device);
 		device->setCapabilityDescriptor(deviceInfo->getCapabilityDescriptor());
 		updateProtocolVersionFromDevice(device);
 		shared_ptr<ConferenceParticipantDeviceEvent> event = q->getConference()->notifyParticipantDeviceAdded(time(nullptr), false, participant, device);
@@ -915,6 +933,7 @@ shared_ptr<CallSession> ServerGroupChatRoomPrivate::makeSession(const std::share
 		session = participant->createSession(*q->getConference().get(), &csp, false, this);
 		session->configure(LinphoneCallOutgoing, nullptr, nullptr, q->getConference()->getConferenceAddress().asAddress(), device->getAddress().asAddress());
 		device->setSession(session);
+		q->indexCachedParticipantDevice(device);
 		session->initiateOutgoing();
 		session->getPrivate()->createOp();
 		//FIXME jehan check conference server  potential impact
@@ -1057,6 +1076,7 @@ void ServerGroupChatRoomPrivate::removeParticipantDevice (const shared_ptr<Parti
 
 	// First set it as left, so that it may eventually trigger the destruction of the chatroom if no device are present for any participant.
 	setParticipantDeviceState(participantDevice, ParticipantDevice::State::Left, false);
+	q->unindexCachedParticipantDevice(participantDevice);
 	participantCopy->removeDevice(deviceAddress);
 }
 
@@ -1291,6 +1311,7 @@ void ServerGroupChatRoomPrivate::onCallSessionStateChanged (const shared_ptr<Cal
 void ServerGroupChatRoomPrivate::onCallSessionSetReleased (const shared_ptr<CallSession> &session) {
 	L_Q();
 	shared_ptr<ParticipantDevice> device = q->findCachedParticipantDevice(session);
+	q->cachedDevicesBySession.erase(session.get());
 	if (device)
 		device->setSession(nullptr);
 }
@@ -1365,7 +1386,8 @@ ServerGroupChatRoom::ServerGroupChatRoom (
 	unsigned int lastNotifyId
 ) : ChatRoom(*new ServerGroupChatRoomPrivate(capabilities), core, params, make_shared<LocalConference>(core, peerAddress, nullptr, ConferenceParams::create(core->getCCore()),this)) {
 	L_D();
-	cachedParticipants = move(participants);
+	for (const auto &participant : participants)
+		addCachedParticipant(participant);
 	getConference()->setLastNotify(lastNotifyId);
 	getConference()->setConferenceId(ConferenceId(peerAddress, peerAddress));
 	getConference()->confParams->setConferenceAddress(peerAddress);
@@ -1397,9 +1419,10 @@ ServerGroupChatRoom::CapabilitiesMask ServerGroupChatRoom::getCapabilities () co
 }
 
 shared_ptr<Participant> ServerGroupChatRoom::findParticipant (const shared_ptr<const CallSession> &session) const {
-	for (const auto &participant : getParticipants()) {
-		shared_ptr<ParticipantDevice> device = participant->findDevice(session);
-		if (device || (participant->getSession() == session))
+	shared_ptr<ParticipantDevice> device = findCachedParticipantDevice(session);
+	if (device) {
+		shared_ptr<Participant> participant = device->getParticipant();
+		if (isParticipantAuthorized(participant))
 			return participant;
 	}
 	lInfo() << "Unable to find participant in server group chat room " << this << " with call session " << session;
@@ -1407,47 +1430,114 @@ shared_ptr<Participant> ServerGroupChatRoom::findParticipant (const shared_ptr<c
 }
 
 shared_ptr<Participant> ServerGroupChatRoom::findParticipant (const IdentityAddress &participantAddress) const {
-	IdentityAddress searchedAddr(participantAddress);
-	searchedAddr.setGruu("");
-	for (const auto &participant : getParticipants()) {
-		if (participant->getAddress() == searchedAddr)
-			return participant;
-	}
+	// Authorized participants are cached participants.
+	shared_ptr<Participant> participant = findCachedParticipant(participantAddress);
+	if (participant && isParticipantAuthorized(participant))
+		return participant;
 	lInfo() << "Unable to find participant in server group chat room " << this << " with address " << participantAddress.asString();
 	return nullptr;
 }
 
 shared_ptr<Participant> ServerGroupChatRoom::findCachedParticipant (const shared_ptr<const CallSession> &session) const {
-	for (const auto &participant : cachedParticipants) {
-		shared_ptr<ParticipantDevice> device = participant->findDevice(session);
-		if (device || (participant->getSession() == session))
-			return participant;
-	}
-	return nullptr;
+	shared_ptr<ParticipantDevice> device = findCachedParticipantDevice(session);
+	return device ? device->getParticipant() : nullptr;
 }
 
 shared_ptr<Participant> ServerGroupChatRoom::findCachedParticipant (const IdentityAddress &participantAddress) const {
-	IdentityAddress searchedAddr(participantAddress);
-	searchedAddr.setGruu("");
-	for (const auto &participant : cachedParticipants) {
-		if (participant->getAddress() == searchedAddr)
-			return participant;
-	}
-	return nullptr;
+	auto it = cachedParticipantsByAddress.find(participantAddress.getAddressWithoutGruu());
+	return (it != cachedParticipantsByAddress.end()) ? it->second : nullptr;
 }
 
 shared_ptr<ParticipantDevice> ServerGroupChatRoom::findCachedParticipantDevice (const shared_ptr<const CallSession> &session) const {
+	if (!session)
+		return nullptr;
+
+	auto it = cachedDevicesBySession.find(session.get());
+	if (it != cachedDevicesBySession.end()) {
+		shared_ptr<ParticipantDevice> device = it->second.lock();
+		// The session may have been replaced since the device was indexed.
+		if (device && (device->getSession() == session))
+			return device;
+		cachedDevicesBySession.erase(it);
+	}
+
+	shared_ptr<ParticipantDevice> device = findCachedParticipantDeviceByScan([&session](const shared_ptr<ParticipantDevice> &candidate) {
+		return candidate->getSession() == session;
+	});
+	if (device)
+		indexCachedParticipantDevice(device);
+	return device;
+}
+
+shared_ptr<ParticipantDevice> ServerGroupChatRoom::findCachedParticipantDevice (const string &gruu) const {
+	auto it = cachedDevicesByGruu.find(gruu);
+	if (it != cachedDevicesByGruu.end()) {
+		shared_ptr<ParticipantDevice> device = it->second.lock();
+		if (device)
+			return device;
+		cachedDevicesByGruu.erase(it);
+	}
+
+	shared_ptr<ParticipantDevice> device = findCachedParticipantDeviceByScan([&gruu](const shared_ptr<ParticipantDevice> &candidate) {
+		return candidate->getAddress().asString() == gruu;
+	});
+	if (device)
+		indexCachedParticipantDevice(device);
+	return device;
+}
 
+/* Fallback of the indexes, for the devices added or changed where this chat room does not index them. */
+shared_ptr<ParticipantDevice> ServerGroupChatRoom::findCachedParticipantDeviceByScan (
+	const function<bool (const shared_ptr<ParticipantDevice> &)> &predicate
+) const {
 	for (const auto &participant : cachedParticipants) {
 		for (const auto &device : participant->getDevices()) {
-			if (device->getSession() == session)
+			if (predicate(device))
 				return device;
 		}
 	}
-
 	return nullptr;
 }
 
+void ServerGroupChatRoom::addCachedParticipant (const shared_ptr<Participant> &participant) {
+	cachedParticipants.push_back(participant);
+	cachedParticipantsByAddress[participant->getAddress()] = participant;
+	for (const auto &device : participant->getDevices())
+		indexCachedParticipantDevice(device);
+}
+
+void ServerGroupChatRoom::indexCachedParticipantDevice (const shared_ptr<ParticipantDevice> &device) const {
+	cachedDevicesByGruu[device->getAddress().asString()] = device;
+	const shared_ptr<CallSession> &session = device->getSession();
+	if (session)
+		cachedDevicesBySession[session.get()] = device;
+}
+
+void ServerGroupChatRoom::unindexCachedParticipantDevice (const shared_ptr<ParticipantDevice> &device) const {
+	cachedDevicesByGruu.erase(device->getAddress().asString());
+	const shared_ptr<CallSession> &session = device->getSession();
+	if (session)
+		cachedDevicesBySession.erase(session.get());
+}
+
+bool ServerGroupChatRoom::isParticipantAuthorized (const shared_ptr<const Participant> &participant) const {
+	return participant && (authorizedParticipants.find(participant.get()) != authorizedParticipants.end());
+}
+
+void ServerGroupChatRoom::authorizeParticipant (const shared_ptr<Participant> &participant) {
+	getConference()->participants.push_back(participant);
+	authorizedParticipants.insert(participant.get());
+}
+
+void ServerGroupChatRoom::unauthorizeParticipant (const shared_ptr<Participant> &participant) {
+	// Remove this very participant, as it was added: Conference::removeParticipant() would remove the first one having its address.
+	auto &participants = getConference()->participants;
+	auto it = find(participants.begin(), participants.end(), participant);
+	if (it != participants.end())
+		participants.erase(it);
+	authorizedParticipants.erase(participant.get());
+}
+
 void ServerGroupChatRoom::allowCpim (bool value) {}
 
 void ServerGroupChatRoom::allowMultipart (bool value) {}
@@ -1589,7 +1679,7 @@ void ServerGroupChatRoom::setState (ConferenceInterface::State state) {
 				 * Since we don't have the protocol version at this stage (it will be known after receiving register information),
 				 * it is not a problem to push the two participants in the authorized list even if they are in the process of leaving.
 				 */
-				getConference()->participants.push_back(participant);
+				authorizeParticipant(participant);
 			}else{
 				bool atLeastOneDeviceJoining = false;
 				bool atLeastOneDevicePresent = false;
@@ -1618,7 +1708,7 @@ void ServerGroupChatRoom::setState (ConferenceInterface::State state) {
 				//its devices were "BYEed" yet. This is what the line below is testing. Might be better to add a new state in the participant Class,
 				// but it's not the case yet.
 				if (atLeastOneDevicePresent || atLeastOneDeviceJoining || atLeastOneDeviceLeaving == false ){
-					getConference()->participants.push_back(participant);
+					authorizeParticipant(participant);
 				}
 			}
 		}
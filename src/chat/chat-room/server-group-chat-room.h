@@ -21,6 +21,10 @@
 #ifndef _L_SERVER_GROUP_CHAT_ROOM_H_
 #define _L_SERVER_GROUP_CHAT_ROOM_H_
 
+#include <functional>
+#include <unordered_map>
+#include <unordered_set>
+
 #include "chat/chat-room/chat-room.h"
 #include "conference/local-conference.h"
 
@@ -73,6 +77,7 @@ public:
 	std::shared_ptr<Participant> findCachedParticipant (const std::shared_ptr<const CallSession> &session) const;
 	std::shared_ptr<Participant> findCachedParticipant (const IdentityAddress &participantAddress) const;
 	std::shared_ptr<ParticipantDevice> findCachedParticipantDevice (const std::shared_ptr<const CallSession> &session) const;
+	std::shared_ptr<ParticipantDevice> findCachedParticipantDevice (const std::string &gruu) const;
 
 	std::shared_ptr<Participant> getMe () const override;
 	int getParticipantCount () const override;
@@ -95,8 +100,29 @@ public:
 
 private:
 
+	void addCachedParticipant (const std::shared_ptr<Participant> &participant);
+	void indexCachedParticipantDevice (const std::shared_ptr<ParticipantDevice> &device) const;
+	void unindexCachedParticipantDevice (const std::shared_ptr<ParticipantDevice> &device) const;
+	std::shared_ptr<ParticipantDevice> findCachedParticipantDeviceByScan (
+		const std::function<bool (const std::shared_ptr<ParticipantDevice> &)> &predicate
+	) const;
+
+	bool isParticipantAuthorized (const std::shared_ptr<const Participant> &participant) const;
+	void authorizeParticipant (const std::shared_ptr<Participant> &participant);
+	void unauthorizeParticipant (const std::shared_ptr<Participant> &participant);
+
 	std::list<std::shared_ptr<Participant>> cachedParticipants; /*list of participant that have been added to the chat room. It includes participants that are currently active in the chat room as well as past participants.*/
 
+	/* Indexes on cachedParticipants, to avoid walking every participant and device on each lookup.
+	 * Devices and sessions are indexed wherever this chat room adds them, device entries are weak and checked on lookup.
+	 * A device missing from an index is searched among the cached participants and indexed again. */
+	std::unordered_map<IdentityAddress, std::shared_ptr<Participant>> cachedParticipantsByAddress; /*keyed by address without gruu*/
+	mutable std::unordered_map<std::string, std::weak_ptr<ParticipantDevice>> cachedDevicesByGruu; /*keyed as queued messages are*/
+	mutable std::unordered_map<const CallSession *, std::weak_ptr<ParticipantDevice>> cachedDevicesBySession;
+	/* Cached participants that are in the conference participant list, which only this chat room modifies.
+	 * Both are only updated together, by authorizeParticipant() and unauthorizeParticipant(). */
+	std::unordered_set<const Participant *> authorizedParticipants;
+
 	L_DECLARE_PRIVATE(ServerGroupChatRoom);
 	L_DISABLE_COPY(ServerGroupChatRoom);
 };
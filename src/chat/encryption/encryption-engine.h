@@ -90,6 +90,9 @@ public:
 		FileTransferContent *fileTransferContent
 	) { return 0; }
 
+	// True if uploadingFile() and downloadingFile() accept the same buffer as input and output.
+	virtual bool canProcessFileInPlace () const { return false; }
+
 	virtual int cancelFileTransfer (
 		FileTransferContent *fileTransferContent
 	) { return 0; }
@@ -118,6 +118,9 @@ public:
 		FileTransferContent *fileTransferContent
 	) override;
 
+	// AES-GCM file encryption works in place.
+	bool canProcessFileInPlace () const override { return true; }
+
 	int cancelFileTransfer (
 			FileTransferContent *fileTransferContent
 	) override;
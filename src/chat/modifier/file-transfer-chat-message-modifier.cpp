@@ -61,6 +61,8 @@ FileTransferChatMessageModifier::~FileTransferChatMessageModifier () {
 		cancelFileTransfer(); //to avoid body handler to still refference zombie FileTransferChatMessageModifier
 	else
 		releaseHttpRequest();
+	if (sendChunkBuffer)
+		linphone_buffer_unref(sendChunkBuffer);
 }
 
 ChatMessageModifier::Result FileTransferChatMessageModifier::encode (const shared_ptr<ChatMessage> &message, int &errorCode) {
@@ -193,29 +195,35 @@ int FileTransferChatMessageModifier::onSendBody (
 		// Deprecated, use _linphone_chat_message_notify_file_transfer_send_chunk instead
 		_linphone_chat_message_notify_file_transfer_send(msg, content, offset, *size);
 
-		LinphoneBuffer *lb = linphone_buffer_new();
-		_linphone_chat_message_notify_file_transfer_send_chunk(msg, content, offset, *size, lb);
-		size_t lb_size = linphone_buffer_get_size(lb);
+		// The same buffer is handed to the application for every chunk.
+		if (!sendChunkBuffer)
+			sendChunkBuffer = linphone_buffer_new();
+		linphone_buffer_set_size(sendChunkBuffer, 0);
+		_linphone_chat_message_notify_file_transfer_send_chunk(msg, content, offset, *size, sendChunkBuffer);
+		size_t lb_size = linphone_buffer_get_size(sendChunkBuffer);
 		if (lb_size != 0) {
-			memcpy(buffer, linphone_buffer_get_content(lb), lb_size);
+			if (lb_size > *size) {
+				lError() << "File transfer send chunk callback returned a size bigger than the size of the buffer, so it will be truncated !";
+				lb_size = *size;
+			}
+			memcpy(buffer, linphone_buffer_get_content(sendChunkBuffer), lb_size);
 			*size = lb_size;
 		}
-		linphone_buffer_unref(lb);
 	}
 
 	EncryptionEngine *imee = message->getCore()->getEncryptionEngine();
 	if (imee) {
 		size_t max_size = *size;
-		uint8_t *encrypted_buffer = (uint8_t *)ms_malloc0(max_size);
-		retval = imee->uploadingFile(L_GET_CPP_PTR_FROM_C_OBJECT(msg), offset, buffer, size, encrypted_buffer, currentFileTransferContent);
+		uint8_t *encrypted_buffer = getCryptoBuffer(imee, buffer, max_size);
+		retval = imee->uploadingFile(message, offset, buffer, size, encrypted_buffer, currentFileTransferContent);
 		if (retval == 0) {
 			if (*size > max_size) {
 				lError() << "IM encryption engine process upload file callback returned a size bigger than the size of the buffer, so it will be truncated !";
 				*size = max_size;
 			}
-			memcpy(buffer, encrypted_buffer, *size);
+			if (encrypted_buffer != buffer)
+				memcpy(buffer, encrypted_buffer, *size);
 		}
-		ms_free(encrypted_buffer);
 	}
 
 	return retval <= 0 && *size != 0 ? BELLE_SIP_CONTINUE : BELLE_SIP_STOP;
@@ -226,6 +234,14 @@ static void _chat_message_on_send_end (belle_sip_user_body_handler_t *bh, void *
 	d->onSendEnd(bh);
 }
 
+uint8_t *FileTransferChatMessageModifier::getCryptoBuffer (EncryptionEngine *imee, uint8_t *buffer, size_t size) {
+	if (imee->canProcessFileInPlace())
+		return buffer;
+	if (cryptoBuffer.size() < size)
+		cryptoBuffer.resize(size);
+	return cryptoBuffer.data();
+}
+
 void FileTransferChatMessageModifier::onSendEnd (belle_sip_user_body_handler_t *bh) {
 	shared_ptr<ChatMessage> message = chatMessage.lock();
 	if (!message)
@@ -279,15 +295,17 @@ belle_sip_body_handler_t *FileTransferChatMessageModifier::prepare_upload_body_h
 		first_part_header = "form-data; name=\"File\"; filename=\"" + escapeFileName(currentFileContentToTransfer->getFileNameUtf8()) + "\"";
 	}
 
-	// create a user body handler to take care of the file and add the content disposition and content-type headers
-	first_part_bh = (belle_sip_body_handler_t *)belle_sip_user_body_handler_new(currentFileContentToTransfer->getFileSize(),
-			_chat_message_file_transfer_on_progress, nullptr, nullptr,
-			_chat_message_on_send_body, _chat_message_on_send_end, this);
 	if (!currentFileContentToTransfer->getFilePath().empty()) {
-		belle_sip_user_body_handler_t *body_handler = (belle_sip_user_body_handler_t *)first_part_bh;
-		// No need to add again the callback for progression, otherwise it will be called twice
 		first_part_bh = (belle_sip_body_handler_t *)belle_sip_file_body_handler_new(currentFileContentToTransfer->getFilePathSys().c_str(), nullptr, this);
-		belle_sip_file_body_handler_set_user_body_handler((belle_sip_file_body_handler_t *)first_part_bh, body_handler);
+		if (isFileEncryptionEnabled) {
+			// The file body handler reads the chunks, the user body handler encrypts them before they are sent.
+			// No need to add again the callback for progression, otherwise it will be called twice
+			belle_sip_user_body_handler_t *body_handler = belle_sip_user_body_handler_new(currentFileContentToTransfer->getFileSize(),
+				_chat_message_file_transfer_on_progress, nullptr, nullptr,
+				_chat_message_on_send_body, _chat_message_on_send_end, this);
+			belle_sip_file_body_handler_set_user_body_handler((belle_sip_file_body_handler_t *)first_part_bh, body_handler);
+		}
+		// Otherwise the file is streamed as is, without going through a callback for each chunk.
 		// Ensure the file size has been set to the correct value
 		currentFileTransferContent->setFileSize(belle_sip_file_body_handler_get_file_size((belle_sip_file_body_handler_t *)first_part_bh));
 	} else if (!currentFileContentToTransfer->isEmpty()) {
@@ -295,21 +313,20 @@ belle_sip_body_handler_t *FileTransferChatMessageModifier::prepare_upload_body_h
 		uint8_t *buf = (uint8_t *)ms_malloc(buf_size);
 		memcpy(buf, currentFileContentToTransfer->getBody().data(), buf_size);
 
-		EncryptionEngine *imee = message->getCore()->getEncryptionEngine();
 		if (imee) {
 			size_t max_size = buf_size;
-			uint8_t *encrypted_buffer = (uint8_t *)ms_malloc0(max_size);
+			uint8_t *encrypted_buffer = getCryptoBuffer(imee, buf, max_size);
 			int retval = imee->uploadingFile(message, 0, buf, &max_size, encrypted_buffer, currentFileTransferContent);
 			if (retval == 0) {
 				if (max_size > buf_size) {
 					lError() << "IM encryption engine process upload file callback returned a size bigger than the size of the buffer, so it will be truncated !";
 					max_size = buf_size;
 				}
-				memcpy(buf, encrypted_buffer, buf_size);
+				if (encrypted_buffer != buf)
+					memcpy(buf, encrypted_buffer, buf_size);
 				// Call it once more to compute the authentication tag
 				imee->uploadingFile(message, 0, nullptr, 0, nullptr, currentFileTransferContent);
 			}
-			ms_free(encrypted_buffer);
 		}
 
 		first_part_bh = (belle_sip_body_handler_t *)belle_sip_memory_body_handler_new_from_buffer(
@@ -625,12 +642,11 @@ void FileTransferChatMessageModifier::onRecvBody (belle_sip_user_body_handler_t
 	int retval = -1;
 	EncryptionEngine *imee = message->getCore()->getEncryptionEngine();
 	if (imee) {
-		uint8_t *decrypted_buffer = (uint8_t *)ms_malloc0(size);
+		uint8_t *decrypted_buffer = getCryptoBuffer(imee, buffer, size);
 		retval = imee->downloadingFile(message, offset, buffer, size, decrypted_buffer, currentFileTransferContent);
-		if (retval == 0) {
+		if (retval == 0 && decrypted_buffer != buffer) {
 			memcpy(buffer, decrypted_buffer, size);
 		}
-		ms_free(decrypted_buffer);
 	}
 
 	if (retval == 0 || retval == -1) {
@@ -21,9 +21,12 @@
 #ifndef _L_FILE_TRANSFER_CHAT_MESSAGE_MODIFIER_H_
 #define _L_FILE_TRANSFER_CHAT_MESSAGE_MODIFIER_H_
 
+#include <vector>
+
 #include <belle-sip/belle-sip.h>
 
 #include "chat-message-modifier.h"
+#include "linphone/types.h"
 #include "utils/background-task.h"
 
 // =============================================================================
@@ -32,6 +35,7 @@ LINPHONE_BEGIN_NAMESPACE
 
 class ChatRoom;
 class Core;
+class EncryptionEngine;
 class FileContent;
 class FileTransferContent;
 
@@ -85,6 +89,8 @@ private:
 	void onDownloadFailed ();
 	void releaseHttpRequest ();
 	belle_sip_body_handler_t *prepare_upload_body_handler(std::shared_ptr<ChatMessage> message);
+	// Output buffer for the encryption engine: the chunk itself if the engine works in place, a reused buffer otherwise.
+	uint8_t *getCryptoBuffer (EncryptionEngine *imee, uint8_t *buffer, size_t size);
 
 	std::string escapeFileName(const std::string& fileName) const;
 	std::string unEscapeFileName(const std::string& fileName) const;
@@ -99,6 +105,9 @@ private:
 
 	size_t lastNotifiedPercentage = 0;
 
+	std::vector<uint8_t> cryptoBuffer;
+	LinphoneBuffer *sendChunkBuffer = nullptr;
+
 	BackgroundTask bgTask;
 };
 
@@ -0,0 +1,231 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone 
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+#include <vector>
+
+#include "core/core.h"
+#include "logger/logger.h"
+
+#include "imdn.h"
+#include "imdn-scheduler.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+// -----------------------------------------------------------------------------
+
+ImdnScheduler::ImdnScheduler (Core &core) : mCore(core) {
+	LpConfig *config = linphone_core_get_config(core.getCCore());
+	mRate = linphone_config_get_float(config, "misc", "imdn_max_rate", 20.0f);
+	mBurst = max(1.0, (double)linphone_config_get_float(config, "misc", "imdn_burst", 20.0f));
+	mTokens = mBurst;
+	mLastRefill = bctbx_get_cur_time_ms();
+	resetStats();
+}
+
+ImdnScheduler::~ImdnScheduler () {
+	stop();
+}
+
+// -----------------------------------------------------------------------------
+
+void ImdnScheduler::schedule (Imdn *imdn, unsigned int delayMs) {
+	uint64_t now = bctbx_get_cur_time_ms();
+	uint64_t dueTime = now + delayMs;
+	auto it = mEntriesByImdn.find(imdn);
+	if (it != mEntriesByImdn.end()) {
+		// A due chat room only waits for tokens, it keeps its place.
+		if (it->second->dueTime <= now)
+			return;
+		it->second->dueTime = dueTime;
+	} else {
+		mEntries.push_back(Entry{ imdn, dueTime });
+		mEntriesByImdn[imdn] = prev(mEntries.end());
+		mStats.number_of_pending = (int)mEntries.size();
+		if (mEntries.size() == 1)
+			mBgTask.start(mCore.getSharedFromThis(), 1);
+	}
+	startTimer(dueTime);
+}
+
+bool ImdnScheduler::sendNow (Imdn *imdn) {
+	refillTokens(bctbx_get_cur_time_ms());
+	if (mRate > 0 && mTokens < 1)
+		return false;
+	erase(imdn);
+	send(imdn);
+	return true;
+}
+
+void ImdnScheduler::unschedule (Imdn *imdn) {
+	if (mForeground == imdn)
+		mForeground = nullptr;
+	erase(imdn);
+}
+
+bool ImdnScheduler::isScheduled (const Imdn *imdn) const {
+	return mEntriesByImdn.find(imdn) != mEntriesByImdn.end();
+}
+
+void ImdnScheduler::setForeground (const Imdn *imdn) {
+	mForeground = imdn;
+}
+
+void ImdnScheduler::notificationQueued () {
+	mStats.number_of_queued++;
+}
+
+void ImdnScheduler::stop () {
+	stopTimer();
+	mEntries.clear();
+	mEntriesByImdn.clear();
+	mForeground = nullptr;
+	mStats.number_of_pending = 0;
+	mBgTask.stop();
+}
+
+// -----------------------------------------------------------------------------
+
+const LinphoneCoreImdnSchedulerStats *ImdnScheduler::getStats () const {
+	return &mStats;
+}
+
+void ImdnScheduler::resetStats () {
+	mStats = { 0, 0, 0, (int)mEntries.size() };
+}
+
+// -----------------------------------------------------------------------------
+
+int ImdnScheduler::timerExpired (void *data, unsigned int revents) {
+	ImdnScheduler *scheduler = static_cast<ImdnScheduler *>(data);
+	scheduler->stopTimer();
+	scheduler->flush();
+	return BELLE_SIP_STOP;
+}
+
+void ImdnScheduler::refillTokens (uint64_t now) {
+	if (mRate <= 0)
+		return;
+	mTokens = min(mBurst, mTokens + (double)(now - mLastRefill) * mRate / 1000.0);
+	mLastRefill = now;
+}
+
+void ImdnScheduler::flush () {
+	uint64_t now = bctbx_get_cur_time_ms();
+	refillTokens(now);
+
+	vector<Entry> ready;
+	for (const auto &entry : mEntries) {
+		if (entry.dueTime <= now)
+			ready.push_back(entry);
+	}
+	// The foreground chat room first, then the chat rooms having display notifications, then the oldest ones.
+	stable_sort(ready.begin(), ready.end(), [this](const Entry &a, const Entry &b) {
+		if ((a.imdn == mForeground) != (b.imdn == mForeground))
+			return a.imdn == mForeground;
+		bool aDisplay = a.imdn->hasPendingDisplayNotifications();
+		bool bDisplay = b.imdn->hasPendingDisplayNotifications();
+		if (aDisplay != bDisplay)
+			return aDisplay;
+		return a.dueTime < b.dueTime;
+	});
+
+	bool throttled = false;
+	for (const auto &entry : ready) {
+		if (mRate > 0 && mTokens < 1) {
+			throttled = true;
+			break;
+		}
+		// A previous send may have destroyed or rescheduled this chat room.
+		auto it = mEntriesByImdn.find(entry.imdn);
+		if (it == mEntriesByImdn.end() || it->second->dueTime > now)
+			continue;
+		mEntries.erase(it->second);
+		mEntriesByImdn.erase(it);
+		send(entry.imdn);
+	}
+	mStats.number_of_pending = (int)mEntries.size();
+
+	if (mEntries.empty()) {
+		mBgTask.stop();
+		return;
+	}
+
+	uint64_t nextDueTime = UINT64_MAX;
+	for (const auto &entry : mEntries)
+		nextDueTime = min(nextDueTime, entry.dueTime);
+	if (throttled) {
+		lInfo() << "IMDN scheduler: rate limit reached, " << mEntries.size() << " chat rooms waiting";
+		nextDueTime = max(nextDueTime, now + (uint64_t)ceil((1 - mTokens) * 1000.0 / mRate));
+	}
+	startTimer(nextDueTime);
+}
+
+void ImdnScheduler::send (Imdn *imdn) {
+	int notifications = imdn->getPendingNotificationsCount();
+	int transactions = imdn->send();
+	if (transactions > 0) {
+		mStats.number_of_sent += transactions;
+		mStats.number_of_coalesced += max(0, notifications - transactions);
+		mTokens -= transactions;
+	}
+}
+
+void ImdnScheduler::erase (const Imdn *imdn) {
+	auto it = mEntriesByImdn.find(imdn);
+	if (it == mEntriesByImdn.end())
+		return;
+	mEntries.erase(it->second);
+	mEntriesByImdn.erase(it);
+	mStats.number_of_pending = (int)mEntries.size();
+	if (mEntries.empty()) {
+		stopTimer();
+		mBgTask.stop();
+	}
+}
+
+void ImdnScheduler::startTimer (uint64_t dueTime) {
+	uint64_t now = bctbx_get_cur_time_ms();
+	unsigned int duration = (dueTime > now) ? (unsigned int)(dueTime - now) : 0;
+	if (!mTimer) {
+		mTimer = mCore.getCCore()->sal->createTimer(timerExpired, this, duration, "imdn scheduler");
+		mTimerDueTime = dueTime;
+	} else if (dueTime < mTimerDueTime) {
+		belle_sip_source_set_timeout_int64(mTimer, (int64_t)duration);
+		mTimerDueTime = dueTime;
+	}
+}
+
+void ImdnScheduler::stopTimer () {
+	if (mTimer) {
+		auto core = mCore.getCCore();
+		if (core && core->sal)
+			core->sal->cancelTimer(mTimer);
+		belle_sip_object_unref(mTimer);
+		mTimer = nullptr;
+	}
+}
+
+LINPHONE_END_NAMESPACE
@@ -0,0 +1,105 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone 
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_IMDN_SCHEDULER_H_
+#define _L_IMDN_SCHEDULER_H_
+
+#include <list>
+#include <unordered_map>
+
+#include "linphone/utils/general.h"
+
+#include "utils/background-task.h"
+
+#include "private.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class Core;
+class Imdn;
+
+// Core-wide queue of the chat rooms that have IMDNs to send.
+// The IMDNs of a chat room are aggregated until its aggregation delay expires, then the chat rooms are flushed
+// in priority order (foreground chat room, then display notifications, then the oldest) as long as the
+// token bucket allows new MESSAGE transactions. A chat room waiting for tokens keeps aggregating its notifications.
+class ImdnScheduler {
+public:
+	ImdnScheduler (Core &core);
+	ImdnScheduler (const ImdnScheduler &other) = delete;
+	~ImdnScheduler ();
+
+	// Queue the IMDNs of a chat room, to be sent after delayMs. A chat room already queued is delayed again, unless it is due.
+	void schedule (Imdn *imdn, unsigned int delayMs);
+	// Send the IMDNs of a chat room at once if the token bucket allows it, returns false otherwise.
+	bool sendNow (Imdn *imdn);
+	// Remove the chat room from the queue, its IMDNs are not sent.
+	void unschedule (Imdn *imdn);
+	bool isScheduled (const Imdn *imdn) const;
+
+	// The foreground chat room is the last one for which display notifications were requested.
+	void setForeground (const Imdn *imdn);
+
+	// Count a notification added to the queue of a chat room.
+	void notificationQueued ();
+
+	// Drop the queue, called when the core stops.
+	void stop ();
+
+	const LinphoneCoreImdnSchedulerStats *getStats () const;
+	void resetStats ();
+
+private:
+	struct Entry {
+		Imdn *imdn;
+		uint64_t dueTime;
+	};
+
+	static int timerExpired (void *data, unsigned int revents);
+
+	void flush ();
+	void send (Imdn *imdn);
+	void erase (const Imdn *imdn);
+	void refillTokens (uint64_t now);
+	void startTimer (uint64_t dueTime);
+	void stopTimer ();
+
+	Core &mCore;
+	std::list<Entry> mEntries;
+	std::unordered_map<const Imdn *, std::list<Entry>::iterator> mEntriesByImdn;
+	const Imdn *mForeground = nullptr;
+
+	// Token bucket, a token is a MESSAGE transaction. A rate of 0 disables the limitation.
+	double mTokens = 0;
+	double mRate = 0;
+	double mBurst = 0;
+	uint64_t mLastRefill = 0;
+
+	belle_sip_source_t *mTimer = nullptr;
+	uint64_t mTimerDueTime = 0;
+	BackgroundTask mBgTask { "IMDN sending" };
+
+	LinphoneCoreImdnSchedulerStats mStats;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_IMDN_SCHEDULER_H_
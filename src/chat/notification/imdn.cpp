@@ -18,16 +18,23 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cctype>
+#include <cstdlib>
+
 #include "linphone/utils/algorithm.h"
+#include "linphone/utils/utils.h"
 
 #include "chat/chat-message/imdn-message-p.h"
 #include "chat/chat-room/chat-room-p.h"
 #include "core/core-p.h"
 #include "logger/logger.h"
+#include "imdn-scheduler.h"
 
 #ifdef HAVE_ADVANCED_IM
 #include "xml/imdn.h"
 #include "xml/linphone-imdn.h"
+#include "xml/xml-pull-parser.h"
+#include "xml/xml-stream-writer.h"
 #include "chat/encryption/encryption-engine.h"
 #endif
 
@@ -39,6 +46,9 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+// Delay during which the notifications of a chat room are aggregated.
+static constexpr unsigned int AggregationDelayMs = 500;
+
 // -----------------------------------------------------------------------------
 
 Imdn::Imdn (ChatRoom *chatRoom) : chatRoom(chatRoom) {
@@ -48,8 +58,8 @@ Imdn::Imdn (ChatRoom *chatRoom) : chatRoom(chatRoom) {
 }
 
 Imdn::~Imdn () {
-	stopTimer();
 	try { //getCore may no longuer be available when deleting, specially in case of managed enviroment like java
+		cancelSend();
 		chatRoom->getCore()->getPrivate()->unregisterListener(this);
 	} catch (const bad_weak_ptr &) {}
 }
@@ -59,7 +69,8 @@ Imdn::~Imdn () {
 void Imdn::notifyDelivery (const shared_ptr<ChatMessage> &message) {
 	if (find(deliveredMessages, message) == deliveredMessages.end()) {
 		deliveredMessages.push_back(message);
-		startTimer();
+		getScheduler().notificationQueued();
+		scheduleSend(aggregationEnabled() ? AggregationDelayMs : 0);
 	}
 }
 
@@ -70,7 +81,8 @@ void Imdn::notifyDeliveryError (const shared_ptr<ChatMessage> &message, Linphone
 		}) == nonDeliveredMessages.end()
 	) {
 		nonDeliveredMessages.emplace_back(message, reason);
-		startTimer();
+		getScheduler().notificationQueued();
+		scheduleSend(aggregationEnabled() ? AggregationDelayMs : 0);
 	}
 }
 
@@ -81,7 +93,10 @@ void Imdn::notifyDisplay (const shared_ptr<ChatMessage> &message) {
 
 	if (find(displayedMessages.begin(), displayedMessages.end(), message) == displayedMessages.end()) {
 		displayedMessages.push_back(message);
-		startTimer();
+		getScheduler().notificationQueued();
+		// Display notifications are requested for the chat room the user is looking at.
+		getScheduler().setForeground(this);
+		scheduleSend(aggregationEnabled() ? AggregationDelayMs : 0);
 	}
 }
 
@@ -121,14 +136,15 @@ bool Imdn::isCurrentlySendingImdnMessages() {
 		}
 	}
 	
-	// IMDNs are pending if the timer before sending them is not NULL or if the list of IMDN chat message isn't empty
-	return timer != NULL || !sentImdnMessages.empty();
+	// IMDNs are pending if they are waiting in the scheduler or if the list of IMDN chat message isn't empty
+	return getScheduler().isScheduled(this) || !sentImdnMessages.empty();
 }
 
 // -----------------------------------------------------------------------------
 
 void Imdn::onLinphoneCoreStop() {
 	auto ref = chatRoom->getSharedFromThis();
+	cancelSend();
 	deliveredMessages.clear();
 	displayedMessages.clear();
 	nonDeliveredMessages.clear();
@@ -138,8 +154,10 @@ void Imdn::onLinphoneCoreStop() {
 void Imdn::onRegistrationStateChanged(LinphoneProxyConfig *cfg, LinphoneRegistrationState state, const std::string &message){
 	if (state == LinphoneRegistrationOk && cfg == getRelatedProxyConfig()){
 		// When we are registered to the proxy, then send pending notification if any.
+		// All the chat rooms of the account do it at once, the scheduler paces them.
 		sentImdnMessages.clear();
-		send();
+		if (getPendingNotificationsCount() > 0)
+			scheduleSend(0);
 	}
 }
 
@@ -147,7 +165,8 @@ void Imdn::onNetworkReachable (bool sipNetworkReachable, bool mediaNetworkReacha
 	if (sipNetworkReachable && getRelatedProxyConfig() == nullptr) {
 		// When the SIP network gets up and this chatroom isn't related to any proxy configuration, retry notification
 		sentImdnMessages.clear();
-		send();
+		if (getPendingNotificationsCount() > 0)
+			scheduleSend(0);
 	}
 }
 
@@ -155,9 +174,149 @@ void Imdn::onNetworkReachable (bool sipNetworkReachable, bool mediaNetworkReacha
 
 // -----------------------------------------------------------------------------
 
-string Imdn::createXml (const string &id, time_t timestamp, Imdn::Type imdnType, LinphoneReason reason) {
+bool Imdn::isXmlStreamingEnabled (LinphoneCore *core) {
+	return !!linphone_config_get_bool(linphone_core_get_config(core), "misc", "xml_streaming_codec", TRUE);
+}
+
+#ifdef HAVE_ADVANCED_IM
+static const string ImdnNamespace = "urn:ietf:params:xml:ns:imdn";
+static const string LinphoneImdnNamespace = "http://www.linphone.org/xsds/imdn.xsd";
+
+static string createStreamedXml (const string &id, const char *datetime, Imdn::Type imdnType, LinphoneReason reason) {
+	XmlStreamWriter writer;
+	writer.startElement("imdn");
+	writer.writeAttribute("xmlns", ImdnNamespace);
+	if ((imdnType == Imdn::Type::Delivery) && (reason != LinphoneReasonNone))
+		writer.writeAttribute("xmlns:imdn", LinphoneImdnNamespace);
+	writer.writeElement("message-id", id);
+	writer.writeElement("datetime", datetime);
+	if (imdnType == Imdn::Type::Delivery) {
+		writer.startElement("delivery-notification");
+		writer.startElement("status");
+		if (reason == LinphoneReasonNone) {
+			writer.startElement("delivered");
+			writer.endElement();
+		} else {
+			writer.startElement("failed");
+			writer.endElement();
+			writer.startElement("imdn:reason");
+			writer.writeAttribute("code", Utils::toString(linphone_reason_to_error_code(reason)));
+			writer.writeText(linphone_reason_to_string(reason));
+			writer.endElement();
+		}
+	} else if (imdnType == Imdn::Type::Display) {
+		writer.startElement("display-notification");
+		writer.startElement("status");
+		writer.startElement("displayed");
+		writer.endElement();
+	}
+	return writer.getDocument();
+}
+
+// message-id is a xs:token: leading, trailing and repeated whitespaces are not significant.
+static string collapseWhitespaces (const string &value) {
+	string result;
+	result.reserve(value.size());
+	bool pendingSpace = false;
+	for (const char c : value) {
+		if (isspace(static_cast<unsigned char>(c))) {
+			pendingSpace = !result.empty();
+			continue;
+		}
+		if (pendingSpace) {
+			result += ' ';
+			pendingSpace = false;
+		}
+		result += c;
+	}
+	return result;
+}
+
+static bool parseStreamedXml (const string &xml, Imdn::Notification &notification) {
+	XmlPullParser parser(xml);
+	string messageId;
+	bool hasMessageId = false;
+	bool hasDatetime = false;
+	bool inMessageId = false;
+	bool inStatus = false;
+	for (;;) {
+		switch (parser.next()) {
+			case XmlPullParser::Event::StartElement: {
+				const int depth = parser.getDepth();
+				const string &name = parser.getLocalName();
+				const bool isImdnElement = (parser.getNamespace() == ImdnNamespace);
+				if (depth == 1) {
+					if (!isImdnElement || (name != "imdn"))
+						return false;
+				} else if ((depth == 2) && isImdnElement) {
+					if (name == "message-id") {
+						hasMessageId = inMessageId = true;
+					} else if (name == "datetime") {
+						hasDatetime = true;
+					} else if (name == "delivery-notification") {
+						notification.isDelivery = true;
+					} else if (name == "display-notification") {
+						notification.isDisplay = true;
+					}
+				} else if ((depth == 3) && isImdnElement && (name == "status")) {
+					inStatus = notification.isDelivery || notification.isDisplay;
+				} else if ((depth == 4) && inStatus) {
+					if (isImdnElement) {
+						if (name == "delivered")
+							notification.delivered = notification.isDelivery;
+						else if (name == "failed")
+							notification.failed = notification.isDelivery;
+						else if (name == "displayed")
+							notification.displayed = notification.isDisplay;
+						else if (name == "error")
+							notification.error = true;
+					} else if ((parser.getNamespace() == LinphoneImdnNamespace) && (name == "reason") && notification.isDelivery) {
+						notification.hasReason = true;
+						string code;
+						if (parser.getAttribute("code", code)) {
+							char *end = nullptr;
+							long value = strtol(code.c_str(), &end, 10);
+							if (code.empty() || (*end != '\0'))
+								return false;
+							notification.reasonCode = static_cast<int>(value);
+						}
+					}
+				}
+			} break;
+
+			case XmlPullParser::Event::Text:
+				if (inMessageId)
+					messageId += parser.getText();
+				break;
+
+			case XmlPullParser::Event::EndElement:
+				if (parser.getDepth() == 1)
+					inMessageId = false;
+				else if (parser.getDepth() == 2)
+					inStatus = false;
+				break;
+
+			case XmlPullParser::Event::EndDocument:
+				if (!hasMessageId || !hasDatetime)
+					return false;
+				notification.messageId = collapseWhitespaces(messageId);
+				return true;
+
+			case XmlPullParser::Event::Error:
+				return false;
+		}
+	}
+}
+#endif
+
+string Imdn::createXml (const string &id, time_t timestamp, Imdn::Type imdnType, LinphoneReason reason, bool streamed) {
 #ifdef HAVE_ADVANCED_IM
 	char *datetime = linphone_timestamp_to_rfc3339_string(timestamp);
+	if (streamed) {
+		string xml = createStreamedXml(id, datetime, imdnType, reason);
+		ms_free(datetime);
+		return xml;
+	}
 	Xsd::Imdn::Imdn imdn(id, datetime);
 	ms_free(datetime);
 	bool needLinphoneImdnNamespace = false;
@@ -197,24 +356,65 @@ string Imdn::createXml (const string &id, time_t timestamp, Imdn::Type imdnType,
 #endif
 }
 
+bool Imdn::parseXml (const string &xml, Notification &notification, bool streamed) {
+#ifdef HAVE_ADVANCED_IM
+	if (streamed) {
+		if (parseStreamedXml(xml, notification))
+			return true;
+		// Let the generated parser deal with what the streamed one does not support, or report the error.
+		lDebug() << "Streamed IMDN parsing failed, falling back to DOM parsing";
+		notification = Notification();
+	}
+
+	istringstream data(xml);
+	unique_ptr<Xsd::Imdn::Imdn> imdn;
+	try {
+		imdn = Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate);
+	} catch (const exception &e) {
+		lError() << "IMDN parsing exception: " << e.what();
+	}
+	if (!imdn)
+		return false;
+
+	notification.messageId = imdn->getMessageId();
+	auto &deliveryNotification = imdn->getDeliveryNotification();
+	auto &displayNotification = imdn->getDisplayNotification();
+	if (deliveryNotification.present()) {
+		auto &status = deliveryNotification.get().getStatus();
+		notification.isDelivery = true;
+		notification.delivered = status.getDelivered().present();
+		notification.failed = status.getFailed().present();
+		notification.error = status.getError().present();
+		if (status.getReason().present()) {
+			notification.hasReason = true;
+			notification.reasonCode = status.getReason().get().getCode();
+		}
+	} else if (displayNotification.present()) {
+		auto &status = displayNotification.get().getStatus();
+		notification.isDisplay = true;
+		notification.displayed = status.getDisplayed().present();
+		notification.error = status.getError().present();
+	}
+	return true;
+#else
+	lWarning() << "Advanced IM such as group chat is disabled!";
+	return false;
+#endif
+}
+
 void Imdn::parse (const shared_ptr<ChatMessage> &chatMessage) {
 #ifdef HAVE_ADVANCED_IM
 	shared_ptr<AbstractChatRoom> cr = chatMessage->getChatRoom();
+	const bool streamed = isXmlStreamingEnabled(cr->getCore()->getCCore());
 	list<string> messagesIds;
-	list<unique_ptr<Xsd::Imdn::Imdn>> imdns;
+	list<Notification> imdns;
 
 	for (const auto &content : chatMessage->getPrivate()->getContents()) {
-		istringstream data(content->getBodyAsString());
-		unique_ptr<Xsd::Imdn::Imdn> imdn;
-		try {
-			imdn = Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate);
-		} catch (const exception &e) {
-			lError() << "IMDN parsing exception: " << e.what();
-		}
-		if (!imdn)
+		Notification imdn;
+		if (!parseXml(content->getBodyAsString(), imdn, streamed))
 			continue;
-		
-		messagesIds.push_back(imdn->getMessageId());
+
+		messagesIds.push_back(imdn.messageId);
 		imdns.push_back(move(imdn));
 	}
 
@@ -224,39 +424,35 @@ void Imdn::parse (const shared_ptr<ChatMessage> &chatMessage) {
 	for (const auto& imdn: imdns)  {
 		shared_ptr<ChatMessage> cm = nullptr;
 		for (const auto &chatMessage : chatMessages) {
-			if (chatMessage->getImdnMessageId() == imdn->getMessageId()) {
+			if (chatMessage->getImdnMessageId() == imdn.messageId) {
 				cm = chatMessage;
 				break;
 			}
 		}
 
 		if (!cm) {
-			lWarning() << "Received IMDN for unknown message " << imdn->getMessageId();
+			lWarning() << "Received IMDN for unknown message " << imdn.messageId;
 		} else {
 			chatMessages.remove(cm);
 
 			auto policy = linphone_core_get_im_notif_policy(cr->getCore()->getCCore());
 			time_t imdnTime = chatMessage->getTime();
 			const IdentityAddress &participantAddress = chatMessage->getFromAddress().getAddressWithoutGruu();
-			auto &deliveryNotification = imdn->getDeliveryNotification();
-			auto &displayNotification = imdn->getDisplayNotification();
-			if (deliveryNotification.present()) {
-				auto &status = deliveryNotification.get().getStatus();
-				if (status.getDelivered().present() && linphone_im_notif_policy_get_recv_imdn_delivered(policy)) {
+			if (imdn.isDelivery) {
+				if (imdn.delivered && linphone_im_notif_policy_get_recv_imdn_delivered(policy)) {
 					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::DeliveredToUser, imdnTime);
-				} else if ((status.getFailed().present() || status.getError().present()) && linphone_im_notif_policy_get_recv_imdn_delivered(policy)) {
+				} else if ((imdn.failed || imdn.error) && linphone_im_notif_policy_get_recv_imdn_delivered(policy)) {
 					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::NotDelivered, imdnTime);
 					// When the IMDN status is failed for reason code 488 (Not acceptable here) and the chatroom is encrypted,
 					// something is wrong with our encryption session with this peer, stale the active session the next
 					// message (which can be a resend of this one) will be encrypted with a new session
 					if (cr->getLocalAddress() == cm->getFromAddress() // check the imdn is in response to a message sent by the local user
-							&& status.getFailed().present() // that we have a fail tag
-							&& status.getReason().present() // and a reason tag
+							&& imdn.failed // that we have a fail tag
+							&& imdn.hasReason // and a reason tag
 							&& (cr->getCapabilities() & ChatRoom::Capabilities::Encrypted)) { // and the chatroom is encrypted
 						// Check the reason code is 488
-						auto reason = status.getReason().get();
 						auto imee = cm->getCore()->getEncryptionEngine();
-						if ((reason.getCode() == 488) && imee) {
+						if ((imdn.reasonCode == 488) && imee) {
 							// stale the encryption sessions with this device: something went wrong, we will create a new one at next encryption
 							lWarning()<<"Peer "<<chatMessage->getFromAddress().asString()<<" could not decrypt message from "
 								<< cm->getFromAddress().asString()<<" -> Stale the lime X3DH session";
@@ -264,9 +460,8 @@ void Imdn::parse (const shared_ptr<ChatMessage> &chatMessage) {
 						}
 					}
 				}
-			} else if (displayNotification.present()) {
-				auto &status = displayNotification.get().getStatus();
-				if (status.getDisplayed().present() && linphone_im_notif_policy_get_recv_imdn_displayed(policy)) {
+			} else if (imdn.isDisplay) {
+				if (imdn.displayed && linphone_im_notif_policy_get_recv_imdn_displayed(policy)) {
 					cm->getPrivate()->setParticipantState(participantAddress, ChatMessage::State::Displayed, imdnTime);
 					if (cr->getLocalAddress().getAddressWithoutGruu() == chatMessage->getFromAddress().getAddressWithoutGruu()) {
 						auto lastMsg = cr->getLastChatMessageInHistory();
@@ -286,26 +481,17 @@ void Imdn::parse (const shared_ptr<ChatMessage> &chatMessage) {
 
 bool Imdn::isError (const shared_ptr<ChatMessage> &chatMessage) {
 #ifdef HAVE_ADVANCED_IM
+	const bool streamed = isXmlStreamingEnabled(chatMessage->getCore()->getCCore());
 	for (const auto &content : chatMessage->getPrivate()->getContents()) {
 		if (content->getContentType() != ContentType::Imdn)
 			continue;
 		
-		istringstream data(content->getBodyAsString());
-		unique_ptr<Xsd::Imdn::Imdn> imdn;
-		try {
-			imdn = Xsd::Imdn::parseImdn(data, Xsd::XmlSchema::Flags::dont_validate);
-		} catch (const exception &e) {
-			lError() << "IMDN parsing exception: " << e.what();
-		}
-		if (!imdn)
+		Notification imdn;
+		if (!parseXml(content->getBodyAsString(), imdn, streamed))
 			continue;
 		
-		auto &deliveryNotification = imdn->getDeliveryNotification();
-		if (deliveryNotification.present()) {
-			auto &status = deliveryNotification.get().getStatus();
-			if (status.getFailed().present() || status.getError().present())
-				return true;
-		}
+		if (imdn.isDelivery && (imdn.failed || imdn.error))
+			return true;
 	}
 	return false;
 #else
@@ -316,15 +502,6 @@ bool Imdn::isError (const shared_ptr<ChatMessage> &chatMessage) {
 
 // -----------------------------------------------------------------------------
 
-int Imdn::timerExpired (void *data, unsigned int revents) {
-	Imdn *d = static_cast<Imdn *>(data);
-	d->stopTimer();
-	d->send();
-	return BELLE_SIP_STOP;
-}
-
-// -----------------------------------------------------------------------------
-
 bool Imdn::aggregationEnabled () const {
 	return chatRoom->canHandleCpim() && chatRoom->canHandleMultipart() && aggregationAllowed;
 }
@@ -339,23 +516,28 @@ LinphoneProxyConfig * Imdn::getRelatedProxyConfig(){
 	return cfg;
 }
 
-void Imdn::send () {
+int Imdn::getPendingNotificationsCount () const {
+	return (int)(deliveredMessages.size() + displayedMessages.size() + nonDeliveredMessages.size());
+}
+
+int Imdn::send () {
+	int transactions = 0;
 	try {
 		if (!chatRoom->getCore()->getCCore()->send_imdn_if_unregistered) {
 			LinphoneProxyConfig *cfg = getRelatedProxyConfig();
 			if (!cfg) {
 				lInfo() << "No matching proxy config found, will wait to send pending IMDNs";
-				return;
+				return 0;
 			} else if (linphone_proxy_config_get_state(cfg) != LinphoneRegistrationOk){
 				lInfo() << "Proxy config not registered, will wait to send pending IMDNs";
-				return;
+				return 0;
 			}
 
 			if (!linphone_core_is_network_reachable(chatRoom->getCore()->getCCore()))
-				return;
+				return 0;
 		}
 	} catch (const bad_weak_ptr &) {
-		return; // Cannot send imdn if core is destroyed.
+		return 0; // Cannot send imdn if core is destroyed.
 	}
 
 	if (!deliveredMessages.empty() || !displayedMessages.empty()) {
@@ -366,6 +548,7 @@ void Imdn::send () {
 			} else {
 				sentImdnMessages.push_back(imdnMessage);
 				imdnMessage->getPrivate()->send();
+				transactions++;
 			}
 		} else {
 			list<shared_ptr<ImdnMessage>> imdnMessages;
@@ -385,6 +568,7 @@ void Imdn::send () {
 				} else {
 					sentImdnMessages.push_back(message);
 					message->getPrivate()->send();
+					transactions++;
 				}
 			}
 			deliveredMessages.clear();
@@ -399,6 +583,7 @@ void Imdn::send () {
 			} else {
 				sentImdnMessages.push_back(imdnMessage);
 				imdnMessage->getPrivate()->send();
+				transactions++;
 			}
 		} else {
 			list<shared_ptr<ImdnMessage>> imdnMessages;
@@ -413,37 +598,28 @@ void Imdn::send () {
 				} else {
 					sentImdnMessages.push_back(message);
 					message->getPrivate()->send();
+					transactions++;
 				}
 			}
 			nonDeliveredMessages.clear();
 		}
 	}
+	return transactions;
 }
 
-void Imdn::startTimer () {
-	if (!aggregationEnabled()) {
-		// Compatibility mode for basic chat rooms, do not aggregate notifications
-		send();
+void Imdn::scheduleSend (unsigned int delayMs) {
+	// Compatibility mode for basic chat rooms, do not aggregate notifications: send them at once unless the rate limit is reached.
+	if (!aggregationEnabled() && getScheduler().sendNow(this))
 		return;
-	}
+	getScheduler().schedule(this, delayMs);
+}
 
-	unsigned int duration = 500;
-	if (!timer)
-		timer = chatRoom->getCore()->getCCore()->sal->createTimer(timerExpired, this, duration, "imdn timeout");
-	else
-		belle_sip_source_set_timeout_int64(timer, duration);
-	bgTask.start(chatRoom->getCore(), 1);
+void Imdn::cancelSend () {
+	getScheduler().unschedule(this);
 }
 
-void Imdn::stopTimer () {
-	if (timer) {
-		auto core = chatRoom->getCore()->getCCore();
-		if (core && core->sal)
-			core->sal->cancelTimer(timer);
-		belle_sip_object_unref(timer);
-		timer = nullptr;
-	}
-	bgTask.stop();
+ImdnScheduler &Imdn::getScheduler () const {
+	return chatRoom->getCore()->getPrivate()->getImdnScheduler();
 }
 
 LINPHONE_END_NAMESPACE
@@ -24,7 +24,6 @@
 #include "linphone/utils/general.h"
 
 #include "core/core-listener.h"
-#include "utils/background-task.h"
 
 #include "private.h"
 
@@ -35,6 +34,7 @@ LINPHONE_BEGIN_NAMESPACE
 class ChatMessage;
 class ChatRoom;
 class ImdnMessage;
+class ImdnScheduler;
 
 class Imdn : public CoreListener {
 public:
@@ -55,6 +55,19 @@ public:
 		LinphoneReason reason;
 	};
 
+	// What is read from an IMDN document to update the state of the message it refers to.
+	struct Notification {
+		std::string messageId;
+		bool isDelivery = false;
+		bool isDisplay = false;
+		bool delivered = false;
+		bool displayed = false;
+		bool failed = false;
+		bool error = false;
+		bool hasReason = false;
+		int reasonCode = 200;
+	};
+
 	Imdn (ChatRoom *chatRoom);
 	~Imdn ();
 
@@ -72,17 +85,25 @@ public:
 	bool aggregationEnabled () const;
 	void onLinphoneCoreStop();
 
-	static std::string createXml (const std::string &id, time_t time, Imdn::Type imdnType, LinphoneReason reason);
+	// Used by the ImdnScheduler.
+	bool hasPendingDisplayNotifications () const { return !displayedMessages.empty(); }
+	int getPendingNotificationsCount () const;
+	// Returns the number of MESSAGE transactions that have been sent.
+	int send ();
+
+	// The streamed codec writes and reads the documents without building any DOM tree. Both codecs produce the same output.
+	static bool isXmlStreamingEnabled (LinphoneCore *core);
+	LINPHONE_PUBLIC static std::string createXml (const std::string &id, time_t time, Imdn::Type imdnType, LinphoneReason reason, bool streamed = false);
+	LINPHONE_PUBLIC static bool parseXml (const std::string &xml, Notification &notification, bool streamed = false);
 	static void parse (const std::shared_ptr<ChatMessage> &chatMessage);
 	static bool isError (const std::shared_ptr<ChatMessage> &chatMessage);
 
 private:
 	LinphoneProxyConfig *getRelatedProxyConfig();
-	static int timerExpired (void *data, unsigned int revents);
+	ImdnScheduler &getScheduler () const;
 
-	void send ();
-	void startTimer ();
-	void stopTimer ();
+	void scheduleSend (unsigned int delayMs);
+	void cancelSend ();
 
 private:
 	ChatRoom *chatRoom = nullptr;
@@ -90,8 +111,6 @@ private:
 	std::list<std::shared_ptr<ChatMessage>> displayedMessages;
 	std::list<MessageReason> nonDeliveredMessages;
 	std::list<std::shared_ptr<ImdnMessage>> sentImdnMessages;
-	belle_sip_source_t *timer = nullptr;
-	BackgroundTask bgTask { "IMDN sending" };
 	bool aggregationAllowed;
 };
 
@@ -18,6 +18,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <cstdlib>
 #include <utility>
 
 #include "linphone/utils/utils.h"
@@ -28,6 +29,8 @@
 
 #ifdef HAVE_ADVANCED_IM
 #include "xml/is-composing.h"
+#include "xml/xml-pull-parser.h"
+#include "xml/xml-stream-writer.h"
 #endif
 
 
@@ -57,10 +60,107 @@ IsComposing::~IsComposing () {
 // -----------------------------------------------------------------------------
 
 string IsComposing::createXml (bool isComposing) {
+	unsigned long long refresh = 0;
+	if (isComposing)
+		refresh = static_cast<unsigned long long>(linphone_config_get_int(core->config, "sip", "composing_refresh_timeout", defaultRefreshTimeout));
+	return createXml(isComposing, refresh, isXmlStreamingEnabled());
+}
+
+void IsComposing::parse (const Address &remoteAddr, const string &text) {
+#ifdef HAVE_ADVANCED_IM
+	string state;
+	unsigned long long refresh = 0;
+	if (!parseXml(text, state, refresh, isXmlStreamingEnabled()))
+		return;
+
+	if (state == "active") {
+		startRemoteRefreshTimer(remoteAddr.asStringUriOnly(), refresh);
+		listener->onIsRemoteComposingStateChanged(remoteAddr, true);
+	} else if (state == "idle") {
+		stopRemoteRefreshTimer(remoteAddr.asStringUriOnly());
+		listener->onIsRemoteComposingStateChanged(remoteAddr, false);
+	}
+#else
+	lWarning() << "Advanced IM such as group chat is disabled!";
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
 #ifdef HAVE_ADVANCED_IM
+static const string IsComposingNamespace = "urn:ietf:params:xml:ns:im-iscomposing";
+
+static bool parseStreamedXml (const string &xml, string &state, unsigned long long &refresh) {
+	XmlPullParser parser(xml);
+	string value;
+	bool hasState = false;
+	bool inState = false;
+	bool inRefresh = false;
+	for (;;) {
+		switch (parser.next()) {
+			case XmlPullParser::Event::StartElement:
+				if (parser.getNamespace() != IsComposingNamespace)
+					break;
+				if (parser.getDepth() == 1) {
+					if (parser.getLocalName() != "isComposing")
+						return false;
+				} else if (parser.getDepth() == 2) {
+					inState = (parser.getLocalName() == "state");
+					inRefresh = (parser.getLocalName() == "refresh");
+					hasState = hasState || inState;
+					value.clear();
+				}
+				break;
+
+			case XmlPullParser::Event::Text:
+				if (inState || inRefresh)
+					value += parser.getText();
+				break;
+
+			case XmlPullParser::Event::EndElement:
+				if (parser.getDepth() != 1)
+					break;
+				if (inState) {
+					state = value;
+				} else if (inRefresh) {
+					// refresh is a xs:positiveInteger, surrounding whitespaces are not significant.
+					const size_t begin = value.find_first_not_of(" \t\n");
+					if (begin == string::npos)
+						return false;
+					const string digits = value.substr(begin, value.find_last_not_of(" \t\n") - begin + 1);
+					char *end = nullptr;
+					refresh = strtoull(digits.c_str(), &end, 10);
+					if (*end != '\0')
+						return false;
+				}
+				inState = inRefresh = false;
+				break;
+
+			case XmlPullParser::Event::EndDocument:
+				return hasState;
+
+			case XmlPullParser::Event::Error:
+				return false;
+		}
+	}
+}
+#endif
+
+string IsComposing::createXml (bool isComposing, unsigned long long refresh, bool streamed) {
+#ifdef HAVE_ADVANCED_IM
+	if (streamed) {
+		XmlStreamWriter writer;
+		writer.startElement("isComposing");
+		writer.writeAttribute("xmlns", IsComposingNamespace);
+		writer.writeElement("state", isComposing ? "active" : "idle");
+		if (isComposing)
+			writer.writeElement("refresh", Utils::toString(refresh));
+		return writer.getDocument();
+	}
+
 	Xsd::IsComposing::IsComposing node(isComposing ? "active" : "idle");
 	if (isComposing)
-		node.setRefresh(static_cast<unsigned long long>(linphone_config_get_int(core->config, "sip", "composing_refresh_timeout", defaultRefreshTimeout)));
+		node.setRefresh(refresh);
 
 	stringstream ss;
 	Xsd::XmlSchema::NamespaceInfomap map;
@@ -73,28 +173,33 @@ string IsComposing::createXml (bool isComposing) {
 #endif
 }
 
-void IsComposing::parse (const Address &remoteAddr, const string &text) {
+bool IsComposing::parseXml (const string &xml, string &state, unsigned long long &refresh, bool streamed) {
 #ifdef HAVE_ADVANCED_IM
-	istringstream data(text);
+	if (streamed) {
+		if (parseStreamedXml(xml, state, refresh))
+			return true;
+		lDebug() << "Streamed is-composing parsing failed, falling back to DOM parsing";
+		state.clear();
+		refresh = 0;
+	}
+
+	istringstream data(xml);
 	unique_ptr<Xsd::IsComposing::IsComposing> node(Xsd::IsComposing::parseIsComposing(data, Xsd::XmlSchema::Flags::dont_validate));
 	if (!node)
-		return;
+		return false;
 
-	if (node->getState() == "active") {
-		unsigned long long refresh = 0;
-		if (node->getRefresh().present())
-			refresh = node->getRefresh().get();
-		startRemoteRefreshTimer(remoteAddr.asStringUriOnly(), refresh);
-		listener->onIsRemoteComposingStateChanged(remoteAddr, true);
-	} else if (node->getState() == "idle") {
-		stopRemoteRefreshTimer(remoteAddr.asStringUriOnly());
-		listener->onIsRemoteComposingStateChanged(remoteAddr, false);
-	}
+	state = node->getState();
+	if (node->getRefresh().present())
+		refresh = node->getRefresh().get();
+	return true;
 #else
 	lWarning() << "Advanced IM such as group chat is disabled!";
+	return false;
 #endif
 }
 
+// -----------------------------------------------------------------------------
+
 void IsComposing::startIdleTimer () {
 	unsigned int duration = getIdleTimerDuration();
 	if (!idleTimer) {
@@ -149,6 +254,10 @@ void IsComposing::stopRemoteRefreshTimer (const string &uri) {
 
 // -----------------------------------------------------------------------------
 
+bool IsComposing::isXmlStreamingEnabled () const {
+	return !!linphone_config_get_bool(core->config, "misc", "xml_streaming_codec", TRUE);
+}
+
 unsigned int IsComposing::getIdleTimerDuration () {
 	int idleTimerDuration = linphone_config_get_int(core->config, "sip", "composing_idle_timeout", defaultIdleTimeout);
 	return idleTimerDuration < 0 ? 0 : static_cast<unsigned int>(idleTimerDuration);
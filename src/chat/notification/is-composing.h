@@ -48,7 +48,11 @@ public:
 	void stopRemoteRefreshTimer (const std::string &uri);
 	void stopTimers ();
 
+	LINPHONE_PUBLIC static std::string createXml (bool isComposing, unsigned long long refresh, bool streamed = false);
+	LINPHONE_PUBLIC static bool parseXml (const std::string &xml, std::string &state, unsigned long long &refresh, bool streamed = false);
+
 private:
+	bool isXmlStreamingEnabled () const;
 	unsigned int getIdleTimerDuration ();
 	unsigned int getRefreshTimerDuration ();
 	unsigned int getRemoteRefreshTimerDuration ();
@@ -18,6 +18,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <ctime>
 
 #include "linphone/api/c-content.h"
@@ -53,6 +54,10 @@ using namespace Xsd::ConferenceInfoLinphoneExtension;
 // =============================================================================
 
 LocalConferenceEventHandler::LocalConferenceEventHandler (Conference *conference, ConferenceListener *listener): conf(conference), confListener(listener) {
+	if (conf) {
+		int historySize = linphone_config_get_int(linphone_core_get_config(conf->getCore()->getCCore()), "misc", "conference_notify_history_size", 100);
+		notifyHistorySize = (historySize > 0) ? static_cast<size_t>(historySize) : 0;
+	}
 }
 
 // -----------------------------------------------------------------------------
@@ -95,6 +100,38 @@ Content LocalConferenceEventHandler::createNotifyFullState (LinphoneEvent * lev)
 		}
 	}
 
+	if (!linphone_config_get_bool(linphone_core_get_config(conf->getCore()->getCCore()), "misc", "conference_full_state_cache", TRUE)) {
+		resetFullState();
+		ConferenceType confInfo = createConferenceInfoFullState();
+		fullStateSerializationCount++;
+		return makeContent(createNotify(confInfo, true));
+	}
+
+	// All subscribers asking for the same version get the same body: it is only serialized again once something changed.
+	invalidateChangedFullStateDevices();
+	const unsigned int version = conf->getLastNotify();
+	if (fullStateContent.isEmpty() || (fullStateVersion != version)) {
+		updateFullStateConferenceInfo();
+		fullStateContent = makeContent(createNotify(*fullStateConfInfo, true));
+		fullStateVersion = version;
+		fullStateSerializationCount++;
+	}
+	return fullStateContent;
+}
+
+ConferenceType LocalConferenceEventHandler::createConferenceInfoFullState () {
+	ConferenceType confInfo = ConferenceType(conf->getConferenceAddress().asString());
+	confInfo.setConferenceDescription(createConferenceDescriptionFullState());
+
+	UsersType users;
+	confInfo.setUsers(users);
+	for (const auto &participant : getFullStateParticipants()) {
+		confInfo.getUsers()->getUser().push_back(createUserFullState(participant));
+	}
+	return confInfo;
+}
+
+ConferenceDescriptionType LocalConferenceEventHandler::createConferenceDescriptionFullState () {
 	ConferenceAddress conferenceAddress = conf->getConferenceAddress();
 	ConferenceId conferenceId(conferenceAddress, conferenceAddress);
 	// Enquire whether this conference belongs to a server group chat room
@@ -102,9 +139,7 @@ Content LocalConferenceEventHandler::createNotifyFullState (LinphoneEvent * lev)
 	std::shared_ptr<AbstractChatRoom> chatRoom = core->findChatRoom (conferenceId);
 	const bool oneToOne = chatRoom ? !!(chatRoom->getCapabilities() & AbstractChatRoom::Capabilities::OneToOne) : false;
 	const bool ephemerable = chatRoom ? !!(chatRoom->getCapabilities() & AbstractChatRoom::Capabilities::Ephemeral) : false;
-	string entity = conferenceAddress.asString();
 	string subject = conf->getUtf8Subject();
-	ConferenceType confInfo = ConferenceType(entity);
 	ConferenceDescriptionType confDescr = ConferenceDescriptionType();
 	if (!subject.empty()) {
 		confDescr.setSubject(subject);
@@ -142,67 +177,153 @@ Content LocalConferenceEventHandler::createNotifyFullState (LinphoneEvent * lev)
 		confDescr.getAny().push_back(e);
 	}
 
-	confInfo.setConferenceDescription((const ConferenceDescriptionType) confDescr);
-
-	UsersType users;
-	confInfo.setUsers(users);
+	return confDescr;
+}
 
+list<shared_ptr<Participant>> LocalConferenceEventHandler::getFullStateParticipants () const {
 	std::list<std::shared_ptr<Participant>> participants(conf->getParticipants());
 
 	// Add local participant only if it is enabled
-	if (confParams.localParticipantEnabled() && conf->isIn()) {
+	if (conf->getCurrentParams().localParticipantEnabled() && conf->isIn()) {
 		std::shared_ptr<Participant> me = conf->getMe();
 		if (me) {
 			participants.push_front(me);
 		}
 	}
+	return participants;
+}
 
-	for (const auto &participant : participants) {
-		UserType user = UserType();
-		UserRolesType roles;
-		UserType::EndpointSequence endpoints;
-		user.setRoles(roles);
-		user.setEndpoint(endpoints);
-		user.setEntity(participant->getAddress().asString());
-		user.getRoles()->getEntry().push_back(participant->isAdmin() ? "admin" : "participant");
-		user.setState(StateType::full);
+UserType LocalConferenceEventHandler::createUserFullState (const shared_ptr<Participant> &participant) {
+	UserType user = UserType();
+	UserRolesType roles;
+	UserType::EndpointSequence endpoints;
+	user.setRoles(roles);
+	user.setEndpoint(endpoints);
+	user.setEntity(participant->getAddress().asString());
+	user.getRoles()->getEntry().push_back(participant->isAdmin() ? "admin" : "participant");
+	user.setState(StateType::full);
 
-		for (const auto &device : participant->getDevices()) {
-			const string &gruu = device->getAddress().asString();
-			EndpointType endpoint = EndpointType();
-			endpoint.setEntity(gruu);
-			const string &displayName = device->getName();
-			if (!displayName.empty())
-				endpoint.setDisplayText(displayName);
+	for (const auto &device : participant->getDevices()) {
+		const string &gruu = device->getAddress().asString();
+		EndpointType endpoint = EndpointType();
+		endpoint.setEntity(gruu);
+		const string &displayName = device->getName();
+		if (!displayName.empty())
+			endpoint.setDisplayText(displayName);
+
+		auto protocols = Utils::parseCapabilityDescriptor(device->getCapabilityDescriptor());
+		for (const auto & protocol : protocols) {
+			std::ostringstream versionStr;
+			versionStr << protocol.second;
+			const auto ephemeralService = ServiceDescription(protocol.first, versionStr.str());
+			auto & endpointDOMDoc = endpoint.getDomDocument();
+			::xercesc::DOMElement * e (endpointDOMDoc.createElementNS(::xsd::cxx::xml::string("linphone:xml:ns:conference-info-linphone-extension").c_str(), ::xsd::cxx::xml::string("linphone-cie:service-description").c_str()));
+			*e << ephemeralService;
+//			endpoint.setAnyAttribute(e);
+		}
 
-			auto protocols = Utils::parseCapabilityDescriptor(device->getCapabilityDescriptor());
-			for (const auto & protocol : protocols) {
-				std::ostringstream versionStr;
-				versionStr << protocol.second;
-				const auto ephemeralService = ServiceDescription(protocol.first, versionStr.str());
-				auto & endpointDOMDoc = endpoint.getDomDocument();
-				::xercesc::DOMElement * e (endpointDOMDoc.createElementNS(::xsd::cxx::xml::string("linphone:xml:ns:conference-info-linphone-extension").c_str(), ::xsd::cxx::xml::string("linphone-cie:service-description").c_str()));
-				*e << ephemeralService;
-//				endpoint.setAnyAttribute(e);
-			}
+		// Media capabilities
+		addMediaCapabilities(device, endpoint);
 
-			// Media capabilities
-			addMediaCapabilities(device, endpoint);
+		// Enpoint session info
+		addEndpointSessionInfo(device, endpoint);
 
-			// Enpoint session info
-			addEndpointSessionInfo(device, endpoint);
+		// Call ID
+		addEndpointCallInfo(device, endpoint);
 
-			// Call ID
-			addEndpointCallInfo(device, endpoint);
+		endpoint.setState(StateType::full);
 
-			endpoint.setState(StateType::full);
+		user.getEndpoint().push_back(endpoint);
+		fullStateDeviceSignatures[gruu] = getFullStateDeviceSignature(device);
+	}
 
-			user.getEndpoint().push_back(endpoint);
+	return user;
+}
+
+// Data of the device written in its endpoint by createUserFullState().
+string LocalConferenceEventHandler::getFullStateDeviceSignature (const shared_ptr<ParticipantDevice> &device) const {
+	ostringstream signature;
+	signature << device->getName() << '\n' << device->getCapabilityDescriptor() << '\n'
+		<< static_cast<int>(device->getState()) << ' ' << static_cast<int>(device->getJoiningMethod()) << ' ' << device->getTimeOfJoining() << '\n'
+		<< device->getCallId() << '\n' << device->getFromTag() << '\n' << device->getToTag() << '\n' << device->getLabel() << '\n';
+	for (const auto type : { LinphoneStreamTypeAudio, LinphoneStreamTypeVideo, LinphoneStreamTypeText })
+		signature << static_cast<int>(device->getStreamCapability(type)) << ' ' << device->getSsrc(type) << ' ';
+	return signature.str();
+}
+
+bool LocalConferenceEventHandler::hasFullStateDeviceChanged (const shared_ptr<ParticipantDevice> &device) const {
+	if (!fullStateConfInfo)
+		return true;
+	auto it = fullStateDeviceSignatures.find(device->getAddress().asString());
+	return (it == fullStateDeviceSignatures.end()) || (it->second != getFullStateDeviceSignature(device));
+}
+
+// Session data of the devices (call-id, tags, ssrc, label...) may be updated without any event reaching this handler:
+// the participants having a device that differs from the cached full state are built again.
+void LocalConferenceEventHandler::invalidateChangedFullStateDevices () {
+	if (!fullStateConfInfo)
+		return;
+	for (const auto &participant : getFullStateParticipants()) {
+		for (const auto &device : participant->getDevices()) {
+			if (hasFullStateDeviceChanged(device)) {
+				invalidateFullState(participant);
+				break;
+			}
 		}
+	}
+}
 
-		confInfo.getUsers()->getUser().push_back(user);
+void LocalConferenceEventHandler::updateFullStateConferenceInfo () {
+	if (!fullStateConfInfo) {
+		fullStateDeviceSignatures.clear();
+		fullStateConfInfo.reset(new ConferenceType(createConferenceInfoFullState()));
+		fullStateDirtyUsers.clear();
+		return;
+	}
+
+	// The conference description is cheap to build and depends on chat room parameters that are not always notified.
+	fullStateConfInfo->setConferenceDescription(createConferenceDescriptionFullState());
+
+	const auto participants = getFullStateParticipants();
+	auto &users = fullStateConfInfo->getUsers()->getUser();
+	for (const auto &entity : fullStateDirtyUsers) {
+		auto userIt = find_if(users.begin(), users.end(), [&entity] (const UserType &user) {
+			return user.getEntity().present() && (user.getEntity().get() == entity);
+		});
+		auto participantIt = find_if(participants.cbegin(), participants.cend(), [&entity] (const shared_ptr<Participant> &participant) {
+			return participant->getAddress().asString() == entity;
+		});
+		if (participantIt == participants.cend()) {
+			if (userIt != users.end())
+				users.erase(userIt);
+		} else if (userIt != users.end()) {
+			*userIt = createUserFullState(*participantIt);
+		} else {
+			users.push_back(createUserFullState(*participantIt));
+		}
 	}
-	return makeContent(createNotify(confInfo, true));
+	fullStateDirtyUsers.clear();
+
+	// Participants may come and go without any event reaching this handler (local participant joining, cached
+	// participants of a chat room being reloaded...): start again from scratch whenever the user lists disagree.
+	if (users.size() != participants.size()) {
+		lInfo() << "Full state of conference [" << conf->getConferenceAddress() << "] is out of sync with its participants, rebuilding it";
+		fullStateDeviceSignatures.clear();
+		fullStateConfInfo.reset(new ConferenceType(createConferenceInfoFullState()));
+	}
+}
+
+void LocalConferenceEventHandler::invalidateFullState (const shared_ptr<Participant> &participant) {
+	if (participant)
+		fullStateDirtyUsers.insert(participant->getAddress().asString());
+	fullStateContent = Content();
+}
+
+void LocalConferenceEventHandler::resetFullState () {
+	fullStateConfInfo.reset();
+	fullStateDeviceSignatures.clear();
+	fullStateDirtyUsers.clear();
+	fullStateContent = Content();
 }
 
 void LocalConferenceEventHandler::addAvailableMediaCapabilities(const LinphoneMediaDirection audioDirection, const LinphoneMediaDirection videoDirection, const LinphoneMediaDirection textDirection, ConferenceDescriptionType & confDescr) {
@@ -362,6 +483,30 @@ void LocalConferenceEventHandler::addMediaCapabilities(const std::shared_ptr<Par
 }
 
 Content LocalConferenceEventHandler::createNotifyMultipart (int notifyId) {
+	list<Content> contents;
+	if (!notifyHistory.empty() && (notifyId >= 0) && (static_cast<unsigned int>(notifyId) >= notifyHistoryFloor)) {
+		// Every NOTIFY sent after notifyId is still in memory, there is no need to rebuild them from the database.
+		for (const auto &notify : notifyHistory) {
+			if (notify.first > static_cast<unsigned int>(notifyId))
+				contents.emplace_back(makeContent(notify.second));
+		}
+	} else {
+		contents = createNotifyContentsFromDb(notifyId);
+	}
+
+	if (contents.empty())
+		return Content();
+
+	list<Content *> contentPtrs;
+	for (auto &content : contents)
+		contentPtrs.push_back(&content);
+	Content multipart = ContentManager::contentListToMultipart(contentPtrs);
+	if (linphone_core_content_encoding_supported(conf->getCore()->getCCore(), "deflate"))
+		multipart.setContentEncoding("deflate");
+	return multipart;
+}
+
+list<Content> LocalConferenceEventHandler::createNotifyContentsFromDb (int notifyId) {
 	list<shared_ptr<EventLog>> events = conf->getCore()->getPrivate()->mainDb->getConferenceNotifiedEvents(
 		ConferenceId(conf->getConferenceAddress(), conf->getConferenceAddress()),
 		static_cast<unsigned int>(notifyId)
@@ -471,17 +616,7 @@ Content LocalConferenceEventHandler::createNotifyMultipart (int notifyId) {
 		}
 		contents.emplace_back(makeContent(body));
 	}
-
-	if (contents.empty())
-		return Content();
-
-	list<Content *> contentPtrs;
-	for (auto &content : contents)
-		contentPtrs.push_back(&content);
-	Content multipart = ContentManager::contentListToMultipart(contentPtrs);
-	if (linphone_core_content_encoding_supported(conf->getCore()->getCCore(), "deflate"))
-		multipart.setContentEncoding("deflate");
-	return multipart;
+	return contents;
 }
 
 string LocalConferenceEventHandler::createNotifyParticipantAdded (const Address & pAddress) {
@@ -776,7 +911,7 @@ void LocalConferenceEventHandler::notifyResponseCb (const LinphoneEvent *ev) {
 
 // -----------------------------------------------------------------------------
 
-string LocalConferenceEventHandler::createNotify (ConferenceType confInfo, bool isFullState) {
+string LocalConferenceEventHandler::createNotify (ConferenceType &confInfo, bool isFullState) {
 	confInfo.setVersion(conf->getLastNotify());
 	confInfo.setState(isFullState ? StateType::full : StateType::partial);
 
@@ -999,7 +1134,7 @@ LinphoneStatus LocalConferenceEventHandler::subscribeReceived (LinphoneEvent *le
 			if (deviceState != ParticipantDevice::State::Present) {
 				// Notify everybody that a participant device has been added and its capabilities after receiving the SUBSCRIBE
 				const auto notify = createNotifyParticipantDeviceDataChanged(participant->getAddress().asAddress(), device->getAddress().asAddress());
-				notifyAllExceptDevice(makeContent(notify), device);
+				notifyAllExceptDevice(makeDeltaContent(notify), device);
 			}
 		} else if (evLastNotify < lastNotify) {
 			lInfo() << "Sending all missed notify [" << evLastNotify << "-" << lastNotify <<
@@ -1072,13 +1207,32 @@ Content LocalConferenceEventHandler::makeContent(const std::string & xml){
 	return content;
 }
 
+Content LocalConferenceEventHandler::makeDeltaContent (const std::string & xml) {
+	if (notifyHistorySize > 0) {
+		const unsigned int version = conf->getLastNotify();
+		// The version going backwards means that the conference has been reset: older bodies do not match anymore.
+		if (!notifyHistory.empty() && (version < notifyHistory.back().first))
+			notifyHistory.clear();
+		if (notifyHistory.empty())
+			notifyHistoryFloor = (version > 0) ? (version - 1) : 0;
+		notifyHistory.emplace_back(version, xml);
+		while (notifyHistory.size() > notifyHistorySize) {
+			notifyHistoryFloor = notifyHistory.front().first;
+			notifyHistory.pop_front();
+		}
+	}
+	return makeContent(xml);
+}
+
 void LocalConferenceEventHandler::onFullStateReceived () {
+	resetFullState();
 }
 
 void LocalConferenceEventHandler::onParticipantAdded (const std::shared_ptr<ConferenceParticipantEvent> &event, const std::shared_ptr<Participant> &participant) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
-		notifyAllExcept(makeContent(createNotifyParticipantAdded(participant->getAddress().asAddress())), participant);
+		invalidateFullState(participant);
+		notifyAllExcept(makeDeltaContent(createNotifyParticipantAdded(participant->getAddress().asAddress())), participant);
 		conf->updateParticipantsInConferenceInfo(participant->getAddress());
 
 		if (conf) {
@@ -1100,7 +1254,8 @@ void LocalConferenceEventHandler::onParticipantAdded (const std::shared_ptr<Conf
 void LocalConferenceEventHandler::onParticipantRemoved (const std::shared_ptr<ConferenceParticipantEvent> &event, const std::shared_ptr<Participant> &participant) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
-		notifyAllExcept(makeContent(createNotifyParticipantRemoved(participant->getAddress().asAddress())), participant);
+		invalidateFullState(participant);
+		notifyAllExcept(makeDeltaContent(createNotifyParticipantRemoved(participant->getAddress().asAddress())), participant);
 		if (conf) {
 			shared_ptr<Core> core = conf->getCore();
 			ConferenceAddress conferenceAddress = conf->getConferenceAddress();
@@ -1121,7 +1276,8 @@ void LocalConferenceEventHandler::onParticipantSetAdmin (const std::shared_ptr<C
 	const bool isAdmin = (event->getType() == EventLog::Type::ConferenceParticipantSetAdmin);
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
-		notifyAll(makeContent(createNotifyParticipantAdminStatusChanged(participant->getAddress().asAddress(), isAdmin)));
+		invalidateFullState(participant);
+		notifyAll(makeDeltaContent(createNotifyParticipantAdminStatusChanged(participant->getAddress().asAddress(), isAdmin)));
 		if (conf) {
 			shared_ptr<Core> core = conf->getCore();
 			ConferenceAddress conferenceAddress = conf->getConferenceAddress();
@@ -1141,7 +1297,8 @@ void LocalConferenceEventHandler::onParticipantSetAdmin (const std::shared_ptr<C
 void LocalConferenceEventHandler::onSubjectChanged (const std::shared_ptr<ConferenceSubjectEvent> &event) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
-		notifyAll(makeContent(createNotifySubjectChanged(event->getSubject())));
+		invalidateFullState();
+		notifyAll(makeDeltaContent(createNotifySubjectChanged(event->getSubject())));
 		if (conf) {
 			shared_ptr<Core> core = conf->getCore();
 			ConferenceAddress conferenceAddress = conf->getConferenceAddress();
@@ -1159,17 +1316,20 @@ void LocalConferenceEventHandler::onSubjectChanged (const std::shared_ptr<Confer
 }
 
 void LocalConferenceEventHandler::onParticipantDeviceIsSpeakingChanged (const std::shared_ptr<ParticipantDevice> &device, bool isSpeaking) {
-	
+	if (conf)
+		invalidateFullState(device->getParticipant());
 }
 
 void LocalConferenceEventHandler::onParticipantDeviceIsMuted (const std::shared_ptr<ParticipantDevice> &device, bool isMuted) {
-	
+	if (conf)
+		invalidateFullState(device->getParticipant());
 }
 
 void LocalConferenceEventHandler::onAvailableMediaChanged (const std::shared_ptr<ConferenceAvailableMediaEvent> &event) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
-		notifyAll(makeContent(createNotifyAvailableMediaChanged(event->getAvailableMediaType())));
+		invalidateFullState();
+		notifyAll(makeDeltaContent(createNotifyAvailableMediaChanged(event->getAvailableMediaType())));
 	} else {
 		lWarning() << __func__ << ": Not sending notification of conference subject change because pointer to conference is null";
 	}
@@ -1178,12 +1338,13 @@ void LocalConferenceEventHandler::onAvailableMediaChanged (const std::shared_ptr
 void LocalConferenceEventHandler::onParticipantDeviceAdded (const std::shared_ptr<ConferenceParticipantDeviceEvent> &event, const std::shared_ptr<ParticipantDevice> &device) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
+		invalidateFullState(device->getParticipant());
 		auto participant = device->getParticipant();
 		// If the ssrc is not 0, send a NOTIFY to the participant being added in order to give him its own SSRC
 		if ((device->getSsrc(LinphoneStreamTypeAudio) != 0) || (device->getSsrc(LinphoneStreamTypeVideo) != 0)) {
-			notifyAll(makeContent(createNotifyParticipantDeviceAdded(participant->getAddress().asAddress(), device->getAddress().asAddress())));
+			notifyAll(makeDeltaContent(createNotifyParticipantDeviceAdded(participant->getAddress().asAddress(), device->getAddress().asAddress())));
 		} else {
-			notifyAllExceptDevice(makeContent(createNotifyParticipantDeviceAdded(participant->getAddress().asAddress(), device->getAddress().asAddress())), device);
+			notifyAllExceptDevice(makeDeltaContent(createNotifyParticipantDeviceAdded(participant->getAddress().asAddress(), device->getAddress().asAddress())), device);
 		}
 		if (conf) {
 			shared_ptr<Core> core = conf->getCore();
@@ -1204,8 +1365,9 @@ void LocalConferenceEventHandler::onParticipantDeviceAdded (const std::shared_pt
 void LocalConferenceEventHandler::onParticipantDeviceRemoved (const std::shared_ptr<ConferenceParticipantDeviceEvent> &event, const std::shared_ptr<ParticipantDevice> &device) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
+		invalidateFullState(device->getParticipant());
 		auto participant = device->getParticipant();
-		notifyAllExceptDevice(makeContent(createNotifyParticipantDeviceRemoved(participant->getAddress().asAddress(), device->getAddress().asAddress())), device);
+		notifyAllExceptDevice(makeDeltaContent(createNotifyParticipantDeviceRemoved(participant->getAddress().asAddress(), device->getAddress().asAddress())), device);
 		if (conf) {
 			shared_ptr<Core> core = conf->getCore();
 			ConferenceAddress conferenceAddress = conf->getConferenceAddress();
@@ -1225,8 +1387,9 @@ void LocalConferenceEventHandler::onParticipantDeviceRemoved (const std::shared_
 void LocalConferenceEventHandler::onParticipantDeviceStateChanged (const std::shared_ptr<ConferenceParticipantDeviceEvent> &event, const std::shared_ptr<ParticipantDevice> &device) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
+		invalidateFullState(device->getParticipant());
 		auto participant = device->getParticipant();
-		notifyAll(makeContent(createNotifyParticipantDeviceDataChanged(participant->getAddress().asAddress(), device->getAddress().asAddress())));
+		notifyAll(makeDeltaContent(createNotifyParticipantDeviceDataChanged(participant->getAddress().asAddress(), device->getAddress().asAddress())));
 		if (conf) {
 			shared_ptr<Core> core = conf->getCore();
 			ConferenceAddress conferenceAddress = conf->getConferenceAddress();
@@ -1246,8 +1409,9 @@ void LocalConferenceEventHandler::onParticipantDeviceStateChanged (const std::sh
 void LocalConferenceEventHandler::onParticipantDeviceMediaCapabilityChanged (const std::shared_ptr<ConferenceParticipantDeviceEvent> &event, const std::shared_ptr<ParticipantDevice> &device) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
+		invalidateFullState(device->getParticipant());
 		auto participant = device->getParticipant();
-		notifyAll(makeContent(createNotifyParticipantDeviceDataChanged(participant->getAddress().asAddress(), device->getAddress().asAddress())));
+		notifyAll(makeDeltaContent(createNotifyParticipantDeviceDataChanged(participant->getAddress().asAddress(), device->getAddress().asAddress())));
 	} else {
 		lWarning() << __func__ << ": Not sending notification of participant device " << device->getAddress() << " being added because pointer to conference is null";
 	}
@@ -1256,7 +1420,8 @@ void LocalConferenceEventHandler::onParticipantDeviceMediaCapabilityChanged (con
 void LocalConferenceEventHandler::onEphemeralModeChanged (const std::shared_ptr<ConferenceEphemeralMessageEvent> &event) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
-		notifyAll(makeContent(createNotifyEphemeralMode(event->getType())));
+		invalidateFullState();
+		notifyAll(makeDeltaContent(createNotifyEphemeralMode(event->getType())));
 	} else {
 		lWarning() << __func__ << ": Not sending notification of ephemeral mode changed to " << event->getType();
 	}
@@ -1265,13 +1430,15 @@ void LocalConferenceEventHandler::onEphemeralModeChanged (const std::shared_ptr<
 void LocalConferenceEventHandler::onEphemeralLifetimeChanged (const std::shared_ptr<ConferenceEphemeralMessageEvent> &event) {
 	// Do not send notify if conference pointer is null. It may mean that the confernece has been terminated
 	if (conf) {
-		notifyAll(makeContent(createNotifyEphemeralLifetime(event->getEphemeralMessageLifetime())));
+		invalidateFullState();
+		notifyAll(makeDeltaContent(createNotifyEphemeralLifetime(event->getEphemeralMessageLifetime())));
 	} else {
 		lWarning() << __func__ << ": Not sending notification of ephemeral lifetime changed to " << event->getEphemeralMessageLifetime();
 	}
 }
 
 void LocalConferenceEventHandler::onStateChanged (LinphonePrivate::ConferenceInterface::State state) {
+	resetFullState();
 }
 
 void LocalConferenceEventHandler::onActiveSpeakerParticipantDevice(const std::shared_ptr<ParticipantDevice> &device) {
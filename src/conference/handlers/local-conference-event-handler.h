@@ -35,7 +35,11 @@
 #include "xml/conference-info.h"
 
 #include "content/content.h"
+#include <deque>
+#include <list>
+#include <map>
 #include <memory>
+#include <set>
 
 // =============================================================================
 
@@ -69,6 +73,8 @@ public:
 	void notifyAll (const Content &notify);
 	Content createNotifyFullState (LinphoneEvent * lev);
 	Content createNotifyMultipart (int notifyId);
+	// Number of full state documents serialized since the creation of the handler.
+	unsigned int getFullStateSerializationCount () const { return fullStateSerializationCount; }
 
 	// Conference
 	std::string createNotifyAvailableMediaChanged (const std::map<ConferenceMediaCapabilities, bool> mediaCapabilities);
@@ -197,11 +203,23 @@ protected:
 
 private:
 
-	std::string createNotify (Xsd::ConferenceInfo::ConferenceType confInfo, bool isFullState = false);
+	std::string createNotify (Xsd::ConferenceInfo::ConferenceType &confInfo, bool isFullState = false);
+	Xsd::ConferenceInfo::ConferenceType createConferenceInfoFullState ();
+	Xsd::ConferenceInfo::ConferenceDescriptionType createConferenceDescriptionFullState ();
+	Xsd::ConferenceInfo::UserType createUserFullState (const std::shared_ptr<Participant> &participant);
+	std::list<std::shared_ptr<Participant>> getFullStateParticipants () const;
+	void updateFullStateConferenceInfo ();
+	void invalidateFullState (const std::shared_ptr<Participant> &participant = nullptr);
+	void resetFullState ();
+	std::string getFullStateDeviceSignature (const std::shared_ptr<ParticipantDevice> &device) const;
+	bool hasFullStateDeviceChanged (const std::shared_ptr<ParticipantDevice> &device) const;
+	void invalidateChangedFullStateDevices ();
 	std::string createNotifySubjectChanged (const std::string &subject);
 	std::string createNotifyEphemeralLifetime (const long & lifetime);
 	std::string createNotifyEphemeralMode (const EventLog::Type & type);
 	Content makeContent(const std::string & xml);
+	Content makeDeltaContent (const std::string & xml);
+	std::list<Content> createNotifyContentsFromDb (int notifyId);
 	void notifyParticipant (const Content &notify, const std::shared_ptr<Participant> &participant);
 	void notifyParticipantDevice (const Content &notify, const std::shared_ptr<ParticipantDevice> &device);
 
@@ -212,6 +230,22 @@ private:
 	void addEndpointCallInfo(const std::shared_ptr<ParticipantDevice> & device, Xsd::ConferenceInfo::EndpointType & endpoint);
 	void addAvailableMediaCapabilities(const LinphoneMediaDirection audioDirection, const LinphoneMediaDirection videoDirection, const LinphoneMediaDirection textDirection, Xsd::ConferenceInfo::ConferenceDescriptionType & confDescr);
 
+	// Full state document kept between subscribes: users are patched when a participant or one of its devices changes,
+	// and the serialized body is shared by every subscriber asking for the same version.
+	std::unique_ptr<Xsd::ConferenceInfo::ConferenceType> fullStateConfInfo;
+	std::set<std::string> fullStateDirtyUsers;
+	// Signature of the data of each device endpoint in fullStateConfInfo, keyed by gruu.
+	std::map<std::string, std::string> fullStateDeviceSignatures;
+	Content fullStateContent;
+	unsigned int fullStateVersion = 0;
+	unsigned int fullStateSerializationCount = 0;
+
+	// Bodies of the last partial NOTIFYs sent, keyed by their version. They cover every version strictly above
+	// notifyHistoryFloor so that a device catching up from there does not require the events to be read again from database.
+	std::deque<std::pair<unsigned int, std::string>> notifyHistory;
+	size_t notifyHistorySize = 0;
+	unsigned int notifyHistoryFloor = 0;
+
 	L_DISABLE_COPY(LocalConferenceEventHandler);
 };
 
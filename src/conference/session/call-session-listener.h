@@ -42,6 +42,8 @@ public:
 	virtual void onCallSessionAccepting (const std::shared_ptr<CallSession> &session) {}
 	virtual bool onCallSessionAccepted (const std::shared_ptr<CallSession> &session) { return false; }
 	virtual void onCallSessionEarlyFailed (const std::shared_ptr<CallSession> &session, LinphoneErrorInfo *ei) {}
+	// The Call-ID or the addresses of the log of the session changed.
+	virtual void onCallSessionLogUpdated (const std::shared_ptr<CallSession> &session) {}
 	virtual void onCallSessionSetReleased (const std::shared_ptr<CallSession> &session) {}
 	virtual void onCallSessionSetTerminated (const std::shared_ptr<CallSession> &session) {}
 	virtual void onCallSessionStartReferred (const std::shared_ptr<CallSession> &session) {}
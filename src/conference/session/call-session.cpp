@@ -421,6 +421,8 @@ bool CallSessionPrivate::failure () {
 					lWarning() << "Redirecting CallSession [" << q << "] to " << url;
 					log->setToAddress(linphone_address_new(url));
 					ms_free(url);
+					if (listener)
+						listener->onCallSessionLogUpdated(q->getSharedFromThis());
 					restartInvite();
 					return true;
 				}
@@ -1269,6 +1271,8 @@ void CallSession::configure (LinphoneCallDir direction, LinphoneProxyConfig *cfg
 		d->log->setCallId(op->getCallId()); /* Must be known at that time */
 		getCore()->reportConferenceCallEvent(EventLog::Type::ConferenceCallStarted, d->log, nullptr);
 	}
+	if (d->listener)
+		d->listener->onCallSessionLogUpdated(getSharedFromThis());
 
 	if (direction == LinphoneCallOutgoing) {
 		if (d->params->getPrivate()->getReferer())
@@ -1287,6 +1291,8 @@ void CallSession::configure (LinphoneCallDir direction, const string &callid) {
 	// Keeping a valid address while following https://www.ietf.org/rfc/rfc3323.txt guidelines.
 	d->log = CallLog::create(getCore(), direction, linphone_address_new("Anonymous <sip:anonymous@anonymous.invalid>"), linphone_address_new("Anonymous <sip:anonymous@anonymous.invalid>"));
 	d->log->setCallId(callid);
+	if (d->listener)
+		d->listener->onCallSessionLogUpdated(getSharedFromThis());
 }
 
 bool CallSession::isOpConfigured () {
@@ -1524,6 +1530,8 @@ int CallSession::startInvite (const Address *destination, const string &subject,
 		}
 	} else {
 		d->log->setCallId(d->op->getCallId()); /* Must be known at that time */
+		if (d->listener)
+			d->listener->onCallSessionLogUpdated(getSharedFromThis());
 		d->setState(CallSession::State::OutgoingProgress, "Outgoing call in progress");
 		getCore()->reportConferenceCallEvent(EventLog::Type::ConferenceCallStarted, d->log, nullptr);
 	}
@@ -58,6 +58,10 @@ class ToneManager {
 	LinphoneStatus playLocal(const char *audiofile);
 	void startDtmfStream();
 	void stopDtmfStream();
+	/* Whether a ring, tone or DTMF stream is running, its filters being fed by linphone_core_iterate(). */
+	bool hasRingStream() const {
+		return mRingStream != nullptr;
+	}
 	
 	/* Used to temporarily override the audio output device. */
 	void setOutputDevice(const std::shared_ptr<CallSession> &session, AudioDevice *audioDevice);
@@ -1,7 +1,7 @@
 /*
  * Copyright (c) 2010-2022 Belledonne Communications SARL.
  *
- * This file is part of Liblinphone 
+ * This file is part of Liblinphone
  * (see https://gitlab.linphone.org/BC/public/liblinphone).
  *
  * This program is free software: you can redistribute it and/or modify
@@ -21,8 +21,14 @@
 #ifndef _L_LRU_CACHE_H_
 #define _L_LRU_CACHE_H_
 
-#include <list>
-#include <unordered_map>
+#include <cstdint>
+#include <cstring>
+#include <functional>
+#include <memory>
+#include <new>
+#include <string>
+#include <type_traits>
+#include <vector>
 
 #include "linphone/utils/general.h"
 
@@ -30,12 +36,49 @@
 
 LINPHONE_BEGIN_NAMESPACE
 
-template<typename Key, typename Value>
+template<typename Key>
+struct LruCacheHash : public std::hash<Key> {};
+
+// Strings are hashed from their characters: they can be looked up from a `const char *` without copy.
+template<>
+struct LruCacheHash<std::string> {
+	size_t operator() (const std::string &key) const {
+		return hash(key.data(), key.size());
+	}
+
+	size_t operator() (const char *key) const {
+		return hash(key, strlen(key));
+	}
+
+private:
+	// FNV-1a.
+	static size_t hash (const char *data, size_t size) {
+		uint64_t value = 14695981039346656037ULL;
+		for (size_t i = 0; i < size; ++i) {
+			value ^= static_cast<unsigned char>(data[i]);
+			value *= 1099511628211ULL;
+		}
+		return static_cast<size_t>(value);
+	}
+};
+
+// Nodes are allocated once, at construction, in a pool of `capacity` entries and are reused on eviction.
+// The key and the value of a node only live while it is in the cache: they are destroyed on erase and on eviction.
+// The index is an open addressing table (linear probing, load factor <= 0.5) of node indexes:
+// each operation hashes the key once and keys are only stored in nodes.
+template<typename Key, typename Value, typename Hash = LruCacheHash<Key>>
 class LruCache {
 public:
-	LruCache (int capacity = DefaultCapacity) : mCapacity(capacity) {
-		if (capacity < MinCapacity)
-			capacity = MinCapacity;
+	LruCache (int capacity = DefaultCapacity) : mCapacity(capacity < MinCapacity ? int(MinCapacity) : capacity) {
+		size_t bucketCount = 1;
+		while (bucketCount < size_t(mCapacity) * 2)
+			bucketCount <<= 1;
+		mBuckets.assign(bucketCount, int(Empty));
+		mNodes.reset(new Node[size_t(mCapacity)]);
+	}
+
+	~LruCache () {
+		clear();
 	}
 
 	int getCapacity () const {
@@ -43,66 +86,226 @@ public:
 	}
 
 	int getSize () const {
-		return int(mKeyToPair.size());
+		return mSize;
 	}
 
-	Value *operator[] (const Key &key) {
-		auto it = mKeyToPair.find(key);
-		return it == mKeyToPair.end() ? nullptr : &it->second.second;
+	// Number of entries removed to make room for new ones since the construction.
+	unsigned long long getEvictionCount () const {
+		return mEvictionCount;
 	}
 
-	const Value *operator[] (const Key &key) const {
-		auto it = mKeyToPair.find(key);
-		return it == mKeyToPair.cend() ? nullptr : &it->second.second;
+	// Returns the cached value and marks it as the most recently used.
+	template<typename LookupKey>
+	Value *operator[] (const LookupKey &key) {
+		int index = mBuckets[findSlot(key, Hash()(key))];
+		if (index == Empty)
+			return nullptr;
+
+		moveToFront(index);
+		return &mNodes[size_t(index)].entry().value;
 	}
 
-	void insert (const Key &key, const Value &value) {
-		auto it = mKeyToPair.find(key);
-		if (it != mKeyToPair.end()) {
-			mKeys.erase(it->second.first);
-			mKeyToPair.erase(it);
-		} else if (int(mKeyToPair.size()) == mCapacity) {
-			Key lastKey = mKeys.back();
-			mKeys.pop_back();
-			mKeyToPair.erase(lastKey);
-		}
+	template<typename LookupKey>
+	const Value *operator[] (const LookupKey &key) const {
+		int index = mBuckets[findSlot(key, Hash()(key))];
+		return index == Empty ? nullptr : &mNodes[size_t(index)].entry().value;
+	}
 
-		mKeys.push_front(key);
-		mKeyToPair.insert({ key, { mKeys.begin(), value } });
+	// If the construction of the entry throws, the cache is left unchanged except that a previous value of `key`
+	// is no longer cached.
+	void insert (const Key &key, const Value &value) {
+		emplace(key, value);
 	}
 
 	void insert (const Key &key, Value &&value) {
-		auto it = mKeyToPair.find(key);
-		if (it != mKeyToPair.end()) {
-			mKeys.erase(it->second.first);
-			mKeyToPair.erase(it);
-		} else if (int(mKeyToPair.size()) == mCapacity) {
-			Key lastKey = mKeys.back();
-			mKeys.pop_back();
-			mKeyToPair.erase(lastKey);
-		}
+		emplace(key, std::move(value));
+	}
+
+	template<typename LookupKey>
+	bool erase (const LookupKey &key) {
+		size_t slot = findSlot(key, Hash()(key));
+		int index = mBuckets[slot];
+		if (index == Empty)
+			return false;
 
-		mKeys.push_front(key);
-		mKeyToPair.insert({ key, std::make_pair(mKeys.begin(), std::move(value)) });
+		eraseNode(slot, index);
+		return true;
 	}
 
 	void clear () {
-		mKeyToPair.clear();
-		mKeys.clear();
+		for (int index = mHead; index != Empty; index = mNodes[size_t(index)].next)
+			mNodes[size_t(index)].destroyEntry();
+		mBuckets.assign(mBuckets.size(), int(Empty));
+		mHead = mTail = mFree = Empty;
+		mUsedNodeCount = 0;
+		mSize = 0;
 	}
 
 	static constexpr int MinCapacity = 10;
 	static constexpr int DefaultCapacity = 1000;
 
 private:
-	using Pair = std::pair<typename std::list<Key>::iterator, Value>;
+	static constexpr int Empty = -1;
+
+	struct Entry {
+		template<typename V>
+		Entry (const Key &_key, V &&_value) : key(_key), value(std::forward<V>(_value)) {}
+
+		Key key;
+		Value value;
+	};
+
+	struct Node {
+		Entry &entry () {
+			return *reinterpret_cast<Entry *>(&storage);
+		}
+
+		const Entry &entry () const {
+			return *reinterpret_cast<const Entry *>(&storage);
+		}
+
+		void destroyEntry () {
+			entry().~Entry();
+		}
+
+		typename std::aligned_storage<sizeof(Entry), alignof(Entry)>::type storage;
+		size_t hash = 0;
+		int previous = Empty;
+		int next = Empty;
+	};
+
+	template<typename V>
+	void emplace (const Key &key, V &&value) {
+		const size_t hash = Hash()(key);
+		size_t slot = findSlot(key, hash);
+		int index = mBuckets[slot];
+		if (index != Empty) {
+			// Values are not required to be assignable: the node is released and a new entry is built.
+			eraseNode(slot, index);
+		} else if (mFree == Empty && size_t(mUsedNodeCount) == size_t(mCapacity)) {
+			// Evict the least recently used node and reuse it.
+			eraseNode(findNodeSlot(mTail), mTail);
+			++mEvictionCount;
+		}
+
+		if (mFree != Empty) {
+			index = mFree;
+			mFree = mNodes[size_t(index)].next;
+		} else {
+			index = mUsedNodeCount++;
+		}
+
+		Node &node = mNodes[size_t(index)];
+		try {
+			new (&node.storage) Entry(key, std::forward<V>(value));
+		} catch (...) {
+			releaseNode(index);
+			throw;
+		}
+		node.hash = hash;
+
+		// An erased slot may have moved the probe sequence of the new key.
+		mBuckets[findSlot(key, hash)] = index;
+		pushFront(index);
+		++mSize;
+	}
+
+	void eraseNode (size_t slot, int index) {
+		eraseSlot(slot);
+		unlink(index);
+		mNodes[size_t(index)].destroyEntry();
+		releaseNode(index);
+		--mSize;
+	}
+
+	void releaseNode (int index) {
+		mNodes[size_t(index)].next = mFree;
+		mFree = index;
+	}
+
+	template<typename LookupKey>
+	size_t findSlot (const LookupKey &key, size_t hash) const {
+		const size_t mask = mBuckets.size() - 1;
+		for (size_t slot = hash & mask; ; slot = (slot + 1) & mask) {
+			int index = mBuckets[slot];
+			if (index == Empty)
+				return slot;
+
+			const Node &node = mNodes[size_t(index)];
+			if (node.hash == hash && node.entry().key == key)
+				return slot;
+		}
+	}
+
+	size_t findNodeSlot (int index) const {
+		const size_t mask = mBuckets.size() - 1;
+		size_t slot = mNodes[size_t(index)].hash & mask;
+		while (mBuckets[slot] != index)
+			slot = (slot + 1) & mask;
+		return slot;
+	}
+
+	// Backward shift deletion: no tombstones, probe sequences stay short.
+	void eraseSlot (size_t slot) {
+		const size_t mask = mBuckets.size() - 1;
+		size_t hole = slot;
+		for (size_t current = (slot + 1) & mask; mBuckets[current] != Empty; current = (current + 1) & mask) {
+			const size_t ideal = mNodes[size_t(mBuckets[current])].hash & mask;
+			if (((current - ideal) & mask) >= ((current - hole) & mask)) {
+				mBuckets[hole] = mBuckets[current];
+				hole = current;
+			}
+		}
+		mBuckets[hole] = Empty;
+	}
+
+	void unlink (int index) {
+		Node &node = mNodes[size_t(index)];
+		if (node.previous != Empty)
+			mNodes[size_t(node.previous)].next = node.next;
+		else
+			mHead = node.next;
+
+		if (node.next != Empty)
+			mNodes[size_t(node.next)].previous = node.previous;
+		else
+			mTail = node.previous;
+
+		node.previous = node.next = Empty;
+	}
+
+	void pushFront (int index) {
+		Node &node = mNodes[size_t(index)];
+		node.previous = Empty;
+		node.next = mHead;
+		if (mHead != Empty)
+			mNodes[size_t(mHead)].previous = index;
+		mHead = index;
+		if (mTail == Empty)
+			mTail = index;
+	}
+
+	void moveToFront (int index) {
+		if (index == mHead)
+			return;
+
+		unlink(index);
+		pushFront(index);
+	}
 
 	const int mCapacity;
+	int mSize = 0;
+	unsigned long long mEvictionCount = 0;
+
+	int mHead = Empty;
+	int mTail = Empty;
+	int mFree = Empty;
+	int mUsedNodeCount = 0;
+
+	std::unique_ptr<Node[]> mNodes;
+	std::vector<int> mBuckets;
 
-	// See: https://stackoverflow.com/questions/16781886/can-we-store-unordered-maptiterator
-	// Do not store iterator key.
-	std::list<Key> mKeys;
-	std::unordered_map<Key, Pair> mKeyToPair;
+	L_DISABLE_COPY(LruCache);
 };
 
 LINPHONE_END_NAMESPACE
@@ -0,0 +1,202 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_SHARDED_LRU_CACHE_H_
+#define _L_SHARDED_LRU_CACHE_H_
+
+#include <memory>
+#include <mutex>
+
+#include "lru-cache.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+struct ShardedLruCacheStats {
+	int size = 0;
+	int capacity = 0;
+	unsigned long long hits = 0;
+	unsigned long long misses = 0;
+	unsigned long long evictions = 0;
+};
+
+// Thread-safe LruCache: keys are dispatched on independent shards, each one protected by its own mutex.
+// Values are copied out of the cache, a returned value stays valid after a concurrent eviction.
+// A capacity of 0 disables the cache: lookups always miss and insertions are dropped.
+template<typename Key, typename Value, typename Hash = LruCacheHash<Key>>
+class ShardedLruCache {
+public:
+	using Stats = ShardedLruCacheStats;
+
+	ShardedLruCache (int capacity = LruCache<Key, Value, Hash>::DefaultCapacity, int shardCount = DefaultShardCount) :
+		mShardCount(shardCount < 1 ? 1 : shardCount),
+		mShards(new Shard[size_t(mShardCount)]) {
+		setCapacity(capacity);
+	}
+
+	// The configured capacity. The shards are rounded up to their minimum capacity, the stats give their actual sum.
+	int getCapacity () const {
+		std::lock_guard<std::mutex> lock(mCapacityMutex);
+		return mCapacity;
+	}
+
+	// Drops every cached entry if the capacity changes, the counters are kept.
+	void setCapacity (int capacity) {
+		if (capacity < 0)
+			capacity = 0;
+		std::lock_guard<std::mutex> capacityLock(mCapacityMutex);
+		if (capacity == mCapacity)
+			return;
+		mCapacity = capacity;
+
+		const int shardCapacity = capacity > 0 ? (capacity + mShardCount - 1) / mShardCount : 0;
+		for (int i = 0; i < mShardCount; ++i) {
+			Shard &shard = mShards[size_t(i)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.cache.reset(shardCapacity > 0 ? new LruCache<Key, Value, Hash>(shardCapacity) : nullptr);
+		}
+	}
+
+	int getSize () const {
+		int size = 0;
+		for (int i = 0; i < mShardCount; ++i) {
+			Shard &shard = mShards[size_t(i)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			if (shard.cache)
+				size += shard.cache->getSize();
+		}
+		return size;
+	}
+
+	Stats getStats () const {
+		Stats stats;
+		for (int i = 0; i < mShardCount; ++i) {
+			Shard &shard = mShards[size_t(i)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			stats.hits += shard.hits;
+			stats.misses += shard.misses;
+			stats.evictions += shard.evictions;
+			if (shard.cache) {
+				stats.size += shard.cache->getSize();
+				stats.capacity += shard.cache->getCapacity();
+			}
+		}
+		return stats;
+	}
+
+	void resetStats () {
+		for (int i = 0; i < mShardCount; ++i) {
+			Shard &shard = mShards[size_t(i)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			shard.hits = shard.misses = shard.evictions = 0;
+		}
+	}
+
+	template<typename LookupKey>
+	bool get (const LookupKey &key, Value &value) {
+		return visit(key, [&value] (const Value &cached) { value = cached; });
+	}
+
+	// Calls `function` with the cached value while the shard is locked: the value can be used without copying it.
+	template<typename LookupKey, typename Function>
+	bool visit (const LookupKey &key, Function &&function) {
+		Shard &shard = getShard(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		const Value *cached = shard.cache ? (*shard.cache)[key] : nullptr;
+		if (!cached) {
+			++shard.misses;
+			return false;
+		}
+
+		++shard.hits;
+		function(*cached);
+		return true;
+	}
+
+	void insert (const Key &key, const Value &value) {
+		Shard &shard = getShard(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (!shard.cache)
+			return;
+
+		const unsigned long long evictions = shard.cache->getEvictionCount();
+		shard.cache->insert(key, value);
+		shard.evictions += shard.cache->getEvictionCount() - evictions;
+	}
+
+	void insert (const Key &key, Value &&value) {
+		Shard &shard = getShard(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		if (!shard.cache)
+			return;
+
+		const unsigned long long evictions = shard.cache->getEvictionCount();
+		shard.cache->insert(key, std::move(value));
+		shard.evictions += shard.cache->getEvictionCount() - evictions;
+	}
+
+	template<typename LookupKey>
+	bool erase (const LookupKey &key) {
+		Shard &shard = getShard(key);
+		std::lock_guard<std::mutex> lock(shard.mutex);
+		return shard.cache ? shard.cache->erase(key) : false;
+	}
+
+	void clear () {
+		for (int i = 0; i < mShardCount; ++i) {
+			Shard &shard = mShards[size_t(i)];
+			std::lock_guard<std::mutex> lock(shard.mutex);
+			if (shard.cache)
+				shard.cache->clear();
+		}
+	}
+
+	static constexpr int DefaultShardCount = 8;
+
+private:
+	struct Shard {
+		mutable std::mutex mutex;
+		std::unique_ptr<LruCache<Key, Value, Hash>> cache;
+		unsigned long long hits = 0;
+		unsigned long long misses = 0;
+		unsigned long long evictions = 0;
+	};
+
+	template<typename LookupKey>
+	Shard &getShard (const LookupKey &key) const {
+		// Fold the high bits: the low ones also select the bucket inside the shard.
+		const size_t hash = Hash()(key);
+		return mShards[size_t(((hash >> 16) ^ hash) % size_t(mShardCount))];
+	}
+
+	const int mShardCount;
+	std::unique_ptr<Shard[]> mShards;
+
+	mutable std::mutex mCapacityMutex;
+	// Not set until the constructor creates the shards.
+	int mCapacity = -1;
+
+	L_DISABLE_COPY(ShardedLruCache);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_SHARDED_LRU_CACHE_H_
@@ -57,4 +57,9 @@ shared_ptr<Core> CoreAccessor::getCore () const {
 	return core;
 }
 
+shared_ptr<Core> CoreAccessor::tryGetCore () const {
+	L_D();
+	return d->core.lock();
+}
+
 LINPHONE_END_NAMESPACE
@@ -39,6 +39,9 @@ public:
 	// Returns a valid core instance. Or throw one std::bad_weak_ptr exception if core is destroyed.
 	std::shared_ptr<Core> getCore () const;
 
+	// Returns the core instance, or nullptr if core is destroyed.
+	std::shared_ptr<Core> tryGetCore () const;
+
 private:
 	CoreAccessorPrivate *mPrivate = nullptr;
 
@@ -40,6 +40,21 @@ using namespace std;
 
 LINPHONE_BEGIN_NAMESPACE
 
+// Address::weakEqual() compares username, domain and port: the first two make the index key.
+static string getCallIndexKey (const Address &address) {
+	return address.getUsername() + "@" + address.getDomain();
+}
+
+static void eraseFromCallIndex (unordered_multimap<string, shared_ptr<Call>> &index, const string &key, const shared_ptr<Call> &call) {
+	auto range = index.equal_range(key);
+	for (auto it = range.first; it != range.second; it++) {
+		if (it->second == call) {
+			index.erase(it);
+			return;
+		}
+	}
+}
+
 int CorePrivate::addCall (const shared_ptr<Call> &call) {
 	L_Q();
 	L_ASSERT(call);
@@ -64,6 +79,9 @@ int CorePrivate::addCall (const shared_ptr<Call> &call) {
 		linphone_core_stop_dtmf_stream(q->getCCore());
 	}
 	calls.push_back(call);
+	indexCall(call);
+	// Calls need linphone_core_iterate() to run periodically.
+	linphone_core_wake_up_iterate(q->getCCore());
 
 	linphone_core_notify_call_created(q->getCCore(), call->toC());
 	return 0;
@@ -97,7 +115,9 @@ bool CorePrivate::inviteReplacesABrokenCall (SalCallOp *op) {
 }
 
 bool CorePrivate::isAlreadyInCallWithAddress (const Address &addr) const {
-	for (const auto &call : calls) {
+	auto range = callsByRemoteAddress.equal_range(getCallIndexKey(addr));
+	for (auto it = range.first; it != range.second; it++) {
+		const auto &call = it->second;
 		if (call->isOpConfigured() && call->getRemoteAddress()->weakEqual(addr))
 			return true;
 	}
@@ -105,11 +125,59 @@ bool CorePrivate::isAlreadyInCallWithAddress (const Address &addr) const {
 }
 
 void CorePrivate::iterateCalls (time_t currentRealTime, bool oneSecondElapsed) const {
-	// Make a copy of the list af calls because it may be altered during calls to the Call::iterate method
-	list<shared_ptr<Call>> savedCalls(calls);
-	for (const auto &call : savedCalls) {
+	if (iteratingCalls) {
+		// Iteration requested from a call being iterated: the cursor is in use, work on a copy.
+		list<shared_ptr<Call>> savedCalls(calls);
+		for (const auto &call : savedCalls) {
+			call->iterate(currentRealTime, oneSecondElapsed);
+		}
+		return;
+	}
+
+	// The list of calls may be altered during calls to the Call::iterate method: removeCall() moves the
+	// cursor past a removed call, and calls added meanwhile are appended, so they are iterated too.
+	iteratingCalls = true;
+	for (auto it = calls.cbegin(); it != calls.cend(); it = nextCallToIterate) {
+		nextCallToIterate = next(it);
+		shared_ptr<Call> call = *it; // Keeps the call alive if it removes itself.
 		call->iterate(currentRealTime, oneSecondElapsed);
 	}
+	iteratingCalls = false;
+}
+
+void CorePrivate::indexCall (const shared_ptr<Call> &call) {
+	auto &keys = callIndexKeys[call.get()];
+	const auto &log = call->getLog();
+	if (log && !log->getCallId().empty()) {
+		keys.first = log->getCallId();
+		callsByCallId.emplace(keys.first, call);
+	}
+	const Address *remoteAddress = call->getRemoteAddress();
+	if (remoteAddress) {
+		keys.second = getCallIndexKey(*remoteAddress);
+		callsByRemoteAddress.emplace(keys.second, call);
+	}
+}
+
+// The call is erased with the keys it was indexed with, its log may have changed since.
+void CorePrivate::unindexCall (const shared_ptr<Call> &call) {
+	auto it = callIndexKeys.find(call.get());
+	if (it == callIndexKeys.end())
+		return;
+	if (!it->second.first.empty())
+		eraseFromCallIndex(callsByCallId, it->second.first, call);
+	if (!it->second.second.empty())
+		eraseFromCallIndex(callsByRemoteAddress, it->second.second, call);
+	callIndexKeys.erase(it);
+}
+
+void CorePrivate::reindexCall (Call *call) {
+	// Calls that are not attached to the core yet, or no longer, are not indexed.
+	if (callIndexKeys.find(call) == callIndexKeys.end())
+		return;
+	shared_ptr<Call> indexedCall = call->getSharedFromThis();
+	unindexCall(indexedCall);
+	indexCall(indexedCall);
 }
 
 void CorePrivate::notifySoundcardUsage (bool used) {
@@ -142,6 +210,9 @@ int CorePrivate::removeCall (const shared_ptr<Call> &call) {
 	}
 	lInfo() << "Removing the call (local address " << call->getLocalAddress().asString() << " remote address " << (call->getRemoteAddress() ? call->getRemoteAddress()->asString() : "Unknown") << ") from the list attached to the core";
 
+	if (iteratingCalls && nextCallToIterate == iter)
+		nextCallToIterate = next(iter);
+	unindexCall(call);
 	calls.erase(iter);
 	return 0;
 }
@@ -236,11 +307,21 @@ bool Core::areSoundResourcesLocked () const {
 
 shared_ptr<Call> Core::getCallByRemoteAddress (const Address &addr) const {
 	L_D();
-	for (const auto &call : d->calls) {
-		if (call->getRemoteAddress()->weakEqual(addr))
-			return call;
+	shared_ptr<Call> found;
+	auto range = d->callsByRemoteAddress.equal_range(getCallIndexKey(addr));
+	for (auto it = range.first; it != range.second; it++) {
+		if (!it->second->getRemoteAddress()->weakEqual(addr))
+			continue;
+		if (found) {
+			// Several calls with this remote address: return the first one of the list, as before.
+			for (const auto &call : d->calls) {
+				if (call->getRemoteAddress()->weakEqual(addr))
+					return call;
+			}
+		}
+		found = it->second;
 	}
-	return nullptr;
+	return found;
 }
 
 shared_ptr<Call> Core::getCallByCallId (const string &callId) const {
@@ -249,8 +330,15 @@ shared_ptr<Call> Core::getCallByCallId (const string &callId) const {
 		return nullptr;
 	}
 
+	auto range = d->callsByCallId.equal_range(callId);
+	if (range.first == range.second)
+		return nullptr;
+	if (next(range.first) == range.second)
+		return range.first->second;
+
+	// Several calls share this Call-ID: return the first one of the list, as before.
 	for (const auto &call : d->calls) {
-		if (!call->getLog()->getCallId().empty() && call->getLog()->getCallId() == callId) {
+		if (call->getLog()->getCallId() == callId) {
 			return call;
 		}
 	}
@@ -18,6 +18,7 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
 #include <iterator>
 
 #include "linphone/utils/algorithm.h"
@@ -28,6 +29,7 @@
 #include "chat/chat-room/chat-room-p.h"
 #include "conference/participant.h"
 #include "core-p.h"
+#include "event-log/events.h"
 #include "logger/logger.h"
 
 #ifdef HAVE_ADVANCED_IM
@@ -108,6 +110,25 @@ IdentityAddress CorePrivate::getIdentityAddressWithGruu(const IdentityAddress &i
 	return identityAddressWithGruu;
 }
 
+// Username and domain are what IdentityAddress comparisons look at once the gruu is removed.
+static string getChatRoomIndexKey (const IdentityAddress &address) {
+	return address.getUsername() + "@" + address.getDomain();
+}
+
+static string getOneToOneChatRoomIndexKey (const IdentityAddress &localAddress, const IdentityAddress &participantAddress) {
+	return getChatRoomIndexKey(localAddress) + " " + getChatRoomIndexKey(participantAddress);
+}
+
+static string getOneToOneChatRoomIndexKey (const shared_ptr<AbstractChatRoom> &chatRoom) {
+	if (chatRoom->getCapabilities() & ChatRoom::Capabilities::Basic)
+		return getOneToOneChatRoomIndexKey(chatRoom->getLocalAddress(), chatRoom->getPeerAddress());
+
+	const auto &participants = chatRoom->getParticipants();
+	if (participants.empty())
+		return string();
+	return getOneToOneChatRoomIndexKey(chatRoom->getLocalAddress(), participants.front()->getAddress());
+}
+
 // -----------------------------------------------------------------------------
 
 //Base client group chat room creator
@@ -236,36 +257,35 @@ shared_ptr<AbstractChatRoom> CorePrivate::createBasicChatRoom (
 }
 
 shared_ptr<AbstractChatRoom> CorePrivate::searchChatRoom (const shared_ptr<ChatRoomParams> &params, const IdentityAddress &localAddress, const IdentityAddress &remoteAddress, const std::list<IdentityAddress> &participants) const {
-	for (auto it = chatRoomsById.begin(); it != chatRoomsById.end(); it++) {
-		const auto &chatRoom = it->second;
+	const_cast<CorePrivate *>(this)->loadLazyChatRooms();
+	auto matches = [&](const shared_ptr<AbstractChatRoom> &chatRoom) {
 		const IdentityAddress &curLocalAddress = chatRoom->getLocalAddress();
 		const IdentityAddress &curRemoteAddress = chatRoom->getPeerAddress();
 		ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
 
 		if (params) {
 			if (params->getChatRoomBackend() != chatRoom->getCurrentParams()->getChatRoomBackend())
-				continue;
+				return false;
 
 			if (!params->isGroup() && !(capabilities & ChatRoom::Capabilities::OneToOne))
-				continue;
+				return false;
 
 			if (params->isGroup() && !(capabilities & ChatRoom::Capabilities::Conference))
-				continue;
+				return false;
 
 			if (params->isEncrypted() != bool(capabilities & ChatRoom::Capabilities::Encrypted))
-				continue;
+				return false;
 
 			if (!params->getSubject().empty() && params->getSubject() != chatRoom->getSubject())
-				continue;
+				return false;
 		}
 
 		if (localAddress.getAddressWithoutGruu() != curLocalAddress.getAddressWithoutGruu())
-			continue;
+			return false;
 
 		if (remoteAddress.isValid() && remoteAddress.getAddressWithoutGruu() != curRemoteAddress.getAddressWithoutGruu())
-			continue;
+			return false;
 
-		bool allFound = true;
 		for (const auto &participant : participants) {
 			bool found = false;
 			for (const auto &p : chatRoom->getParticipants()) {
@@ -274,16 +294,20 @@ shared_ptr<AbstractChatRoom> CorePrivate::searchChatRoom (const shared_ptr<ChatR
 					break;
 				}
 			}
-			if (!found) {
-				allFound = false;
-				break;
-			}
+			if (!found)
+				return false;
 		}
-		if (!allFound) continue;
+		return true;
+	};
 
-		return chatRoom;
+	// Look into the narrowest index the criteria allow.
+	if (remoteAddress.isValid())
+		return findIndexedChatRoom(chatRoomsByPeerAddress, getChatRoomIndexKey(remoteAddress), matches);
+	if (params && !params->isGroup() && participants.size() == 1) {
+		const_cast<CorePrivate *>(this)->indexPendingOneToOneChatRooms();
+		return findIndexedChatRoom(oneToOneChatRoomsByParticipant, getOneToOneChatRoomIndexKey(localAddress, participants.front()), matches);
 	}
-	return nullptr;
+	return findIndexedChatRoom(chatRoomsByLocalAddress, getChatRoomIndexKey(localAddress), matches);
 }
 
 shared_ptr<AbstractChatRoom> CorePrivate::createChatRoom(const shared_ptr<ChatRoomParams> &params, const IdentityAddress &localAddr, const std::string &subject, const std::list<IdentityAddress> &participants) {
@@ -424,6 +448,7 @@ void CorePrivate::insertChatRoom (const shared_ptr<AbstractChatRoom> &chatRoom)
 			lInfo() << "Insert chat room " << conferenceId << " to core map";
 		}
 		chatRoomsById[conferenceId] = chatRoom;
+		indexChatRoom(conferenceId, chatRoom);
 	}
 }
 
@@ -434,95 +459,276 @@ void CorePrivate::insertChatRoomWithDb (const shared_ptr<AbstractChatRoom> &chat
 
 void CorePrivate::loadChatRooms () {
 	chatRoomsById.clear();
+	clearChatRoomIndexes();
+	lazyChatRooms.clear();
 #ifdef HAVE_ADVANCED_IM
 	if (remoteListEventHandler)
 		remoteListEventHandler->clearHandlers();
 #endif
 
 	if (!mainDb->isInitialized()) return;
-	for (auto &chatRoom : mainDb->getChatRooms()) {
-		insertChatRoom(chatRoom);
+	if (!!linphone_config_get_int(linphone_core_get_config(getCCore()), "misc", "chat_rooms_lazy_loading", 0)) {
+		for (auto &descriptor : mainDb->getChatRoomDescriptors())
+			lazyChatRooms.insert({ descriptor.conferenceId, move(descriptor) });
+
+		// Client group chat rooms that were not left subscribe to their conference when they are created,
+		// they can't wait for an access.
+		bool conferenceServer = !!linphone_core_conference_server_enabled(getCCore());
+		loadLazyChatRooms([conferenceServer](const MainDb::ChatRoomDescriptor &descriptor) {
+			return !conferenceServer
+				&& (descriptor.capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::Conference))
+				&& !descriptor.hasBeenLeft;
+		});
+		lInfo() << "Chat rooms lazy loading: " << chatRoomsById.size() << " loaded, " << lazyChatRooms.size() << " pending.";
+	} else {
+		for (auto &chatRoom : mainDb->getChatRooms()) {
+			insertChatRoom(chatRoom);
+		}
 	}
 	sendDeliveryNotifications();
 }
 
+shared_ptr<AbstractChatRoom> CorePrivate::loadLazyChatRoom (const ConferenceId &conferenceId) {
+	auto it = lazyChatRooms.find(conferenceId);
+	if (it == lazyChatRooms.end())
+		return nullptr;
+
+	lazyChatRooms.erase(it);
+	shared_ptr<AbstractChatRoom> chatRoom = mainDb->getChatRoom(conferenceId);
+	if (chatRoom)
+		insertChatRoom(chatRoom);
+	return chatRoom;
+}
+
+void CorePrivate::loadLazyChatRooms (const function<bool (const MainDb::ChatRoomDescriptor &)> &filter) {
+	if (lazyChatRooms.empty())
+		return;
+
+	if (!filter) {
+		lazyChatRooms.clear();
+		for (auto &chatRoom : mainDb->getChatRooms()) {
+			if (chatRoomsById.find(chatRoom->getConferenceId()) == chatRoomsById.end())
+				insertChatRoom(chatRoom);
+		}
+		return;
+	}
+
+	list<ConferenceId> conferenceIds;
+	for (const auto &entry : lazyChatRooms) {
+		if (filter(entry.second))
+			conferenceIds.push_back(entry.first);
+	}
+	for (const auto &conferenceId : conferenceIds)
+		loadLazyChatRoom(conferenceId);
+}
+
+// Chat rooms read from the database use their current conference id: previous ids don't need to be checked.
+shared_ptr<AbstractChatRoom> CorePrivate::findLoadedChatRoom (const ConferenceId &conferenceId) const {
+	auto it = chatRoomsById.find(conferenceId);
+	return it == chatRoomsById.cend() ? nullptr : it->second;
+}
+
+void CorePrivate::indexChatRoom (const ConferenceId &conferenceId, const shared_ptr<AbstractChatRoom> &chatRoom) {
+	unindexChatRoom(conferenceId);
+
+	ChatRoomIndexKeys &keys = chatRoomIndexKeys[conferenceId];
+	keys.peer = getChatRoomIndexKey(chatRoom->getPeerAddress());
+	keys.local = getChatRoomIndexKey(chatRoom->getLocalAddress());
+	chatRoomsByPeerAddress[keys.peer].insert(conferenceId);
+	chatRoomsByLocalAddress[keys.local].insert(conferenceId);
+
+	if (chatRoom->getCapabilities() & ChatRoom::Capabilities::OneToOne) {
+		keys.oneToOne = getOneToOneChatRoomIndexKey(chatRoom);
+		if (keys.oneToOne.empty())
+			pendingOneToOneChatRooms.insert(conferenceId);
+		else
+			oneToOneChatRoomsByParticipant[keys.oneToOne].insert(conferenceId);
+	}
+}
+
+void CorePrivate::unindexChatRoom (const ConferenceId &conferenceId) {
+	auto it = chatRoomIndexKeys.find(conferenceId);
+	if (it == chatRoomIndexKeys.end())
+		return;
+
+	removeFromChatRoomIndex(chatRoomsByPeerAddress, it->second.peer, conferenceId);
+	removeFromChatRoomIndex(chatRoomsByLocalAddress, it->second.local, conferenceId);
+	if (!it->second.oneToOne.empty())
+		removeFromChatRoomIndex(oneToOneChatRoomsByParticipant, it->second.oneToOne, conferenceId);
+	pendingOneToOneChatRooms.erase(conferenceId);
+	chatRoomIndexKeys.erase(it);
+}
+
+void CorePrivate::clearChatRoomIndexes () {
+	chatRoomIndexKeys.clear();
+	chatRoomsByPeerAddress.clear();
+	chatRoomsByLocalAddress.clear();
+	oneToOneChatRoomsByParticipant.clear();
+	pendingOneToOneChatRooms.clear();
+}
+
+// The participant of a one to one client group chat room may only be known once it is inserted.
+// It doesn't change afterwards, so these chat rooms are indexed as soon as it is.
+void CorePrivate::indexPendingOneToOneChatRooms () {
+	for (auto it = pendingOneToOneChatRooms.begin(); it != pendingOneToOneChatRooms.end();) {
+		auto chatRoomIt = chatRoomsById.find(*it);
+		string key = chatRoomIt == chatRoomsById.end() ? string() : getOneToOneChatRoomIndexKey(chatRoomIt->second);
+		if (key.empty()) {
+			it++;
+			continue;
+		}
+		chatRoomIndexKeys[*it].oneToOne = key;
+		oneToOneChatRoomsByParticipant[key].insert(*it);
+		it = pendingOneToOneChatRooms.erase(it);
+	}
+}
+
+shared_ptr<AbstractChatRoom> CorePrivate::findIndexedChatRoom (
+	const ChatRoomIndex &index,
+	const string &key,
+	const function<bool (const shared_ptr<AbstractChatRoom> &)> &predicate
+) const {
+	auto it = index.find(key);
+	if (it == index.cend())
+		return nullptr;
+
+	for (const auto &conferenceId : it->second) {
+		auto chatRoomIt = chatRoomsById.find(conferenceId);
+		if (chatRoomIt != chatRoomsById.cend() && predicate(chatRoomIt->second))
+			return chatRoomIt->second;
+	}
+	return nullptr;
+}
+
+void CorePrivate::removeFromChatRoomIndex (ChatRoomIndex &index, const string &key, const ConferenceId &conferenceId) {
+	auto it = index.find(key);
+	if (it == index.end())
+		return;
+
+	it->second.erase(conferenceId);
+	if (it->second.empty())
+		index.erase(it);
+}
+
+bool CorePrivate::ephemeralMessageExpiresLater (const EphemeralMessage &a, const EphemeralMessage &b) {
+	return a.expireTime > b.expireTime;
+}
+
 void CorePrivate::handleEphemeralMessages (time_t currentTime) {
-	if (!ephemeralMessages.empty()) {
-		shared_ptr<ChatMessage> msg = ephemeralMessages.front();
-		time_t expireTime = msg->getEphemeralExpireTime();
-		if (currentTime > expireTime) {
-			shared_ptr<LinphonePrivate::EventLog> event = LinphonePrivate::MainDb::getEvent(mainDb, msg->getStorageId());
-			shared_ptr<AbstractChatRoom> chatRoom = msg->getChatRoom();
-			if (chatRoom && event) {
-				LinphonePrivate::EventLog::deleteFromDatabase(event);
-				lInfo() << "[Ephemeral] Message deleted from database";
-				
-				// Notify ephemeral message deleted to message if exists.
-				LinphoneChatMessage *message = L_GET_C_BACK_PTR(msg.get());
-				if (message) {
-					LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(message);
-					if (cbs && linphone_chat_message_cbs_get_ephemeral_message_deleted(cbs)) {
-						linphone_chat_message_cbs_get_ephemeral_message_deleted(cbs)(message);
-					}
-					_linphone_chat_message_notify_ephemeral_message_deleted(message);
-				}
+	while (true) {
+		list<shared_ptr<EventLog>> expiredEvents;
+		while (!ephemeralMessages.empty() && currentTime > ephemeralMessages.front().expireTime) {
+			pop_heap(ephemeralMessages.begin(), ephemeralMessages.end(), ephemeralMessageExpiresLater);
+			expiredEvents.push_back(move(ephemeralMessages.back().event));
+			ephemeralMessages.pop_back();
+		}
+		bool deleted = deleteEphemeralMessages(expiredEvents);
 
-				// Notify ephemeral message deleted to chat room & core.
-				LinphoneChatRoom *cr = L_GET_C_BACK_PTR(chatRoom);
-				_linphone_chat_room_notify_ephemeral_message_deleted(cr, L_GET_C_BACK_PTR(event));
-				linphone_core_notify_chat_room_ephemeral_message_deleted(linphone_chat_room_get_core(cr), cr);
+		// Go on with the next page of database when this one is done, the expired messages are not in database anymore.
+		if (ephemeralMessages.empty() && ephemeralMessagesHorizon != numeric_limits<time_t>::max() && deleted && loadEphemeralMessages())
+			continue;
 
-			}
+		if (!ephemeralMessages.empty())
+			startEphemeralMessageTimer(ephemeralMessages.front().expireTime);
+		return;
+	}
+}
 
-			// Delete message from this list even when chatroom is gone.
-			ephemeralMessages.pop_front();
-			handleEphemeralMessages(currentTime);
-		} else {
-			startEphemeralMessageTimer(expireTime);
+bool CorePrivate::deleteEphemeralMessages (const list<shared_ptr<EventLog>> &events) {
+	// Messages whose chat room is gone are deleted from database too, only the notifications are skipped for them.
+	if (events.empty() || !mainDb->deleteEvents(events))
+		return false;
+
+	lInfo() << "[Ephemeral] " << events.size() << " message(s) deleted from database";
+
+	for (const auto &event : events) {
+		shared_ptr<ChatMessage> msg = static_pointer_cast<ConferenceChatMessageEvent>(event)->getChatMessage();
+		shared_ptr<AbstractChatRoom> chatRoom = msg->getChatRoom();
+		if (!chatRoom)
+			continue;
+
+		// Notify ephemeral message deleted to message if exists.
+		LinphoneChatMessage *message = L_GET_C_BACK_PTR(msg.get());
+		if (message) {
+			LinphoneChatMessageCbs *cbs = linphone_chat_message_get_callbacks(message);
+			if (cbs && linphone_chat_message_cbs_get_ephemeral_message_deleted(cbs)) {
+				linphone_chat_message_cbs_get_ephemeral_message_deleted(cbs)(message);
+			}
+			_linphone_chat_message_notify_ephemeral_message_deleted(message);
 		}
-	} else {
-		initEphemeralMessages();
+
+		// Notify ephemeral message deleted to chat room & core.
+		LinphoneChatRoom *cr = L_GET_C_BACK_PTR(chatRoom);
+		_linphone_chat_room_notify_ephemeral_message_deleted(cr, L_GET_C_BACK_PTR(event));
+		linphone_core_notify_chat_room_ephemeral_message_deleted(linphone_chat_room_get_core(cr), cr);
 	}
+	return true;
+}
+
+bool CorePrivate::loadEphemeralMessages () {
+	ephemeralMessages.clear();
+	ephemeralMessagesHorizon = numeric_limits<time_t>::max();
+	if (!mainDb || !mainDb->isInitialized())
+		return false;
+
+	list<shared_ptr<EventLog>> events = mainDb->getEphemeralMessageEvents(EPHEMERAL_MESSAGE_TASKS_MAX_NB);
+	ephemeralMessages.reserve(events.size());
+	for (const auto &event : events) {
+		time_t expireTime = static_pointer_cast<ConferenceChatMessageEvent>(event)->getChatMessage()->getEphemeralExpireTime();
+		ephemeralMessages.push_back({ expireTime, event });
+	}
+	make_heap(ephemeralMessages.begin(), ephemeralMessages.end(), ephemeralMessageExpiresLater);
+
+	// A full page means later messages may remain in database. The page is sorted, its last message expires the latest.
+	if (!events.empty() && events.size() >= size_t(EPHEMERAL_MESSAGE_TASKS_MAX_NB))
+		ephemeralMessagesHorizon = static_pointer_cast<ConferenceChatMessageEvent>(events.back())->getChatMessage()->getEphemeralExpireTime();
+
+	return !ephemeralMessages.empty();
 }
 
 void CorePrivate::initEphemeralMessages () {
 	L_Q();
-	if (mainDb && mainDb->isInitialized()) {
-		ephemeralMessages.clear();
-		ephemeralMessages = mainDb->getEphemeralMessages();
-		if (!ephemeralMessages.empty()) {
-			lInfo() << "[Ephemeral] list initiated on core " << linphone_core_get_identity(q->getCCore());
-			shared_ptr<ChatMessage> msg = ephemeralMessages.front();
-			startEphemeralMessageTimer(msg->getEphemeralExpireTime());
-		}
+	if (loadEphemeralMessages()) {
+		lInfo() << "[Ephemeral] list initiated on core " << linphone_core_get_identity(q->getCCore());
+		startEphemeralMessageTimer(ephemeralMessages.front().expireTime);
 	}
 }
 
-void CorePrivate::updateEphemeralMessages (const shared_ptr<ChatMessage> &message) {
+void CorePrivate::pushEphemeralMessage (time_t expireTime, const shared_ptr<EventLog> &event) {
+	ephemeralMessages.push_back({ expireTime, event });
+	push_heap(ephemeralMessages.begin(), ephemeralMessages.end(), ephemeralMessageExpiresLater);
+
+	// Keep a page in memory: the messages expiring the latest are loaded again from database when their turn comes.
+	if (ephemeralMessages.size() > size_t(2 * EPHEMERAL_MESSAGE_TASKS_MAX_NB)) {
+		auto last = ephemeralMessages.begin() + (EPHEMERAL_MESSAGE_TASKS_MAX_NB - 1);
+		nth_element(ephemeralMessages.begin(), last, ephemeralMessages.end(), [](const EphemeralMessage &a, const EphemeralMessage &b) {
+			return a.expireTime < b.expireTime;
+		});
+		ephemeralMessagesHorizon = last->expireTime;
+		ephemeralMessages.erase(last + 1, ephemeralMessages.end());
+		make_heap(ephemeralMessages.begin(), ephemeralMessages.end(), ephemeralMessageExpiresLater);
+	}
+}
+
+void CorePrivate::updateEphemeralMessages (const shared_ptr<ChatMessage> &message, const shared_ptr<EventLog> &event) {
 	if (ephemeralMessages.empty()) {
 		// Can not determine this message will expire most quickly, so init this list.
 		initEphemeralMessages();
-	} else {
-		shared_ptr<ChatMessage> lastmsg = ephemeralMessages.back();
-		if (lastmsg->getEphemeralLifetime() < message->getEphemeralLifetime()) {
-			// The last message of this list will expire more quickly than this message, can not determine this message will expire most quickly in the remaining messages.
-			return;
-		}
-		for (std::list<shared_ptr<ChatMessage>>::iterator it=ephemeralMessages.begin(); it!=ephemeralMessages.end(); ++it) {
-			shared_ptr<ChatMessage> msg = *it;
-			if (msg->getEphemeralExpireTime() > message->getEphemeralExpireTime()) {
-				// This message will expire more quickly than the last message of this list, add it.
-				if (it == ephemeralMessages.begin()) {
-					ephemeralMessages.push_front(message);
-					startEphemeralMessageTimer(message->getEphemeralExpireTime());
-				} else {
-					it = --it;
-					ephemeralMessages.insert(it, message);
-				}
-				return;
-			}
-		}
+		return;
 	}
+
+	time_t expireTime = message->getEphemeralExpireTime();
+	if (expireTime > ephemeralMessagesHorizon) {
+		// This message will be loaded from database with the next pages.
+		return;
+	}
+
+	if (!event)
+		return;
+
+	pushEphemeralMessage(expireTime, event);
+	if (ephemeralMessages.front().event == event)
+		startEphemeralMessageTimer(expireTime);
 }
 
 void CorePrivate::sendDeliveryNotifications () {
@@ -540,6 +746,7 @@ void CorePrivate::replaceChatRoom (const shared_ptr<AbstractChatRoom> &replacedC
 	const ConferenceId &replacedConferenceId = replacedChatRoom->getConferenceId();
 	const ConferenceId &newConferenceId = newChatRoom->getConferenceId();
 
+	unindexChatRoom(replacedConferenceId);
 	if (replacedChatRoom->getCapabilities() & ChatRoom::Capabilities::Proxy) {
 		chatRoomsById.erase(replacedConferenceId);
 		chatRoomsById[newConferenceId] = replacedChatRoom;
@@ -547,6 +754,8 @@ void CorePrivate::replaceChatRoom (const shared_ptr<AbstractChatRoom> &replacedC
 		chatRoomsById.erase(replacedConferenceId);
 		chatRoomsById[newConferenceId] = newChatRoom;
 	}
+	// A proxy is about to forward to the new chat room: index what it will expose.
+	indexChatRoom(newConferenceId, newChatRoom);
 }
 
 shared_ptr<AbstractChatRoom> CorePrivate::findExhumableOneToOneChatRoom (
@@ -556,22 +765,29 @@ shared_ptr<AbstractChatRoom> CorePrivate::findExhumableOneToOneChatRoom (
 #ifdef HAVE_ADVANCED_IM
 	lInfo() << "Looking for exhumable 1-1 chat room with local address [" << localAddress.asString() << "] and participant [" << participantAddress.asString() << "]";
 	
-	for (auto it = chatRoomsById.begin(); it != chatRoomsById.end(); it++) {
-		const auto &chatRoom = it->second;
-		const IdentityAddress &curLocalAddress = chatRoom->getLocalAddress();
-		ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
-		// Don't check if terminated, it can be exhumed before the BYE has been received
-		if (/*chatRoom->getState() == ChatRoom::State::Terminated
-				&& */capabilities & ChatRoom::Capabilities::Conference
-				&& capabilities & ChatRoom::Capabilities::OneToOne
-				&& encrypted == bool(capabilities & ChatRoom::Capabilities::Encrypted)) {
-			if (chatRoom->getParticipants().size() > 0 
+	const_cast<CorePrivate *>(this)->loadLazyChatRooms([&localAddress](const MainDb::ChatRoomDescriptor &descriptor) {
+		return (descriptor.capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::OneToOne))
+			&& localAddress.getAddressWithoutGruu() == descriptor.conferenceId.getLocalAddress().getAddressWithoutGruu();
+	});
+	const_cast<CorePrivate *>(this)->indexPendingOneToOneChatRooms();
+	shared_ptr<AbstractChatRoom> exhumableChatRoom = findIndexedChatRoom(
+		oneToOneChatRoomsByParticipant,
+		getOneToOneChatRoomIndexKey(localAddress, participantAddress),
+		[&](const shared_ptr<AbstractChatRoom> &chatRoom) {
+			const IdentityAddress &curLocalAddress = chatRoom->getLocalAddress();
+			ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
+			// Don't check if terminated, it can be exhumed before the BYE has been received
+			return /*chatRoom->getState() == ChatRoom::State::Terminated
+					&& */capabilities & ChatRoom::Capabilities::Conference
+					&& capabilities & ChatRoom::Capabilities::OneToOne
+					&& encrypted == bool(capabilities & ChatRoom::Capabilities::Encrypted)
+					&& chatRoom->getParticipants().size() > 0
 					&& localAddress.getAddressWithoutGruu() == curLocalAddress.getAddressWithoutGruu()
-					&& participantAddress.getAddressWithoutGruu() == chatRoom->getParticipants().front()->getAddress().getAddressWithoutGruu()) {
-				return chatRoom;
-			}
+					&& participantAddress.getAddressWithoutGruu() == chatRoom->getParticipants().front()->getAddress().getAddressWithoutGruu();
 		}
-	}
+	);
+	if (exhumableChatRoom)
+		return exhumableChatRoom;
 
 	lInfo() << "Unable to find exhumable 1-1 chat room with local address [" << localAddress.asString() << "] and participant [" << participantAddress.asString() << "]";
 #endif
@@ -580,6 +796,12 @@ shared_ptr<AbstractChatRoom> CorePrivate::findExhumableOneToOneChatRoom (
 
 shared_ptr<AbstractChatRoom> CorePrivate::findExumedChatRoomFromPreviousConferenceId(const ConferenceId conferenceId) const {
 #ifdef HAVE_ADVANCED_IM
+	// Previous conference ids are kept with the same local address.
+	const_cast<CorePrivate *>(this)->loadLazyChatRooms([&conferenceId](const MainDb::ChatRoomDescriptor &descriptor) {
+		return !(descriptor.capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::Basic))
+			&& (descriptor.capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::OneToOne))
+			&& descriptor.conferenceId.getLocalAddress() == conferenceId.getLocalAddress();
+	});
 	for (auto it = chatRoomsById.begin(); it != chatRoomsById.end(); it++) {
 		const shared_ptr<AbstractChatRoom> &chatRoom = it->second;
 		ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
@@ -607,8 +829,10 @@ void CorePrivate::updateChatRoomConferenceId (const shared_ptr<AbstractChatRoom>
 	const ConferenceId &newConferenceId = chatRoom->getConferenceId();
 	lInfo() << "Chat room [" << oldConferenceId << "] has been exhumed into [" << newConferenceId << "]";
 
+	unindexChatRoom(oldConferenceId);
 	chatRoomsById.erase(oldConferenceId);
 	chatRoomsById[newConferenceId] = chatRoom;
+	indexChatRoom(newConferenceId, chatRoom);
 
 	mainDb->updateChatRoomConferenceId(oldConferenceId, newConferenceId);
 #endif
@@ -647,6 +871,8 @@ string Core::getConferenceFactoryUri(const shared_ptr<Core> &core, const Linphon
 list<shared_ptr<AbstractChatRoom>> Core::getChatRooms () const {
 	L_D();
 
+	const_cast<CorePrivate *>(d)->loadLazyChatRooms();
+
 	LinphoneCore *lc = getCCore();
 	LinphoneConfig *config = linphone_core_get_config(lc);
 	bool hideEmptyChatRooms = !!linphone_config_get_int(config, "misc", "hide_empty_chat_rooms", 1);
@@ -684,6 +910,24 @@ list<shared_ptr<AbstractChatRoom>> Core::getChatRooms () const {
 	return rooms;
 }
 
+list<shared_ptr<AbstractChatRoom>> Core::getChatRooms (int offset, int limit) const {
+	L_D();
+
+	if (!d->mainDb->isInitialized())
+		return list<shared_ptr<AbstractChatRoom>>();
+
+	list<shared_ptr<AbstractChatRoom>> chatRooms = d->mainDb->getChatRooms(offset, limit);
+	CorePrivate *dCore = const_cast<CorePrivate *>(d);
+	for (const auto &chatRoom : chatRooms) {
+		const ConferenceId &conferenceId = chatRoom->getConferenceId();
+		if (d->chatRoomsById.find(conferenceId) == d->chatRoomsById.cend()) {
+			dCore->lazyChatRooms.erase(conferenceId);
+			dCore->insertChatRoom(chatRoom);
+		}
+	}
+	return chatRooms;
+}
+
 shared_ptr<AbstractChatRoom> Core::findChatRoom (const ConferenceId &conferenceId, bool logIfNotFound) const {
 	L_D();
 	auto it = d->chatRoomsById.find(conferenceId);
@@ -692,6 +936,12 @@ shared_ptr<AbstractChatRoom> Core::findChatRoom (const ConferenceId &conferenceI
 		return it->second;
 	}
 
+	shared_ptr<AbstractChatRoom> lazyChatRoom = const_cast<CorePrivate *>(d)->loadLazyChatRoom(conferenceId);
+	if (lazyChatRoom) {
+		lDebug() << "Loaded chat room from DB for conference ID " << conferenceId << ".";
+		return lazyChatRoom;
+	}
+
 	auto alreadyExhumedOneToOne = d->findExumedChatRoomFromPreviousConferenceId(conferenceId);
 	if (alreadyExhumedOneToOne) {
 		lWarning() << "Found conference id as already exhumed chat room with new conference ID " << alreadyExhumedOneToOne->getConferenceId() << ".";
@@ -707,13 +957,16 @@ shared_ptr<AbstractChatRoom> Core::findChatRoom (const ConferenceId &conferenceI
 list<shared_ptr<AbstractChatRoom>> Core::findChatRooms (const IdentityAddress &peerAddress) const {
 	L_D();
 
+	const_cast<CorePrivate *>(d)->loadLazyChatRooms([&peerAddress](const MainDb::ChatRoomDescriptor &descriptor) {
+		return descriptor.conferenceId.getPeerAddress() == peerAddress;
+	});
+
 	list<shared_ptr<AbstractChatRoom>> output;
-	for (auto it = d->chatRoomsById.begin(); it != d->chatRoomsById.end(); it++) {
-		const auto &chatRoom = it->second;
-		if (chatRoom->getPeerAddress() == peerAddress) {
+	d->findIndexedChatRoom(d->chatRoomsByPeerAddress, getChatRoomIndexKey(peerAddress), [&](const shared_ptr<AbstractChatRoom> &chatRoom) {
+		if (chatRoom->getPeerAddress() == peerAddress)
 			output.push_front(chatRoom);
-		}
-	}
+		return false;
+	});
 
 	return output;
 }
@@ -726,18 +979,23 @@ shared_ptr<AbstractChatRoom> Core::findOneToOneChatRoom (
 	bool encrypted
 ) const {
 	L_D();
-	for (auto it = d->chatRoomsById.begin(); it != d->chatRoomsById.end(); it++) {
-		const auto &chatRoom = it->second;
+
+	const_cast<CorePrivate *>(d)->loadLazyChatRooms([&localAddress](const MainDb::ChatRoomDescriptor &descriptor) {
+		return (descriptor.capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::OneToOne))
+			&& localAddress.getAddressWithoutGruu() == descriptor.conferenceId.getLocalAddress().getAddressWithoutGruu();
+	});
+	const_cast<CorePrivate *>(d)->indexPendingOneToOneChatRooms();
+	auto matches = [&](const shared_ptr<AbstractChatRoom> &chatRoom) {
 		const IdentityAddress &curLocalAddress = chatRoom->getLocalAddress();
 		ChatRoom::CapabilitiesMask capabilities = chatRoom->getCapabilities();
 
 		// We are looking for a one to one chatroom
 		// Do not return a group chat room that everyone except one person has left
 		if (!(capabilities & ChatRoom::Capabilities::OneToOne))
-			continue;
+			return false;
 
 		if (encrypted != bool(capabilities & ChatRoom::Capabilities::Encrypted))
-			continue;
+			return false;
 
 		// One to one client group chat room
 		// The only participant's address must match the participantAddress argument
@@ -748,7 +1006,7 @@ shared_ptr<AbstractChatRoom> Core::findOneToOneChatRoom (
 			localAddress.getAddressWithoutGruu() == curLocalAddress.getAddressWithoutGruu() &&
 			participantAddress.getAddressWithoutGruu() == chatRoom->getParticipants().front()->getAddress()
 		)
-			return chatRoom;
+			return true;
 
 		// One to one basic chat room (addresses without gruu)
 		// The peer address must match the participantAddress argument
@@ -758,9 +1016,15 @@ shared_ptr<AbstractChatRoom> Core::findOneToOneChatRoom (
 			localAddress.getAddressWithoutGruu() == curLocalAddress.getAddressWithoutGruu() &&
 			participantAddress.getAddressWithoutGruu() == chatRoom->getPeerAddress().getAddressWithoutGruu()
 		)
-			return chatRoom;
-	}
-	return nullptr;
+			return true;
+
+		return false;
+	};
+	return d->findIndexedChatRoom(
+		d->oneToOneChatRoomsByParticipant,
+		getOneToOneChatRoomIndexKey(localAddress, participantAddress),
+		matches
+	);
 }
 
 shared_ptr<AbstractChatRoom> Core::getOrCreateBasicChatRoom (const ConferenceId &conferenceId) {
@@ -827,6 +1091,7 @@ void Core::deleteChatRoom (const shared_ptr<const AbstractChatRoom> &chatRoom) {
 	auto chatRoomsByIdIt = d->chatRoomsById.find(conferenceId);
 	if (chatRoomsByIdIt != d->chatRoomsById.end()) {
 		d->chatRoomsById.erase(chatRoomsByIdIt);
+		d->unindexChatRoom(conferenceId);
 		if (d->mainDb->isInitialized()) d->mainDb->deleteChatRoom(conferenceId);
 	} else {
 		lError() << "Unable to delete chat room with conference ID " << conferenceId << " because it cannot be found.";
@@ -21,15 +21,21 @@
 #ifndef _L_CORE_P_H_
 #define _L_CORE_P_H_
 
+#include <limits>
 #include <stdexcept>
+#include <unordered_set>
+#include <vector>
 
 #include "linphone/utils/utils.h"
 
 #include "chat/chat-room/abstract-chat-room.h"
+#include "chat/notification/imdn-scheduler.h"
 #include "core.h"
 #include "db/main-db.h"
+#include "nat/ice-scheduler.h"
 #include "object/object-p.h"
 #include "sal/call-op.h"
+#include "search/search-index.h"
 #include "auth-info/auth-stack.h"
 #include "conference/session/tone-manager.h"
 #include "utils/background-task.h"
@@ -75,6 +81,9 @@ public:
 	bool inviteReplacesABrokenCall (SalCallOp *op);
 	bool isAlreadyInCallWithAddress (const Address &addr) const;
 	void iterateCalls (time_t currentRealTime, bool oneSecondElapsed) const;
+	// Called when the Call-ID or the remote address of a call of the core changes.
+	void reindexCall (Call *call);
+	size_t getIndexedCallCount () const { return callsByCallId.size() + callsByRemoteAddress.size(); }
 	void notifySoundcardUsage (bool used);
 	int removeCall (const std::shared_ptr<Call> &call);
 	void setCurrentCall (const std::shared_ptr<Call> &call);
@@ -84,15 +93,24 @@ public:
 	bool setInputAudioDevice(AudioDevice *audioDevice);
 
 	void loadChatRooms ();
+	// Lazy loading: chat rooms are only described until they are accessed.
+	std::shared_ptr<AbstractChatRoom> loadLazyChatRoom (const ConferenceId &conferenceId);
+	void loadLazyChatRooms (const std::function<bool (const MainDb::ChatRoomDescriptor &)> &filter = nullptr);
+	bool hasLazyChatRooms () const { return !lazyChatRooms.empty(); }
+	int getLoadedChatRoomCount () const { return int(chatRoomsById.size()); }
+	int getLazyChatRoomCount () const { return int(lazyChatRooms.size()); }
+	std::shared_ptr<AbstractChatRoom> findLoadedChatRoom (const ConferenceId &conferenceId) const;
 	void handleEphemeralMessages (time_t currentTime);
 	void initEphemeralMessages ();
-	void updateEphemeralMessages (const std::shared_ptr<ChatMessage> &message);
+	void updateEphemeralMessages (const std::shared_ptr<ChatMessage> &message, const std::shared_ptr<EventLog> &event);
 	void sendDeliveryNotifications ();
 	void insertChatRoom (const std::shared_ptr<AbstractChatRoom> &chatRoom);
 	void insertChatRoomWithDb (const std::shared_ptr<AbstractChatRoom> &chatRoom, unsigned int notifyId = 0);
 	std::shared_ptr<AbstractChatRoom> createBasicChatRoom (const ConferenceId &conferenceId, AbstractChatRoom::CapabilitiesMask capabilities, const std::shared_ptr<ChatRoomParams> &params);
 
 	ToneManager & getToneManager();
+	ImdnScheduler & getImdnScheduler();
+	IceScheduler & getIceScheduler();
 	
 	void reloadLdapList();
 
@@ -154,6 +172,7 @@ public:
 	belle_sip_main_loop_t *getMainLoop();
 	bool basicToFlexisipChatroomMigrationEnabled()const;
 	std::unique_ptr<MainDb> mainDb;
+	ContactSearchIndex contactSearchIndex;
 #ifdef HAVE_ADVANCED_IM
 	std::unique_ptr<RemoteConferenceListEventHandler> remoteListEventHandler;
 	std::unique_ptr<LocalConferenceListEventHandler> localListEventHandler;
@@ -184,7 +203,47 @@ private:
 	std::list<std::shared_ptr<Call>> calls;
 	std::shared_ptr<Call> currentCall;
 
+	/* Next call to iterate while iterateCalls() runs, removeCall() moves it past the removed call. */
+	mutable std::list<std::shared_ptr<Call>>::const_iterator nextCallToIterate;
+	mutable bool iteratingCalls = false;
+
+	/* Indexes on calls by Call-ID and by remote address (username and domain), kept along with the keys each call is
+	 * indexed with so that a call can be re-keyed on its own. */
+	void indexCall (const std::shared_ptr<Call> &call);
+	void unindexCall (const std::shared_ptr<Call> &call);
+	std::unordered_multimap<std::string, std::shared_ptr<Call>> callsByCallId;
+	std::unordered_multimap<std::string, std::shared_ptr<Call>> callsByRemoteAddress;
+	std::unordered_map<const Call *, std::pair<std::string, std::string>> callIndexKeys;
+
 	std::unordered_map<ConferenceId, std::shared_ptr<AbstractChatRoom>> chatRoomsById;
+	std::unordered_map<ConferenceId, MainDb::ChatRoomDescriptor> lazyChatRooms;
+
+	/* Secondary indexes on chatRoomsById, maintained by insertChatRoom(), replaceChatRoom(),
+	 * updateChatRoomConferenceId() and deleteChatRoom(). They are keyed by the username and domain
+	 * of addresses, so they return candidates that are still checked against the lookup criteria. */
+	using ChatRoomIndex = std::unordered_map<std::string, std::unordered_set<ConferenceId>>;
+	struct ChatRoomIndexKeys {
+		std::string peer;
+		std::string local;
+		std::string oneToOne; /*local and participant keys, empty when the participant isn't known yet*/
+	};
+
+	void indexChatRoom (const ConferenceId &conferenceId, const std::shared_ptr<AbstractChatRoom> &chatRoom);
+	void unindexChatRoom (const ConferenceId &conferenceId);
+	void clearChatRoomIndexes ();
+	void indexPendingOneToOneChatRooms ();
+	std::shared_ptr<AbstractChatRoom> findIndexedChatRoom (
+		const ChatRoomIndex &index,
+		const std::string &key,
+		const std::function<bool (const std::shared_ptr<AbstractChatRoom> &)> &predicate
+	) const;
+	static void removeFromChatRoomIndex (ChatRoomIndex &index, const std::string &key, const ConferenceId &conferenceId);
+
+	std::unordered_map<ConferenceId, ChatRoomIndexKeys> chatRoomIndexKeys;
+	ChatRoomIndex chatRoomsByPeerAddress;
+	ChatRoomIndex chatRoomsByLocalAddress;
+	ChatRoomIndex oneToOneChatRoomsByParticipant;
+	std::unordered_set<ConferenceId> pendingOneToOneChatRooms; /*one to one chat rooms without participant yet*/
 
 	std::unique_ptr<EncryptionEngine> imee;
 
@@ -192,12 +251,30 @@ private:
 
 	std::unique_ptr<ToneManager> toneManager;
 
+	std::unique_ptr<ImdnScheduler> imdnScheduler;
+
+	std::unique_ptr<IceScheduler> iceScheduler;
+
 	// This is to keep a ref on a clientGroupChatRoom while it is being created
 	// Otherwise the chatRoom will be freed() before it is inserted
 	std::unordered_map<const AbstractChatRoom *, std::shared_ptr<const AbstractChatRoom>> noCreatedClientGroupChatRooms;
 	AuthStack authStack;
 
-	std::list<std::shared_ptr<ChatMessage>> ephemeralMessages;
+	/* Min-heap of the ephemeral messages waiting for their expiry, loaded by pages of
+	 * EPHEMERAL_MESSAGE_TASKS_MAX_NB. Every pending message expiring at or before
+	 * ephemeralMessagesHorizon is in the heap, the later ones are only in database. */
+	struct EphemeralMessage {
+		time_t expireTime;
+		std::shared_ptr<EventLog> event;
+	};
+
+	bool loadEphemeralMessages ();
+	void pushEphemeralMessage (time_t expireTime, const std::shared_ptr<EventLog> &event);
+	bool deleteEphemeralMessages (const std::list<std::shared_ptr<EventLog>> &events);
+	static bool ephemeralMessageExpiresLater (const EphemeralMessage &a, const EphemeralMessage &b);
+
+	std::vector<EphemeralMessage> ephemeralMessages;
+	time_t ephemeralMessagesHorizon = std::numeric_limits<time_t>::max();
 	belle_sip_source_t *ephemeralTimer = nullptr;
 
 	belle_sip_source_t *chatMessagesAggregationTimer = nullptr;
@@ -38,6 +38,7 @@
 
 #include "account/account.h"
 #include "address/address.h"
+#include "address/identity-address-parser.h"
 #include "call/call.h"
 #include "chat/encryption/encryption-engine.h"
 #ifdef HAVE_LIME_X3DH
@@ -97,6 +98,14 @@ void CorePrivate::init () {
 #endif
 
 	LinphoneCore *lc = L_GET_C_BACK_PTR(q);
+	// These caches are shared by all the cores of the process, the last started one sets their capacity.
+	Address::setSipAddressesCacheCapacity(
+		linphone_config_get_int(lc->config, "misc", "sip_address_cache_size", Address::DefaultSipAddressesCacheCapacity)
+	);
+	IdentityAddressParser::getInstance()->setCacheCapacity(
+		linphone_config_get_int(lc->config, "misc", "identity_address_cache_size", IdentityAddressParser::DefaultCacheCapacity)
+	);
+
 	if (q->limeX3dhAvailable()) {
 		bool limeEnabled = linphone_config_get_bool(lc->config, "lime", "enabled", TRUE);
 		if (limeEnabled) {
@@ -148,6 +157,14 @@ void CorePrivate::init () {
 				lWarning() << "Opening database took " << duration << " ms !";
 			}
 
+			if (linphone_config_get_bool(linphone_core_get_config(lc), "storage", "write_behind", FALSE)) {
+				mainDb->enableWriteBehind(
+					true,
+					linphone_config_get_int(linphone_core_get_config(lc), "storage", "write_behind_flush_delay", 200),
+					linphone_config_get_int(linphone_core_get_config(lc), "storage", "write_behind_max_pending_writes", 500)
+				);
+			}
+
 			loadChatRooms();
 		} else lWarning() << "Database explicitely not requested, this Core is built with no database support.";
 
@@ -270,6 +287,7 @@ void CorePrivate::shutdown() {
 
 	stopEphemeralMessageTimer();
 	ephemeralMessages.clear();
+	ephemeralMessagesHorizon = numeric_limits<time_t>::max();
 
 	stopChatMessagesAggregationTimer();
 
@@ -298,10 +316,10 @@ void CorePrivate::uninit() {
 		q->enableLimeX3dh(false);
 	}
 
-	const list<shared_ptr<AbstractChatRoom>> chatRooms = q->getChatRooms();
+	// Chat rooms that were not loaded have nothing to stop.
 	shared_ptr<ChatRoom> cr;
-	for (const auto &chatRoom : chatRooms) {
-		cr = dynamic_pointer_cast<ChatRoom>(chatRoom);
+	for (const auto &entry : chatRoomsById) {
+		cr = dynamic_pointer_cast<ChatRoom>(entry.second);
 		if (cr) {
 			cr->getPrivate()->getImdnHandler()->onLinphoneCoreStop();
 #ifdef HAVE_ADVANCED_IM
@@ -321,7 +339,12 @@ void CorePrivate::uninit() {
 		}
 	}
 
+	if (imdnScheduler) imdnScheduler->stop();
+	if (iceScheduler) iceScheduler->stop();
+
 	chatRoomsById.clear();
+	clearChatRoomIndexes();
+	lazyChatRooms.clear();
 
 	for (const auto &audioVideoConference : q->audioVideoConferenceById) {
 		// Terminate audio video conferences just before core is stopped
@@ -330,6 +353,7 @@ void CorePrivate::uninit() {
 	q->audioVideoConferenceById.clear();
 
 	noCreatedClientGroupChatRooms.clear();
+	contactSearchIndex.clear();
 	listeners.clear();
 	pushReceivedBackgroundTask.stop();
 	mLdapServers.clear();
@@ -350,6 +374,7 @@ void CorePrivate::uninit() {
 
 void CorePrivate::disconnectMainDb () {
 	if (mainDb != nullptr) {
+		mainDb->flushPendingEvents();
 		mainDb->disconnect();
 	}
 }
@@ -474,6 +499,16 @@ ToneManager & CorePrivate::getToneManager() {
 	return *toneManager.get();
 }
 
+ImdnScheduler & CorePrivate::getImdnScheduler() {
+	if (!imdnScheduler) imdnScheduler = makeUnique<ImdnScheduler>(*getPublic());
+	return *imdnScheduler.get();
+}
+
+IceScheduler & CorePrivate::getIceScheduler() {
+	if (!iceScheduler) iceScheduler = makeUnique<IceScheduler>(*getPublic());
+	return *iceScheduler.get();
+}
+
 int CorePrivate::ephemeralMessageTimerExpired (void *data, unsigned int revents) {
 	CorePrivate *d = static_cast<CorePrivate *>(data);
 	d->stopEphemeralMessageTimer();
@@ -1237,6 +1272,11 @@ int Core::getUnreadChatMessageCount (const IdentityAddress &localAddress) const
 		if (addressToCompare.weakEqual(chatRoom->getLocalAddress().asAddress()))
 			count += chatRoom->getUnreadChatMessageCount();
 	}
+	// Chat rooms not loaded yet can't be read, their description is up to date.
+	for (const auto &entry : d->lazyChatRooms) {
+		if (addressToCompare.weakEqual(entry.first.getLocalAddress().asAddress()))
+			count += entry.second.unreadChatMessageCount;
+	}
 	return count;
 }
 
@@ -1254,6 +1294,15 @@ int Core::getUnreadChatMessageCountFromActiveLocals () const {
 			}
 		}
 	}
+	for (const auto &entry : d->lazyChatRooms) {
+		for (auto it = linphone_core_get_proxy_config_list(getCCore()); it != NULL; it = it->next) {
+			LinphoneProxyConfig *cfg = (LinphoneProxyConfig *)it->data;
+			const LinphoneAddress *identityAddr = linphone_proxy_config_get_identity_address(cfg);
+			if (L_GET_CPP_PTR_FROM_C_OBJECT(identityAddr)->weakEqual(entry.first.getLocalAddress().asAddress())) {
+				count += entry.second.unreadChatMessageCount;
+			}
+		}
+	}
 	return count;
 }
 
@@ -161,6 +161,8 @@ public:
 	// ---------------------------------------------------------------------------
 
 	std::list<std::shared_ptr<AbstractChatRoom>> getChatRooms () const;
+	// Chat rooms ordered by last update time, without filtering. A limit lower or equal to 0 means no limit.
+	std::list<std::shared_ptr<AbstractChatRoom>> getChatRooms (int offset, int limit) const;
 
 	std::shared_ptr<AbstractChatRoom> findChatRoom (const ConferenceId &conferenceId, bool logIfNotFound = true) const;
 	std::list<std::shared_ptr<AbstractChatRoom>> findChatRooms (const IdentityAddress &peerAddress) const;
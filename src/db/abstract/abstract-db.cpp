@@ -117,6 +117,7 @@ bool AbstractDb::forceReconnect () {
 		for (int i = 0; i < retryCount; ++i) {
 			try {
 				lInfo() << "Reconnect... Try: " << i;
+				d->dbSession.clearPreparedStatements(); // Prepared on the closed connection.
 				d->dbSession.getBackendSession()->reconnect(); // Equivalent to close and connect.
 				d->safeInit();
 				lInfo() << "Database reconnection successful!";
@@ -31,21 +31,33 @@
 
 #define L_DB_TRANSACTION L_DB_TRANSACTION_C(this)
 
+#define L_DB_SAVEPOINT_PREFIX "linphone_savepoint_"
+
 LINPHONE_BEGIN_NAMESPACE
 
 class SmartTransaction {
 public:
-	SmartTransaction (soci::session *session, const char *name) :
+	// A transaction opened in another one (write-behind batch or nested MainDb call) becomes a savepoint:
+	// it can be rolled back alone but is only durable once the outermost transaction is committed.
+	SmartTransaction (soci::session *session, const char *name, int savepointLevel = 0) :
 	mSession(session), mName(name), mIsCommitted(false) {
 		lDebug() << "Start transaction " << this << " in MainDb::" << mName << ".";
-		mSession->begin();
+		if (savepointLevel > 0) {
+			mSavepoint = L_DB_SAVEPOINT_PREFIX + std::to_string(savepointLevel);
+			*mSession << "SAVEPOINT " << mSavepoint;
+		} else
+			mSession->begin();
 	}
 
 	~SmartTransaction () {
 		if (!mIsCommitted) {
 			lDebug() << "Rollback transaction " << this << " in MainDb::" << mName << ".";
 			try {
-				mSession->rollback();
+				if (!mSavepoint.empty()) {
+					*mSession << "ROLLBACK TO SAVEPOINT " << mSavepoint;
+					*mSession << "RELEASE SAVEPOINT " << mSavepoint;
+				} else
+					mSession->rollback();
 			} catch (std::runtime_error &e) {
 				lError() << "Error during rollback transaction " << this << " in MainDb::" << mName
 						 << ". Error : " << e.what();
@@ -61,13 +73,21 @@ public:
 
 		lDebug() << "Commit transaction " << this << " in MainDb::" << mName << ".";
 		mIsCommitted = true;
-		mSession->commit();
+		if (!mSavepoint.empty())
+			*mSession << "RELEASE SAVEPOINT " << mSavepoint;
+		else
+			mSession->commit();
+	}
+
+	bool isCommitted () const {
+		return mIsCommitted;
 	}
 
 private:
 	soci::session *mSession;
 	const char *mName;
 	bool mIsCommitted;
+	std::string mSavepoint;
 
 	L_DISABLE_COPY(SmartTransaction);
 };
@@ -98,25 +118,40 @@ public:
 
 	DbTransaction (DbTransactionInfo &info, Function &&function) : mFunction(std::move(function)) {
 		MainDb *mainDb = info.mainDb;
+		MainDbPrivate *d = mainDb->getPrivate();
 		const char *name = info.name;
-		soci::session *session = mainDb->getPrivate()->dbSession.getBackendSession();
+		soci::session *session = d->dbSession.getBackendSession();
 
+		bool isCommitted = false;
 		try {
-			SmartTransaction tr(session, name);
+			// Staged updates must reach the database before anything else reads or writes it.
+			d->applyStagedEventUpdates();
+
+			const int savepointLevel = d->getSavepointLevel();
+			NestingGuard guard(d);
+			SmartTransaction tr(session, name, savepointLevel);
 			mResult = exec<InternalReturnType>(tr);
+			isCommitted = tr.isCommitted();
 		} catch (const soci::soci_error &e) {
 			lWarning() << "Caught exception in MainDb::" << name << "(" << e.what() << ").";
 			soci::soci_error::error_category category = e.get_error_category();
 			if (
 				(category == soci::soci_error::connection_error || category == soci::soci_error::unknown) &&
+				!d->isTransactionOpened() &&
 				mainDb->forceReconnect()
 			) {
+				// The pending batch died with the previous connection.
+				d->discardWriteBehindBatch();
+				d->invalidateInternedIds();
 				try {
+					NestingGuard guard(d);
 					SmartTransaction tr(session, name);
 					mResult = exec<InternalReturnType>(tr);
+					isCommitted = tr.isCommitted();
 				} catch (const std::exception &e) {
 					lError() << "Unable to execute query after reconnect in MainDb::" << name << "(" << e.what() << ").";
 				}
+				d->endInterningTransaction(isCommitted);
 				return;
 			}
 			lError() << "Unhandled [" << getErrorCategoryAsString(category) << "] exception in MainDb::" <<
@@ -124,6 +159,7 @@ public:
 		} catch (const std::exception &e) {
 			lError() << "Unhandled generic exception in MainDb::" << name << ": `" << e.what() << "`.";
 		}
+		d->endInterningTransaction(isCommitted);
 	}
 
 	DbTransaction (DbTransaction &&DbTransaction) : mFunction(std::move(DbTransaction.mFunction)) {}
@@ -133,6 +169,21 @@ public:
 	}
 
 private:
+	// Transactions opened while this one runs are nested in it.
+	class NestingGuard {
+	public:
+		NestingGuard (MainDbPrivate *d) : mD(d) {
+			++mD->transactionDepth;
+		}
+
+		~NestingGuard () {
+			--mD->transactionDepth;
+		}
+
+	private:
+		MainDbPrivate *mD;
+	};
+
 	// Exec function with no return type.
 	template<typename T>
 	typename std::enable_if<std::is_same<T, void>::value, bool>::type exec (SmartTransaction &tr) const {
@@ -134,6 +134,12 @@ namespace Statements {
 			SELECT id
 			FROM conference_call
 			WHERE call_id = :1
+		)",
+
+		/* SelectContentTypeId */ R"(
+			SELECT id
+			FROM content_type
+			WHERE value = :1
 		)"
 	};
 
@@ -146,6 +152,40 @@ namespace Statements {
 			INSERT INTO one_to_one_chat_room (
 				chat_room_id, participant_a_sip_address_id, participant_b_sip_address_id
 			) VALUES (:1, :2, :3)
+		)",
+
+		/* InsertSipAddress */ R"(
+			INSERT INTO sip_address (value, display_name)
+			VALUES (:1, :2)
+		)",
+
+		/* InsertContentType */ R"(
+			INSERT INTO content_type (value)
+			VALUES (:1)
+		)",
+
+		/* InsertChatMessageContent */ R"(
+			INSERT INTO chat_message_content (
+				event_id, content_type_id, body, body_encoding_type
+			) VALUES (:1, :2, :3, 1)
+		)",
+
+		/* InsertChatMessageFileContent */ R"(
+			INSERT INTO chat_message_file_content (
+				chat_message_content_id, name, size, path, duration
+			) VALUES (:1, :2, :3, :4, :5)
+		)",
+
+		/* InsertChatMessageContentAppData */ R"(
+			INSERT INTO chat_message_content_app_data (
+				chat_message_content_id, name, data
+			) VALUES (:1, :2, :3)
+		)",
+
+		/* InsertChatMessageParticipant */ R"(
+			INSERT INTO chat_message_participant (
+				event_id, participant_sip_address_id, state, state_change_time
+			) VALUES (:1, :2, :3, :4)
 		)"
 	};
 
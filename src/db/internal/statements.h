@@ -39,16 +39,32 @@ namespace Statements {
 		SelectConferenceInfoParticipantId,
 		SelectConferenceInfoOrganizerId,
 		SelectConferenceCall,
+		SelectContentTypeId,
 		SelectCount
 	};
 
 	enum Insert {
 		InsertOneToOneChatRoom,
+		InsertSipAddress,
+		InsertContentType,
+		InsertChatMessageContent,
+		InsertChatMessageFileContent,
+		InsertChatMessageContentAppData,
+		InsertChatMessageParticipant,
 		InsertCount
 	};
 
 	const char *get (Select selectStmt);
 	const char *get (Insert insertStmt, AbstractDb::Backend backend);
+
+	// Unique key of a statement, used to cache it once prepared. See DbSession::executePreparedStatement.
+	constexpr int key (Select selectStmt) {
+		return selectStmt;
+	}
+
+	constexpr int key (Insert insertStmt) {
+		return SelectCount + insertStmt;
+	}
 }
 
 LINPHONE_END_NAMESPACE
@@ -22,6 +22,7 @@
 #define _L_MAIN_DB_P_H_
 
 #include <unordered_map>
+#include <unordered_set>
 
 #include "linphone/utils/utils.h"
 
@@ -32,6 +33,8 @@
 
 // =============================================================================
 
+typedef struct belle_sip_source belle_sip_source_t;
+
 LINPHONE_BEGIN_NAMESPACE
 
 class Content;
@@ -44,6 +47,36 @@ public:
 	mutable std::unordered_map<long long, std::weak_ptr<CallLog>> storageIdToCallLog;
 	mutable std::unordered_map<long long, std::weak_ptr<ConferenceInfo>> storageIdToConferenceInfo;
 
+	// Number of DbTransaction currently running, a transaction opened by another one is nested.
+	int transactionDepth = 0;
+
+	bool isTransactionOpened () const {
+		return transactionDepth > 0;
+	}
+
+	// ---------------------------------------------------------------------------
+	// Write-behind API.
+	// ---------------------------------------------------------------------------
+
+	bool isWriteBehindBatchOpened () const {
+		return writeBehindBatchOpened;
+	}
+
+	int getSavepointLevel () const {
+		return (writeBehindBatchOpened ? 1 : 0) + transactionDepth;
+	}
+
+	void applyStagedEventUpdates ();
+	void discardWriteBehindBatch ();
+
+	// ---------------------------------------------------------------------------
+	// Interning API.
+	// ---------------------------------------------------------------------------
+
+	// Ids interned by a transaction that is not committed may not exist: they are dropped.
+	void endInterningTransaction (bool committed);
+	void invalidateInternedIds ();
+
 private:
 	// ---------------------------------------------------------------------------
 	// Misc helpers.
@@ -59,6 +92,7 @@ private:
 
 	long long insertSipAddress (const Address &address);
 	long long insertSipAddress (const std::string &sipAddress);
+	long long insertSipAddress (const std::string &sipAddress, const std::string &displayName);
 	void insertContent (long long chatMessageId, const Content &content);
 	long long insertContentType (const std::string &contentType);
 	long long insertOrUpdateImportedBasicChatRoom (
@@ -212,6 +246,15 @@ private:
 	std::shared_ptr<ConferenceInfo> selectConferenceInfo (const soci::row &row) const;
 #endif
 
+	// ---------------------------------------------------------------------------
+	// Chat rooms API.
+	// ---------------------------------------------------------------------------
+
+#ifdef HAVE_DB_STORAGE
+	std::shared_ptr<AbstractChatRoom> selectChatRoom (const soci::row &row) const;
+	std::list<std::shared_ptr<AbstractChatRoom>> selectChatRooms (const std::string &condition, int offset, int limit) const;
+#endif
+
 	// ---------------------------------------------------------------------------
 	// Cache API.
 	// ---------------------------------------------------------------------------
@@ -230,6 +273,14 @@ private:
 
 	void invalidConferenceEventsFromQuery (const std::string &query, long long chatRoomId);
 
+	// ---------------------------------------------------------------------------
+	// Write-behind.
+	// ---------------------------------------------------------------------------
+
+	void openWriteBehindBatch ();
+	void stageEventUpdate (const std::shared_ptr<EventLog> &eventLog);
+	void notifyWriteBehindWrite ();
+
 	// ---------------------------------------------------------------------------
 	// Versions.
 	// ---------------------------------------------------------------------------
@@ -252,6 +303,26 @@ private:
 
 	mutable LruCache<ConferenceId, int> unreadChatMessageCountCache;
 
+	// Write-through caches of sip_address and content_type ids.
+	mutable LruCache<std::string, long long> sipAddressIdCache{ 5000 };
+	mutable LruCache<std::string, long long> contentTypeIdCache{ 100 };
+	mutable MainDb::CacheStats sipAddressIdCacheStats;
+	mutable MainDb::CacheStats contentTypeIdCacheStats;
+	bool hasUncommittedInternedIds = false;
+
+	bool writeBehindEnabled = false;
+	bool writeBehindBatchOpened = false;
+	int writeBehindFlushDelay = 0;
+	int writeBehindMaxPendingWrites = 0;
+	int writeBehindPendingWrites = 0;
+	int writeBehindCoalescedUpdates = 0;
+	int writeBehindCommits = 0;
+	belle_sip_source_t *writeBehindTimer = nullptr;
+
+	// Chat message updates are coalesced per event: only the latest state is written on flush.
+	std::list<std::shared_ptr<EventLog>> stagedEventUpdates;
+	std::unordered_set<long long> stagedEventUpdateIds;
+
 	L_DECLARE_PUBLIC(MainDb);
 };
 
@@ -64,7 +64,7 @@ LINPHONE_BEGIN_NAMESPACE
 
 #ifdef HAVE_DB_STORAGE
 namespace {
-	constexpr unsigned int ModuleVersionEvents = makeVersion(1, 0, 20);
+	constexpr unsigned int ModuleVersionEvents = makeVersion(1, 0, 21);
 	constexpr unsigned int ModuleVersionFriends = makeVersion(1, 0, 0);
 	constexpr unsigned int ModuleVersionLegacyFriendsImport = makeVersion(1, 0, 0);
 	constexpr unsigned int ModuleVersionLegacyHistoryImport = makeVersion(1, 0, 0);
@@ -144,6 +144,18 @@ static T getValueFromRow (const soci::row &row, int index, bool &isNull) {
 	}
 	return row.get<T>(size_t(index));
 }
+
+// COUNT(*) is an integer or a big integer depending on the backend.
+static int getCountFromRow (const soci::row &row, size_t col) {
+	switch (row.get_properties(col).get_data_type()) {
+		case soci::dt_long_long:
+			return static_cast<int>(row.get<long long>(col, 0));
+		case soci::dt_unsigned_long_long:
+			return static_cast<int>(row.get<unsigned long long>(col, 0));
+		default:
+			return row.get<int>(col, 0);
+	}
+}
 #endif
 
 // -----------------------------------------------------------------------------
@@ -318,12 +330,7 @@ long long MainDbPrivate::insertSipAddress (const Address &address) {
 
 	if (sipAddressId < 0) {
 		lInfo() << "Insert new sip address in database: `" << sipAddress << "`.";
-		soci::indicator displayNameInd = displayName.empty() ? soci::i_null : soci::i_ok;
-
-		*dbSession.getBackendSession() << "INSERT INTO sip_address (value, display_name) VALUES (:sipAddress, :displayName)",
-			soci::use(sipAddress), soci::use(displayName, displayNameInd);
-
-		return dbSession.getLastInsertId();
+		return insertSipAddress(sipAddress, displayName);
 	} else if (sipAddressId >=0 && !displayName.empty()) {
 		lInfo() << "Updating sip address display name in database: `" << sipAddress << "`.";
 
@@ -344,8 +351,29 @@ long long MainDbPrivate::insertSipAddress (const string &sipAddress) {
 		return sipAddressId;
 
 	lInfo() << "Insert new sip address in database: `" << sipAddress << "`.";
-	*dbSession.getBackendSession() << "INSERT INTO sip_address (value, display_name) VALUES (:sipAddress, NULL)", soci::use(sipAddress);
-	return dbSession.getLastInsertId();
+	return insertSipAddress(sipAddress, string());
+#else
+	return -1;
+#endif
+}
+
+long long MainDbPrivate::insertSipAddress (const string &sipAddress, const string &displayName) {
+#ifdef HAVE_DB_STORAGE
+	L_Q();
+
+	soci::indicator displayNameIndicator = displayName.empty() ? soci::i_null : soci::i_ok;
+	dbSession.executePreparedStatement(
+		Statements::key(Statements::InsertSipAddress), Statements::get(Statements::InsertSipAddress, q->getBackend()),
+		[&sipAddress, &displayName, &displayNameIndicator](soci::statement &statement) {
+			statement.exchange(soci::use(sipAddress));
+			statement.exchange(soci::use(displayName, displayNameIndicator));
+		}
+	);
+
+	const long long sipAddressId = dbSession.getLastInsertId();
+	sipAddressIdCache.insert(sipAddress, sipAddressId);
+	hasUncommittedInternedIds = true;
+	return sipAddressId;
 #else
 	return -1;
 #endif
@@ -353,45 +381,88 @@ long long MainDbPrivate::insertSipAddress (const string &sipAddress) {
 
 void MainDbPrivate::insertContent (long long chatMessageId, const Content &content) {
 #ifdef HAVE_DB_STORAGE
-	soci::session *session = dbSession.getBackendSession();
+	L_Q();
 
 	const long long &contentTypeId = insertContentType(content.getContentType().getMediaType());
+
 	const string &body = content.getBodyAsUtf8String();
-	*session << "INSERT INTO chat_message_content (event_id, content_type_id, body, body_encoding_type) VALUES"
-		" (:chatMessageId, :contentTypeId, :body, 1)",
-		soci::use(chatMessageId), soci::use(contentTypeId), soci::use(body);
+	dbSession.executePreparedStatement(
+		Statements::key(Statements::InsertChatMessageContent), Statements::get(Statements::InsertChatMessageContent, q->getBackend()),
+		[&chatMessageId, &contentTypeId, &body](soci::statement &statement) {
+			statement.exchange(soci::use(chatMessageId));
+			statement.exchange(soci::use(contentTypeId));
+			statement.exchange(soci::use(body));
+		}
+	);
 
 	const long long &chatMessageContentId = dbSession.getLastInsertId();
 	if (content.isFile()) {
 		const FileContent &fileContent = static_cast<const FileContent &>(content);
-		const string &name = fileContent.getFileName();
-		const size_t &size = fileContent.getFileSize();
-		const string &path = fileContent.getFilePath();
-		int duration = fileContent.getFileDuration();
-		*session << "INSERT INTO chat_message_file_content (chat_message_content_id, name, size, path, duration) VALUES"
-			" (:chatMessageContentId, :name, :size, :path, :duration)",
-			soci::use(chatMessageContentId), soci::use(name), soci::use(size), soci::use(path), soci::use(duration);
+		const string &fileName = fileContent.getFileName();
+		const size_t &fileSize = fileContent.getFileSize();
+		const string &filePath = fileContent.getFilePath();
+		const int &fileDuration = fileContent.getFileDuration();
+		dbSession.executePreparedStatement(
+			Statements::key(Statements::InsertChatMessageFileContent), Statements::get(Statements::InsertChatMessageFileContent, q->getBackend()),
+			[&chatMessageContentId, &fileName, &fileSize, &filePath, &fileDuration](soci::statement &statement) {
+				statement.exchange(soci::use(chatMessageContentId));
+				statement.exchange(soci::use(fileName));
+				statement.exchange(soci::use(fileSize));
+				statement.exchange(soci::use(filePath));
+				statement.exchange(soci::use(fileDuration));
+			}
+		);
 	}
 
-	for (const auto &appData : content.getAppDataMap())
-		*session << "INSERT INTO chat_message_content_app_data (chat_message_content_id, name, data) VALUES"
-			" (:chatMessageContentId, :name, :data)",
-			soci::use(chatMessageContentId), soci::use(appData.first), soci::use(appData.second);
+	for (const auto &appData : content.getAppDataMap()) {
+		dbSession.executePreparedStatement(
+			Statements::key(Statements::InsertChatMessageContentAppData),
+			Statements::get(Statements::InsertChatMessageContentAppData, q->getBackend()),
+			[&chatMessageContentId, &appData](soci::statement &statement) {
+				statement.exchange(soci::use(chatMessageContentId));
+				statement.exchange(soci::use(appData.first));
+				statement.exchange(soci::use(appData.second));
+			}
+		);
+	}
 #endif
 }
 
 long long MainDbPrivate::insertContentType (const string &contentType) {
 #ifdef HAVE_DB_STORAGE
-	soci::session *session = dbSession.getBackendSession();
+	L_Q();
 
-	long long contentTypeId;
-	*session << "SELECT id FROM content_type WHERE value = :contentType", soci::use(contentType), soci::into(contentTypeId);
-	if (session->got_data())
+	const long long *cachedId = contentTypeIdCache[contentType];
+	if (cachedId) {
+		++contentTypeIdCacheStats.hits;
+		return *cachedId;
+	}
+	++contentTypeIdCacheStats.misses;
+
+	long long contentTypeId = -1;
+	if (dbSession.executePreparedStatement(
+		Statements::key(Statements::SelectContentTypeId), Statements::get(Statements::SelectContentTypeId),
+		[&contentType, &contentTypeId](soci::statement &statement) {
+			statement.exchange(soci::use(contentType));
+			statement.exchange(soci::into(contentTypeId));
+		}
+	)) {
+		contentTypeIdCache.insert(contentType, contentTypeId);
 		return contentTypeId;
+	}
 
 	lInfo() << "Insert new content type in database: `" << contentType << "`.";
-	*session << "INSERT INTO content_type (value) VALUES (:contentType)", soci::use(contentType);
-	return dbSession.getLastInsertId();
+	dbSession.executePreparedStatement(
+		Statements::key(Statements::InsertContentType), Statements::get(Statements::InsertContentType, q->getBackend()),
+		[&contentType](soci::statement &statement) {
+			statement.exchange(soci::use(contentType));
+		}
+	);
+
+	contentTypeId = dbSession.getLastInsertId();
+	contentTypeIdCache.insert(contentType, contentTypeId);
+	hasUncommittedInternedIds = true;
+	return contentTypeId;
 #else
 	return -1;
 #endif
@@ -558,10 +629,16 @@ void MainDbPrivate::insertChatMessageParticipant (long long chatMessageId, long
 	L_Q();
 	if (q->isInitialized()) {
 		const tm &stateChangeTm = Utils::getTimeTAsTm(stateChangeTime);
-		*dbSession.getBackendSession() <<
-			"INSERT INTO chat_message_participant (event_id, participant_sip_address_id, state, state_change_time)"
-			" VALUES (:chatMessageId, :sipAddressId, :state, :stateChangeTm)",
-			soci::use(chatMessageId), soci::use(sipAddressId), soci::use(state), soci::use(stateChangeTm);
+		dbSession.executePreparedStatement(
+			Statements::key(Statements::InsertChatMessageParticipant),
+			Statements::get(Statements::InsertChatMessageParticipant, q->getBackend()),
+			[&chatMessageId, &sipAddressId, &state, &stateChangeTm](soci::statement &statement) {
+				statement.exchange(soci::use(chatMessageId));
+				statement.exchange(soci::use(sipAddressId));
+				statement.exchange(soci::use(state));
+				statement.exchange(soci::use(stateChangeTm));
+			}
+		);
 	}
 #endif
 }
@@ -773,13 +850,25 @@ long long MainDbPrivate::insertOrUpdateConferenceCall (const std::shared_ptr<Cal
 
 long long MainDbPrivate::selectSipAddressId (const string &sipAddress) const {
 #ifdef HAVE_DB_STORAGE
-	long long sipAddressId;
-
-	soci::session *session = dbSession.getBackendSession();
-	*session << Statements::get(Statements::SelectSipAddressId),
-		soci::use(sipAddress), soci::into(sipAddressId);
+	const long long *cachedId = sipAddressIdCache[sipAddress];
+	if (cachedId) {
+		++sipAddressIdCacheStats.hits;
+		return *cachedId;
+	}
+	++sipAddressIdCacheStats.misses;
+
+	long long sipAddressId = -1;
+	if (!dbSession.executePreparedStatement(
+		Statements::key(Statements::SelectSipAddressId), Statements::get(Statements::SelectSipAddressId),
+		[&sipAddress, &sipAddressId](soci::statement &statement) {
+			statement.exchange(soci::use(sipAddress));
+			statement.exchange(soci::into(sipAddressId));
+		}
+	))
+		return -1;
 
-	return session->got_data() ? sipAddressId : -1;
+	sipAddressIdCache.insert(sipAddress, sipAddressId);
+	return sipAddressId;
 #else
 	return -1;
 #endif
@@ -787,13 +876,15 @@ long long MainDbPrivate::selectSipAddressId (const string &sipAddress) const {
 
 long long MainDbPrivate::selectChatRoomId (long long peerSipAddressId, long long localSipAddressId) const {
 #ifdef HAVE_DB_STORAGE
-	long long chatRoomId;
-
-	soci::session *session = dbSession.getBackendSession();
-	*session << Statements::get(Statements::SelectChatRoomId),
-		soci::use(peerSipAddressId), soci::use(localSipAddressId), soci::into(chatRoomId);
-
-	return session->got_data() ? chatRoomId : -1;
+	long long chatRoomId = -1;
+	return dbSession.executePreparedStatement(
+		Statements::key(Statements::SelectChatRoomId), Statements::get(Statements::SelectChatRoomId),
+		[&peerSipAddressId, &localSipAddressId, &chatRoomId](soci::statement &statement) {
+			statement.exchange(soci::use(peerSipAddressId));
+			statement.exchange(soci::use(localSipAddressId));
+			statement.exchange(soci::into(chatRoomId));
+		}
+	) ? chatRoomId : -1;
 #else
 	return -1;
 #endif
@@ -846,13 +937,15 @@ ConferenceId MainDbPrivate::selectConferenceId (const long long chatRoomId) cons
 
 long long MainDbPrivate::selectChatRoomParticipantId (long long chatRoomId, long long participantSipAddressId) const {
 #ifdef HAVE_DB_STORAGE
-	long long chatRoomParticipantId;
-
-	soci::session *session = dbSession.getBackendSession();
-	*session << Statements::get(Statements::SelectChatRoomParticipantId),
-		soci::use(chatRoomId), soci::use(participantSipAddressId), soci::into(chatRoomParticipantId);
-
-	return session->got_data() ? chatRoomParticipantId : -1;
+	long long chatRoomParticipantId = -1;
+	return dbSession.executePreparedStatement(
+		Statements::key(Statements::SelectChatRoomParticipantId), Statements::get(Statements::SelectChatRoomParticipantId),
+		[&chatRoomId, &participantSipAddressId, &chatRoomParticipantId](soci::statement &statement) {
+			statement.exchange(soci::use(chatRoomId));
+			statement.exchange(soci::use(participantSipAddressId));
+			statement.exchange(soci::into(chatRoomParticipantId));
+		}
+	) ? chatRoomParticipantId : -1;
 #else
 	return -1;
 #endif
@@ -1905,6 +1998,188 @@ shared_ptr<ConferenceInfo> MainDbPrivate::selectConferenceInfo (const soci::row
 }
 #endif
 
+// -----------------------------------------------------------------------------
+// Chat rooms API.
+// -----------------------------------------------------------------------------
+
+#ifdef HAVE_DB_STORAGE
+shared_ptr<AbstractChatRoom> MainDbPrivate::selectChatRoom (const soci::row &row) const {
+	L_Q();
+
+	shared_ptr<Core> core = q->getCore();
+
+	ConferenceId conferenceId = ConferenceId(
+		ConferenceAddress(row.get<string>(1)),
+		ConferenceAddress(row.get<string>(2))
+	);
+
+	shared_ptr<AbstractChatRoom> chatRoom = core->getPrivate()->findLoadedChatRoom(conferenceId);
+	if (chatRoom)
+		return chatRoom;
+
+	const long long &dbChatRoomId = dbSession.resolveId(row, 0);
+	cache(conferenceId, dbChatRoomId);
+
+	time_t creationTime = dbSession.getTime(row, 3);
+	time_t lastUpdateTime = dbSession.getTime(row, 4);
+	int capabilities = row.get<int>(5);
+	string subject = row.get<string>(6, "");
+	const long long &lastMessageId = dbSession.resolveId(row, 9);
+
+	shared_ptr<ChatRoomParams> params = ChatRoomParams::fromCapabilities(capabilities);
+	if (capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::Basic)) {
+		chatRoom = core->getPrivate()->createBasicChatRoom(conferenceId, capabilities, params);
+		chatRoom->setUtf8Subject(subject);
+	} else if (capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::Conference)) {
+#ifdef HAVE_ADVANCED_IM
+		soci::session *session = dbSession.getBackendSession();
+		list<shared_ptr<Participant>> participants;
+
+		static const string query = "SELECT chat_room_participant.id, sip_address.value, is_admin"
+			" FROM sip_address, chat_room, chat_room_participant"
+			" WHERE chat_room.id = :chatRoomId"
+			" AND sip_address.id = chat_room_participant.participant_sip_address_id"
+			" AND chat_room_participant.chat_room_id = chat_room.id";
+
+		// Fetch participants.
+		unsigned int lastNotifyId = dbSession.getUnsignedInt(row, 7, 0);
+		soci::rowset<soci::row> rows = (session->prepare << query, soci::use(dbChatRoomId));
+		shared_ptr<Participant> me;
+		for (const auto &row : rows) {
+			shared_ptr<Participant> participant = Participant::create(nullptr, IdentityAddress(row.get<string>(1)));
+			participant->setAdmin(!!row.get<int>(2));
+
+			// Fetch devices.
+			{
+				const long long &participantId = dbSession.resolveId(row, 0);
+				static const string query = "SELECT sip_address.value, state, name FROM chat_room_participant_device, sip_address"
+					" WHERE chat_room_participant_id = :participantId"
+					" AND participant_device_sip_address_id = sip_address.id";
+
+				soci::rowset<soci::row> rows = (session->prepare << query, soci::use(participantId));
+				for (const auto &row : rows) {
+					shared_ptr<ParticipantDevice> device = participant->addDevice(IdentityAddress(row.get<string>(0)), row.get<string>(2, ""));
+					device->setState(ParticipantDevice::State(static_cast<unsigned int>(row.get<int>(1, 0))));
+				}
+			}
+
+			if (participant->getAddress() == conferenceId.getLocalAddress().getAddressWithoutGruu())
+				me = participant;
+			else
+				participants.push_back(participant);
+		}
+
+		Conference *conference = nullptr;
+		if (!linphone_core_conference_server_enabled(core->getCCore())) {
+			bool hasBeenLeft = !!row.get<int>(8, 0);
+			if (!me) {
+				lError() << "Unable to find me in: (peer=" + conferenceId.getPeerAddress().asString() +
+					", local=" + conferenceId.getLocalAddress().asString() + ").";
+				return nullptr;
+			}
+			shared_ptr<ClientGroupChatRoom> clientGroupChatRoom(new ClientGroupChatRoom(
+				core,
+				conferenceId,
+				me,
+				capabilities,
+				params,
+				Utils::utf8ToLocale(subject),
+				move(participants),
+				lastNotifyId,
+				hasBeenLeft
+			));
+			chatRoom = clientGroupChatRoom;
+			conference = clientGroupChatRoom->getConference().get();
+			chatRoom->setState(ConferenceInterface::State::Instantiated);
+			chatRoom->enableEphemeral(!!row.get<int>(10, 0), false);
+			chatRoom->setEphemeralLifetime((long)row.get<double>(11), false);
+			chatRoom->setState(hasBeenLeft
+				? ConferenceInterface::State::Terminated
+				: ConferenceInterface::State::Created
+			);
+
+			if (capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::OneToOne)) {
+				// TODO: load previous IDs if any
+				static const string query = "SELECT sip_address.value FROM one_to_one_chat_room_previous_conference_id, sip_address"
+					" WHERE chat_room_id = :chatRoomId"
+					" AND sip_address_id = sip_address.id";
+				soci::rowset<soci::row> rows = (session->prepare << query, soci::use(dbChatRoomId));
+				for (const auto &row : rows) {
+					ConferenceId previousId = ConferenceId(ConferenceAddress(row.get<string>(0)), conferenceId.getLocalAddress());
+					if (previousId != conferenceId) {
+						lInfo() << "Keeping around previous chat room ID [" << previousId << "] in case BYE is received for exhumed chat room [" << conferenceId << "]";
+						clientGroupChatRoom->getPrivate()->addConferenceIdToPreviousList(previousId);
+					}
+				}
+			}
+
+		} else {
+			auto serverGroupChatRoom = std::make_shared<ServerGroupChatRoom>(
+				core,
+				conferenceId.getPeerAddress(),
+				capabilities,
+				params,
+				subject,
+				move(participants),
+				lastNotifyId
+			);
+			chatRoom = serverGroupChatRoom;
+			conference = serverGroupChatRoom->getConference().get();
+			chatRoom->setState(ConferenceInterface::State::Instantiated);
+			chatRoom->enableEphemeral(!!row.get<int>(10, 0), false);
+			chatRoom->setEphemeralLifetime((long)row.get<double>(11), false);
+			chatRoom->setState(ConferenceInterface::State::Created);
+		}
+		for (auto participant : chatRoom->getParticipants())
+			participant->setConference(conference);
+#else
+		lWarning() << "Advanced IM such as group chat is disabled!";
+#endif
+	}
+
+	if (!chatRoom)
+		return nullptr; // Not fetched.
+
+	AbstractChatRoomPrivate *dChatRoom = chatRoom->getPrivate();
+	dChatRoom->setCreationTime(creationTime);
+	dChatRoom->setLastUpdateTime(lastUpdateTime);
+	dChatRoom->setIsEmpty(lastMessageId == 0);
+
+	lDebug() << "Found chat room in DB: (peer=" <<
+		conferenceId.getPeerAddress().asString() << ", local=" << conferenceId.getLocalAddress().asString() << ").";
+
+	return chatRoom;
+}
+
+list<shared_ptr<AbstractChatRoom>> MainDbPrivate::selectChatRooms (const string &condition, int offset, int limit) const {
+	string query = "SELECT chat_room.id, peer_sip_address.value, local_sip_address.value,"
+		" creation_time, last_update_time, capabilities, subject, last_notify_id, flags, last_message_id,"
+		" ephemeral_enabled, ephemeral_messages_lifetime"
+		" FROM chat_room, sip_address AS peer_sip_address, sip_address AS local_sip_address"
+		" WHERE chat_room.peer_sip_address_id = peer_sip_address.id AND chat_room.local_sip_address_id = local_sip_address.id";
+	query += condition;
+	query += " ORDER BY last_update_time DESC";
+
+	if (limit > 0)
+		query += " LIMIT " + Utils::toString(limit);
+	else if (offset > 0)
+		query += " LIMIT " + dbSession.noLimitValue();
+
+	if (offset > 0)
+		query += " OFFSET " + Utils::toString(offset);
+
+	list<shared_ptr<AbstractChatRoom>> chatRooms;
+	soci::rowset<soci::row> rows = (dbSession.getBackendSession()->prepare << query);
+	for (const auto &row : rows) {
+		shared_ptr<AbstractChatRoom> chatRoom = selectChatRoom(row);
+		if (chatRoom)
+			chatRooms.push_back(chatRoom);
+	}
+
+	return chatRooms;
+}
+#endif
+
 // -----------------------------------------------------------------------------
 // Cache API.
 // -----------------------------------------------------------------------------
@@ -2039,6 +2314,125 @@ void MainDbPrivate::invalidConferenceEventsFromQuery (const string &query, long
 #endif
 }
 
+// -----------------------------------------------------------------------------
+// Write-behind API.
+// -----------------------------------------------------------------------------
+
+void MainDbPrivate::openWriteBehindBatch () {
+#ifdef HAVE_DB_STORAGE
+	// The batch can't be opened inside a running transaction.
+	if (!writeBehindEnabled || writeBehindBatchOpened || isTransactionOpened())
+		return;
+
+	lDebug() << "Open write-behind batch in MainDb.";
+	try {
+		dbSession.getBackendSession()->begin();
+		writeBehindBatchOpened = true;
+	} catch (const exception &e) {
+		lError() << "Unable to open MainDb write-behind batch: `" << e.what() << "`.";
+	}
+#endif
+}
+
+void MainDbPrivate::stageEventUpdate (const shared_ptr<EventLog> &eventLog) {
+#ifdef HAVE_DB_STORAGE
+	const EventLogPrivate *dEventLog = eventLog->getPrivate();
+	const long long &storageId = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate()->storageId;
+
+	openWriteBehindBatch();
+	if (stagedEventUpdateIds.insert(storageId).second)
+		stagedEventUpdates.push_back(eventLog);
+	else
+		++writeBehindCoalescedUpdates;
+
+	notifyWriteBehindWrite();
+#endif
+}
+
+void MainDbPrivate::applyStagedEventUpdates () {
+#ifdef HAVE_DB_STORAGE
+	if (stagedEventUpdates.empty())
+		return;
+
+	// Detach the staged updates first: a failing update must not be replayed on each transaction.
+	list<shared_ptr<EventLog>> eventLogs;
+	eventLogs.swap(stagedEventUpdates);
+	stagedEventUpdateIds.clear();
+
+	try {
+		SmartTransaction tr(dbSession.getBackendSession(), __func__, getSavepointLevel());
+		for (const auto &eventLog : eventLogs) {
+			if (eventLog->getPrivate()->dbKey.isValid())
+				updateConferenceChatMessageEvent(eventLog);
+		}
+		tr.commit();
+		endInterningTransaction(true);
+	} catch (const exception &e) {
+		lError() << "Unable to apply " << eventLogs.size() << " staged event update(s) in MainDb: `" << e.what() << "`.";
+		endInterningTransaction(false);
+	}
+#endif
+}
+
+void MainDbPrivate::notifyWriteBehindWrite () {
+#ifdef HAVE_DB_STORAGE
+	L_Q();
+
+	if (!writeBehindBatchOpened)
+		return;
+
+	if (++writeBehindPendingWrites >= writeBehindMaxPendingWrites && !isTransactionOpened()) {
+		q->flushPendingEvents();
+		return;
+	}
+
+	if (!writeBehindTimer)
+		writeBehindTimer = q->getCore()->createTimer([this]() -> bool {
+			L_Q();
+			q->flushPendingEvents();
+			return false; // BELLE_SIP_STOP
+		}, (unsigned int)writeBehindFlushDelay, "MainDb write-behind flush");
+#endif
+}
+
+void MainDbPrivate::discardWriteBehindBatch () {
+#ifdef HAVE_DB_STORAGE
+	if (!writeBehindBatchOpened)
+		return;
+
+	lError() << "Write-behind batch of " << writeBehindPendingWrites << " write(s) lost by MainDb.";
+	writeBehindBatchOpened = false;
+	writeBehindPendingWrites = 0;
+	writeBehindCoalescedUpdates = 0;
+	stagedEventUpdates.clear();
+	stagedEventUpdateIds.clear();
+
+	// Ids interned during the batch may have been lost with it.
+	invalidateInternedIds();
+#endif
+}
+
+// -----------------------------------------------------------------------------
+// Interning API.
+// -----------------------------------------------------------------------------
+
+void MainDbPrivate::endInterningTransaction (bool committed) {
+	if (!hasUncommittedInternedIds)
+		return;
+
+	if (!committed)
+		invalidateInternedIds();
+	// Nested in a write-behind batch or in another transaction, ids are only committed with it.
+	else if (getSavepointLevel() == 0)
+		hasUncommittedInternedIds = false;
+}
+
+void MainDbPrivate::invalidateInternedIds () {
+	sipAddressIdCache.clear();
+	contentTypeIdCache.clear();
+	hasUncommittedInternedIds = false;
+}
+
 // -----------------------------------------------------------------------------
 // Versions.
 // -----------------------------------------------------------------------------
@@ -2264,6 +2658,11 @@ void MainDbPrivate::updateSchema () {
 		*session << "ALTER TABLE conference_info_participant ADD COLUMN params VARCHAR(2048) DEFAULT ''";
 	}
 
+	if (version < makeVersion(1, 0, 21)) {
+		// Ephemeral messages are loaded by pages in expiry order.
+		*session << "CREATE INDEX ephemeral_expired_time_index ON chat_message_ephemeral_event (expired_time)";
+	}
+
 	// /!\ Warning : if varchar columns < 255 were to be indexed, their size must be set back to 191 = max indexable (KEY or UNIQUE) varchar size for mysql < 5.7 with charset utf8mb4 (both here and in column creation)
 
 #endif
@@ -3145,9 +3544,10 @@ bool MainDb::addEvent (const shared_ptr<EventLog> &eventLog) {
 		return false;
 	}
 
-	return L_DB_TRANSACTION {
-		L_D();
+	L_D();
+	d->openWriteBehindBatch();
 
+	const bool added = L_DB_TRANSACTION {
 		long long eventId = -1;
 
 		EventLog::Type type = eventLog->getType();
@@ -3219,6 +3619,10 @@ bool MainDb::addEvent (const shared_ptr<EventLog> &eventLog) {
 		lError() << "MainDb::addEvent() of type " << type << " failed.";
 		return false;
 	};
+
+	if (added)
+		d->notifyWriteBehindWrite();
+	return added;
 #else
 	return false;
 #endif
@@ -3231,9 +3635,13 @@ bool MainDb::updateEvent (const shared_ptr<EventLog> &eventLog) {
 		return false;
 	}
 
-	return L_DB_TRANSACTION {
-		L_D();
+	L_D();
+	if (d->writeBehindEnabled && eventLog->getType() == EventLog::Type::ConferenceChatMessage) {
+		d->stageEventUpdate(eventLog);
+		return true;
+	}
 
+	return L_DB_TRANSACTION {
 		switch (eventLog->getType()) {
 			case EventLog::Type::None:
 				return false;
@@ -3326,6 +3734,68 @@ bool MainDb::deleteEvent (const shared_ptr<const EventLog> &eventLog) {
 #endif
 }
 
+bool MainDb::deleteEvents (const list<shared_ptr<EventLog>> &eventLogs) {
+#ifdef HAVE_DB_STORAGE
+	list<shared_ptr<EventLog>> validEventLogs;
+	for (const auto &eventLog : eventLogs) {
+		if (eventLog->getPrivate()->dbKey.isValid())
+			validEventLogs.push_back(eventLog);
+		else
+			lWarning() << "Unable to delete invalid event.";
+	}
+	if (validEventLogs.empty())
+		return false;
+
+	return L_DB_TRANSACTION {
+		L_D();
+
+		soci::session *session = d->dbSession.getBackendSession();
+		string ids;
+		unordered_set<long long> dbChatRoomIds;
+		for (const auto &eventLog : validEventLogs) {
+			const EventLogPrivate *dEventLog = eventLog->getPrivate();
+			MainDbKeyPrivate *dEventKey = static_cast<MainDbKey &>(dEventLog->dbKey).getPrivate();
+			if (!ids.empty())
+				ids += ",";
+			ids += Utils::toString(dEventKey->storageId);
+
+			if (eventLog->getType() == EventLog::Type::ConferenceChatMessage) {
+				shared_ptr<AbstractChatRoom> chatRoom(static_pointer_cast<ConferenceChatMessageEvent>(eventLog)->getChatMessage()->getChatRoom());
+				if (chatRoom)
+					dbChatRoomIds.insert(d->selectChatRoomId(chatRoom->getConferenceId()));
+			}
+		}
+		*session << "DELETE FROM event WHERE id IN (" + ids + ")";
+
+		// Update the last message of each chat room once.
+		for (const long long &dbChatRoomId : dbChatRoomIds)
+			*session << "UPDATE chat_room SET last_message_id = IFNULL((SELECT id FROM conference_event_simple_view WHERE chat_room_id = chat_room.id AND type = " << mapEventFilterToSql(ConferenceChatMessageFilter) << " ORDER BY id DESC LIMIT 1), 0) WHERE id = :1", soci::use(dbChatRoomId);
+
+		tr.commit();
+
+		for (const auto &eventLog : validEventLogs) {
+			// Reset storage ID as event is not valid anymore
+			eventLog->getPrivate()->resetStorageId();
+
+			if (eventLog->getType() == EventLog::Type::ConferenceChatMessage) {
+				shared_ptr<ChatMessage> chatMessage(static_pointer_cast<ConferenceChatMessageEvent>(eventLog)->getChatMessage());
+				chatMessage->getPrivate()->resetStorageId();
+				shared_ptr<AbstractChatRoom> chatRoom(chatMessage->getChatRoom());
+				if (chatRoom && chatMessage->getDirection() == ChatMessage::Direction::Incoming && !chatMessage->getPrivate()->isMarkedAsRead()) {
+					int *count = d->unreadChatMessageCountCache[chatRoom->getConferenceId()];
+					if (count)
+						--*count;
+				}
+			}
+		}
+
+		return true;
+	};
+#else
+	return false;
+#endif
+}
+
 int MainDb::getEventCount (FilterMask mask) const {
 #ifdef HAVE_DB_STORAGE
 	const string query = "SELECT COUNT(*) FROM event" +
@@ -3468,6 +3938,9 @@ int MainDb::getUnreadChatMessageCount (const ConferenceId &conferenceId) const {
 #ifdef HAVE_DB_STORAGE
 	L_D();
 
+	// Staged updates can change the cached counts.
+	const_cast<MainDbPrivate *>(d)->applyStagedEventUpdates();
+
 	if (conferenceId.isValid()) {
 		const int *count = d->unreadChatMessageCountCache[conferenceId];
 		if (count)
@@ -3628,28 +4101,33 @@ list<shared_ptr<ChatMessage>> MainDb::getUnreadChatMessages (const ConferenceId
 #endif
 }
 
-list<shared_ptr<ChatMessage>> MainDb::getEphemeralMessages () const {
+list<shared_ptr<EventLog>> MainDb::getEphemeralMessageEvents (int maxCount) const {
 #ifdef HAVE_DB_STORAGE
 	// Keep chat_room_id at the end of the query !!!
-	string query =
+	// The page is selected in a derived table, MySQL doesn't support LIMIT in IN subqueries.
+	static const string query =
 		"SELECT conference_event_view.id, type, creation_time, from_sip_address.value, to_sip_address.value, time, imdn_message_id, state, direction, is_secured, notify_id, device_sip_address.value, participant_sip_address.value, subject, delivery_notification_required, display_notification_required, security_alert, faulty_device, marked_as_read, forward_info, ephemeral_lifetime, expired_time, lifetime, reply_message_id, reply_sender_address.value, chat_room_id"
 		" FROM conference_event_view"
+		" JOIN ("
+		"  SELECT event_id"
+		"  FROM chat_message_ephemeral_event"
+		"  WHERE expired_time > :nullTime"
+		"  ORDER BY expired_time ASC"
+		"  LIMIT :maxCount"
+		" ) AS ephemeral_page ON ephemeral_page.event_id = conference_event_view.id"
 		" LEFT JOIN sip_address AS from_sip_address ON from_sip_address.id = from_sip_address_id"
 		" LEFT JOIN sip_address AS to_sip_address ON to_sip_address.id = to_sip_address_id"
 		" LEFT JOIN sip_address AS device_sip_address ON device_sip_address.id = device_sip_address_id"
 		" LEFT JOIN sip_address AS participant_sip_address ON participant_sip_address.id = participant_sip_address_id"
 		" LEFT JOIN sip_address AS reply_sender_address ON reply_sender_address.id = reply_sender_address_id"
-		" WHERE conference_event_view.id in ("
-		" SELECT event_id"
-		" FROM chat_message_ephemeral_event"
-		" WHERE expired_time > :nullTime"
 		" ORDER BY expired_time ASC";
-	query += getBackend() == MainDb::Backend::Sqlite3 ? " LIMIT :maxMessages) ORDER BY expired_time ASC" : " ) ORDER BY expired_time ASC";
 
 	return L_DB_TRANSACTION {
 		L_D();
-		list<shared_ptr<ChatMessage>> chatMessages;
-		soci::rowset<soci::row> rows = getBackend() == MainDb::Backend::Sqlite3 ? (d->dbSession.getBackendSession()->prepare << query, soci::use(Utils::getTimeTAsTm(0)),  soci::use(EPHEMERAL_MESSAGE_TASKS_MAX_NB)) : (d->dbSession.getBackendSession()->prepare << query, soci::use(Utils::getTimeTAsTm(0)));
+		list<shared_ptr<EventLog>> events;
+		soci::rowset<soci::row> rows = (d->dbSession.getBackendSession()->prepare << query,
+			soci::use(Utils::getTimeTAsTm(0)), soci::use(maxCount)
+		);
 		for (const auto &row : rows) {
 			const long long &dbChatRoomId = d->dbSession.resolveId(row, (int)row.size()-1);
 			ConferenceId conferenceId = d->getConferenceIdFromCache(dbChatRoomId);
@@ -3663,15 +4141,15 @@ list<shared_ptr<ChatMessage>> MainDb::getEphemeralMessages () const {
 					shared_ptr<EventLog> event = d->selectGenericConferenceEvent(chatRoom, row);
 					if (event) {
 						L_ASSERT(event->getType() == EventLog::Type::ConferenceChatMessage);
-						chatMessages.push_back(static_pointer_cast<ConferenceChatMessageEvent>(event)->getChatMessage());
+						events.push_back(event);
 					}
 				}
 			}
 		}
-		return chatMessages;
+		return events;
 	};
 #else
-	return list<shared_ptr<ChatMessage>>();
+	return list<shared_ptr<EventLog>>();
 #endif
 }
 
@@ -4283,176 +4761,100 @@ void MainDb::disableDisplayNotificationRequired (const std::shared_ptr<const Eve
 // -----------------------------------------------------------------------------
 
 list<shared_ptr<AbstractChatRoom>> MainDb::getChatRooms () const {
-#ifdef HAVE_DB_STORAGE
-	static const string query = "SELECT chat_room.id, peer_sip_address.value, local_sip_address.value,"
-		" creation_time, last_update_time, capabilities, subject, last_notify_id, flags, last_message_id,"
-		" ephemeral_enabled, ephemeral_messages_lifetime"
-		" FROM chat_room, sip_address AS peer_sip_address, sip_address AS local_sip_address"
-		" WHERE chat_room.peer_sip_address_id = peer_sip_address.id AND chat_room.local_sip_address_id = local_sip_address.id"
-		" ORDER BY last_update_time DESC";
+	return getChatRooms(0, -1);
+}
 
-	DurationLogger durationLogger("Get chat rooms.");
+list<shared_ptr<AbstractChatRoom>> MainDb::getChatRooms (int offset, int limit) const {
+#ifdef HAVE_DB_STORAGE
+	DurationLogger durationLogger(
+		"Get chat rooms (offset=" + Utils::toString(offset) + ", limit=" + Utils::toString(limit) + ")."
+	);
 
 	return L_DB_TRANSACTION {
 		L_D();
 
-		list<shared_ptr<AbstractChatRoom>> chatRooms;
-		shared_ptr<Core> core = getCore();
-
-		soci::session *session = d->dbSession.getBackendSession();
-
-		soci::rowset<soci::row> rows = (session->prepare << query);
-		for (const auto &row : rows) {
-			ConferenceId conferenceId = ConferenceId(
-				ConferenceAddress(row.get<string>(1)),
-				ConferenceAddress(row.get<string>(2))
-			);
-
-			shared_ptr<AbstractChatRoom> chatRoom = core->findChatRoom(conferenceId, false);
-			if (chatRoom) {
-				chatRooms.push_back(chatRoom);
-				continue;
-			}
-
-			const long long &dbChatRoomId = d->dbSession.resolveId(row, 0);
-			d->cache(conferenceId, dbChatRoomId);
-
-			time_t creationTime = d->dbSession.getTime(row, 3);
-			time_t lastUpdateTime = d->dbSession.getTime(row, 4);
-			int capabilities = row.get<int>(5);
-			string subject = row.get<string>(6, "");
-			const long long &lastMessageId = d->dbSession.resolveId(row, 9);
-
-			shared_ptr<ChatRoomParams> params = ChatRoomParams::fromCapabilities(capabilities);
-			if (capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::Basic)) {
-				chatRoom = core->getPrivate()->createBasicChatRoom(conferenceId, capabilities, params);
-				chatRoom->setUtf8Subject(subject);
-			} else if (capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::Conference)) {
-#ifdef HAVE_ADVANCED_IM
-				list<shared_ptr<Participant>> participants;
-
-				static const string query = "SELECT chat_room_participant.id, sip_address.value, is_admin"
-					" FROM sip_address, chat_room, chat_room_participant"
-					" WHERE chat_room.id = :chatRoomId"
-					" AND sip_address.id = chat_room_participant.participant_sip_address_id"
-					" AND chat_room_participant.chat_room_id = chat_room.id";
-
-				// Fetch participants.
-				unsigned int lastNotifyId = d->dbSession.getUnsignedInt(row, 7, 0);
-				soci::rowset<soci::row> rows = (session->prepare << query, soci::use(dbChatRoomId));
-				shared_ptr<Participant> me;
-				for (const auto &row : rows) {
-					shared_ptr<Participant> participant = Participant::create(nullptr, IdentityAddress(row.get<string>(1)));
-					participant->setAdmin(!!row.get<int>(2));
-
-					// Fetch devices.
-					{
-						const long long &participantId = d->dbSession.resolveId(row, 0);
-						static const string query = "SELECT sip_address.value, state, name FROM chat_room_participant_device, sip_address"
-							" WHERE chat_room_participant_id = :participantId"
-							" AND participant_device_sip_address_id = sip_address.id";
-
-						soci::rowset<soci::row> rows = (session->prepare << query, soci::use(participantId));
-						for (const auto &row : rows) {
-							shared_ptr<ParticipantDevice> device = participant->addDevice(IdentityAddress(row.get<string>(0)), row.get<string>(2, ""));
-							device->setState(ParticipantDevice::State(static_cast<unsigned int>(row.get<int>(1, 0))));
-						}
-					}
+		list<shared_ptr<AbstractChatRoom>> chatRooms = d->selectChatRooms("", offset, limit);
+		tr.commit();
+		return chatRooms;
+	};
+#else
+	return list<shared_ptr<AbstractChatRoom>>();
+#endif
+}
 
-					if (participant->getAddress() == conferenceId.getLocalAddress().getAddressWithoutGruu())
-						me = participant;
-					else
-						participants.push_back(participant);
-				}
+shared_ptr<AbstractChatRoom> MainDb::getChatRoom (const ConferenceId &conferenceId) const {
+#ifdef HAVE_DB_STORAGE
+	return L_DB_TRANSACTION {
+		L_D();
 
-				Conference *conference = nullptr;
-				if (!linphone_core_conference_server_enabled(core->getCCore())) {
-					bool hasBeenLeft = !!row.get<int>(8, 0);
-					if (!me) {
-						lError() << "Unable to find me in: (peer=" + conferenceId.getPeerAddress().asString() +
-							", local=" + conferenceId.getLocalAddress().asString() + ").";
-						continue;
-					}
-					shared_ptr<ClientGroupChatRoom> clientGroupChatRoom(new ClientGroupChatRoom(
-						core,
-						conferenceId,
-						me,
-						capabilities,
-						params,
-						Utils::utf8ToLocale(subject),
-						move(participants),
-						lastNotifyId,
-						hasBeenLeft
-					));
-					chatRoom = clientGroupChatRoom;
-					conference = clientGroupChatRoom->getConference().get();
-					chatRoom->setState(ConferenceInterface::State::Instantiated);
-					chatRoom->enableEphemeral(!!row.get<int>(10, 0), false);
-					chatRoom->setEphemeralLifetime((long)row.get<double>(11), false);
-					chatRoom->setState(hasBeenLeft
-						? ConferenceInterface::State::Terminated
-						: ConferenceInterface::State::Created
-					);
-
-					if (capabilities & ChatRoom::CapabilitiesMask(ChatRoom::Capabilities::OneToOne)) {
-						// TODO: load previous IDs if any
-						static const string query = "SELECT sip_address.value FROM one_to_one_chat_room_previous_conference_id, sip_address"
-							" WHERE chat_room_id = :chatRoomId"
-							" AND sip_address_id = sip_address.id";
-						soci::rowset<soci::row> rows = (session->prepare << query, soci::use(dbChatRoomId));
-						for (const auto &row : rows) {
-							ConferenceId previousId = ConferenceId(ConferenceAddress(row.get<string>(0)), conferenceId.getLocalAddress());
-							if (previousId != conferenceId) {
-								lInfo() << "Keeping around previous chat room ID [" << previousId << "] in case BYE is received for exhumed chat room [" << conferenceId << "]";
-								clientGroupChatRoom->getPrivate()->addConferenceIdToPreviousList(previousId);
-							}
-						}
-					}
+		const long long &dbChatRoomId = d->selectChatRoomId(conferenceId);
+		if (dbChatRoomId < 0)
+			return shared_ptr<AbstractChatRoom>();
 
-				} else {
-					auto serverGroupChatRoom = std::make_shared<ServerGroupChatRoom>(
-						core,
-						conferenceId.getPeerAddress(),
-						capabilities,
-						params,
-						subject,
-						move(participants),
-						lastNotifyId
-					);
-					chatRoom = serverGroupChatRoom;
-					conference = serverGroupChatRoom->getConference().get();
-					chatRoom->setState(ConferenceInterface::State::Instantiated);
-					chatRoom->enableEphemeral(!!row.get<int>(10, 0), false);
-					chatRoom->setEphemeralLifetime((long)row.get<double>(11), false);
-					chatRoom->setState(ConferenceInterface::State::Created);
-				}
-				for (auto participant : chatRoom->getParticipants())
-					participant->setConference(conference);
+		list<shared_ptr<AbstractChatRoom>> chatRooms = d->selectChatRooms(
+			" AND chat_room.id = " + Utils::toString(dbChatRoomId), 0, -1
+		);
+		tr.commit();
+		return chatRooms.empty() ? shared_ptr<AbstractChatRoom>() : chatRooms.front();
+	};
 #else
-				lWarning() << "Advanced IM such as group chat is disabled!";
+	return nullptr;
 #endif
-			}
+}
 
-			if (!chatRoom)
-				continue; // Not fetched.
+list<MainDb::ChatRoomDescriptor> MainDb::getChatRoomDescriptors (int offset, int limit) const {
+#ifdef HAVE_DB_STORAGE
+	L_D();
 
-			AbstractChatRoomPrivate *dChatRoom = chatRoom->getPrivate();
-			dChatRoom->setCreationTime(creationTime);
-			dChatRoom->setLastUpdateTime(lastUpdateTime);
-			dChatRoom->setIsEmpty(lastMessageId == 0);
+	string query = "SELECT chat_room.id, peer_sip_address.value, local_sip_address.value,"
+		" creation_time, last_update_time, capabilities, subject, last_message_id, flags,"
+		"  (SELECT COUNT(*) FROM conference_event, conference_chat_message_event"
+		"   WHERE conference_event.chat_room_id = chat_room.id"
+		"   AND conference_chat_message_event.event_id = conference_event.event_id"
+		"   AND marked_as_read = 0)"
+		" FROM chat_room, sip_address AS peer_sip_address, sip_address AS local_sip_address"
+		" WHERE chat_room.peer_sip_address_id = peer_sip_address.id AND chat_room.local_sip_address_id = local_sip_address.id"
+		" ORDER BY last_update_time DESC";
 
-			lDebug() << "Found chat room in DB: (peer=" <<
-				conferenceId.getPeerAddress().asString() << ", local=" << conferenceId.getLocalAddress().asString() << ").";
+	if (limit > 0)
+		query += " LIMIT " + Utils::toString(limit);
+	else if (offset > 0)
+		query += " LIMIT " + d->dbSession.noLimitValue();
 
-			chatRooms.push_back(chatRoom);
+	if (offset > 0)
+		query += " OFFSET " + Utils::toString(offset);
+
+	DurationLogger durationLogger("Get chat room descriptors.");
+
+	return L_DB_TRANSACTION {
+		list<ChatRoomDescriptor> descriptors;
+		soci::rowset<soci::row> rows = (d->dbSession.getBackendSession()->prepare << query);
+		for (const auto &row : rows) {
+			ChatRoomDescriptor descriptor;
+			descriptor.storageId = d->dbSession.resolveId(row, 0);
+			descriptor.conferenceId = ConferenceId(
+				ConferenceAddress(row.get<string>(1)),
+				ConferenceAddress(row.get<string>(2))
+			);
+			descriptor.creationTime = d->dbSession.getTime(row, 3);
+			descriptor.lastUpdateTime = d->dbSession.getTime(row, 4);
+			descriptor.capabilities = row.get<int>(5);
+			descriptor.subject = row.get<string>(6, "");
+			descriptor.isEmpty = d->dbSession.resolveId(row, 7) == 0;
+			descriptor.hasBeenLeft = !!row.get<int>(8, 0);
+			descriptor.unreadChatMessageCount = getCountFromRow(row, 9);
+
+			d->cache(descriptor.conferenceId, descriptor.storageId);
+			d->unreadChatMessageCountCache.insert(descriptor.conferenceId, descriptor.unreadChatMessageCount);
+
+			descriptors.push_back(move(descriptor));
 		}
 
 		tr.commit();
-
-		return chatRooms;
+		return descriptors;
 	};
 #else
-	return list<shared_ptr<AbstractChatRoom>>();
+	return list<ChatRoomDescriptor>();
 #endif
 }
 
@@ -4531,6 +4933,7 @@ void MainDb::deleteChatRoom (const ConferenceId &conferenceId) {
 
 		tr.commit();
 		d->unreadChatMessageCountCache.insert(conferenceId, 0);
+		d->invalidateInternedIds();
 	};
 #endif
 }
@@ -5216,6 +5619,98 @@ int MainDb::getCallHistorySize () {
 
 // -----------------------------------------------------------------------------
 
+void MainDb::enableWriteBehind (bool enable, int flushDelay, int maxPendingWrites) {
+#ifdef HAVE_DB_STORAGE
+	L_D();
+
+	if (!enable)
+		flushPendingEvents();
+
+	d->writeBehindEnabled = enable;
+	d->writeBehindFlushDelay = max(flushDelay, 0);
+	d->writeBehindMaxPendingWrites = max(maxPendingWrites, 1);
+	lInfo() << "MainDb write-behind " << (enable ? "enabled" : "disabled") << " (flush delay: " << d->writeBehindFlushDelay
+		<< " ms, max pending writes: " << d->writeBehindMaxPendingWrites << ").";
+#endif
+}
+
+int MainDb::getWriteBehindCommitCount () const {
+#ifdef HAVE_DB_STORAGE
+	L_D();
+	return d->writeBehindCommits;
+#else
+	return 0;
+#endif
+}
+
+bool MainDb::writeBehindEnabled () const {
+#ifdef HAVE_DB_STORAGE
+	L_D();
+	return d->writeBehindEnabled;
+#else
+	return false;
+#endif
+}
+
+void MainDb::flushPendingEvents () {
+#ifdef HAVE_DB_STORAGE
+	L_D();
+
+	if (d->writeBehindTimer) {
+		getCore()->destroyTimer(d->writeBehindTimer);
+		d->writeBehindTimer = nullptr;
+	}
+
+	if (!d->writeBehindBatchOpened)
+		return;
+
+	d->applyStagedEventUpdates();
+
+	soci::session *session = d->dbSession.getBackendSession();
+	try {
+		session->commit();
+		d->writeBehindBatchOpened = false;
+		d->hasUncommittedInternedIds = false;
+		d->writeBehindCommits++;
+		lInfo() << "MainDb write-behind batch committed: " << d->writeBehindPendingWrites << " write(s), "
+			<< d->writeBehindCoalescedUpdates << " coalesced update(s).";
+	} catch (const exception &e) {
+		lError() << "Unable to commit MainDb write-behind batch: `" << e.what() << "`.";
+		try {
+			session->rollback();
+		} catch (const exception &e) {
+			lError() << "Error during rollback of MainDb write-behind batch: `" << e.what() << "`.";
+		}
+		d->discardWriteBehindBatch();
+	}
+
+	d->writeBehindPendingWrites = 0;
+	d->writeBehindCoalescedUpdates = 0;
+#endif
+}
+
+// -----------------------------------------------------------------------------
+
+MainDb::CacheStats MainDb::getSipAddressCacheStats () const {
+	L_D();
+
+	CacheStats stats = d->sipAddressIdCacheStats;
+	stats.size = d->sipAddressIdCache.getSize();
+	stats.capacity = d->sipAddressIdCache.getCapacity();
+	return stats;
+}
+
+MainDb::CacheStats MainDb::getContentTypeCacheStats () const {
+	L_D();
+
+	CacheStats stats = d->contentTypeIdCacheStats;
+	stats.size = d->contentTypeIdCache.getSize();
+	stats.capacity = d->contentTypeIdCache.getCapacity();
+	return stats;
+}
+
+// -----------------------------------------------------------------------------
+
 bool MainDb::import (Backend, const string &parameters) {
 #ifdef HAVE_DB_STORAGE
 	L_D();
@@ -5236,6 +5731,8 @@ bool MainDb::import (Backend, const string &parameters) {
 	d->importLegacyHistory(inDbSession);
 	d->importLegacyCallLogs(inDbSession);
 
+	d->invalidateInternedIds();
+
 	return true;
 #else
 	return false;
@@ -74,6 +74,26 @@ public:
 		time_t timestamp = 0;
 	};
 
+	// Chat room columns loaded without building the chat room itself.
+	struct ChatRoomDescriptor {
+		long long storageId = -1;
+		ConferenceId conferenceId;
+		std::string subject;
+		int capabilities = 0;
+		time_t creationTime = 0;
+		time_t lastUpdateTime = 0;
+		int unreadChatMessageCount = 0;
+		bool isEmpty = true;
+		bool hasBeenLeft = false;
+	};
+
+	struct CacheStats {
+		int size = 0;
+		int capacity = 0;
+		unsigned long long hits = 0;
+		unsigned long long misses = 0;
+	};
+
 	MainDb (const std::shared_ptr<Core> &core);
 
 	// ---------------------------------------------------------------------------
@@ -83,6 +103,8 @@ public:
 	bool addEvent (const std::shared_ptr<EventLog> &eventLog);
 	bool updateEvent (const std::shared_ptr<EventLog> &eventLog);
 	static bool deleteEvent (const std::shared_ptr<const EventLog> &eventLog);
+	// Deletes the given events in a single transaction.
+	bool deleteEvents (const std::list<std::shared_ptr<EventLog>> &eventLogs);
 	int getEventCount (FilterMask mask = NoFilter) const;
 
 	static std::shared_ptr<EventLog> getEventFromKey (const MainDbKey &dbKey);
@@ -128,7 +150,8 @@ public:
 		time_t stateChangeTime
 	);
 
-	std::list<std::shared_ptr<ChatMessage>> getEphemeralMessages () const;
+	// Returns the events of the first maxCount ephemeral messages to expire, sorted by expire time.
+	std::list<std::shared_ptr<EventLog>> getEphemeralMessageEvents (int maxCount) const;
 
 	bool isChatRoomEmpty (const ConferenceId &conferenceId) const;
 	std::shared_ptr<ChatMessage> getLastChatMessage (const ConferenceId &conferenceId) const;
@@ -181,6 +204,10 @@ public:
 	// ---------------------------------------------------------------------------
 
 	std::list<std::shared_ptr<AbstractChatRoom>> getChatRooms () const;
+	// Chat rooms ordered by last update time, most recent first. A limit lower or equal to 0 means no limit.
+	std::list<std::shared_ptr<AbstractChatRoom>> getChatRooms (int offset, int limit) const;
+	std::shared_ptr<AbstractChatRoom> getChatRoom (const ConferenceId &conferenceId) const;
+	std::list<ChatRoomDescriptor> getChatRoomDescriptors (int offset = 0, int limit = -1) const;
 	void insertChatRoom (const std::shared_ptr<AbstractChatRoom> &chatRoom, unsigned int notifyId = 0);
 	void deleteChatRoom (const ConferenceId &conferenceId);
 	void updateNotifyId (const std::shared_ptr<AbstractChatRoom> &chatRoom, const unsigned int lastNotify);
@@ -251,6 +278,29 @@ public:
 
 	int getCallHistorySize ();
 
+	// ---------------------------------------------------------------------------
+	// Write-behind.
+	// ---------------------------------------------------------------------------
+
+	// In write-behind mode, writes are grouped in a batch transaction committed at most
+	// flushDelay ms later or once maxPendingWrites writes are pending. Chat message updates
+	// are coalesced until the next database access. Uncommitted writes are lost on crash.
+	void enableWriteBehind (bool enable, int flushDelay = 200, int maxPendingWrites = 500);
+	bool writeBehindEnabled () const;
+	// Number of write-behind batches committed so far.
+	int getWriteBehindCommitCount () const;
+
+	// Commit the pending batch, if any. Must be called before disconnecting.
+	void flushPendingEvents ();
+
+	// ---------------------------------------------------------------------------
+	// Interning caches.
+	// ---------------------------------------------------------------------------
+
+	// Sip address and content type ids are resolved through bounded in-memory caches.
+	CacheStats getSipAddressCacheStats () const;
+	CacheStats getContentTypeCacheStats () const;
+
 	// ---------------------------------------------------------------------------
 	// Other.
 	// ---------------------------------------------------------------------------
@@ -18,6 +18,8 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <unordered_map>
+
 #include "linphone/utils/utils.h"
 
 #include "sqlite3_bctbx_vfs.h"
@@ -39,6 +41,9 @@ public:
 	} backend = Backend::None;
 
 	std::unique_ptr<soci::session> backendSession;
+
+	// Must be destroyed before the backend session.
+	mutable std::unordered_map<int, soci::statement> preparedStatements;
 };
 
 DbSession::DbSession () : mPrivate(new DbSessionPrivate) {}
@@ -204,8 +209,6 @@ string DbSession::noLimitValue () const {
 }
 
 long long DbSession::getLastInsertId () const {
-	long long id = 0;
-
 	L_D();
 
 	string sql;
@@ -217,14 +220,15 @@ long long DbSession::getLastInsertId () const {
 			sql = "SELECT last_insert_rowid()";
 			break;
 		case DbSessionPrivate::Backend::None:
-			break;
-	}
-
-	if (!sql.empty()) {
-		*d->backendSession << sql, soci::into(id);
+			return 0;
 	}
 
-	return id;
+	// Negative key: not a Statements key.
+	long long lastInsertId = 0;
+	executePreparedStatement(-1, sql, [&lastInsertId](soci::statement &statement) {
+		statement.exchange(soci::into(lastInsertId));
+	});
+	return lastInsertId;
 }
 
 void DbSession::enableForeignKeys (bool status) {
@@ -293,6 +297,44 @@ unsigned int DbSession::getUnsignedInt (const soci::row &row, const std::size_t
 	return 0;
 }
 
+bool DbSession::executePreparedStatement (
+	int key,
+	const string &sql,
+	const function<void (soci::statement &)> &bind
+) const {
+	L_D();
+
+	auto it = d->preparedStatements.find(key);
+	if (it == d->preparedStatements.end()) {
+		soci::statement statement(*d->backendSession);
+		statement.alloc();
+		statement.prepare(sql);
+		it = d->preparedStatements.emplace(key, move(statement)).first;
+	}
+
+	soci::statement &statement = it->second;
+	bool gotData = false;
+	try {
+		bind(statement);
+		statement.define_and_bind();
+		gotData = statement.execute(true);
+		// Step to the end of the result: Sqlite3 keeps a read transaction opened on a statement that isn't done.
+		// There is no other row, the bound variables are left untouched.
+		if (gotData)
+			while (statement.fetch());
+	} catch (const exception &) {
+		statement.bind_clean_up();
+		throw;
+	}
+	statement.bind_clean_up();
+	return gotData;
+}
+
+void DbSession::clearPreparedStatements () {
+	L_D();
+	d->preparedStatements.clear();
+}
+
 time_t DbSession::getTime (const soci::row &row, int col) const {
 	L_D();
 
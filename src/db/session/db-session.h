@@ -21,6 +21,8 @@
 #ifndef _L_DB_SESSION_H_
 #define _L_DB_SESSION_H_
 
+#include <functional>
+
 #include <soci/soci.h>
 
 #include "linphone/utils/general.h"
@@ -65,6 +67,12 @@ public:
 
 	unsigned int getUnsignedInt (const soci::row &row, std::size_t col, const unsigned int def = 0) const;
 
+	// Execute a statement prepared once and reused until the session is closed. `bind` exchanges the
+	// soci::use/soci::into of this execution only, they are unbound before returning.
+	// The statement must return at most one row. Returns true if a row was fetched.
+	bool executePreparedStatement (int key, const std::string &sql, const std::function<void (soci::statement &)> &bind) const;
+	void clearPreparedStatements ();
+
 private:
 	DbSessionPrivate *mPrivate;
 
@@ -0,0 +1,230 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <cmath>
+
+#include "core/core.h"
+#include "logger/logger.h"
+
+#include "ice-scheduler.h"
+#include "ice-service.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+// -----------------------------------------------------------------------------
+
+IceScheduler::IceScheduler (Core &core) : mCore(core) {
+	LpConfig *config = linphone_core_get_config(core.getCCore());
+	mServerReflexiveTtl = (uint64_t)max(0, linphone_config_get_int(config, "net", "ice_srflx_cache_ttl", 0));
+	mTa = (unsigned int)max(0, linphone_config_get_int(config, "net", "ice_checks_pacing_ta", 20));
+	mBurst = max(1, linphone_config_get_int(config, "net", "ice_checks_pacing_burst", 10));
+	mTokens = mBurst;
+	mLastRefill = bctbx_get_cur_time_ms();
+	resetStats();
+}
+
+IceScheduler::~IceScheduler () {
+	stop();
+}
+
+// -----------------------------------------------------------------------------
+
+string IceScheduler::getServerReflexiveAddress (const string &stunServer, const string &localAddress) {
+	if (mServerReflexiveTtl == 0)
+		return string();
+
+	auto it = mServerReflexiveAddresses.find(stunServer + " " + localAddress);
+	if (it == mServerReflexiveAddresses.end())
+		return string();
+	if (it->second.expireTime <= bctbx_get_cur_time_ms()) {
+		mServerReflexiveAddresses.erase(it);
+		return string();
+	}
+	return it->second.address;
+}
+
+void IceScheduler::setServerReflexiveAddress (const string &stunServer, const string &localAddress, const string &reflexiveAddress) {
+	if (mServerReflexiveTtl == 0)
+		return;
+
+	mServerReflexiveAddresses[stunServer + " " + localAddress] = ServerReflexiveAddress{
+		reflexiveAddress, bctbx_get_cur_time_ms() + mServerReflexiveTtl
+	};
+}
+
+void IceScheduler::removeServerReflexiveAddress (const string &stunServer, const string &localAddress) {
+	mServerReflexiveAddresses.erase(stunServer + " " + localAddress);
+}
+
+// -----------------------------------------------------------------------------
+
+void IceScheduler::gatheringStarted (const IceService *service) {
+	mGatheringStartTimes[service] = bctbx_get_cur_time_ms();
+	mStats.number_of_gatherings++;
+}
+
+void IceScheduler::gatheringShared () {
+	mStats.number_of_shared_gatherings++;
+}
+
+void IceScheduler::gatheringFinished (const IceService *service) {
+	auto it = mGatheringStartTimes.find(service);
+	if (it == mGatheringStartTimes.end())
+		return;
+	addToHistogram(mStats.gathering_latency_histogram, bctbx_get_cur_time_ms() - it->second);
+	mGatheringStartTimes.erase(it);
+}
+
+void IceScheduler::scheduleChecks (IceService *service) {
+	uint64_t now = bctbx_get_cur_time_ms();
+	// The latency is measured from the first request, a session restarting its checks keeps it.
+	mChecksStartTimes.insert({ service, now });
+	if (mPendingByService.find(service) != mPendingByService.end())
+		return;
+
+	refillTokens(now);
+	if (mTa == 0 || (mPending.empty() && mTokens >= 1)) {
+		startChecks(service, now);
+		return;
+	}
+
+	mPending.push_back(service);
+	mPendingByService[service] = prev(mPending.end());
+	mStats.number_of_deferred_checks++;
+	mStats.number_of_pending = (int)mPending.size();
+	if (!mTimer)
+		startTimer((unsigned int)ceil((1 - mTokens) * mTa));
+}
+
+void IceScheduler::checksFinished (const IceService *service) {
+	auto it = mChecksStartTimes.find(service);
+	if (it == mChecksStartTimes.end())
+		return;
+	addToHistogram(mStats.checks_latency_histogram, bctbx_get_cur_time_ms() - it->second);
+	mChecksStartTimes.erase(it);
+}
+
+void IceScheduler::unschedule (const IceService *service) {
+	mGatheringStartTimes.erase(service);
+	mChecksStartTimes.erase(service);
+
+	auto it = mPendingByService.find(service);
+	if (it == mPendingByService.end())
+		return;
+	mPending.erase(it->second);
+	mPendingByService.erase(it);
+	mStats.number_of_pending = (int)mPending.size();
+	if (mPending.empty())
+		stopTimer();
+}
+
+void IceScheduler::stop () {
+	stopTimer();
+	mPending.clear();
+	mPendingByService.clear();
+	mGatheringStartTimes.clear();
+	mChecksStartTimes.clear();
+	mServerReflexiveAddresses.clear();
+	mStats.number_of_pending = 0;
+}
+
+// -----------------------------------------------------------------------------
+
+const LinphoneCoreIceSchedulerStats *IceScheduler::getStats () const {
+	return &mStats;
+}
+
+void IceScheduler::resetStats () {
+	mStats = LinphoneCoreIceSchedulerStats();
+	mStats.number_of_pending = (int)mPending.size();
+}
+
+void IceScheduler::addToHistogram (int *histogram, uint64_t durationMs) {
+	static const uint64_t bounds[] = LINPHONE_ICE_LATENCY_HISTOGRAM_BOUNDS;
+	size_t bucket = 0;
+	while (bucket < sizeof(bounds) / sizeof(bounds[0]) && durationMs >= bounds[bucket])
+		bucket++;
+	histogram[bucket]++;
+}
+
+// -----------------------------------------------------------------------------
+
+int IceScheduler::timerExpired (void *data, unsigned int revents) {
+	IceScheduler *scheduler = static_cast<IceScheduler *>(data);
+	scheduler->stopTimer();
+	scheduler->processPending();
+	return BELLE_SIP_STOP;
+}
+
+void IceScheduler::startChecks (IceService *service, uint64_t now) {
+	if (mTa > 0)
+		mTokens -= 1;
+	mStats.number_of_checks++;
+	service->startConnectivityChecks();
+}
+
+void IceScheduler::refillTokens (uint64_t now) {
+	if (mTa == 0)
+		return;
+	mTokens = min(mBurst, mTokens + (double)(now - mLastRefill) / mTa);
+	mLastRefill = now;
+}
+
+void IceScheduler::processPending () {
+	uint64_t now = bctbx_get_cur_time_ms();
+	refillTokens(now);
+	while (!mPending.empty() && (mTa == 0 || mTokens >= 1)) {
+		IceService *service = mPending.front();
+		mPending.pop_front();
+		mPendingByService.erase(service);
+		startChecks(service, now);
+	}
+	mStats.number_of_pending = (int)mPending.size();
+
+	if (!mPending.empty()) {
+		lInfo() << "ICE scheduler: " << mPending.size() << " sessions waiting to start their connectivity checks";
+		startTimer((unsigned int)ceil((1 - mTokens) * mTa));
+	}
+}
+
+void IceScheduler::startTimer (unsigned int durationMs) {
+	if (!mTimer) {
+		mTimer = mCore.getCCore()->sal->createTimer(timerExpired, this, durationMs, "ice scheduler");
+	} else {
+		belle_sip_source_set_timeout_int64(mTimer, (int64_t)durationMs);
+	}
+}
+
+void IceScheduler::stopTimer () {
+	if (mTimer) {
+		auto core = mCore.getCCore();
+		if (core && core->sal)
+			core->sal->cancelTimer(mTimer);
+		belle_sip_object_unref(mTimer);
+		mTimer = nullptr;
+	}
+}
+
+LINPHONE_END_NAMESPACE
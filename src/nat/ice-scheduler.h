@@ -0,0 +1,114 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_ICE_SCHEDULER_H_
+#define _L_ICE_SCHEDULER_H_
+
+#include <list>
+#include <string>
+#include <unordered_map>
+
+#include "linphone/utils/general.h"
+
+#include "private.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class Core;
+class IceService;
+
+// Core-wide coordination of the ICE sessions of all calls.
+// - The server-reflexive addresses observed by a STUN gathering are kept for a short time ([net] ice_srflx_cache_ttl,
+//   in ms, 0 by default which disables the sharing), so that the next calls using the same local address and STUN
+//   server can skip their own gathering. Only port preserving mappings are kept, as the candidates of the next calls
+//   are built from their own ports.
+// - The connectivity checks of the sessions are started one per Ta ([net] ice_checks_pacing_ta, in ms, 20 by default,
+//   0 disables the pacing) after a burst of [net] ice_checks_pacing_burst sessions, so that a burst of calls doesn't
+//   send all its STUN binding requests at once.
+// - The gathering and checks durations are collected in histograms.
+class IceScheduler {
+public:
+	IceScheduler (Core &core);
+	IceScheduler (const IceScheduler &other) = delete;
+	~IceScheduler ();
+
+	// Returns the server-reflexive address recently observed for a local address, or an empty string.
+	std::string getServerReflexiveAddress (const std::string &stunServer, const std::string &localAddress);
+	void setServerReflexiveAddress (const std::string &stunServer, const std::string &localAddress, const std::string &reflexiveAddress);
+	void removeServerReflexiveAddress (const std::string &stunServer, const std::string &localAddress);
+
+	void gatheringStarted (const IceService *service);
+	void gatheringShared ();
+	void gatheringFinished (const IceService *service);
+
+	// Start the connectivity checks of the service now, or later if the pacing doesn't allow it.
+	void scheduleChecks (IceService *service);
+	void checksFinished (const IceService *service);
+
+	// Forget the service, its checks are not started if they were waiting.
+	void unschedule (const IceService *service);
+
+	// Drop the queue, called when the core stops.
+	void stop ();
+
+	const LinphoneCoreIceSchedulerStats *getStats () const;
+	void resetStats ();
+
+private:
+	struct ServerReflexiveAddress {
+		std::string address;
+		uint64_t expireTime;
+	};
+
+	static int timerExpired (void *data, unsigned int revents);
+	static void addToHistogram (int *histogram, uint64_t durationMs);
+
+	void startChecks (IceService *service, uint64_t now);
+	void processPending ();
+	void refillTokens (uint64_t now);
+	void startTimer (unsigned int durationMs);
+	void stopTimer ();
+
+	Core &mCore;
+	uint64_t mServerReflexiveTtl = 0;
+	std::unordered_map<std::string, ServerReflexiveAddress> mServerReflexiveAddresses;
+
+	std::unordered_map<const IceService *, uint64_t> mGatheringStartTimes;
+	std::unordered_map<const IceService *, uint64_t> mChecksStartTimes;
+
+	std::list<IceService *> mPending;
+	std::unordered_map<const IceService *, std::list<IceService *>::iterator> mPendingByService;
+
+	// Token bucket, a token is the start of the checks of a session. A Ta of 0 disables the pacing.
+	double mTokens = 0;
+	double mBurst = 0;
+	unsigned int mTa = 0;
+	uint64_t mLastRefill = 0;
+
+	belle_sip_source_t *mTimer = nullptr;
+
+	LinphoneCoreIceSchedulerStats mStats;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_ICE_SCHEDULER_H_
@@ -24,6 +24,8 @@
 #include "c-wrapper/internal/c-tools.h"
 #include "conference/session/streams.h"
 #include "conference/session/media-session-p.h"
+#include "core/core-p.h"
+#include "nat/ice-scheduler.h"
 #include "utils/if-addrs.h"
 
 #if defined(__APPLE__)
@@ -248,6 +250,17 @@ LinphoneCore *IceService::getCCore()const{
 	return mStreamsGroup.getCCore();
 }
 
+IceScheduler &IceService::getIceScheduler()const{
+	return mStreamsGroup.getCore().getPrivate()->getIceScheduler();
+}
+
+void IceService::unscheduleChecks(){
+	// The session may be torn down after the core, and its scheduler with it, are destroyed.
+	shared_ptr<Core> core = mStreamsGroup.getMediaSession().tryGetCore();
+	if (core)
+		core->getPrivate()->getIceScheduler().unschedule(this);
+}
+
 int IceService::gatherLocalCandidates(){
 	list<string> localAddrs = IfAddrs::fetchLocalAddresses();
 	bool ipv6Allowed = linphone_core_ipv6_enabled(getCCore());
@@ -319,6 +332,88 @@ void IceService::addPredefinedSflrxCandidates(const NatPolicy *natPolicy){
 	lInfo() << "Configuration-defined server reflexive candidates added to check lists.";
 }
 
+/*
+ * Add the server-reflexive candidates recently observed by another call with the same STUN server, so that the
+ * gathering can be skipped. Returns false if a check list has no known mapping, the gathering is then needed.
+ */
+bool IceService::addSharedServerReflexiveCandidates(const string &stunServer){
+	struct SharedCandidate {
+		IceCheckList *checkList;
+		int rtpPort;
+		int rtcpPort;
+		string address;
+	};
+	IceScheduler &scheduler = getIceScheduler();
+	bool ipv6Allowed = linphone_core_ipv6_enabled(getCCore());
+	bool hasCheckList = false;
+	list<SharedCandidate> candidates;
+	for (auto & stream : mStreamsGroup.getStreams()){
+		if (!stream) continue;
+		IceCheckList *cl = ice_session_check_list(mIceSession, (int)stream->getIndex());
+		if (!cl || ice_check_list_state(cl) == ICL_Completed || ice_check_list_candidates_gathered(cl)) continue;
+		hasCheckList = true;
+		bool found = false;
+		for (bctbx_list_t *elem = cl->local_candidates; elem != nullptr; elem = elem->next){
+			IceCandidate *candidate = static_cast<IceCandidate *>(elem->data);
+			if (candidate->componentID != ICE_RTP_COMPONENT_ID || strcmp(ice_candidate_type(candidate), "host") != 0) continue;
+			string address = scheduler.getServerReflexiveAddress(stunServer, candidate->taddr.ip);
+			if (address.empty()) continue;
+			found = true;
+			// A mapping to the host address itself means there is no NAT, there is no candidate to add.
+			if (address != candidate->taddr.ip)
+				candidates.push_back({ cl, stream->getPortConfig().rtpPort, stream->getPortConfig().rtcpPort, address });
+		}
+		if (!found) return false;
+	}
+	if (!hasCheckList) return false;
+
+	for (const auto & candidate : candidates){
+		int family = candidate.address.find(':') != string::npos ? AF_INET6 : AF_INET;
+		if (family == AF_INET6 && !ipv6Allowed) continue;
+		ice_add_local_candidate(candidate.checkList, "srflx", family, L_STRING_TO_C(candidate.address), candidate.rtpPort, ICE_RTP_COMPONENT_ID, nullptr);
+		if (!rtp_session_rtcp_mux_enabled(candidate.checkList->rtp_session)) {
+			ice_add_local_candidate(candidate.checkList, "srflx", family, L_STRING_TO_C(candidate.address), candidate.rtcpPort, ICE_RTCP_COMPONENT_ID, nullptr);
+		}
+	}
+	if (!candidates.empty())
+		ice_session_set_base_for_srflx_candidates(mIceSession);
+	return true;
+}
+
+/*
+ * Keep the server-reflexive addresses found by a successful gathering for the next calls. Only the port preserving
+ * mappings can be reused, as the next calls build their candidates from their own ports.
+ */
+void IceService::recordServerReflexiveCandidates(){
+	LinphoneNatPolicy *cNatPolicy = getMediaSessionPrivate().getNatPolicy();
+	NatPolicy *natPolicy = cNatPolicy ? NatPolicy::toCpp(cNatPolicy) : nullptr;
+	if (!mIceSession || !natPolicy || !natPolicy->stunServerActivated() || natPolicy->turnEnabled()) return;
+
+	const string &stunServer = natPolicy->getStunServer();
+	IceScheduler &scheduler = getIceScheduler();
+	bool found = false;
+	for (auto & stream : mStreamsGroup.getStreams()){
+		if (!stream) continue;
+		IceCheckList *cl = ice_session_check_list(mIceSession, (int)stream->getIndex());
+		if (!cl) continue;
+		for (bctbx_list_t *elem = cl->local_candidates; elem != nullptr; elem = elem->next){
+			IceCandidate *candidate = static_cast<IceCandidate *>(elem->data);
+			if (candidate->componentID != ICE_RTP_COMPONENT_ID || strcmp(ice_candidate_type(candidate), "srflx") != 0) continue;
+			if (!candidate->base || candidate->base == candidate) continue;
+			found = true;
+			if (candidate->taddr.port == candidate->base->taddr.port)
+				scheduler.setServerReflexiveAddress(stunServer, candidate->base->taddr.ip, candidate->taddr.ip);
+			else
+				scheduler.removeServerReflexiveAddress(stunServer, candidate->base->taddr.ip);
+		}
+	}
+	// The STUN server answered with the host addresses: there is no NAT in between.
+	if (!found) {
+		const string &mediaLocalIp = getMediaSessionPrivate().getMediaLocalIp();
+		scheduler.setServerReflexiveAddress(stunServer, mediaLocalIp, mediaLocalIp);
+	}
+}
+
 /** Return values:
  *  1: STUN gathering is started
  *  0: no STUN gathering is started, but it's ok to proceed with ICE anyway (with local candidates only or because STUN gathering was already done before)
@@ -370,8 +465,14 @@ int IceService::gatherIceCandidates () {
 			linphone_parse_host_port(server.c_str(), host, sizeof(host), &port);
 			ice_session_set_turn_cn(mIceSession, host);
 		}
-		ice_session_set_stun_auth_requested_cb(mIceSession, MediaSessionPrivate::stunAuthRequestedCb, &getMediaSessionPrivate());
-		err = ice_session_gather_candidates(mIceSession, ai->ai_addr, (socklen_t)ai->ai_addrlen) ? 1 : 0;
+		if (!natPolicy->turnEnabled() && addSharedServerReflexiveCandidates(server)) {
+			lInfo() << "ICE: server-reflexive candidates from [" << server << "] reused from a previous gathering";
+			getIceScheduler().gatheringShared();
+		} else {
+			ice_session_set_stun_auth_requested_cb(mIceSession, MediaSessionPrivate::stunAuthRequestedCb, &getMediaSessionPrivate());
+			err = ice_session_gather_candidates(mIceSession, ai->ai_addr, (socklen_t)ai->ai_addrlen) ? 1 : 0;
+			if (err == 1) getIceScheduler().gatheringStarted(this);
+		}
 	} else {
 		lInfo() << "ICE: bypass server-reflexive candidates gathering";
 		addPredefinedSflrxCandidates(natPolicy);
@@ -772,7 +873,7 @@ void IceService::render(const OfferAnswerContext & ctx, CallSession::State targe
 	
 	updateFromRemoteMediaDescription(ctx.localMediaDescription, ctx.remoteMediaDescription, !ctx.localIsOfferer);
 	if (mIceSession && ice_session_state(mIceSession) != IS_Completed) {
-		ice_session_start_connectivity_checks(mIceSession);
+		getIceScheduler().scheduleChecks(this);
 	}
 
 	if (!mIceSession){
@@ -782,6 +883,12 @@ void IceService::render(const OfferAnswerContext & ctx, CallSession::State targe
 
 }
 
+void IceService::startConnectivityChecks(){
+	if (mIceSession && ice_session_state(mIceSession) != IS_Completed) {
+		ice_session_start_connectivity_checks(mIceSession);
+	}
+}
+
 void IceService::sessionConfirmed(const OfferAnswerContext &ctx){
 }
 
@@ -796,6 +903,7 @@ void IceService::finish(){
 void IceService::deleteSession () {
 	if (!mIceSession)
 		return;
+	unscheduleChecks();
 	/* clear all check lists */
 	for (auto & stream : mStreamsGroup.getStreams()) {
 		if (stream) {
@@ -817,12 +925,14 @@ void IceService::restartSession (IceRole role) {
 	 * Indeed, the local candidates are always added back after restart.
 	 * This avoids previously discovered and possibly non-working peer-reflexive candidates to be accumulated after successive restarts.
 	 */
+	unscheduleChecks();
 	ice_session_reset(mIceSession, role);
 }
 
 void IceService::resetSession() {
 	if (!mIceSession)
 		return;
+	unscheduleChecks();
 	ice_session_reset(mIceSession, IR_Controlling);
 }
 
@@ -843,6 +953,7 @@ void IceService::handleIceEvent(const OrtpEvent *ev){
 	const OrtpEventData *evd = ortp_event_get_data(const_cast<OrtpEvent*>(ev));
 	switch (evt){
 		case ORTP_EVENT_ICE_SESSION_PROCESSING_FINISHED:
+			getIceScheduler().checksFinished(this);
 			if (hasCompletedCheckList()) {
 				if (mListener) mListener->onIceCompleted(*this);
 			}
@@ -850,6 +961,9 @@ void IceService::handleIceEvent(const OrtpEvent *ev){
 		case ORTP_EVENT_ICE_GATHERING_FINISHED:
 			if (!evd->info.ice_processing_successful)
 				lWarning() << "No STUN answer from [" << linphone_nat_policy_get_stun_server(getMediaSessionPrivate().getNatPolicy()) << "], continuing without STUN";
+			else
+				recordServerReflexiveCandidates();
+			getIceScheduler().gatheringFinished(this);
 			mStreamsGroup.finishPrepare();
 			if (mListener) mListener->onGatheringFinished(*this);
 		break;
@@ -29,6 +29,7 @@
 
 LINPHONE_BEGIN_NAMESPACE
 
+class IceScheduler;
 class StreamsGroup;
 class MediaSessionPrivate;
 class IceServiceListener;
@@ -103,6 +104,11 @@ public:
 	 * Ideally the IceService should place its own listener to these ortp events, but well oRTP is C and has to be simple.
 	 */
 	void handleIceEvent(const OrtpEvent *ev);
+
+	/*
+	 * Start the connectivity checks, called by the core IceScheduler that paces them across calls.
+	 */
+	void startConnectivityChecks();
 	
 	/**
 	 * used by non-regression tests only.
@@ -121,6 +127,8 @@ private:
 	static bool checkLocalNetworkPermission(const std::string &localAddr);
 	MediaSessionPrivate &getMediaSessionPrivate()const;
 	LinphoneCore *getCCore()const;
+	IceScheduler &getIceScheduler()const;
+	void unscheduleChecks();
 	bool iceFoundInMediaDescription (const std::shared_ptr<SalMediaDescription> &md);
 	const struct addrinfo *getIcePreferredStunServerAddrinfo (const struct addrinfo *ai);
 	void updateLocalMediaDescriptionFromIce(std::shared_ptr<SalMediaDescription> &desc);
@@ -135,6 +143,8 @@ private:
 	int gatherIceCandidates ();
 	int gatherLocalCandidates();
 	void addPredefinedSflrxCandidates(const NatPolicy *natPolicy);
+	bool addSharedServerReflexiveCandidates(const std::string &stunServer);
+	void recordServerReflexiveCandidates();
 	bool hasRelayCandidates(const SalMediaDescription &md)const;
 	void chooseDefaultCandidates(const OfferAnswerContext & ctx);
 	StreamsGroup & mStreamsGroup;
@@ -270,6 +270,62 @@ std::list<OrtpPayloadType*> OfferAnswerEngine::matchPayloads(MSFactory *factory,
 	return res;
 }
 
+OfferAnswerEngine::PayloadMatchCache::~PayloadMatchCache(){
+	for (auto & result : mResults) {
+		PayloadTypeHandler::clearPayloadList(result.second);
+	}
+}
+
+/*
+ * The red matcher writes the t140 numbering into the local payload, the result of a match then depends on more than the content of the lists.
+*/
+bool OfferAnswerEngine::PayloadMatchCache::isCacheable(const std::list<OrtpPayloadType*> & l){
+	for (const auto & pt : l) {
+		if (pt->mime_type && strcasecmp(pt->mime_type, payload_type_t140_red.mime_type) == 0){
+			return false;
+		}
+	}
+	return true;
+}
+
+void OfferAnswerEngine::PayloadMatchCache::appendKey(std::string & key, const std::list<OrtpPayloadType*> & l){
+	key += std::to_string(l.size()) + '\n';
+	for (const auto & pt : l) {
+		key += L_C_TO_STRING(pt->mime_type) + '\n';
+		key += L_C_TO_STRING(pt->recv_fmtp) + '\n';
+		key += L_C_TO_STRING(pt->send_fmtp) + '\n';
+		key += std::to_string(payload_type_get_number(pt)) + ' ' + std::to_string(pt->type) + ' ' + std::to_string(pt->clock_rate)
+			+ ' ' + std::to_string(pt->channels) + ' ' + std::to_string(pt->bits_per_sample) + ' ' + std::to_string(pt->normal_bitrate)
+			+ ' ' + std::to_string(pt->flags) + ' ' + std::to_string(pt->avpf.features) + ' ' + std::to_string(pt->avpf.rpsi_compatibility)
+			+ ' ' + std::to_string(pt->avpf.trr_interval) + '\n';
+	}
+}
+
+std::list<OrtpPayloadType*> OfferAnswerEngine::PayloadMatchCache::matchPayloads(MSFactory *factory, const std::list<OrtpPayloadType*> & local, const std::list<OrtpPayloadType*> & remote, bool reading_response, bool one_matching_codec, bool bundle_enabled){
+	if (!mEnabled || !isCacheable(local) || !isCacheable(remote)) {
+		mMatchCount++;
+		return OfferAnswerEngine::matchPayloads(factory, local, remote, reading_response, one_matching_codec, bundle_enabled);
+	}
+
+	std::string key;
+	key += reading_response ? '1' : '0';
+	key += one_matching_codec ? '1' : '0';
+	key += bundle_enabled ? '1' : '0';
+	appendKey(key, local);
+	appendKey(key, remote);
+
+	auto it = mResults.find(key);
+	if (it == mResults.end()) {
+		mMatchCount++;
+		it = mResults.emplace(key, OfferAnswerEngine::matchPayloads(factory, local, remote, reading_response, one_matching_codec, bundle_enabled)).first;
+	}
+	std::list<OrtpPayloadType*> res;
+	for (const auto & pt : it->second) {
+		res.push_back(payload_type_clone(pt));
+	}
+	return res;
+}
+
 bool OfferAnswerEngine::matchCryptoAlgo(const std::vector<SalSrtpCryptoAlgo> &local, const std::vector<SalSrtpCryptoAlgo> &remote,
 	SalSrtpCryptoAlgo & result, unsigned int & choosen_local_tag, bool use_local_key) {
 	for(const auto & rc : remote) {
@@ -357,7 +413,7 @@ SalStreamDir OfferAnswerEngine::computeConferenceStreamDir(SalStreamDir dir){
 	return res;
 }
 
-SalStreamDescription OfferAnswerEngine::initiateOutgoingStream(MSFactory* factory, const SalStreamDescription & local_offer, const SalStreamDescription & remote_answer, const bool allowCapabilityNegotiation){
+SalStreamDescription OfferAnswerEngine::initiateOutgoingStream(MSFactory* factory, PayloadMatchCache & payloadMatches, const SalStreamDescription & local_offer, const SalStreamDescription & remote_answer, const bool allowCapabilityNegotiation){
 
 	SalStreamDescription result;
 	result.setLabel(local_offer.getLabel());
@@ -435,7 +491,7 @@ SalStreamDescription OfferAnswerEngine::initiateOutgoingStream(MSFactory* factor
 			if (answerUnparsedCfgs.empty()) {
 				lInfo() << "[Initiate Outgoing Stream] Answerer chose offerer's actual configuration at index " << localCfgIdx;
 				localCfgIdx = local_offer.getActualConfigurationIndex();
-				resultCfgPair = OfferAnswerEngine::initiateOutgoingConfiguration(factory, local_offer,remote_answer,result, localCfgIdx, remoteCfgIdx);
+				resultCfgPair = OfferAnswerEngine::initiateOutgoingConfiguration(factory, payloadMatches, local_offer,remote_answer,result, localCfgIdx, remoteCfgIdx);
 				success = resultCfgPair.second;
 			} else {
 				if (answerUnparsedCfgs.size() > 1) {
@@ -449,7 +505,7 @@ SalStreamDescription OfferAnswerEngine::initiateOutgoingStream(MSFactory* factor
 						localCfgIdx = cfg.first;
 						const auto cfgLine = cfg.second;
 						// Perform negotiations only with acfg
-						resultCfgPair = OfferAnswerEngine::initiateOutgoingConfiguration(factory, local_offer,remote_answer,result, localCfgIdx, remoteCfgIdx);
+						resultCfgPair = OfferAnswerEngine::initiateOutgoingConfiguration(factory, payloadMatches, local_offer,remote_answer,result, localCfgIdx, remoteCfgIdx);
 					}
 				}
 			}
@@ -462,7 +518,7 @@ SalStreamDescription OfferAnswerEngine::initiateOutgoingStream(MSFactory* factor
 
 		} else {
 			localCfgIdx = local_offer.getActualConfigurationIndex();
-			resultCfgPair = OfferAnswerEngine::initiateOutgoingConfiguration(factory, local_offer,remote_answer,result, localCfgIdx, remoteCfgIdx);
+			resultCfgPair = OfferAnswerEngine::initiateOutgoingConfiguration(factory, payloadMatches, local_offer,remote_answer,result, localCfgIdx, remoteCfgIdx);
 		}
 
 		const auto & resultCfg = resultCfgPair.first;
@@ -496,7 +552,7 @@ SalStreamDescription OfferAnswerEngine::initiateOutgoingStream(MSFactory* factor
 	return result;
 }
 
-std::pair<SalStreamConfiguration, bool> OfferAnswerEngine::initiateOutgoingConfiguration(MSFactory* factory, const SalStreamDescription & local_offer, const SalStreamDescription & remote_answer, const SalStreamDescription & result, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx) {
+std::pair<SalStreamConfiguration, bool> OfferAnswerEngine::initiateOutgoingConfiguration(MSFactory* factory, PayloadMatchCache & payloadMatches, const SalStreamDescription & local_offer, const SalStreamDescription & remote_answer, const SalStreamDescription & result, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx) {
 	SalStreamConfiguration resultCfg = result.getActualConfiguration();
 	const SalStreamConfiguration & localCfg = local_offer.getConfigurationAtIndex(localCfgIdx);
 	const SalStreamConfiguration & remoteCfg = remote_answer.getConfigurationAtIndex(remoteCfgIdx);
@@ -530,7 +586,7 @@ std::pair<SalStreamConfiguration, bool> OfferAnswerEngine::initiateOutgoingConfi
 
 	const auto & availableEncs = local_offer.getSupportedEncryptions();
 	if (remoteCfg != Utils::getEmptyConstRefObject<SalStreamConfiguration>()) {
-		resultCfg.payloads=OfferAnswerEngine::matchPayloads(factory, localCfg.payloads,remoteCfg.payloads,true,false,bundle_enabled);
+		resultCfg.payloads=payloadMatches.matchPayloads(factory, localCfg.payloads,remoteCfg.payloads,true,false,bundle_enabled);
 	} else {
 		lWarning() << "[Initiate Outgoing Configuration] Remote configuration has not been found";
 		success = false;
@@ -645,7 +701,47 @@ std::pair<SalStreamConfiguration, bool> OfferAnswerEngine::initiateOutgoingConfi
 	return std::make_pair(resultCfg, success);
 }
 
-SalStreamDescription OfferAnswerEngine::initiateIncomingStream(MSFactory *factory, const SalStreamDescription & local_cap,
+/*
+ * An AVP answer to an AVPF offer is sent with the transport protocol of the offer lowered to the local one.
+ * The remote configuration is updated for every pair negotiated or skipped, so that skipping a pair leaves the offer as its negotiation would.
+*/
+void OfferAnswerEngine::downgradeIncomingProto(const SalStreamConfiguration & localCfg, const SalStreamConfiguration & remoteCfg, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx) {
+	if (OfferAnswerEngine::areProtoCompatibles(localCfg.getProto(), remoteCfg.getProto()) && (localCfg.getProto() != remoteCfg.getProto()) && remoteCfg.hasAvpf()) {
+		lWarning() << "[Initiate Incoming Configuration] Sending a downgraded AVP answer (transport protocol " << sal_media_proto_to_string(remoteCfg.getProto()) << " of the remote offered stream configuration at index " << remoteCfgIdx << ") for the received AVPF offer (transport protocol " << sal_media_proto_to_string(localCfg.getProto()) << " of local stream configuration at index " << localCfgIdx << ")";
+		const_cast<SalStreamConfiguration &>(remoteCfg).proto = localCfg.getProto();
+	}
+}
+
+/*
+ * Cheap checks of the conditions that make initiateIncomingConfiguration() fail whatever the payloads, so that the pairs of potential
+ * configurations that cannot match are skipped before the payload matching.
+ * The checks do not depend on the AVPF downgrade, a downgraded protocol keeps the same compatibility and SRTP.
+*/
+bool OfferAnswerEngine::isIncomingConfigurationPossible(const SalStreamDescription & local_cap, const SalStreamDescription & remote_offer, const SalStreamConfiguration & localCfg, const SalStreamConfiguration & remoteCfg) {
+	if (!remote_offer.enabled() || !OfferAnswerEngine::areProtoCompatibles(localCfg.getProto(), remoteCfg.getProto())) {
+		return false;
+	}
+
+	// The answer takes the transport protocol of the offer, compatible protocols are either all with SRTP or all without.
+	const auto & availableEncs = local_cap.getSupportedEncryptions();
+	if (remoteCfg.hasSrtp()) {
+		if (remote_offer.rtp_addr.empty() == false && ms_is_multicast(L_STRING_TO_C(remote_offer.rtp_addr))) {
+			return false;
+		}
+		if (std::find(availableEncs.cbegin(), availableEncs.cend(), LinphoneMediaEncryptionSRTP) == availableEncs.cend()) {
+			return false;
+		}
+	}
+
+	if ((localCfg.dtls_role!=SalDtlsRoleInvalid) && (remoteCfg.dtls_role!=SalDtlsRoleInvalid)
+			&& (!localCfg.dtls_fingerprint.empty()) && (!remoteCfg.dtls_fingerprint.empty())
+			&& (std::find(availableEncs.cbegin(), availableEncs.cend(), LinphoneMediaEncryptionDTLS) == availableEncs.cend())) {
+		return false;
+	}
+	return true;
+}
+
+SalStreamDescription OfferAnswerEngine::initiateIncomingStream(MSFactory *factory, PayloadMatchCache & payloadMatches, const SalStreamDescription & local_cap,
 						const SalStreamDescription & remote_offer,
 						bool one_matching_codec, const std::string &bundle_owner_mid, const bool allowCapabilityNegotiation){
 	SalStreamDescription result;
@@ -663,15 +759,30 @@ SalStreamDescription OfferAnswerEngine::initiateIncomingStream(MSFactory *factor
 
 	std::pair<SalStreamConfiguration, bool> resultCfgPair{SalStreamConfiguration(), false};
 	if (allowCapabilityNegotiation) {
-		for (const auto & remoteCfg : remote_offer.getAllCfgs()) {
-			for (const auto & localCfg : local_cap.getAllCfgs()) {
+		const auto remoteCfgs = remote_offer.getAllCfgs();
+		const auto localCfgs = local_cap.getAllCfgs();
+		const auto lastRemoteCfgIdx = remoteCfgs.empty() ? remoteCfgIdx : remoteCfgs.rbegin()->first;
+		const auto lastLocalCfgIdx = localCfgs.empty() ? localCfgIdx : localCfgs.rbegin()->first;
+		for (const auto & remoteCfg : remoteCfgs) {
+			for (const auto & localCfg : localCfgs) {
 				const auto success = resultCfgPair.second;
 				if (success) {
 					break;
 				} else {
+					// The last pair is always negotiated, its result is the one kept when no configuration matches.
+					const bool lastPair = (remoteCfg.first == lastRemoteCfgIdx) && (localCfg.first == lastLocalCfgIdx);
+					if (!lastPair) {
+						// The maps are copies, the remote configuration may have been downgraded by a previous pair.
+						const SalStreamConfiguration & currentLocalCfg = local_cap.getConfigurationAtIndex(localCfg.first);
+						const SalStreamConfiguration & currentRemoteCfg = remote_offer.getConfigurationAtIndex(remoteCfg.first);
+						if (!OfferAnswerEngine::isIncomingConfigurationPossible(local_cap, remote_offer, currentLocalCfg, currentRemoteCfg)) {
+							OfferAnswerEngine::downgradeIncomingProto(currentLocalCfg, currentRemoteCfg, localCfg.first, remoteCfg.first);
+							continue;
+						}
+					}
 					localCfgIdx = localCfg.first;
 					remoteCfgIdx = remoteCfg.first;
-					resultCfgPair = OfferAnswerEngine::initiateIncomingConfiguration(factory, local_cap, remote_offer,result,one_matching_codec, bundle_owner_mid, localCfgIdx, remoteCfgIdx);
+					resultCfgPair = OfferAnswerEngine::initiateIncomingConfiguration(factory, payloadMatches, local_cap, remote_offer,result,one_matching_codec, bundle_owner_mid, localCfgIdx, remoteCfgIdx);
 
 				}
 			}
@@ -682,7 +793,7 @@ SalStreamDescription OfferAnswerEngine::initiateIncomingStream(MSFactory *factor
 	} else {
 		localCfgIdx = local_cap.getActualConfigurationIndex();
 		remoteCfgIdx = remote_offer.getActualConfigurationIndex();
-		resultCfgPair = OfferAnswerEngine::initiateIncomingConfiguration(factory, local_cap, remote_offer,result,one_matching_codec, bundle_owner_mid, localCfgIdx, remoteCfgIdx);
+		resultCfgPair = OfferAnswerEngine::initiateIncomingConfiguration(factory, payloadMatches, local_cap, remote_offer,result,one_matching_codec, bundle_owner_mid, localCfgIdx, remoteCfgIdx);
 	}
 
 	const auto & resultCfg = resultCfgPair.first;
@@ -736,7 +847,7 @@ SalStreamDescription OfferAnswerEngine::initiateIncomingStream(MSFactory *factor
 	return result;
 }
 
-std::pair<SalStreamConfiguration, bool> OfferAnswerEngine::initiateIncomingConfiguration(MSFactory *factory, const SalStreamDescription & local_cap, const SalStreamDescription & remote_offer, const SalStreamDescription & result, bool one_matching_codec, const std::string &bundle_owner_mid, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx) {
+std::pair<SalStreamConfiguration, bool> OfferAnswerEngine::initiateIncomingConfiguration(MSFactory *factory, PayloadMatchCache & payloadMatches, const SalStreamDescription & local_cap, const SalStreamDescription & remote_offer, const SalStreamDescription & result, bool one_matching_codec, const std::string &bundle_owner_mid, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx) {
 
 	SalStreamConfiguration resultCfg;
 	if (result.hasConfigurationAtIndex(result.getActualConfigurationIndex())) {
@@ -767,12 +878,9 @@ std::pair<SalStreamConfiguration, bool> OfferAnswerEngine::initiateIncomingConfi
 		resultCfg.rtcp_mux = true; /* RTCP mux must be enabled in bundle mode. */
 	}
 	const auto & availableEncs = local_cap.getSupportedEncryptions();
-	resultCfg.payloads=OfferAnswerEngine::matchPayloads(factory, localCfg.payloads,remoteCfg.payloads, false, one_matching_codec, bundle_enabled);
+	resultCfg.payloads=payloadMatches.matchPayloads(factory, localCfg.payloads,remoteCfg.payloads, false, one_matching_codec, bundle_enabled);
 	if (OfferAnswerEngine::areProtoCompatibles(localCfg.getProto(), remoteCfg.getProto())) {
-		if (localCfg.getProto() != remoteCfg.getProto() && remoteCfg.hasAvpf()) {
-			lWarning() << "[Initiate Incoming Configuration] Sending a downgraded AVP answer (transport protocol " << sal_media_proto_to_string(remoteCfg.getProto()) << " of the remote offered stream configuration at index " << remoteCfgIdx << ") for the received AVPF offer (transport protocol " << sal_media_proto_to_string(localCfg.getProto()) << " of local stream configuration at index " << localCfgIdx << ")";
-			const_cast<SalStreamConfiguration &>(remoteCfg).proto = localCfg.getProto();
-		}
+		OfferAnswerEngine::downgradeIncomingProto(localCfg, remoteCfg, localCfgIdx, remoteCfgIdx);
 		resultCfg.proto=remoteCfg.getProto();
 	} else {
 		lWarning() << "[Initiate Incoming Configuration] The transport protocol " << sal_media_proto_to_string(localCfg.getProto()) << " of local stream configuration at index " << localCfgIdx << " is not compatible with the transport protocol " << sal_media_proto_to_string(remoteCfg.getProto()) << " of the remote offered stream configuration at index " << remoteCfgIdx;
@@ -907,13 +1015,14 @@ std::shared_ptr<SalMediaDescription> OfferAnswerEngine::initiateOutgoing(MSFacto
 
 	auto result = std::make_shared<SalMediaDescription>(local_offer->getParams());
 	const bool capabilityNegotiation = result->getParams().capabilityNegotiationSupported();
+	PayloadMatchCache payloadMatches;
 
 	for(i=0;i<local_offer->streams.size();++i){
 		ms_message("Processing for stream %zu",i);
 		SalStreamDescription & ls = local_offer->streams[i];
 		const SalStreamDescription & rs = remote_answer->streams[i];
 		if ((i < remote_answer->streams.size()) && rs.getType() == ls.getType() && OfferAnswerEngine::areProtoInStreamCompatibles(ls, rs)) {
-			auto stream = OfferAnswerEngine::initiateOutgoingStream(factory, ls,rs, capabilityNegotiation);
+			auto stream = OfferAnswerEngine::initiateOutgoingStream(factory, payloadMatches, ls,rs, capabilityNegotiation);
 			SalStreamConfiguration actualCfg = stream.getActualConfiguration();
 			memcpy(&actualCfg.rtcp_xr, &ls.getChosenConfiguration().rtcp_xr, sizeof(stream.getChosenConfiguration().rtcp_xr));
 			if ((ls.getChosenConfiguration().rtcp_xr.enabled == TRUE) && (rs.getChosenConfiguration().rtcp_xr.enabled == FALSE)) {
@@ -976,6 +1085,22 @@ std::shared_ptr<SalMediaDescription> OfferAnswerEngine::initiateOutgoing(MSFacto
 std::shared_ptr<SalMediaDescription> OfferAnswerEngine::initiateIncoming(MSFactory *factory, const std::shared_ptr<SalMediaDescription> local_capabilities,
 					std::shared_ptr<SalMediaDescription> remote_offer,
 					bool one_matching_codec){
+	PayloadMatchCache payloadMatches;
+	return OfferAnswerEngine::initiateIncoming(factory, local_capabilities, remote_offer, one_matching_codec, payloadMatches);
+}
+
+std::shared_ptr<SalMediaDescription> OfferAnswerEngine::initiateIncoming(MSFactory *factory, const std::shared_ptr<SalMediaDescription> local_capabilities,
+					std::shared_ptr<SalMediaDescription> remote_offer,
+					bool one_matching_codec, bool payloadMatchCacheEnabled, unsigned int & payloadMatchCount){
+	PayloadMatchCache payloadMatches(payloadMatchCacheEnabled);
+	auto result = OfferAnswerEngine::initiateIncoming(factory, local_capabilities, remote_offer, one_matching_codec, payloadMatches);
+	payloadMatchCount += payloadMatches.getMatchCount();
+	return result;
+}
+
+std::shared_ptr<SalMediaDescription> OfferAnswerEngine::initiateIncoming(MSFactory *factory, const std::shared_ptr<SalMediaDescription> local_capabilities,
+					std::shared_ptr<SalMediaDescription> remote_offer,
+					bool one_matching_codec, PayloadMatchCache & payloadMatches){
 
 	auto result = std::make_shared<SalMediaDescription>(local_capabilities->getParams());
 	size_t i = 0;
@@ -999,7 +1124,7 @@ std::shared_ptr<SalMediaDescription> OfferAnswerEngine::initiateIncoming(MSFacto
 					bundle_owner_mid = remote_offer->streams[(size_t)owner_index].getChosenConfiguration().getMid();
 				}
 			}
-			stream = OfferAnswerEngine::initiateIncomingStream(factory, ls,rs,one_matching_codec, bundle_owner_mid, capabilityNegotiation);
+			stream = OfferAnswerEngine::initiateIncomingStream(factory, payloadMatches, ls,rs,one_matching_codec, bundle_owner_mid, capabilityNegotiation);
 			// Get an up to date actual configuration as it may have changed
 			actualCfg = stream.getActualConfiguration();
 			// Handle global RTCP FB attributes
@@ -23,6 +23,8 @@
 
 #include <memory>
 #include <list>
+#include <string>
+#include <unordered_map>
 #include <vector>
 #include <utility>
 
@@ -57,7 +59,42 @@ class OfferAnswerEngine {
 		static std::shared_ptr<SalMediaDescription> initiateIncoming(MSFactory* factory, const std::shared_ptr<SalMediaDescription> local_capabilities,
 							std::shared_ptr<SalMediaDescription> remote_offer, bool one_matching_codec);
 
+		/**
+		 * Same as above, with the cache sharing the payload list matchings within the offer/answer enabled or not.
+		 * The number of matchings computed is added to payloadMatchCount.
+		 * The tester uses it to compare the offer/answer with and without the cache.
+		**/
+		static std::shared_ptr<SalMediaDescription> initiateIncoming(MSFactory* factory, const std::shared_ptr<SalMediaDescription> local_capabilities,
+							std::shared_ptr<SalMediaDescription> remote_offer, bool one_matching_codec, bool payloadMatchCacheEnabled, unsigned int & payloadMatchCount);
+
 	private:
+		/**
+		 * Results of matchPayloads() during one offer/answer, keyed by the content of the payload lists: the potential
+		 * configurations of a stream, and often the streams of a same type, carry identical payload lists.
+		 * The matched lists are owned by the cache, callers get clones.
+		**/
+		class PayloadMatchCache {
+			public:
+				PayloadMatchCache (bool enabled = true) : mEnabled(enabled) {}
+				PayloadMatchCache (const PayloadMatchCache &other) = delete;
+				~PayloadMatchCache ();
+
+				std::list<OrtpPayloadType*> matchPayloads(MSFactory *factory, const std::list<OrtpPayloadType*> & local, const std::list<OrtpPayloadType*> & remote, bool reading_response, bool one_matching_codec, bool bundle_enabled);
+
+				// Number of matchings computed, the ones served from the cache are not counted.
+				unsigned int getMatchCount() const { return mMatchCount; }
+
+			private:
+				static bool isCacheable(const std::list<OrtpPayloadType*> & l);
+				static void appendKey(std::string & key, const std::list<OrtpPayloadType*> & l);
+
+				std::unordered_map<std::string, std::list<OrtpPayloadType*>> mResults;
+				bool mEnabled;
+				unsigned int mMatchCount = 0;
+		};
+
+		static std::shared_ptr<SalMediaDescription> initiateIncoming(MSFactory* factory, const std::shared_ptr<SalMediaDescription> local_capabilities,
+							std::shared_ptr<SalMediaDescription> remote_offer, bool one_matching_codec, PayloadMatchCache & payloadMatches);
 
 		static bool onlyTelephoneEvent(const std::list<OrtpPayloadType*> & l);
 		static bool areProtoInStreamCompatibles(const SalStreamDescription & localStream, const SalStreamDescription & otherStream);
@@ -70,12 +107,14 @@ class OfferAnswerEngine {
 		static PayloadType * genericMatch(const std::list<OrtpPayloadType*> & local_payloads, const PayloadType *refpt, const std::list<OrtpPayloadType*> & remote_payloads);
 		static PayloadType * findPayloadTypeBestMatch(MSFactory *factory, const std::list<OrtpPayloadType*> & local_payloads, const PayloadType *refpt, const std::list<OrtpPayloadType*> & remote_payloads, bool reading_response);
 
-		static SalStreamDescription initiateIncomingStream(MSFactory *factory, const SalStreamDescription & local_cap, const SalStreamDescription & remote_offer, bool one_matching_codec, const std::string &bundle_owner_mid, const bool allowCapabilityNegotiation);
-		static std::pair<SalStreamConfiguration, bool> initiateIncomingConfiguration(MSFactory *factory, const SalStreamDescription & local_cap, const SalStreamDescription & remote_offer, const SalStreamDescription & result, bool one_matching_codec, const std::string &bundle_owner_mid, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx);
+		static void downgradeIncomingProto(const SalStreamConfiguration & localCfg, const SalStreamConfiguration & remoteCfg, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx);
+		static bool isIncomingConfigurationPossible(const SalStreamDescription & local_cap, const SalStreamDescription & remote_offer, const SalStreamConfiguration & localCfg, const SalStreamConfiguration & remoteCfg);
+		static SalStreamDescription initiateIncomingStream(MSFactory *factory, PayloadMatchCache & payloadMatches, const SalStreamDescription & local_cap, const SalStreamDescription & remote_offer, bool one_matching_codec, const std::string &bundle_owner_mid, const bool allowCapabilityNegotiation);
+		static std::pair<SalStreamConfiguration, bool> initiateIncomingConfiguration(MSFactory *factory, PayloadMatchCache & payloadMatches, const SalStreamDescription & local_cap, const SalStreamDescription & remote_offer, const SalStreamDescription & result, bool one_matching_codec, const std::string &bundle_owner_mid, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx);
 
-		static SalStreamDescription initiateOutgoingStream(MSFactory* factory, const SalStreamDescription & local_offer, const SalStreamDescription & remote_answer, const bool allowCapabilityNegotiation);
+		static SalStreamDescription initiateOutgoingStream(MSFactory* factory, PayloadMatchCache & payloadMatches, const SalStreamDescription & local_offer, const SalStreamDescription & remote_answer, const bool allowCapabilityNegotiation);
 
-		static std::pair<SalStreamConfiguration, bool> initiateOutgoingConfiguration(MSFactory* factory, const SalStreamDescription & local_offer, const SalStreamDescription & remote_answer, const SalStreamDescription & result, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx);
+		static std::pair<SalStreamConfiguration, bool> initiateOutgoingConfiguration(MSFactory* factory, PayloadMatchCache & payloadMatches, const SalStreamDescription & local_offer, const SalStreamDescription & remote_answer, const SalStreamDescription & result, const PotentialCfgGraph::media_description_config::key_type & localCfgIdx, const PotentialCfgGraph::media_description_config::key_type & remoteCfgIdx);
 
 		static bool fillZrtpAttributes(const SalStreamDescription & localStream, const unsigned int & localCfgIdx, const SalStreamDescription & remoteStream, const unsigned int & remoteCfgIdx, SalStreamConfiguration & resultCfg);
 };
@@ -138,6 +138,9 @@ public:
 	void *getStackImpl() const { return mStack; }
 
 	int iterate () { belle_sip_stack_sleep(mStack, 0); return 0; }
+	// Runs the main loop, dispatching SIP traffic and timers, until the delay expires or wakeUp() is called.
+	void wait (int milliseconds) { belle_sip_stack_sleep(mStack, (unsigned int)milliseconds); }
+	void wakeUp () { belle_sip_main_loop_quit(belle_sip_stack_get_main_loop(mStack)); }
 
 	void setSendError (int value) { belle_sip_stack_set_send_error(mStack, value); }
 	void setRecvError (int value) { belle_sip_provider_set_recv_error(mProvider, value); }
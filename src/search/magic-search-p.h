@@ -39,6 +39,7 @@ private:
 	bool mUseDelimiter;
 	std::string mFilter;
 	bool_t mAutoResetCache; // When a new search start, let MagicSearch to clean its cache
+	bool mUseIndex; // Only compute the weight of the candidates found by the core's ContactSearchIndex
 	
 	belle_sip_source_t * mIteration;
 
@@ -20,12 +20,14 @@
 
 #include "magic-search-p.h"
 #include "search-async-data.h"
+#include "search-index.h"
 
 #include <bctoolbox/list.h>
 #include <algorithm>
 
 #include "c-wrapper/c-wrapper.h"
 #include "c-wrapper/internal/c-tools.h"
+#include "core/core-p.h"
 #include "linphone/utils/utils.h"
 #include "linphone/core.h"
 #include "linphone/types.h"
@@ -54,6 +56,7 @@ MagicSearch::MagicSearch (const std::shared_ptr<Core> &core) : CoreAccessor(core
 	d->mCacheResult = nullptr;
 	d->mIteration = nullptr;
 	d->mAutoResetCache = TRUE;
+	d->mUseIndex = !!linphone_config_get_bool(linphone_core_get_config(core->getCCore()), "magic_search", "use_index", TRUE);
 }
 
 MagicSearch::~MagicSearch () {
@@ -162,9 +165,17 @@ bool MagicSearch::iterate(void){
 		d->mAsyncData.initStartTime();
 	}
 	if( mState == STATE_WAIT){
-		if(getAddressIsEndAsync(&d->mAsyncData)){
-			mergeResults(request, &d->mAsyncData);
-			mState = STATE_SEND;
+		// Local sources are searched one per step so that the results of each source can be streamed.
+		d->mAsyncData.runNextLocalSource();
+		bool isEnd = getAddressIsEndAsync(&d->mAsyncData);
+		if (d->mAsyncData.takeNewEndedProviders() > 0 && !isEnd)
+			notifyPartialResults(request, &d->mAsyncData);
+		if (mState == STATE_WAIT) {// A new request may have been pushed from the partial results callback.
+			if(isEnd){
+				mergeResults(request, &d->mAsyncData);
+				mState = STATE_SEND;
+			}else if (d->mIteration)
+				belle_sip_source_set_timeout_int64(d->mIteration, d->mAsyncData.haveLocalSourcesPending() ? 0 : 100);
 		}
 	}
 	if( mState == STATE_SEND || mState == STATE_CANCEL){
@@ -182,6 +193,7 @@ bool MagicSearch::iterate(void){
 #endif
 		} else {
 			lInfo() << "[Magic Search] Cancelling : " << request.getFilter().c_str();
+			d->mAsyncData.cancel();
 		}
 		d->mAsyncData.clear();
 		if(d->mAsyncData.keepOneRequest()){
@@ -190,6 +202,8 @@ bool MagicSearch::iterate(void){
 			mState = STATE_START;
 		}else
 			mState = STATE_END;
+		if (d->mIteration)
+			belle_sip_source_set_timeout_int64(d->mIteration, 100);
 	}
 	if(mState == STATE_END && d->mIteration){
 		belle_sip_object_unref(d->mIteration);
@@ -298,7 +312,7 @@ static void sortResultsByFriendInList(std::shared_ptr<list<std::shared_ptr<Searc
 	});
 }
 
-list<std::shared_ptr<SearchResult>> MagicSearch::processResults(std::shared_ptr<list<std::shared_ptr<SearchResult>>> pResultList) {
+void MagicSearch::rankResults(std::shared_ptr<list<std::shared_ptr<SearchResult>>> pResultList) const {
 	L_D();
 
 	if (d->mAsyncData.mSearchRequest.getAggregation() == LinphoneMagicSearchAggregationFriend) {
@@ -308,11 +322,36 @@ list<std::shared_ptr<SearchResult>> MagicSearch::processResults(std::shared_ptr<
 
 	sortResultsList(pResultList);
 	uniqueItemsList(pResultList);
+}
+
+list<std::shared_ptr<SearchResult>> MagicSearch::processResults(std::shared_ptr<list<std::shared_ptr<SearchResult>>> pResultList) {
+	rankResults(pResultList);
 	setSearchCache(pResultList);
 	
    	return getLastSearch();
 }
 
+void MagicSearch::notifyPartialResults(const SearchRequest& request, SearchAsyncData * asyncData) {
+	// Providers results are kept untouched: they are merged again into the final list.
+	std::shared_ptr<list<std::shared_ptr<SearchResult>>> resultList = std::make_shared<list<std::shared_ptr<SearchResult>>>();
+	for (const auto &providerResults : asyncData->mProviderResults) {
+		list<std::shared_ptr<SearchResult>> results;
+		for (const auto &result : providerResults)
+			results.push_back(SearchResult::create(*result));
+		addResultsToResultsList(results, *resultList, request.getFilter(), request.getWithDomain());
+	}
+	rankResults(resultList);
+	if (getLimitedSearch() && resultList->size() > getSearchLimit()) {
+		auto limitIterator = resultList->begin();
+		advance(limitIterator, (int)getSearchLimit());
+		resultList->erase(limitIterator, resultList->end());
+	}
+	lDebug() << "[Magic Search] Streaming " << resultList->size() << " partial results for: " << request.getFilter();
+	bctbx_list_t *results = SearchResult::getCListFromCppList(*resultList);
+	_linphone_magic_search_notify_search_partial_results_received(L_GET_C_BACK_PTR(this), results);
+	bctbx_list_free_with_data(results, (bctbx_list_free_func)linphone_search_result_unref);
+}
+
 std::list<std::shared_ptr<SearchResult>> MagicSearch::getLastSearch() const {
 	L_D();
 	list<std::shared_ptr<SearchResult>> returnList = *getSearchCache();
@@ -379,12 +418,17 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromCallLog (
 	const string &withDomain,
 	const list<std::shared_ptr<SearchResult>> &currentList
 ) const {
+	L_D();
 	list<std::shared_ptr<SearchResult>> resultList;
 	const bctbx_list_t *callLog = linphone_core_get_call_logs(this->getCore()->getCCore());
 
+	vector<const void *> candidates;
+	bool useIndex = d->mUseIndex && L_GET_PRIVATE(this->getCore())->contactSearchIndex.findCallLogs(callLog, filter, candidates);
+
 	// For all call log or when we reach the search limit
 	for (const bctbx_list_t *f = callLog ; f != nullptr ; f = bctbx_list_next(f)) {
 		LinphoneCallLog *log = static_cast<LinphoneCallLog*>(f->data);
+		if (useIndex && !SearchIndex::isCandidate(candidates, log)) continue;
 		if (!linphone_call_log_was_conference(log)) {
 			const LinphoneAddress *addr = (linphone_call_log_get_dir(log) == LinphoneCallDir::LinphoneCallIncoming) ?
 			linphone_call_log_get_from_address(log) : linphone_call_log_get_to_address(log);
@@ -412,12 +456,17 @@ list<std::shared_ptr<SearchResult>> MagicSearch::getAddressFromGroupChatRoomPart
 	const string &withDomain,
 	const list<std::shared_ptr<SearchResult>> &currentList
 ) const {
+	L_D();
 	list<std::shared_ptr<SearchResult>> resultList;
 	const bctbx_list_t *chatRooms = linphone_core_get_chat_rooms(this->getCore()->getCCore());
 
+	vector<const void *> candidates;
+	bool useIndex = d->mUseIndex && L_GET_PRIVATE(this->getCore())->contactSearchIndex.findChatRooms(chatRooms, filter, candidates);
+
 	// For all call log or when we reach the search limit
 	for (const bctbx_list_t *f = chatRooms ; f != nullptr ; f = bctbx_list_next(f)) {
 		LinphoneChatRoom *room = static_cast<LinphoneChatRoom*>(f->data);
+		if (useIndex && !SearchIndex::isCandidate(candidates, room)) continue;
 		if (linphone_chat_room_get_capabilities(room) & LinphoneChatRoomCapabilitiesConference) {
 			bctbx_list_t *participants = linphone_chat_room_get_participants(room);
 			for (const bctbx_list_t *p = participants ; p != nullptr ; p = bctbx_list_next(p)) {
@@ -507,7 +556,7 @@ bool MagicSearch::getAddressIsEndAsync(SearchAsyncData* asyncData)const{
 		timeout = startTime;
 		auto data = asyncData->getData()[i];
 		bctbx_timespec_add(&timeout, data->mTimeout);
-		if( data->mEnd || bctbx_timespec_compare( &currentTime, &timeout) > 0){
+		if( data->mEnd || (data->mTimeout >= 0 && bctbx_timespec_compare( &currentTime, &timeout) > 0)){
 			if(!data->mEnd)
 				data->cancel();
 			++endCount;
@@ -542,33 +591,33 @@ std::list<list<std::shared_ptr<SearchResult>>> MagicSearch::getAddressFromLDAPSe
 void MagicSearch::beginNewSearchAsync (const SearchRequest& request, SearchAsyncData * asyncData) const{
 	asyncData->clear();
 	asyncData->setSearchRequest(request);
-	bool checkFriends = (request.getSourceFlags() & LinphoneMagicSearchSourceFriends) == LinphoneMagicSearchSourceFriends;
-	bool checkFavoriteFriends = (request.getSourceFlags() & LinphoneMagicSearchSourceFavoriteFriends) == LinphoneMagicSearchSourceFavoriteFriends;
+	// Local sources are only queued here: they are searched from iterate(), after the LDAP requests have been sent.
+	const string filter = request.getFilter();
+	const string withDomain = request.getWithDomain();
+	const int sourceFlags = request.getSourceFlags();
+	bool checkFriends = (sourceFlags & LinphoneMagicSearchSourceFriends) == LinphoneMagicSearchSourceFriends;
+	bool checkFavoriteFriends = (sourceFlags & LinphoneMagicSearchSourceFavoriteFriends) == LinphoneMagicSearchSourceFavoriteFriends;
 	if (checkFriends || checkFavoriteFriends) {
-		const bctbx_list_t *friend_lists = linphone_core_get_friends_lists(this->getCore()->getCCore());
-		list<std::shared_ptr<SearchResult>> friendsList;
-		for (const bctbx_list_t *fl = friend_lists ; fl != nullptr ; fl = bctbx_list_next(fl)) {
-			LinphoneFriendList *fList = static_cast<LinphoneFriendList*>(fl->data);
-			// For all friends or when we reach the search limit
-			for (bctbx_list_t *f = fList->friends ; f != nullptr ; f = bctbx_list_next(f)) {
-				LinphoneFriend *lFriend = static_cast<LinphoneFriend*>(f->data);
-				if (checkFriends || linphone_friend_get_starred(lFriend)) {
-					list<std::shared_ptr<SearchResult>> fResults = searchInFriend(lFriend, request.getFilter(), request.getWithDomain());
-					addResultsToResultsList(fResults, friendsList);
-				}
-			}
-		}
-		lInfo() << "[Magic Search] Found " << friendsList.size() << " results in friends";
-		asyncData->createResult(friendsList);
+		asyncData->pushLocalSource(LinphoneMagicSearchSourceFriends, [this, filter, withDomain, sourceFlags]() {
+			list<std::shared_ptr<SearchResult>> friendsList = searchInFriends(filter, withDomain, sourceFlags);
+			lInfo() << "[Magic Search] Found " << friendsList.size() << " results in friends";
+			return friendsList;
+		});
 	}
 #ifdef LDAP_ENABLED
-	if( (request.getSourceFlags() & LinphoneMagicSearchSourceLdapServers) == LinphoneMagicSearchSourceLdapServers && linphone_core_is_network_reachable(this->getCore()->getCCore()))
-		getAddressFromLDAPServerStartAsync(request.getFilter(), request.getWithDomain(), asyncData);
+	if( (sourceFlags & LinphoneMagicSearchSourceLdapServers) == LinphoneMagicSearchSourceLdapServers && linphone_core_is_network_reachable(this->getCore()->getCCore()))
+		getAddressFromLDAPServerStartAsync(filter, withDomain, asyncData);
 #endif
-	if( (request.getSourceFlags() & LinphoneMagicSearchSourceCallLogs) == LinphoneMagicSearchSourceCallLogs)
-		asyncData->createResult(getAddressFromCallLog(request.getFilter(), request.getWithDomain(), list<std::shared_ptr<SearchResult>>()));
-	if( (request.getSourceFlags() & LinphoneMagicSearchSourceChatRooms) == LinphoneMagicSearchSourceChatRooms)
-		asyncData->createResult(getAddressFromGroupChatRoomParticipants(request.getFilter(), request.getWithDomain(), list<std::shared_ptr<SearchResult>>()));
+	if( (sourceFlags & LinphoneMagicSearchSourceCallLogs) == LinphoneMagicSearchSourceCallLogs) {
+		asyncData->pushLocalSource(LinphoneMagicSearchSourceCallLogs, [this, filter, withDomain]() {
+			return getAddressFromCallLog(filter, withDomain, list<std::shared_ptr<SearchResult>>());
+		});
+	}
+	if( (sourceFlags & LinphoneMagicSearchSourceChatRooms) == LinphoneMagicSearchSourceChatRooms) {
+		asyncData->pushLocalSource(LinphoneMagicSearchSourceChatRooms, [this, filter, withDomain]() {
+			return getAddressFromGroupChatRoomParticipants(filter, withDomain, list<std::shared_ptr<SearchResult>>());
+		});
+	}
 }
 
 void MagicSearch::mergeResults (const SearchRequest& request, SearchAsyncData * asyncData) {
@@ -587,18 +636,8 @@ std::shared_ptr<list<std::shared_ptr<SearchResult>>> MagicSearch::beginNewSearch
 	bool checkFriends = (sourceFlags & LinphoneMagicSearchSourceFriends) == LinphoneMagicSearchSourceFriends;
 	bool checkFavoriteFriends = (sourceFlags & LinphoneMagicSearchSourceFavoriteFriends) == LinphoneMagicSearchSourceFavoriteFriends;
 	if (checkFriends || checkFavoriteFriends) {
-		const bctbx_list_t *friend_lists = linphone_core_get_friends_lists(this->getCore()->getCCore());
-		for (const bctbx_list_t *fl = friend_lists ; fl != nullptr ; fl = bctbx_list_next(fl)) {
-			LinphoneFriendList *fList = static_cast<LinphoneFriendList*>(fl->data);
-			// For all friends or when we reach the search limit
-			for (bctbx_list_t *f = fList->friends ; f != nullptr ; f = bctbx_list_next(f)) {
-				LinphoneFriend *lFriend = static_cast<LinphoneFriend*>(f->data);
-				if (checkFriends || linphone_friend_get_starred(lFriend)) {
-					list<std::shared_ptr<SearchResult>> fResults = searchInFriend(lFriend, filter, withDomain);
-					addResultsToResultsList(fResults, *resultList);
-				}
-			}
-		}
+		list<std::shared_ptr<SearchResult>> fResults = searchInFriends(filter, withDomain, sourceFlags);
+		addResultsToResultsList(fResults, *resultList);
 	}
 #ifdef LDAP_ENABLED
 	if( (sourceFlags & LinphoneMagicSearchSourceLdapServers) == LinphoneMagicSearchSourceLdapServers && linphone_core_is_network_reachable(this->getCore()->getCCore())){
@@ -619,6 +658,32 @@ std::shared_ptr<list<std::shared_ptr<SearchResult>>> MagicSearch::beginNewSearch
 	return resultList;
 }
 
+list<std::shared_ptr<SearchResult>> MagicSearch::searchInFriends (const string &filter, const string &withDomain, int sourceFlags) const {
+	L_D();
+	list<std::shared_ptr<SearchResult>> resultList;
+	LinphoneCore *lc = this->getCore()->getCCore();
+	bool checkFriends = (sourceFlags & LinphoneMagicSearchSourceFriends) == LinphoneMagicSearchSourceFriends;
+	const bctbx_list_t *friend_lists = linphone_core_get_friends_lists(lc);
+
+	// The index only tells which friends may match: they are still weighed in the order of their lists.
+	vector<const void *> candidates;
+	const bool useIndex = d->mUseIndex && L_GET_PRIVATE(this->getCore())->contactSearchIndex.findFriends(lc, filter, candidates);
+	for (const bctbx_list_t *fl = friend_lists ; fl != nullptr ; fl = bctbx_list_next(fl)) {
+		LinphoneFriendList *fList = static_cast<LinphoneFriendList*>(fl->data);
+		// For all friends or when we reach the search limit
+		for (bctbx_list_t *f = fList->friends ; f != nullptr ; f = bctbx_list_next(f)) {
+			LinphoneFriend *lFriend = static_cast<LinphoneFriend*>(f->data);
+			if (useIndex && !SearchIndex::isCandidate(candidates, lFriend))
+				continue;
+			if (checkFriends || linphone_friend_get_starred(lFriend)) {
+				list<std::shared_ptr<SearchResult>> fResults = searchInFriend(lFriend, filter, withDomain);
+				addResultsToResultsList(fResults, resultList);
+			}
+		}
+	}
+	return resultList;
+}
+
 std::shared_ptr<list<std::shared_ptr<SearchResult>>> MagicSearch::continueSearch (const string &filter, const string &withDomain) const {
 	std::shared_ptr<list<std::shared_ptr<SearchResult>>> resultList = std::make_shared<list<std::shared_ptr<SearchResult>>>();
 	const std::shared_ptr<list<std::shared_ptr<SearchResult>>> cacheList = getSearchCache();
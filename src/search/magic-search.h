@@ -224,6 +224,17 @@ private:
 	 **/
 	std::list<std::shared_ptr<SearchResult>> getFriends (const std::string &withDomain) const;
 
+	/**
+	 * Search in the friends of all the friend lists
+	 * Only the friends found by the core's index are checked when the filter is not empty
+	 * @param[in] filter word we search
+	 * @param[in] withDomain domain which we want to search only
+	 * @param[in] sourceFlags Flags where to search #LinphoneMagicSearchSource
+	 * @return all friends which match in a SearchResult list
+	 * @private
+	 **/
+	std::list<std::shared_ptr<SearchResult>> searchInFriends (const std::string &filter, const std::string &withDomain, int sourceFlags) const;
+
 	/**
 	 * Begin the search from friend list
 	 * @param[in] filter word we search
@@ -324,6 +335,20 @@ private:
 	 */
 	void mergeResults (const SearchRequest& request, SearchAsyncData * asyncData);
 
+	/**
+	 * @brief rankResults Sort the results and clean for unique items, following the aggregation of the current request.
+	 * @param resultList List of #SearchResult to rank in place.
+	 */
+	void rankResults (std::shared_ptr<std::list<std::shared_ptr<SearchResult>>> resultList) const;
+
+	/**
+	 * @brief notifyPartialResults Stream the ranked results of the providers that already ended.
+	 * The providers results are copied : the final merge is not altered.
+	 * @param request : #SearchRequest that define filter, domain which we want to search only and source flags where to search (#LinphoneMagicSearchSource)
+	 * @param asyncData Instance to use for all data storage.
+	 */
+	void notifyPartialResults (const SearchRequest& request, SearchAsyncData * asyncData);
+
 	/**
 	 * @brief processResults Clean for unique items and set the cache.
 	 * @return the cleaned list.
@@ -332,6 +357,7 @@ private:
 	
 	/**
 	 * @brief beginNewSearchAsync Same as beginNewSearch but on an asynchronous version : it will build the SearchAsyncData from async providers like LDAP.
+	 * Friends, call logs and chat rooms are queued as local providers, searched one per iteration.
 	 * @param request : #SearchRequest that define filter, domain which we want to search only and source flags where to search (#LinphoneMagicSearchSource)
 	 * @param asyncData Instance to use for all data storage.
 	 */
@@ -351,6 +377,7 @@ private:
 	 * @brief iterate Iteration that is executed in the main loop.
 	 * State follows this flow:
 	 * STATE_START => (STATE_WAIT) => STATE_SEND [<=] => STATE_END
+	 * While waiting, a partial batch is notified each time a provider ends.
 	 * @return 
 	 */
 	bool iterate(void);
@@ -54,6 +54,13 @@ void SearchAsyncData::CbData::resultsCb( LinphoneContactSearch* id, bctbx_list_t
 	cbData->mEnd = TRUE;
 }
 
+void SearchAsyncData::LocalCbData::run(){
+	if (mSearch)
+		*mResult = mSearch();
+	mSearch = nullptr;
+	mEnd = TRUE;
+}
+
 SearchAsyncData::SearchAsyncData(){
 	ms_mutex_init(&mLockQueue, NULL);
 	mSearchResults = nullptr;
@@ -104,6 +111,49 @@ int SearchAsyncData::pushRequest(const SearchRequest& request){
 void SearchAsyncData::pushData(std::shared_ptr<CbData> data){
 	mProvidersCbData.push_back(data);
 }
+
+void SearchAsyncData::pushLocalSource(int sourceFlags, const std::function<std::list<std::shared_ptr<SearchResult>>()> &search){
+	std::shared_ptr<LocalCbData> data = std::make_shared<LocalCbData>(sourceFlags, search);
+	data->mResult = createResult();
+	pushData(data);
+}
+
+bool SearchAsyncData::runNextLocalSource(){
+	for (auto &data : mProvidersCbData) {
+		LocalCbData *localData = dynamic_cast<LocalCbData*>(data.get());
+		if (localData && !localData->mEnd) {
+			localData->run();
+			return true;
+		}
+	}
+	return false;
+}
+
+bool SearchAsyncData::haveLocalSourcesPending() const{
+	for (const auto &data : mProvidersCbData) {
+		if (!data->mEnd && dynamic_cast<const LocalCbData*>(data.get()))
+			return true;
+	}
+	return false;
+}
+
+int SearchAsyncData::takeNewEndedProviders(){
+	int count = 0;
+	for (auto &data : mProvidersCbData) {
+		if (data->mEnd && !data->mNotified) {
+			data->mNotified = TRUE;
+			++count;
+		}
+	}
+	return count;
+}
+
+void SearchAsyncData::cancel(){
+	for (auto &data : mProvidersCbData) {
+		if (!data->mEnd)
+			data->cancel();
+	}
+}
 		
 void SearchAsyncData::initStartTime(){
 	bctbx_get_cur_time(&mStartTime);
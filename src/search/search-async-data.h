@@ -21,6 +21,7 @@
 #ifndef _L_MAGIC_SEARCH_ASYNC_DATA_H_
 #define _L_MAGIC_SEARCH_ASYNC_DATA_H_
 
+#include <functional>
 #include <string>
 #include <list>
 #include <queue>
@@ -57,6 +58,7 @@ public:
 		CbData(){
 			mEnd = FALSE;
 			mHaveMoreResults = FALSE;
+			mNotified = FALSE;
 			mTimeout = 5;// 5s is the default
 		}
 		virtual ~CbData();
@@ -81,7 +83,12 @@ public:
 		bool_t mEnd;
 
 		/**
-		 * @brief mTimeout Timeout in seconds.
+		 * @brief mNotified The results of this provider have already been streamed in a partial batch.
+		 */
+		bool_t mNotified;
+
+		/**
+		 * @brief mTimeout Timeout in seconds. A negative value means that the provider cannot time out.
 		 */
 		int64_t mTimeout;
 
@@ -116,6 +123,32 @@ public:
 		const MagicSearch * mParent;
 	};
 
+	/**
+	 * @brief The LocalCbData class. Provider that is run from the main loop, one source per step, instead of waiting for an answer.
+	 */
+	class LocalCbData : public CbData{
+	public:
+		LocalCbData(int sourceFlags, const std::function<std::list<std::shared_ptr<SearchResult>>()> &search){
+			mSourceFlags = sourceFlags;
+			mSearch = search;
+			mTimeout = -1;
+		}
+		virtual ~LocalCbData(){}
+		virtual void cancel() override{
+			mSearch = nullptr;
+		}
+
+		/**
+		 * @brief run Fill the results of the provider and end it.
+		 */
+		void run();
+
+		/**
+		 * @brief mSearch Search to do on the source.
+		 */
+		std::function<std::list<std::shared_ptr<SearchResult>>()> mSearch;
+	};
+
 
 	SearchAsyncData();
 	~SearchAsyncData();
@@ -155,6 +188,37 @@ public:
 	 */
 	void pushData(std::shared_ptr<CbData> data);
 
+	/**
+	 * @brief pushLocalSource Add a provider that is searched from the main loop. Its results keep the provider order.
+	 * @param sourceFlags Source of the provider (#LinphoneMagicSearchSource).
+	 * @param search Search to do on the source.
+	 */
+	void pushLocalSource(int sourceFlags, const std::function<std::list<std::shared_ptr<SearchResult>>()> &search);
+
+	/**
+	 * @brief runNextLocalSource Search in the next pending local source.
+	 * @return true if a source has been searched.
+	 */
+	bool runNextLocalSource();
+
+	/**
+	 * @brief haveLocalSourcesPending
+	 * @return true if some local sources have not been searched yet.
+	 */
+	bool haveLocalSourcesPending() const;
+
+	/**
+	 * @brief takeNewEndedProviders Mark the providers that ended since the last call as notified.
+	 * @return The number of providers that ended since the last call.
+	 */
+	int takeNewEndedProviders();
+
+	/**
+	 * @brief cancel Cancel the current search : pending local sources are dropped and asynchronous providers are cancelled.
+	 * It is the cancellation point used when the filter changes while searching.
+	 */
+	void cancel();
+
 	/**
 	 * @brief initStartTime To be call when starting a search for timeout computation.
 	 */
@@ -0,0 +1,442 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#include <algorithm>
+#include <functional>
+
+#include "search-index.h"
+
+#include "c-wrapper/c-wrapper.h"
+#include "call/call-log.h"
+#include "chat/chat-room/abstract-chat-room.h"
+#include "conference/participant.h"
+#include "linphone/core.h"
+#include "linphone/utils/utils.h"
+#include "private.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	constexpr size_t MaxGramSize = 3;
+
+	inline uint32_t makeGram (const char *data, size_t size) {
+		uint32_t gram = uint32_t(size) << 24;
+		for (size_t i = 0; i < size; ++i)
+			gram |= uint32_t(static_cast<unsigned char>(data[i])) << (8 * (2 - i));
+		return gram;
+	}
+
+	inline void addString (vector<string> &strings, const char *value) {
+		if (value && value[0] != '\0')
+			strings.emplace_back(value);
+	}
+
+	inline void addString (vector<string> &strings, const string &value) {
+		if (!value.empty())
+			strings.push_back(value);
+	}
+}
+
+// -----------------------------------------------------------------------------
+
+void SearchIndex::set (const void *key, const vector<string> &strings) {
+	int id;
+	auto it = mIds.find(key);
+	if (it != mIds.end()) {
+		id = it->second;
+		eraseGrams(id);
+	} else if (!mFreeIds.empty()) {
+		id = mFreeIds.back();
+		mFreeIds.pop_back();
+		mIds[key] = id;
+	} else {
+		id = int(mEntries.size());
+		mEntries.emplace_back();
+		mIds[key] = id;
+	}
+
+	Entry &entry = mEntries[size_t(id)];
+	entry.key = key;
+	entry.text.clear();
+	for (const auto &value : strings) {
+		if (!entry.text.empty())
+			entry.text += '\0';
+		entry.text += normalize(value);
+	}
+	insertGrams(id);
+}
+
+bool SearchIndex::remove (const void *key) {
+	auto it = mIds.find(key);
+	if (it == mIds.end())
+		return false;
+
+	const int id = it->second;
+	eraseGrams(id);
+	Entry &entry = mEntries[size_t(id)];
+	entry.key = nullptr;
+	entry.text.clear();
+	mFreeIds.push_back(id);
+	mIds.erase(it);
+	return true;
+}
+
+bool SearchIndex::contains (const void *key) const {
+	return mIds.find(key) != mIds.end();
+}
+
+void SearchIndex::clear () {
+	mEntries.clear();
+	mFreeIds.clear();
+	mIds.clear();
+	mPostings.clear();
+}
+
+bool SearchIndex::find (const string &filter, vector<const void *> &candidates) const {
+	candidates.clear();
+	const string value = normalize(filter);
+	if (value.empty())
+		return false;
+
+	// Short filters are a gram by themselves, longer ones must contain all their trigrams.
+	vector<uint32_t> grams;
+	if (value.size() <= MaxGramSize)
+		grams.push_back(makeGram(value.data(), value.size()));
+	else {
+		for (size_t i = 0; i + MaxGramSize <= value.size(); ++i)
+			grams.push_back(makeGram(value.data() + i, MaxGramSize));
+		sort(grams.begin(), grams.end());
+		grams.erase(unique(grams.begin(), grams.end()), grams.end());
+	}
+
+	vector<const vector<int> *> postings;
+	postings.reserve(grams.size());
+	for (uint32_t gram : grams) {
+		auto it = mPostings.find(gram);
+		if (it == mPostings.end())
+			return true;
+		postings.push_back(&it->second);
+	}
+
+	// Intersect from the most selective gram.
+	sort(postings.begin(), postings.end(), [](const vector<int> *a, const vector<int> *b) {
+		return a->size() < b->size();
+	});
+	vector<int> ids(*postings.front());
+	vector<int> intersection;
+	for (size_t i = 1; i < postings.size() && !ids.empty(); ++i) {
+		intersection.clear();
+		set_intersection(
+			ids.begin(), ids.end(),
+			postings[i]->begin(), postings[i]->end(),
+			back_inserter(intersection)
+		);
+		ids.swap(intersection);
+	}
+
+	candidates.reserve(ids.size());
+	for (int id : ids)
+		candidates.push_back(mEntries[size_t(id)].key);
+	sort(candidates.begin(), candidates.end());
+	return true;
+}
+
+bool SearchIndex::isCandidate (const vector<const void *> &candidates, const void *key) {
+	return binary_search(candidates.begin(), candidates.end(), key);
+}
+
+void SearchIndex::insertGrams (int id) {
+	vector<uint32_t> grams;
+	getGrams(mEntries[size_t(id)].text, grams);
+	for (uint32_t gram : grams) {
+		vector<int> &ids = mPostings[gram];
+		if (ids.empty() || ids.back() < id)
+			ids.push_back(id);
+		else
+			ids.insert(lower_bound(ids.begin(), ids.end(), id), id);
+	}
+}
+
+void SearchIndex::eraseGrams (int id) {
+	vector<uint32_t> grams;
+	getGrams(mEntries[size_t(id)].text, grams);
+	for (uint32_t gram : grams) {
+		auto it = mPostings.find(gram);
+		if (it == mPostings.end())
+			continue;
+
+		vector<int> &ids = it->second;
+		auto idIt = lower_bound(ids.begin(), ids.end(), id);
+		if (idIt != ids.end() && *idIt == id)
+			ids.erase(idIt);
+		if (ids.empty())
+			mPostings.erase(it);
+	}
+}
+
+// MagicSearch lowers its strings with the current locale. Non ASCII bytes are folded together here so that the
+// index is a superset of the matches whatever the locale is.
+string SearchIndex::normalize (const string &value) {
+	string result(value);
+	for (char &c : result) {
+		const unsigned char uc = static_cast<unsigned char>(c);
+		if (uc >= 0x80)
+			c = static_cast<char>(0x80);
+		else if (uc >= 'A' && uc <= 'Z')
+			c = static_cast<char>(uc - 'A' + 'a');
+	}
+	return result;
+}
+
+void SearchIndex::getGrams (const string &text, vector<uint32_t> &grams) {
+	grams.clear();
+	size_t begin = 0;
+	while (begin <= text.size()) {
+		size_t end = text.find('\0', begin);
+		if (end == string::npos)
+			end = text.size();
+		for (size_t size = 1; size <= MaxGramSize; ++size)
+			for (size_t i = begin; i + size <= end; ++i)
+				grams.push_back(makeGram(text.data() + i, size));
+		begin = end + 1;
+	}
+	sort(grams.begin(), grams.end());
+	grams.erase(unique(grams.begin(), grams.end()), grams.end());
+}
+
+// -----------------------------------------------------------------------------
+
+ContactSearchIndex::~ContactSearchIndex () {
+	clear();
+}
+
+void ContactSearchIndex::updateFriend (LinphoneFriend *lf) {
+	if (mTrackedFriends.insert(lf).second)
+		linphone_friend_ref(lf);
+	mPendingFriends.insert(lf);
+}
+
+void ContactSearchIndex::removeFriend (LinphoneFriend *lf) {
+	if (mTrackedFriends.erase(lf) == 0)
+		return;
+
+	mPendingFriends.erase(lf);
+	mFriendsWithPhoneNumbers.erase(lf);
+	mFriends.remove(lf);
+	linphone_friend_unref(lf);
+}
+
+bool ContactSearchIndex::findFriends (LinphoneCore *lc, const string &filter, vector<const void *> &candidates) {
+	if (filter.empty())
+		return false;
+
+	string normalization = getPhoneNumberNormalization(lc);
+	if (normalization != mPhoneNumberNormalization) {
+		mPhoneNumberNormalization = move(normalization);
+		mPendingFriends.insert(mFriendsWithPhoneNumbers.begin(), mFriendsWithPhoneNumbers.end());
+	}
+
+	for (LinphoneFriend *lf : mPendingFriends)
+		indexFriend(lc, lf);
+	mPendingFriends.clear();
+
+	return mFriends.find(filter, candidates);
+}
+
+bool ContactSearchIndex::findCallLogs (const bctbx_list_t *callLogs, const string &filter, vector<const void *> &candidates) {
+	if (filter.empty())
+		return false;
+
+	++mGeneration;
+	for (const bctbx_list_t *it = callLogs; it; it = bctbx_list_next(it)) {
+		LinphoneCallLog *log = static_cast<LinphoneCallLog *>(bctbx_list_get_data(it));
+		const LinphoneAddress *address = (linphone_call_log_get_dir(log) == LinphoneCallIncoming)
+			? linphone_call_log_get_from_address(log)
+			: linphone_call_log_get_to_address(log);
+
+		// The key may belong to a destroyed call log: compare the owner too.
+		CallLog *callLog = CallLog::toCpp(log);
+		auto stateIt = mCallLogStates.find(log);
+		if (
+			stateIt != mCallLogStates.end() &&
+			stateIt->second.callLog.lock().get() == callLog &&
+			stateIt->second.address == address
+		) {
+			stateIt->second.generation = mGeneration;
+			continue;
+		}
+
+		vector<string> strings;
+		if (address) {
+			addString(strings, linphone_address_get_username(address));
+			addString(strings, linphone_address_get_display_name(address));
+		}
+		mCallLogs.set(log, strings);
+		mCallLogStates[log] = CallLogState{ callLog->getSharedFromThis(), address, mGeneration };
+	}
+
+	for (auto it = mCallLogStates.begin(); it != mCallLogStates.end(); ) {
+		if (it->second.generation != mGeneration) {
+			mCallLogs.remove(it->first);
+			it = mCallLogStates.erase(it);
+		} else
+			++it;
+	}
+
+	return mCallLogs.find(filter, candidates);
+}
+
+bool ContactSearchIndex::findChatRooms (const bctbx_list_t *chatRooms, const string &filter, vector<const void *> &candidates) {
+	if (filter.empty())
+		return false;
+
+	++mGeneration;
+	for (const bctbx_list_t *it = chatRooms; it; it = bctbx_list_next(it)) {
+		LinphoneChatRoom *room = static_cast<LinphoneChatRoom *>(bctbx_list_get_data(it));
+		shared_ptr<AbstractChatRoom> chatRoom = L_GET_CPP_PTR_FROM_C_OBJECT(room);
+		const bool isConference = !!(linphone_chat_room_get_capabilities(room) & LinphoneChatRoomCapabilitiesConference);
+
+		// Participants are added or removed but never modified: they identify the indexed strings.
+		size_t fingerprint = isConference ? 1 : 0;
+		if (isConference) {
+			for (const auto &participant : chatRoom->getParticipants()) {
+				fingerprint = fingerprint * 31 + hash<const Participant *>()(participant.get());
+				fingerprint = fingerprint * 31 + hash<string>()(participant->getAddress().getUsername());
+			}
+		}
+
+		auto stateIt = mChatRoomStates.find(room);
+		if (
+			stateIt != mChatRoomStates.end() &&
+			stateIt->second.chatRoom.lock() == chatRoom &&
+			stateIt->second.fingerprint == fingerprint
+		) {
+			stateIt->second.generation = mGeneration;
+			continue;
+		}
+
+		vector<string> strings;
+		if (isConference) {
+			for (const auto &participant : chatRoom->getParticipants()) {
+				const Address &address = participant->getAddress().asAddress();
+				addString(strings, address.getUsername());
+				addString(strings, address.getDisplayName());
+			}
+		} else if (chatRoom->getPeerAddress().isValid()) {
+			const Address &address = chatRoom->getPeerAddress().asAddress();
+			addString(strings, address.getUsername());
+			addString(strings, address.getDisplayName());
+		}
+		mChatRooms.set(room, strings);
+		mChatRoomStates[room] = ChatRoomState{ chatRoom, fingerprint, mGeneration };
+	}
+
+	for (auto it = mChatRoomStates.begin(); it != mChatRoomStates.end(); ) {
+		if (it->second.generation != mGeneration) {
+			mChatRooms.remove(it->first);
+			it = mChatRoomStates.erase(it);
+		} else
+			++it;
+	}
+
+	return mChatRooms.find(filter, candidates);
+}
+
+void ContactSearchIndex::clear () {
+	for (LinphoneFriend *lf : mTrackedFriends)
+		linphone_friend_unref(lf);
+	mTrackedFriends.clear();
+	mPendingFriends.clear();
+	mFriendsWithPhoneNumbers.clear();
+	mPhoneNumberNormalization.clear();
+	mFriends.clear();
+
+	mCallLogStates.clear();
+	mCallLogs.clear();
+	mChatRoomStates.clear();
+	mChatRooms.clear();
+}
+
+// Index the strings checked by MagicSearch::searchInFriend().
+void ContactSearchIndex::indexFriend (LinphoneCore *lc, LinphoneFriend *lf) {
+	vector<string> strings;
+
+	LinphoneVcard *vcard = linphone_friend_get_vcard(lf);
+	if (vcard) {
+		addString(strings, linphone_vcard_get_full_name(vcard));
+		addString(strings, linphone_vcard_get_organization(vcard));
+	}
+	addString(strings, linphone_friend_get_name(lf));
+
+	const bctbx_list_t *addresses = linphone_friend_get_addresses(lf);
+	for (const bctbx_list_t *it = addresses; it && bctbx_list_get_data(it); it = bctbx_list_next(it)) {
+		const LinphoneAddress *address = static_cast<const LinphoneAddress *>(bctbx_list_get_data(it));
+		addString(strings, linphone_address_get_username(address));
+		addString(strings, linphone_address_get_display_name(address));
+	}
+	// Without vCard, the list is built on each call.
+	if (!linphone_core_vcard_supported())
+		bctbx_list_free(const_cast<bctbx_list_t *>(addresses));
+
+	LinphoneProxyConfig *proxy = linphone_core_get_default_proxy_config(lc);
+	bctbx_list_t *phoneNumbers = linphone_friend_get_phone_numbers(lf);
+	for (const bctbx_list_t *it = phoneNumbers; it && bctbx_list_get_data(it); it = bctbx_list_next(it)) {
+		const char *phoneNumber = static_cast<const char *>(bctbx_list_get_data(it));
+		addString(strings, phoneNumber);
+		if (proxy) {
+			char *normalized = linphone_proxy_config_normalize_phone_number(proxy, phoneNumber);
+			if (normalized) {
+				addString(strings, normalized);
+				bctbx_free(normalized);
+			}
+		}
+
+		const LinphonePresenceModel *presence = linphone_friend_get_presence_model_for_uri_or_tel(lf, phoneNumber);
+		char *contact = presence ? linphone_presence_model_get_contact(presence) : nullptr;
+		if (contact) {
+			addString(strings, contact);
+			bctbx_free(contact);
+		}
+	}
+
+	if (phoneNumbers) {
+		mFriendsWithPhoneNumbers.insert(lf);
+		bctbx_list_free(phoneNumbers);
+	} else
+		mFriendsWithPhoneNumbers.erase(lf);
+
+	mFriends.set(lf, strings);
+}
+
+string ContactSearchIndex::getPhoneNumberNormalization (LinphoneCore *lc) {
+	const LinphoneProxyConfig *proxy = linphone_core_get_default_proxy_config(lc);
+	if (!proxy)
+		return string();
+
+	const char *prefix = linphone_proxy_config_get_dial_prefix(proxy);
+	return Utils::toString(static_cast<const void *>(proxy)) + "/" + (prefix ? prefix : "") +
+		(linphone_proxy_config_get_dial_escape_plus(proxy) ? "/+" : "/");
+}
+
+LINPHONE_END_NAMESPACE
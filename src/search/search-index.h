@@ -0,0 +1,138 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+#ifndef _L_SEARCH_INDEX_H_
+#define _L_SEARCH_INDEX_H_
+
+#include <cstdint>
+#include <memory>
+#include <string>
+#include <unordered_map>
+#include <unordered_set>
+#include <vector>
+
+#include <bctoolbox/list.h>
+
+#include "linphone/types.h"
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+class AbstractChatRoom;
+class CallLog;
+
+// Inverted index of the 1, 2 and 3-grams of lowercased strings, keyed by the object owning them.
+// A filter is looked up from its trigrams: found keys are a superset of the keys having a string containing the
+// filter, the caller still has to compute the weight of each candidate.
+class SearchIndex {
+public:
+	// Adds the key or replaces its strings.
+	void set (const void *key, const std::vector<std::string> &strings);
+	bool remove (const void *key);
+	bool contains (const void *key) const;
+	void clear ();
+
+	size_t getSize () const {
+		return mIds.size();
+	}
+
+	// Fills candidates with the keys that may match the filter, sorted by address.
+	// Returns false if the filter is empty: every key matches and the index is useless.
+	bool find (const std::string &filter, std::vector<const void *> &candidates) const;
+
+	static bool isCandidate (const std::vector<const void *> &candidates, const void *key);
+
+private:
+	struct Entry {
+		const void *key = nullptr;
+		// Normalized strings, separated by '\0'.
+		std::string text;
+	};
+
+	void insertGrams (int id);
+	void eraseGrams (int id);
+
+	static std::string normalize (const std::string &value);
+	static void getGrams (const std::string &text, std::vector<uint32_t> &grams);
+
+	std::vector<Entry> mEntries;
+	std::vector<int> mFreeIds;
+	std::unordered_map<const void *, int> mIds;
+	// Sorted entry ids per gram.
+	std::unordered_map<uint32_t, std::vector<int>> mPostings;
+};
+
+// Indexes of the sources searched locally by MagicSearch, shared by all the MagicSearch of a core.
+// Friends are updated when they are modified (see linphone_core_update_friend_search_index()), call logs and
+// chat rooms are synchronized with the core at each search: only the changed ones are indexed again.
+class ContactSearchIndex {
+public:
+	ContactSearchIndex () = default;
+	~ContactSearchIndex ();
+
+	void updateFriend (LinphoneFriend *lf);
+	void removeFriend (LinphoneFriend *lf);
+
+	bool findFriends (LinphoneCore *lc, const std::string &filter, std::vector<const void *> &candidates);
+	bool findCallLogs (const bctbx_list_t *callLogs, const std::string &filter, std::vector<const void *> &candidates);
+	bool findChatRooms (const bctbx_list_t *chatRooms, const std::string &filter, std::vector<const void *> &candidates);
+
+	void clear ();
+
+private:
+	struct CallLogState {
+		std::weak_ptr<CallLog> callLog;
+		const LinphoneAddress *address;
+		unsigned int generation;
+	};
+
+	struct ChatRoomState {
+		std::weak_ptr<AbstractChatRoom> chatRoom;
+		size_t fingerprint;
+		unsigned int generation;
+	};
+
+	void indexFriend (LinphoneCore *lc, LinphoneFriend *lf);
+
+	static std::string getPhoneNumberNormalization (LinphoneCore *lc);
+
+	SearchIndex mFriends;
+	SearchIndex mCallLogs;
+	SearchIndex mChatRooms;
+
+	// Friends are referenced while they are tracked, pending ones are indexed at the next search.
+	std::unordered_set<LinphoneFriend *> mTrackedFriends;
+	std::unordered_set<LinphoneFriend *> mPendingFriends;
+	// Normalized phone numbers depend on the default proxy config.
+	std::unordered_set<LinphoneFriend *> mFriendsWithPhoneNumbers;
+	std::string mPhoneNumberNormalization;
+
+	std::unordered_map<const void *, CallLogState> mCallLogStates;
+	std::unordered_map<const void *, ChatRoomState> mChatRoomStates;
+	unsigned int mGeneration = 0;
+
+	L_DISABLE_COPY(ContactSearchIndex);
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_SEARCH_INDEX_H_
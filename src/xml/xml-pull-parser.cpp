@@ -0,0 +1,320 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone 
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include <cctype>
+#include <cstdlib>
+
+#include "xml-pull-parser.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+namespace {
+	const string XmlNamespace = "http://www.w3.org/XML/1998/namespace";
+
+	void appendUtf8 (string &value, unsigned long codePoint) {
+		if (codePoint < 0x80) {
+			value += char(codePoint);
+		} else if (codePoint < 0x800) {
+			value += char(0xC0 | (codePoint >> 6));
+			value += char(0x80 | (codePoint & 0x3F));
+		} else if (codePoint < 0x10000) {
+			value += char(0xE0 | (codePoint >> 12));
+			value += char(0x80 | ((codePoint >> 6) & 0x3F));
+			value += char(0x80 | (codePoint & 0x3F));
+		} else {
+			value += char(0xF0 | (codePoint >> 18));
+			value += char(0x80 | ((codePoint >> 12) & 0x3F));
+			value += char(0x80 | ((codePoint >> 6) & 0x3F));
+			value += char(0x80 | (codePoint & 0x3F));
+		}
+	}
+}
+
+XmlPullParser::XmlPullParser (const string &document) : document(document) {}
+
+XmlPullParser::Event XmlPullParser::next () {
+	if (failed)
+		return Event::Error;
+
+	if (pendingEndElement) {
+		pendingEndElement = false;
+		return closeElement();
+	}
+
+	while (position < document.size()) {
+		if (document[position] != '<') {
+			size_t end = document.find('<', position);
+			if (end == string::npos)
+				end = document.size();
+			if (elements.empty()) {
+				// Nothing but whitespaces is allowed around the root element.
+				for (size_t i = position; i < end; i++) {
+					if (!isspace(static_cast<unsigned char>(document[i])))
+						return error();
+				}
+				position = end;
+				continue;
+			}
+			if (!unescape(position, end, text))
+				return error();
+			position = end;
+			return Event::Text;
+		}
+
+		if (startsWith("<?")) {
+			const size_t end = document.find("?>", position + 2);
+			if (end == string::npos)
+				return error();
+			position = end + 2;
+		} else if (startsWith("<!--")) {
+			const size_t end = document.find("-->", position + 4);
+			if (end == string::npos)
+				return error();
+			position = end + 3;
+		} else if (startsWith("<![CDATA[")) {
+			const size_t begin = position + 9;
+			const size_t end = document.find("]]>", begin);
+			if (elements.empty() || (end == string::npos))
+				return error();
+			text.assign(document, begin, end - begin);
+			position = end + 3;
+			return Event::Text;
+		} else if (startsWith("<!")) {
+			// DOCTYPE and internal subsets.
+			return error();
+		} else if (startsWith("</")) {
+			return parseEndTag();
+		} else {
+			return parseStartTag();
+		}
+	}
+
+	if (!rootParsed || !elements.empty())
+		return error();
+	return Event::EndDocument;
+}
+
+const string &XmlPullParser::getNamespace () const {
+	return namespaceUri;
+}
+
+bool XmlPullParser::getAttribute (const char *name, string &value) const {
+	for (const auto &attribute : attributes) {
+		if (attribute.first == name) {
+			value = attribute.second;
+			return true;
+		}
+	}
+	return false;
+}
+
+// -----------------------------------------------------------------------------
+
+XmlPullParser::Event XmlPullParser::error () {
+	failed = true;
+	return Event::Error;
+}
+
+XmlPullParser::Event XmlPullParser::parseStartTag () {
+	position++;
+	string qualifiedName;
+	if (!parseName(qualifiedName) || (elements.empty() && rootParsed))
+		return error();
+
+	const size_t namespaceCount = namespaces.size();
+	attributes.clear();
+	for (;;) {
+		skipWhitespaces();
+		if (position >= document.size())
+			return error();
+		if (document[position] == '>') {
+			position++;
+			break;
+		}
+		if (startsWith("/>")) {
+			position += 2;
+			pendingEndElement = true;
+			break;
+		}
+
+		string name;
+		if (!parseName(name))
+			return error();
+		skipWhitespaces();
+		if ((position >= document.size()) || (document[position] != '='))
+			return error();
+		position++;
+		skipWhitespaces();
+		if (position >= document.size())
+			return error();
+		const char quote = document[position];
+		if ((quote != '"') && (quote != '\''))
+			return error();
+		const size_t end = document.find(quote, position + 1);
+		if (end == string::npos)
+			return error();
+		string value;
+		if (!unescape(position + 1, end, value))
+			return error();
+		position = end + 1;
+
+		if (name == "xmlns")
+			namespaces.emplace_back(string(), move(value));
+		else if (name.compare(0, 6, "xmlns:") == 0)
+			namespaces.emplace_back(name.substr(6), move(value));
+		else
+			attributes.emplace_back(move(name), move(value));
+	}
+
+	elements.push_back({ qualifiedName, namespaceCount });
+	rootParsed = true;
+
+	string prefix;
+	setLocalName(qualifiedName, prefix);
+	const string *uri = findNamespace(prefix);
+	if (!uri && !prefix.empty())
+		return error();
+	namespaceUri = uri ? *uri : string();
+	return Event::StartElement;
+}
+
+XmlPullParser::Event XmlPullParser::parseEndTag () {
+	position += 2;
+	string qualifiedName;
+	if (!parseName(qualifiedName))
+		return error();
+	skipWhitespaces();
+	if ((position >= document.size()) || (document[position] != '>'))
+		return error();
+	position++;
+	if (elements.empty() || (elements.back().qualifiedName != qualifiedName))
+		return error();
+	return closeElement();
+}
+
+XmlPullParser::Event XmlPullParser::closeElement () {
+	string prefix;
+	setLocalName(elements.back().qualifiedName, prefix);
+	const string *uri = findNamespace(prefix);
+	namespaceUri = uri ? *uri : string();
+	namespaces.resize(elements.back().namespaceCount);
+	elements.pop_back();
+	return Event::EndElement;
+}
+
+bool XmlPullParser::parseName (string &name) {
+	const size_t begin = position;
+	while (position < document.size()) {
+		const char c = document[position];
+		if (isspace(static_cast<unsigned char>(c)) || (c == '/') || (c == '>') || (c == '=') || (c == '<') || (c == '"') || (c == '\''))
+			break;
+		position++;
+	}
+	if (position == begin)
+		return false;
+	name.assign(document, begin, position - begin);
+	return true;
+}
+
+bool XmlPullParser::unescape (size_t begin, size_t end, string &value) const {
+	value.clear();
+	value.reserve(end - begin);
+	for (size_t i = begin; i < end; i++) {
+		const char c = document[i];
+		if (c == '\r') {
+			// End of lines are normalized to a single line feed.
+			if ((i + 1 < end) && (document[i + 1] == '\n'))
+				continue;
+			value += '\n';
+			continue;
+		}
+		if (c != '&') {
+			value += c;
+			continue;
+		}
+
+		const size_t semicolon = document.find(';', i);
+		if ((semicolon == string::npos) || (semicolon >= end))
+			return false;
+		const size_t length = semicolon - i - 1;
+		if (document.compare(i + 1, length, "amp") == 0)
+			value += '&';
+		else if (document.compare(i + 1, length, "lt") == 0)
+			value += '<';
+		else if (document.compare(i + 1, length, "gt") == 0)
+			value += '>';
+		else if (document.compare(i + 1, length, "quot") == 0)
+			value += '"';
+		else if (document.compare(i + 1, length, "apos") == 0)
+			value += '\'';
+		else if ((length > 1) && (document[i + 1] == '#')) {
+			const bool hexadecimal = (document[i + 2] == 'x');
+			const size_t digits = i + (hexadecimal ? 3 : 2);
+			if (digits >= semicolon)
+				return false;
+			char *parsedEnd = nullptr;
+			const unsigned long codePoint = strtoul(document.c_str() + digits, &parsedEnd, hexadecimal ? 16 : 10);
+			if ((parsedEnd != document.c_str() + semicolon) || (codePoint == 0) || (codePoint > 0x10FFFF))
+				return false;
+			appendUtf8(value, codePoint);
+		} else {
+			return false;
+		}
+		i = semicolon;
+	}
+	return true;
+}
+
+void XmlPullParser::skipWhitespaces () {
+	while ((position < document.size()) && isspace(static_cast<unsigned char>(document[position])))
+		position++;
+}
+
+bool XmlPullParser::startsWith (const char *token) const {
+	return document.compare(position, char_traits<char>::length(token), token) == 0;
+}
+
+void XmlPullParser::setLocalName (const string &qualifiedName, string &prefix) {
+	const size_t colon = qualifiedName.find(':');
+	if (colon == string::npos) {
+		prefix.clear();
+		localName = qualifiedName;
+	} else {
+		prefix.assign(qualifiedName, 0, colon);
+		localName.assign(qualifiedName, colon + 1, string::npos);
+	}
+}
+
+const string *XmlPullParser::findNamespace (const string &prefix) const {
+	if (prefix == "xml")
+		return &XmlNamespace;
+	for (auto it = namespaces.crbegin(); it != namespaces.crend(); it++) {
+		if (it->first == prefix)
+			return &it->second;
+	}
+	return nullptr;
+}
+
+LINPHONE_END_NAMESPACE
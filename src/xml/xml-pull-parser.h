@@ -0,0 +1,101 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone 
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _L_XML_PULL_PARSER_H_
+#define _L_XML_PULL_PARSER_H_
+
+#include <string>
+#include <utility>
+#include <vector>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+// Minimal non-validating pull parser, meant for small documents whose structure is known by the caller.
+// It reads the document in place without building any tree. Namespace prefixes are resolved.
+// Documents with a DTD are not supported and are reported as errors. The caller is expected to fall back
+// on the generated parsers in that case.
+class XmlPullParser {
+public:
+	enum class Event {
+		StartElement,
+		EndElement,
+		Text,
+		EndDocument,
+		Error
+	};
+
+	// The document is read in place and must outlive the parser.
+	explicit XmlPullParser (const std::string &document);
+	XmlPullParser (const std::string &&document) = delete;
+
+	Event next ();
+
+	// Name and namespace of the element that has just been started or ended.
+	const std::string &getLocalName () const { return localName; }
+	const std::string &getNamespace () const;
+	int getDepth () const { return int(elements.size()); }
+
+	// Only valid on StartElement. Attributes are matched on their qualified name, so this is meant for attributes
+	// without prefix and for the reserved xml prefix (xml:lang).
+	bool getAttribute (const char *name, std::string &value) const;
+
+	// Only valid on Text, entities and character references are already replaced.
+	const std::string &getText () const { return text; }
+
+private:
+	struct Element {
+		std::string qualifiedName;
+		size_t namespaceCount;
+	};
+
+	Event error ();
+	Event parseStartTag ();
+	Event parseEndTag ();
+	Event closeElement ();
+	bool parseName (std::string &name);
+	bool unescape (size_t begin, size_t end, std::string &value) const;
+	void skipWhitespaces ();
+	bool startsWith (const char *token) const;
+	void setLocalName (const std::string &qualifiedName, std::string &prefix);
+	const std::string *findNamespace (const std::string &prefix) const;
+
+	const std::string &document;
+	size_t position = 0;
+	bool failed = false;
+	bool pendingEndElement = false;
+	bool rootParsed = false;
+
+	std::vector<Element> elements;
+	// Prefix and URI of every namespace declared by the opened elements, the innermost last.
+	std::vector<std::pair<std::string, std::string>> namespaces;
+	std::vector<std::pair<std::string, std::string>> attributes;
+	std::string localName;
+	std::string namespaceUri;
+	std::string text;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_XML_PULL_PARSER_H_
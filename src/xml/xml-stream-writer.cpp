@@ -0,0 +1,127 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone 
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "xml-stream-writer.h"
+
+// =============================================================================
+
+using namespace std;
+
+LINPHONE_BEGIN_NAMESPACE
+
+XmlStreamWriter::XmlStreamWriter () {
+	// Small documents such as IMDN or is-composing fit in a single allocation.
+	document.reserve(256);
+	document += "<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\"?>";
+}
+
+void XmlStreamWriter::startElement (const char *name) {
+	closeStartTag();
+	document += '<';
+	document += name;
+	openedElements.push_back(name);
+	startTagOpened = true;
+}
+
+void XmlStreamWriter::writeAttribute (const char *name, const string &value) {
+	if (!startTagOpened)
+		return;
+	document += ' ';
+	document += name;
+	document += "=\"";
+	escape(value, true);
+	document += '"';
+}
+
+void XmlStreamWriter::writeText (const string &text) {
+	if (text.empty())
+		return;
+	closeStartTag();
+	escape(text, false);
+}
+
+void XmlStreamWriter::endElement () {
+	if (openedElements.empty())
+		return;
+	if (startTagOpened) {
+		document += "/>";
+		startTagOpened = false;
+	} else {
+		document += "</";
+		document += openedElements.back();
+		document += '>';
+	}
+	openedElements.pop_back();
+}
+
+void XmlStreamWriter::writeElement (const char *name, const string &text) {
+	startElement(name);
+	writeText(text);
+	endElement();
+}
+
+const string &XmlStreamWriter::getDocument () {
+	while (!openedElements.empty())
+		endElement();
+	return document;
+}
+
+// -----------------------------------------------------------------------------
+
+void XmlStreamWriter::closeStartTag () {
+	if (startTagOpened) {
+		document += '>';
+		startTagOpened = false;
+	}
+}
+
+void XmlStreamWriter::escape (const string &value, bool isAttribute) {
+	for (const char c : value) {
+		switch (c) {
+			case '&':
+				document += "&amp;";
+				break;
+			case '<':
+				document += "&lt;";
+				break;
+			case '>':
+				if (isAttribute)
+					document += c;
+				else
+					document += "&gt;";
+				break;
+			case '"':
+				if (isAttribute)
+					document += "&quot;";
+				else
+					document += c;
+				break;
+			case '\r':
+				document += "&#xD;";
+				break;
+			default:
+				document += c;
+				break;
+		}
+	}
+}
+
+LINPHONE_END_NAMESPACE
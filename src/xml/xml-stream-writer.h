@@ -0,0 +1,62 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone 
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#ifndef _L_XML_STREAM_WRITER_H_
+#define _L_XML_STREAM_WRITER_H_
+
+#include <string>
+#include <vector>
+
+#include "linphone/utils/general.h"
+
+// =============================================================================
+
+LINPHONE_BEGIN_NAMESPACE
+
+// Writes an XML document straight into a string, the same way the generated serializers do with the
+// Xsd::XmlSchema::Flags::dont_pretty_print flag: no indentation, and elements without content are self-closed.
+class XmlStreamWriter {
+public:
+	XmlStreamWriter ();
+
+	void startElement (const char *name);
+	void writeAttribute (const char *name, const std::string &value);
+	void writeText (const std::string &text);
+	void endElement ();
+
+	// Convenience for an element that only holds text.
+	void writeElement (const char *name, const std::string &text);
+
+	// Closes all the elements still opened and returns the document.
+	const std::string &getDocument ();
+
+private:
+	void closeStartTag ();
+	void escape (const std::string &value, bool isAttribute);
+
+	std::string document;
+	std::vector<const char *> openedElements;
+	bool startTagOpened = false;
+};
+
+LINPHONE_END_NAMESPACE
+
+#endif // ifndef _L_XML_STREAM_WRITER_H_
@@ -425,6 +425,99 @@ static void call_with_ice_stun_not_responding(void){
 	linphone_core_manager_destroy(pauline);
 }
 
+static int sum_ice_latency_histogram(const int *histogram){
+	int sum = 0;
+	for (int i = 0; i < LINPHONE_ICE_LATENCY_HISTOGRAM_SIZE; i++)
+		sum += histogram[i];
+	return sum;
+}
+
+static void calls_with_ice_sharing_server_reflexive_candidates(void){
+	LinphoneCoreManager * marie = linphone_core_manager_new( "marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	const LinphoneCoreIceSchedulerStats *stats;
+
+	/* Must be set before the first call, the scheduler reads it when it is created. */
+	linphone_config_set_int(linphone_core_get_config(marie->lc), "net", "ice_srflx_cache_ttl", 30000);
+	linphone_core_reset_ice_scheduler_stats(marie->lc);
+
+	_call_with_ice_base(marie, pauline, TRUE, TRUE, FALSE, FALSE, FALSE);
+	stats = linphone_core_get_ice_scheduler_stats(marie->lc);
+	BC_ASSERT_EQUAL(stats->number_of_gatherings, 1, int, "%d");
+	BC_ASSERT_EQUAL(stats->number_of_shared_gatherings, 0, int, "%d");
+
+	/* There is no NAT between the tester and the STUN server: the first call recorded a mapping of the host address
+	 * to itself, so the second call skips the gathering. */
+	_call_with_ice_base(marie, pauline, TRUE, TRUE, FALSE, FALSE, FALSE);
+	stats = linphone_core_get_ice_scheduler_stats(marie->lc);
+	BC_ASSERT_EQUAL(stats->number_of_gatherings, 1, int, "%d");
+	BC_ASSERT_EQUAL(stats->number_of_shared_gatherings, 1, int, "%d");
+	BC_ASSERT_EQUAL(sum_ice_latency_histogram(stats->gathering_latency_histogram), 1, int, "%d");
+	/* The checks are started once per call, the re-INVITE sent once ICE has completed does not start them again. */
+	BC_ASSERT_EQUAL(stats->number_of_checks, 2, int, "%d");
+	BC_ASSERT_EQUAL(stats->number_of_pending, 0, int, "%d");
+	BC_ASSERT_EQUAL(sum_ice_latency_histogram(stats->checks_latency_histogram), 2, int, "%d");
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
+static void calls_with_ice_checks_paced(void){
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	LinphoneCoreManager *laure = linphone_core_manager_new(liblinphone_tester_ipv6_available() ? "laure_tcp_rc" : "laure_rc_udp");
+	LpConfig *config = linphone_core_get_config(marie->lc);
+	const LinphoneCoreIceSchedulerStats *stats;
+	LinphoneCall *marie_call_pauline;
+	LinphoneCall *pauline_called_by_marie;
+
+	/* Must be set before the first call, the scheduler reads them when it is created. The checks of a single session
+	 * are started at once, the next one has to wait for a minute. */
+	linphone_config_set_int(config, "net", "ice_checks_pacing_burst", 1);
+	linphone_config_set_int(config, "net", "ice_checks_pacing_ta", 60000);
+	linphone_core_reset_ice_scheduler_stats(marie->lc);
+
+	enable_stun_in_core(marie, TRUE, TRUE);
+	linphone_core_manager_wait_for_stun_resolution(marie);
+	enable_stun_in_core(pauline, TRUE, TRUE);
+	linphone_core_manager_wait_for_stun_resolution(pauline);
+	enable_stun_in_core(laure, TRUE, TRUE);
+	linphone_core_manager_wait_for_stun_resolution(laure);
+
+	if (!BC_ASSERT_TRUE(call(marie, pauline)))
+		goto end;
+	/* Wait for the ICE re-INVITE, the first session has completed its checks. */
+	BC_ASSERT_TRUE(wait_for(marie->lc, pauline->lc, &marie->stat.number_of_LinphoneCallStreamsRunning, 2));
+	BC_ASSERT_TRUE(check_ice(marie, pauline, LinphoneIceStateHostConnection));
+	stats = linphone_core_get_ice_scheduler_stats(marie->lc);
+	BC_ASSERT_EQUAL(stats->number_of_checks, 1, int, "%d");
+	BC_ASSERT_EQUAL(stats->number_of_deferred_checks, 0, int, "%d");
+
+	marie_call_pauline = linphone_core_get_current_call(marie->lc);
+	pauline_called_by_marie = linphone_core_get_current_call(pauline->lc);
+	BC_ASSERT_TRUE(pause_call_1(marie, marie_call_pauline, pauline, pauline_called_by_marie));
+
+	/* A second session goes over the burst: its checks wait for the next token. */
+	if (!BC_ASSERT_TRUE(call(marie, laure)))
+		goto end;
+	stats = linphone_core_get_ice_scheduler_stats(marie->lc);
+	BC_ASSERT_EQUAL(stats->number_of_checks, 1, int, "%d");
+	BC_ASSERT_EQUAL(stats->number_of_deferred_checks, 1, int, "%d");
+	BC_ASSERT_EQUAL(stats->number_of_pending, 1, int, "%d");
+
+	/* Terminating the call drops its checks from the queue. */
+	end_call(marie, laure);
+	stats = linphone_core_get_ice_scheduler_stats(marie->lc);
+	BC_ASSERT_EQUAL(stats->number_of_checks, 1, int, "%d");
+	BC_ASSERT_EQUAL(stats->number_of_pending, 0, int, "%d");
+	end_call(marie, pauline);
+
+end:
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+	linphone_core_manager_destroy(laure);
+}
+
 static void _call_with_ice(bool_t caller_with_ice, bool_t callee_with_ice, bool_t random_ports, bool_t forced_relay, bool_t ipv6) {
 	LinphoneCoreManager* marie = linphone_core_manager_new_with_proxies_check("marie_rc", FALSE);
 	LinphoneCoreManager* pauline = linphone_core_manager_new_with_proxies_check(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc", FALSE);
@@ -924,6 +1017,8 @@ static test_t call_with_ice_tests[] = {
 	TEST_ONE_TAG("Call with ICE without stun server one side", call_with_ice_without_stun2, "ICE"),
 	TEST_ONE_TAG("Call with ICE and configured server-reflexive addresses", call_with_configured_sflrx_addresses, "ICE"),
 	TEST_ONE_TAG("Call with ICE and stun server not responding", call_with_ice_stun_not_responding, "ICE"),
+	TEST_ONE_TAG("Calls with ICE sharing server-reflexive candidates", calls_with_ice_sharing_server_reflexive_candidates, "ICE"),
+	TEST_ONE_TAG("Calls with ICE checks paced", calls_with_ice_checks_paced, "ICE"),
 	TEST_ONE_TAG("Call with ICE ufrag and password set in SDP m line", call_with_ice_ufrag_and_password_set_in_sdp_m_line, "ICE"),
 	TEST_ONE_TAG("Call with ICE ufrag and password set in SDP m line 2", call_with_ice_ufrag_and_password_set_in_sdp_m_line_2, "ICE"),
 	TEST_ONE_TAG("Call with ICE ufrag and password set in SDP m line 3", call_with_ice_ufrag_and_password_set_in_sdp_m_line_3, "ICE"),
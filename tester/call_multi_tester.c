@@ -118,6 +118,18 @@ static void call_waiting_indication_with_param(bool_t enable_caller_privacy) {
 
 	if (pauline_called_by_laure && enable_caller_privacy )
 		BC_ASSERT_EQUAL(linphone_call_params_get_privacy(linphone_call_get_current_params(pauline_called_by_laure)),LinphonePrivacyId, int, "%d");
+
+	/*both calls are found by Call-ID, and by remote address unless it is hidden*/
+	char *marie_call_id = ms_strdup(linphone_call_log_get_call_id(linphone_call_get_call_log(pauline_called_by_marie)));
+	BC_ASSERT_PTR_EQUAL(linphone_core_get_call_by_callid(pauline->lc, marie_call_id), pauline_called_by_marie);
+	if (pauline_called_by_laure) {
+		BC_ASSERT_PTR_EQUAL(linphone_core_get_call_by_callid(pauline->lc, linphone_call_log_get_call_id(linphone_call_get_call_log(pauline_called_by_laure))), pauline_called_by_laure);
+		if (!enable_caller_privacy)
+			BC_ASSERT_PTR_EQUAL(linphone_core_get_call_by_remote_address2(pauline->lc, laure->identity), pauline_called_by_laure);
+	}
+	if (!enable_caller_privacy)
+		BC_ASSERT_PTR_EQUAL(linphone_core_get_call_by_remote_address2(pauline->lc, marie->identity), pauline_called_by_marie);
+
 	/*wait a bit for ACK to be sent*/
 	wait_for_list(lcs,NULL,0,1000);
 	linphone_core_terminate_all_calls(pauline->lc);
@@ -130,6 +142,15 @@ static void call_waiting_indication_with_param(bool_t enable_caller_privacy) {
 	BC_ASSERT_TRUE(wait_for_list(lcs,&marie->stat.number_of_LinphoneCallReleased,1,10000));
 	BC_ASSERT_TRUE(wait_for_list(lcs,&laure->stat.number_of_LinphoneCallReleased,1,10000));
 
+	/*released calls are not kept by the indexes of the callers either*/
+	BC_ASSERT_EQUAL(linphone_core_get_indexed_call_count(marie->lc), 0, int, "%d");
+	BC_ASSERT_EQUAL(linphone_core_get_indexed_call_count(laure->lc), 0, int, "%d");
+
+	/*released calls are no longer found*/
+	BC_ASSERT_PTR_NULL(linphone_core_get_call_by_callid(pauline->lc, marie_call_id));
+	BC_ASSERT_PTR_NULL(linphone_core_get_call_by_remote_address2(pauline->lc, marie->identity));
+	ms_free(marie_call_id);
+
 	linphone_core_manager_destroy(marie);
 	linphone_core_manager_destroy(pauline);
 	linphone_core_manager_destroy(laure);
@@ -31,6 +31,7 @@
 #include "shared_tester_functions.h"
 #include "capability_negotiation_tester.h"
 #include "sal/call-op.h"
+#include "sal/sal_media_description.h"
 
 void get_expected_encryption_from_call_params(LinphoneCall *offererCall, LinphoneCall *answererCall, LinphoneMediaEncryption* expectedEncryption, bool* potentialConfigurationChosen) {
 	const LinphoneCallParams *offerer_params = linphone_call_get_params(offererCall);
@@ -3115,6 +3116,68 @@ static void call_with_ack_not_sent(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+/*
+ * Replay the offer/answer of the callee of a call where both sides offer all the encryptions as potential configurations,
+ * audio and video, and measure how long it takes.
+ */
+static void offer_answer_with_many_potential_configurations(void) {
+	encryption_params enc_params;
+	enc_params.encryption = LinphoneMediaEncryptionNone;
+	enc_params.level = E_OPTIONAL;
+	enc_params.preferences = set_encryption_preference(TRUE);
+
+	LinphoneCoreManager * marie = create_core_mgr_with_capability_negotiation_setup("marie_rc", enc_params, TRUE, FALSE, TRUE);
+	LinphoneCoreManager * pauline = create_core_mgr_with_capability_negotiation_setup((transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc"), enc_params, TRUE, FALSE, TRUE);
+
+	LinphoneCallParams *pauline_params = linphone_core_create_call_params(pauline->lc, NULL);
+	linphone_call_params_enable_video(pauline_params, TRUE);
+	LinphoneCallParams *marie_params = linphone_core_create_call_params(marie->lc, NULL);
+	linphone_call_params_enable_video(marie_params, TRUE);
+
+	BC_ASSERT_TRUE(call_with_params(pauline, marie, pauline_params, marie_params));
+	linphone_call_params_unref(pauline_params);
+	linphone_call_params_unref(marie_params);
+
+	LinphoneCall * marieCall = linphone_core_get_current_call(marie->lc);
+	BC_ASSERT_PTR_NOT_NULL(marieCall);
+	if (marieCall) {
+		LinphonePrivate::SalCallOp *op = LinphonePrivate::Call::toCpp(marieCall)->getOp();
+		std::shared_ptr<LinphonePrivate::SalMediaDescription> localDesc = op->getLocalMediaDescription();
+		std::shared_ptr<LinphonePrivate::SalMediaDescription> remoteDesc = op->getRemoteMediaDescription();
+		BC_ASSERT_PTR_NOT_NULL(localDesc);
+		BC_ASSERT_PTR_NOT_NULL(remoteDesc);
+		if (localDesc && remoteDesc) {
+			size_t nbConfigurations = 0;
+			for (const auto & stream : remoteDesc->streams) {
+				nbConfigurations += stream.getAllCfgs().size();
+			}
+			BC_ASSERT_GREATER_STRICT((int)nbConfigurations, (int)(2 * remoteDesc->streams.size()), int, "%i");
+
+			const int iterations = 100;
+			// Replay the offer/answer and return the number of payload list matchings it computed.
+			auto replay = [&](bool cacheEnabled) {
+				bool_t sameAnswers = FALSE;
+				MSTimeSpec start;
+				liblinphone_tester_clock_start(&start);
+				unsigned int matchCount = linphone_call_replay_incoming_offer_answer(marieCall, cacheEnabled, iterations, &sameAnswers);
+				long long elapsed = liblinphone_tester_clock_get_elapsed_ms(&start);
+				BC_ASSERT_TRUE(sameAnswers);
+				ms_message("Offer/answer of %zu streams with %zu potential configurations %s the payload match cache: %u payload matchings, %f ms on average",
+					remoteDesc->streams.size(), nbConfigurations, cacheEnabled ? "with" : "without", matchCount / iterations, (double)elapsed / iterations);
+				return matchCount;
+			};
+			unsigned int uncachedMatchCount = replay(false);
+			unsigned int cachedMatchCount = replay(true);
+			BC_ASSERT_LOWER_STRICT(cachedMatchCount, uncachedMatchCount, unsigned int, "%u");
+		}
+	}
+
+	end_call(pauline, marie);
+
+	linphone_core_manager_destroy(marie);
+	linphone_core_manager_destroy(pauline);
+}
+
 test_t capability_negotiation_tests[] = {
 	TEST_NO_TAG("Call with no encryption", call_with_no_encryption),
 	TEST_NO_TAG("Call with 200Ok lost", call_with_200ok_lost),
@@ -3141,7 +3204,8 @@ test_t capability_negotiation_tests[] = {
 	TEST_NO_TAG("Call changes encryption with update and capability negotiations on both sides without reINVITE", call_changes_enc_on_update_cap_neg_both_sides_without_reinvite),
 	TEST_NO_TAG("Unencrypted call with potential configuration same as actual one", unencrypted_call_with_potential_configuration_same_as_actual_configuration),
 	TEST_NO_TAG("Back to back call with capability negotiations on one side", back_to_back_calls_cap_neg_one_side),
-	TEST_NO_TAG("Back to back call with capability negotiations on both sides", back_to_back_calls_cap_neg_both_sides)
+	TEST_NO_TAG("Back to back call with capability negotiations on both sides", back_to_back_calls_cap_neg_both_sides),
+	TEST_NO_TAG("Offer/answer with many potential configurations", offer_answer_with_many_potential_configurations)
 };
 
 test_t capability_negotiation_tests_no_sdp[] = {
@@ -32,6 +32,7 @@
 #include "conference/local-conference.h"
 #include "conference/participant.h"
 #include "conference/remote-conference.h"
+#include "content/content-manager.h"
 #include "liblinphone_tester.h"
 #include "linphone/core.h"
 #include "private.h"
@@ -2105,6 +2106,55 @@ void send_subject_changed_notify () {
 	linphone_core_manager_destroy(pauline);
 }
 
+void send_missed_notifies_from_history () {
+	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
+	char *identityStr = linphone_address_as_string(pauline->identity);
+	Address addr(identityStr);
+	bctbx_free(identityStr);
+	LinphoneAddress *cBobAddr = linphone_core_interpret_url(pauline->lc, bobUri);
+	char *bobAddrStr = linphone_address_as_string(cBobAddr);
+	Address bobAddr(bobAddrStr);
+	bctbx_free(bobAddrStr);
+	linphone_address_unref(cBobAddr);
+
+	for (int historySize : {100, 2}) {
+		linphone_config_set_int(linphone_core_get_config(pauline->lc), "misc", "conference_notify_history_size", historySize);
+		shared_ptr<LocalConferenceTester> localConf = make_shared<LocalConferenceTester>(pauline->lc->cppPtr, addr, nullptr);
+		localConf->setConferenceAddress(ConferenceAddress(addr));
+		localConf->addParticipant(bobAddr);
+		LocalConferenceEventHandler *localHandler = (L_ATTR_GET(localConf.get(), eventHandler)).get();
+
+		unsigned int lastNotify = localConf->getLastNotify();
+		for (int i = 1; i <= 3; i++)
+			localConf->setSubject("Subject " + to_string(i));
+		BC_ASSERT_EQUAL(localConf->getLastNotify(), (lastNotify + 3), int, "%d");
+
+		Content content = localHandler->getNotifyForId(static_cast<int>(lastNotify), nullptr);
+		if (historySize > 2) {
+			// The three subject changes are sent back from memory, in order.
+			BC_ASSERT_TRUE(content.isMultipart());
+			list<Content> contents = ContentManager::multipartToContentList(content);
+			BC_ASSERT_EQUAL((int)contents.size(), 3, int, "%d");
+			if (contents.size() == 3) {
+				BC_ASSERT_TRUE(contents.front().getBodyAsUtf8String().find("Subject 1") != string::npos);
+				BC_ASSERT_TRUE(contents.back().getBodyAsUtf8String().find("Subject 3") != string::npos);
+			}
+		} else {
+			// Too old for the history: the events are looked up in database, where this conference has none.
+			BC_ASSERT_TRUE(content.isEmpty());
+			// The last two subject changes are still in memory though.
+			list<Content> contents = ContentManager::multipartToContentList(localHandler->getNotifyForId(static_cast<int>(lastNotify + 1), nullptr));
+			BC_ASSERT_EQUAL((int)contents.size(), 2, int, "%d");
+		}
+		// Catching up from memory does not alter the version of the conference.
+		BC_ASSERT_EQUAL(localConf->getLastNotify(), (lastNotify + 3), int, "%d");
+
+		localConf = nullptr;
+	}
+
+	linphone_core_manager_destroy(pauline);
+}
+
 void send_device_added_notify() {
 	LinphoneCoreManager *pauline = linphone_core_manager_new(transport_supported(LinphoneTransportTls) ? "pauline_rc" : "pauline_tcp_rc");
 	LinphoneCoreCbs *cbs = linphone_factory_create_core_cbs(linphone_factory_get());
@@ -2310,6 +2360,7 @@ test_t conference_event_tests[] = {
 	TEST_NO_TAG("Send participant admined notify", send_admined_notify),
 	TEST_NO_TAG("Send participant unadmined notify", send_unadmined_notify),
 	TEST_NO_TAG("Send subject changed notify", send_subject_changed_notify),
+	TEST_NO_TAG("Send missed notifies from history", send_missed_notifies_from_history),
 	TEST_NO_TAG("Send device added notify", send_device_added_notify),
 	TEST_NO_TAG("Send device removed notify", send_device_removed_notify),
 	TEST_NO_TAG("one-to-one keyword", one_to_one_keyword)
@@ -4631,6 +4631,7 @@ static void aggregated_imdn_for_group_chat_room_base (bool_t read_while_offline)
 	BC_ASSERT_EQUAL(messageCount, 3, int, "%d");
 
 // Mark the messages as read on Pauline's sides
+	linphone_core_reset_imdn_scheduler_stats(pauline->lc);
 	if (read_while_offline) {
 		linphone_core_set_network_reachable(pauline->lc, FALSE);
 		linphone_chat_room_mark_as_read(paulineCr);
@@ -4644,6 +4645,12 @@ static void aggregated_imdn_for_group_chat_room_base (bool_t read_while_offline)
 	BC_ASSERT_TRUE(wait_for_list(coresList, &chloe->stat.number_of_LinphoneMessageDisplayed, initialChloeStats.number_of_LinphoneMessageDisplayed + 3, liblinphone_tester_sip_timeout));
 	BC_ASSERT_TRUE(wait_for_list(coresList, &chloe2->stat.number_of_LinphoneMessageDisplayed, initialChloe2Stats.number_of_LinphoneMessageDisplayed + 3, liblinphone_tester_sip_timeout));
 	BC_ASSERT_EQUAL(chloe->stat.number_of_LinphoneMessageDeliveredToUser, 3, int, "%d");	// 3 for sending to chloe2
+
+// The 3 display notifications of Pauline have been aggregated by the IMDN scheduler
+	const LinphoneCoreImdnSchedulerStats *paulineImdnStats = linphone_core_get_imdn_scheduler_stats(pauline->lc);
+	BC_ASSERT_EQUAL(paulineImdnStats->number_of_queued, 3, int, "%d");
+	BC_ASSERT_GREATER(paulineImdnStats->number_of_sent, 1, int, "%d");
+	BC_ASSERT_GREATER(paulineImdnStats->number_of_coalesced, 2, int, "%d");
 	
 	if (read_while_offline) {
 		wait_for_list(coresList, 0, 1, 2000); // To prevent memory leak
@@ -417,6 +417,7 @@ void liblinphone_tester_add_suites() {
 	bc_tester_add_suite(&group_chat2_test_suite);
 	bc_tester_add_suite(&cpim_test_suite);
 	bc_tester_add_suite(&ics_test_suite);
+	bc_tester_add_suite(&xml_codec_test_suite);
 #ifdef HAVE_LIME_X3DH
 	bc_tester_add_suite(&secure_group_chat_test_suite);
 	bc_tester_add_suite(&secure_message_test_suite);
@@ -63,6 +63,7 @@ extern test_suite_t conference_info_tester;
 extern test_suite_t contents_test_suite;
 extern test_suite_t cpim_test_suite;
 extern test_suite_t ics_test_suite;
+extern test_suite_t xml_codec_test_suite;
 extern test_suite_t event_test_suite;
 extern test_suite_t main_db_test_suite;
 extern test_suite_t flexisip_test_suite;
@@ -459,6 +460,7 @@ typedef struct _stats {
 	int number_of_ConferenceSchedulerInvitationsSent;
 	
 	int number_of_LinphoneMagicSearchResultReceived;
+	int number_of_LinphoneMagicSearchPartialResultsReceived;
 	int number_of_LinphoneMagicSearchLdapHaveMoreResults;
 }stats;
 
@@ -623,6 +625,7 @@ void liblinphone_tester_check_rtcp(LinphoneCoreManager* caller, LinphoneCoreMana
 void liblinphone_tester_check_rtcp_2(LinphoneCoreManager* caller, LinphoneCoreManager* callee);
 void liblinphone_tester_clock_start(MSTimeSpec *start);
 bool_t liblinphone_tester_clock_elapsed(const MSTimeSpec *start, int value_ms);
+long long liblinphone_tester_clock_get_elapsed_ms(const MSTimeSpec *start);
 
 void linphone_core_manager_check_accounts(LinphoneCoreManager *m);
 void account_manager_destroy(void);
@@ -28,6 +28,7 @@
 #include "c-wrapper/c-wrapper.h"
 #include "chat/chat-room/chat-room.h"
 #include "chat/chat-room/server-group-chat-room-p.h"
+#include "conference/handlers/local-conference-event-handler.h"
 #include "conference/participant.h"
 #include "core/core.h"
 #include "linphone/api/c-chat-room-params.h"
@@ -3612,6 +3613,248 @@ static void group_chat_room_lime_server_clear_message (void) {
 	group_chat_room_lime_server_message(FALSE);
 }
 
+/*
+ * Replays the lookups done by the server when every device of a large chat room joins and then sends a message:
+ * the sender is searched by its gruu, and queued messages are dispatched to the devices.
+ */
+static void group_chat_room_server_participant_lookup_benchmark (void) {
+	const int participantCount = 500;
+	const int devicesPerParticipant = 2;
+	Focus focus("chloe_rc");
+	{
+		shared_ptr<Core> core = L_GET_CPP_PTR_FROM_C_OBJECT(focus.getLc());
+		ConferenceAddress conferenceAddress("sip:benchmark@sip.example.org;conf-id=benchmark");
+		list<shared_ptr<Participant>> participants;
+		list<IdentityAddress> participantAddresses;
+		list<IdentityAddress> deviceAddresses;
+		for (int i = 0; i < participantCount; i++) {
+			IdentityAddress participantAddress("sip:user" + to_string(i) + "@sip.example.org");
+			auto participant = Participant::create(nullptr, participantAddress);
+			for (int j = 0; j < devicesPerParticipant; j++) {
+				IdentityAddress deviceAddress(participantAddress.asString() + ";gr=urn:uuid:" + to_string(i) + "-" + to_string(j));
+				participant->addDevice(deviceAddress);
+				deviceAddresses.push_back(deviceAddress);
+			}
+			participants.push_back(participant);
+			participantAddresses.push_back(participantAddress);
+		}
+
+		auto chatRoom = make_shared<ServerGroupChatRoom>(core, conferenceAddress,
+			ChatRoom::CapabilitiesMask({ChatRoom::Capabilities::Conference}), ChatRoomParams::getDefaults(), "Benchmark", move(participants), 0);
+		auto d = L_GET_PRIVATE(chatRoom);
+
+		// The participants found through the indexes are the authorized ones.
+		const auto countAuthorized = [&chatRoom, &participantAddresses]() {
+			int count = 0;
+			for (const auto &participantAddress : participantAddresses) {
+				auto participant = chatRoom->findParticipant(participantAddress);
+				if (!participant)
+					continue;
+				const auto &authorized = chatRoom->getParticipants();
+				if (BC_ASSERT_TRUE(std::find(authorized.begin(), authorized.end(), participant) != authorized.end()))
+					count++;
+			}
+			return count;
+		};
+		BC_ASSERT_EQUAL(countAuthorized(), (int)chatRoom->getParticipants().size(), int, "%d");
+
+		MSTimeSpec start;
+		liblinphone_tester_clock_start(&start);
+		for (const auto &participantAddress : participantAddresses)
+			d->addParticipant(participantAddress);
+		long long joiningTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+		BC_ASSERT_EQUAL(chatRoom->getParticipantCount(), participantCount, int, "%d");
+		BC_ASSERT_EQUAL((int)chatRoom->getParticipants().size(), participantCount, int, "%d");
+		BC_ASSERT_EQUAL(countAuthorized(), participantCount, int, "%d");
+
+		int found = 0;
+		liblinphone_tester_clock_start(&start);
+		for (const auto &deviceAddress : deviceAddresses) {
+			auto participant = chatRoom->findParticipant(deviceAddress);
+			auto device = chatRoom->findCachedParticipantDevice(deviceAddress.asString());
+			if (participant && device && (device->getParticipant() == participant)
+				&& (participant->getAddress() == deviceAddress.getAddressWithoutGruu()))
+				found++;
+			d->dispatchQueuedMessages();
+		}
+		long long lookupTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+		BC_ASSERT_EQUAL(found, participantCount * devicesPerParticipant, int, "%d");
+
+		// Unknown participants and devices are not found.
+		BC_ASSERT_PTR_NULL(chatRoom->findParticipant(IdentityAddress("sip:unknown@sip.example.org")));
+		BC_ASSERT_PTR_NULL(chatRoom->findCachedParticipantDevice("sip:user0@sip.example.org;gr=urn:uuid:unknown"));
+
+		ms_message("%d devices joined in %lld ms, their lookups took %lld ms",
+			participantCount * devicesPerParticipant, joiningTime, lookupTime);
+	}
+}
+
+/*
+ * Checks that the full state of a conference is serialized once and shared by the devices resubscribing with
+ * Last-Notify-Version 0 while the conference does not change, and once per SUBSCRIBE when the cache is disabled.
+ */
+static void group_chat_room_server_full_state_notify_cache (void) {
+	Focus focus("chloe_rc");
+	{//to make sure focus is destroyed after clients.
+		ClientConference marie("marie_rc", focus.getIdentity().asAddress());
+		ClientConference pauline("pauline_rc", focus.getIdentity().asAddress());
+		ClientConference laure("laure_tcp_rc", focus.getIdentity().asAddress());
+
+		focus.registerAsParticipantDevice(marie);
+		focus.registerAsParticipantDevice(pauline);
+		focus.registerAsParticipantDevice(laure);
+
+		bctbx_list_t * coresList = bctbx_list_append(NULL, focus.getLc());
+		coresList = bctbx_list_append(coresList, marie.getLc());
+		coresList = bctbx_list_append(coresList, pauline.getLc());
+		coresList = bctbx_list_append(coresList, laure.getLc());
+
+		Address paulineAddr(pauline.getIdentity().asAddress());
+		Address laureAddr(laure.getIdentity().asAddress());
+		bctbx_list_t *participantsAddresses = bctbx_list_append(NULL, linphone_address_ref(L_GET_C_BACK_PTR(&paulineAddr)));
+		participantsAddresses = bctbx_list_append(participantsAddresses, linphone_address_ref(L_GET_C_BACK_PTR(&laureAddr)));
+
+		stats initialMarieStats = marie.getStats();
+		stats initialPaulineStats = pauline.getStats();
+		stats initialLaureStats = laure.getStats();
+
+		// Marie creates a new group chat room
+		const char *initialSubject = "Colleagues @work";
+		LinphoneChatRoom *marieCr = create_chat_room_client_side(coresList, marie.getCMgr(), &initialMarieStats, participantsAddresses, initialSubject, FALSE, LinphoneChatRoomEphemeralModeDeviceManaged);
+		const LinphoneAddress *confAddr = linphone_chat_room_get_conference_address(marieCr);
+
+		// Check that the chat room is correctly created on Pauline's and Laure's sides and that the participants are added
+		check_creation_chat_room_client_side(coresList, pauline.getCMgr(), &initialPaulineStats, confAddr, initialSubject, 2, FALSE);
+		check_creation_chat_room_client_side(coresList, laure.getCMgr(), &initialLaureStats, confAddr, initialSubject, 2, FALSE);
+
+		BC_ASSERT_TRUE(CoreManagerAssert({focus,marie,pauline,laure}).wait([&focus] {
+			for (auto chatRoom :focus.getCore().getChatRooms()) {
+				for (auto participant: chatRoom->getParticipants()) {
+					for (auto device: participant->getDevices())
+						if (device->getState() != ParticipantDevice::State::Present) {
+							return false;
+						}
+				}
+			}
+			return true;
+		}));
+
+		BC_ASSERT_EQUAL(focus.getCore().getChatRooms().size(), 1, size_t, "%zu");
+		auto serverCr = static_pointer_cast<ServerGroupChatRoom>(focus.getCore().getChatRooms().front());
+		LocalConferenceEventHandler *handler = L_GET_PRIVATE(serverCr)->getConferenceEventHandler();
+
+		// Restarting a client forcing the full state makes its device, already present in the conference, subscribe with Last-Notify-Version 0.
+		auto resubscribe = [&coresList, confAddr] (ClientConference &client) {
+			linphone_config_set_bool(linphone_core_get_config(client.getLc()), "misc", "conference_event_package_force_full_state", TRUE);
+			coresList = bctbx_list_remove(coresList, client.getLc());
+			client.reStart();
+			coresList = bctbx_list_append(coresList, client.getLc());
+			stats initialStats = client.getStats();
+
+			BC_ASSERT_TRUE(wait_for_list(coresList, &client.getStats().number_of_LinphoneChatRoomConferenceJoined, initialStats.number_of_LinphoneChatRoomConferenceJoined + 1, liblinphone_tester_sip_timeout));
+			char *deviceIdentity = linphone_core_get_device_identity(client.getLc());
+			LinphoneAddress *localAddr = linphone_address_new(deviceIdentity);
+			bctbx_free(deviceIdentity);
+			LinphoneChatRoom *chatRoom = client.searchChatRoom(localAddr, confAddr);
+			linphone_address_unref(localAddr);
+			if (BC_ASSERT_PTR_NOT_NULL(chatRoom))
+				BC_ASSERT_EQUAL(linphone_chat_room_get_nb_participants(chatRoom), 2, int, "%d");
+		};
+
+		// The first full state NOTIFY may have to serialize the current version of the conference.
+		unsigned int serializationCount = handler->getFullStateSerializationCount();
+		resubscribe(pauline);
+		BC_ASSERT_LOWER(handler->getFullStateSerializationCount(), serializationCount + 1, unsigned int, "%u");
+
+		// The next ones reuse it as long as neither the conference nor the subscribing devices change.
+		serializationCount = handler->getFullStateSerializationCount();
+		resubscribe(laure);
+		BC_ASSERT_EQUAL(handler->getFullStateSerializationCount(), serializationCount, unsigned int, "%u");
+		resubscribe(pauline);
+		BC_ASSERT_EQUAL(handler->getFullStateSerializationCount(), serializationCount, unsigned int, "%u");
+
+		// Without the cache, every SUBSCRIBE serializes the full state again.
+		linphone_config_set_bool(linphone_core_get_config(focus.getLc()), "misc", "conference_full_state_cache", FALSE);
+		resubscribe(laure);
+		BC_ASSERT_EQUAL(handler->getFullStateSerializationCount(), serializationCount + 1, unsigned int, "%u");
+		resubscribe(pauline);
+		BC_ASSERT_EQUAL(handler->getFullStateSerializationCount(), serializationCount + 2, unsigned int, "%u");
+
+		bctbx_list_free(coresList);
+	}
+}
+
+/*
+ * Measures the time needed to answer a burst of SUBSCRIBEs with a full state NOTIFY depending on the number of participants,
+ * with and without the full state being shared across subscribers of a same conference version.
+ */
+static void group_chat_room_server_full_state_notify_benchmark (void) {
+	const int devicesPerParticipant = 2;
+	const int subscriberCount = 20;
+	Focus focus("chloe_rc");
+	{
+		shared_ptr<Core> core = L_GET_CPP_PTR_FROM_C_OBJECT(focus.getLc());
+		LinphoneConfig *config = linphone_core_get_config(focus.getLc());
+		for (int participantCount : {50, 200, 800}) {
+			ConferenceAddress conferenceAddress("sip:benchmark" + to_string(participantCount) + "@sip.example.org;conf-id=benchmark" + to_string(participantCount));
+			list<shared_ptr<Participant>> participants;
+			list<IdentityAddress> participantAddresses;
+			for (int i = 0; i < participantCount; i++) {
+				IdentityAddress participantAddress("sip:user" + to_string(i) + "@sip.example.org");
+				auto participant = Participant::create(nullptr, participantAddress);
+				for (int j = 0; j < devicesPerParticipant; j++)
+					participant->addDevice(IdentityAddress(participantAddress.asString() + ";gr=urn:uuid:" + to_string(i) + "-" + to_string(j)));
+				participants.push_back(participant);
+				participantAddresses.push_back(participantAddress);
+			}
+
+			auto chatRoom = make_shared<ServerGroupChatRoom>(core, conferenceAddress,
+				ChatRoom::CapabilitiesMask({ChatRoom::Capabilities::Conference}), ChatRoomParams::getDefaults(), "Benchmark", move(participants), 0);
+			auto d = L_GET_PRIVATE(chatRoom);
+			for (const auto &participantAddress : participantAddresses)
+				d->addParticipant(participantAddress);
+			BC_ASSERT_EQUAL((int)chatRoom->getParticipants().size(), participantCount, int, "%d");
+
+			auto conference = chatRoom->getConference();
+			LocalConferenceEventHandler handler(conference.get());
+
+			MSTimeSpec start;
+			linphone_config_set_bool(config, "misc", "conference_full_state_cache", FALSE);
+			Content uncachedContent;
+			unsigned int serializationCount = handler.getFullStateSerializationCount();
+			liblinphone_tester_clock_start(&start);
+			for (int i = 0; i < subscriberCount; i++)
+				uncachedContent = handler.createNotifyFullState(nullptr);
+			long long uncachedTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+			BC_ASSERT_EQUAL(handler.getFullStateSerializationCount(), serializationCount + subscriberCount, unsigned int, "%u");
+
+			linphone_config_set_bool(config, "misc", "conference_full_state_cache", TRUE);
+			Content cachedContent;
+			serializationCount = handler.getFullStateSerializationCount();
+			liblinphone_tester_clock_start(&start);
+			for (int i = 0; i < subscriberCount; i++)
+				cachedContent = handler.createNotifyFullState(nullptr);
+			long long cachedTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+			BC_ASSERT_EQUAL(handler.getFullStateSerializationCount(), serializationCount + 1, unsigned int, "%u");
+			// Only the timestamp may differ between both bodies, and it always has the same length.
+			BC_ASSERT_FALSE(cachedContent.isEmpty());
+			BC_ASSERT_EQUAL(cachedContent.getBody().size(), uncachedContent.getBody().size(), size_t, "%zu");
+
+			// A new version is serialized again from the cached document, without rebuilding it.
+			liblinphone_tester_clock_start(&start);
+			for (int i = 0; i < subscriberCount; i++) {
+				conference->notifyFullState();
+				cachedContent = handler.createNotifyFullState(nullptr);
+			}
+			long long versionedTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+			BC_ASSERT_EQUAL(cachedContent.getBody().size(), uncachedContent.getBody().size(), size_t, "%zu");
+
+			ms_message("Full state NOTIFY for %d participants (%d devices) sent to %d subscribers: %lld ms uncached, %lld ms cached, %lld ms with a new version each time",
+				participantCount, participantCount * devicesPerParticipant, subscriberCount, uncachedTime, cachedTime, versionedTime);
+		}
+	}
+}
+
 static void conference_scheduler_state_changed(LinphoneConferenceScheduler *scheduler, LinphoneConferenceSchedulerState state) {
 	stats *stat = get_stats(linphone_conference_scheduler_get_core(scheduler));
 	if (state == LinphoneConferenceSchedulerStateReady) {
@@ -12018,7 +12261,10 @@ static test_t local_conference_chat_tests[] = {
 	TEST_ONE_TAG("Group chat room bulk notify to participant", LinphoneTest::group_chat_room_bulk_notify_to_participant,"LeaksMemory"), /* because of network up and down*/
 	TEST_ONE_TAG("One to one chatroom exhumed while participant is offline", LinphoneTest::one_to_one_chatroom_exhumed_while_offline,"LeaksMemory"), /* because of network up and down*/
 	TEST_ONE_TAG("Group chat Server chat room deletion with remote list event handler", LinphoneTest::group_chat_room_server_deletion_with_rmt_lst_event_handler,"LeaksMemory"), /* because of coreMgr restart*/
-	TEST_ONE_TAG("Multi domain chatroom", LinphoneTest::multidomain_group_chat_room,"LeaksMemory") /* because of coreMgr restart*/
+	TEST_ONE_TAG("Multi domain chatroom", LinphoneTest::multidomain_group_chat_room,"LeaksMemory"), /* because of coreMgr restart*/
+	TEST_NO_TAG("Group chat server participant lookup benchmark", LinphoneTest::group_chat_room_server_participant_lookup_benchmark),
+	TEST_ONE_TAG("Group chat server full state NOTIFY cache", LinphoneTest::group_chat_room_server_full_state_notify_cache,"LeaksMemory"), /* because of coreMgr restart*/
+	TEST_ONE_TAG("Group chat server full state NOTIFY benchmark", LinphoneTest::group_chat_room_server_full_state_notify_benchmark,"Benchmark")
 };
 
 static test_t local_conference_ephemeral_chat_tests[] = {
@@ -18,7 +18,14 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <algorithm>
+
+#ifdef HAVE_SOCI
+#include <soci/soci.h>
+#endif
+
 #include "address/address.h"
+#include "chat/chat-message/chat-message-p.h"
 #include "core/core-p.h"
 #include "db/main-db.h"
 #include "event-log/events.h"
@@ -282,6 +289,357 @@ static void load_a_lot_of_chatrooms(void) {
 #endif
 }
 
+static double add_chat_message_burst (MainDb &mainDb, const shared_ptr<AbstractChatRoom> &chatRoom, int count) {
+	const ConferenceId &conferenceId = chatRoom->getConferenceId();
+	const int historySize = mainDb.getHistorySize(conferenceId);
+
+	MSTimeSpec start;
+	liblinphone_tester_clock_start(&start);
+	for (int i = 0; i < count; i++) {
+		shared_ptr<ChatMessage> message = chatRoom->createChatMessageFromUtf8("Burst message " + to_string(i));
+		L_GET_PRIVATE(message)->forceState(ChatMessage::State::Delivered);
+		L_GET_PRIVATE(message)->storeInDb();
+		// Several state updates of the same message, coalesced in write-behind mode.
+		L_GET_PRIVATE(message)->forceState(ChatMessage::State::DeliveredToUser);
+		L_GET_PRIVATE(message)->updateInDb();
+		L_GET_PRIVATE(message)->forceState(ChatMessage::State::Displayed);
+		L_GET_PRIVATE(message)->updateInDb();
+	}
+	// Pending writes must be visible before being committed.
+	BC_ASSERT_EQUAL(mainDb.getHistorySize(conferenceId), historySize + count, int, "%d");
+	mainDb.flushPendingEvents();
+	long long ms = max(liblinphone_tester_clock_get_elapsed_ms(&start), 1LL);
+	BC_ASSERT_EQUAL(mainDb.getHistorySize(conferenceId), historySize + count, int, "%d");
+
+	return count * 1000.0 / ms;
+}
+
+static void add_chat_message_bursts (int count) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	list<shared_ptr<AbstractChatRoom>> chatRooms = mainDb.getCore()->getChatRooms();
+	BC_ASSERT_FALSE(chatRooms.empty());
+	if (chatRooms.empty())
+		return;
+	shared_ptr<AbstractChatRoom> chatRoom = chatRooms.front();
+
+	int commits = mainDb.getWriteBehindCommitCount();
+	double syncRate = add_chat_message_burst(mainDb, chatRoom, count);
+	ms_message("MainDb synchronous writes: %.0f messages/s", syncRate);
+	BC_ASSERT_EQUAL(mainDb.getWriteBehindCommitCount(), commits, int, "%d");
+
+	// No timer can fire during the burst, the batches are only committed when full or flushed.
+	mainDb.enableWriteBehind(true, 200, 500);
+	double writeBehindRate = add_chat_message_burst(mainDb, chatRoom, count);
+	ms_message("MainDb write-behind writes: %.0f messages/s", writeBehindRate);
+	mainDb.enableWriteBehind(false);
+
+	// Each message is one insert and two updates, a batch is committed every 500 writes.
+	BC_ASSERT_EQUAL(mainDb.getWriteBehindCommitCount() - commits, (3 * count + 499) / 500, int, "%d");
+}
+
+static void add_a_burst_of_chat_messages (void) {
+	add_chat_message_bursts(2000);
+}
+
+static void add_a_large_burst_of_chat_messages (void) {
+	add_chat_message_bursts(100000);
+}
+
+static void interned_ids_cache (void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+	list<shared_ptr<AbstractChatRoom>> chatRooms = mainDb.getCore()->getChatRooms();
+	BC_ASSERT_FALSE(chatRooms.empty());
+	if (chatRooms.empty())
+		return;
+	shared_ptr<AbstractChatRoom> chatRoom = chatRooms.front();
+
+	MainDb::CacheStats sipAddressStats = mainDb.getSipAddressCacheStats();
+	MainDb::CacheStats contentTypeStats = mainDb.getContentTypeCacheStats();
+	for (int i = 0; i < 10; i++) {
+		shared_ptr<ChatMessage> message = chatRoom->createChatMessageFromUtf8("Interned " + to_string(i));
+		L_GET_PRIVATE(message)->storeInDb();
+		BC_ASSERT_TRUE(message->isValid());
+	}
+
+	// The same peer and content type are resolved from memory once known.
+	BC_ASSERT_GREATER(
+		(int)(mainDb.getSipAddressCacheStats().hits - sipAddressStats.hits), 10, int, "%d"
+	);
+	BC_ASSERT_GREATER(
+		(int)(mainDb.getContentTypeCacheStats().hits - contentTypeStats.hits), 8, int, "%d"
+	);
+	BC_ASSERT_LOWER(mainDb.getSipAddressCacheStats().size, mainDb.getSipAddressCacheStats().capacity, int, "%d");
+
+	// Deleting a chat room drops the interned ids.
+	mainDb.deleteChatRoom(chatRoom->getConferenceId());
+	BC_ASSERT_EQUAL(mainDb.getSipAddressCacheStats().size, 0, int, "%d");
+	BC_ASSERT_EQUAL(mainDb.getContentTypeCacheStats().size, 0, int, "%d");
+}
+
+static void get_chat_rooms_page (void) {
+	MainDbProvider provider;
+	MainDb &mainDb = provider.getMainDb();
+
+	list<shared_ptr<AbstractChatRoom>> page = mainDb.getChatRooms(0, 10);
+	BC_ASSERT_EQUAL((int)page.size(), 10, int, "%d");
+	time_t lastUpdateTime = page.front()->getLastUpdateTime();
+	for (const auto &chatRoom : page) {
+		BC_ASSERT_TRUE(chatRoom->getLastUpdateTime() <= lastUpdateTime);
+		lastUpdateTime = chatRoom->getLastUpdateTime();
+	}
+	BC_ASSERT_EQUAL((int)mainDb.getChatRooms(80, 10).size(), 6, int, "%d");
+	BC_ASSERT_EQUAL((int)mainDb.getChatRooms(80, 0).size(), 6, int, "%d");
+
+	// Already loaded chat rooms are returned as is.
+	shared_ptr<AbstractChatRoom> chatRoom = mainDb.getChatRoom(page.front()->getConferenceId());
+	BC_ASSERT_PTR_EQUAL(chatRoom.get(), page.front().get());
+
+	list<MainDb::ChatRoomDescriptor> descriptors = mainDb.getChatRoomDescriptors();
+	BC_ASSERT_EQUAL((int)descriptors.size(), 86, int, "%d");
+	int unreadCount = 0;
+	for (const auto &descriptor : descriptors)
+		unreadCount += descriptor.unreadChatMessageCount;
+	BC_ASSERT_EQUAL(unreadCount, mainDb.getUnreadChatMessageCount(), int, "%d");
+	BC_ASSERT_EQUAL((int)mainDb.getChatRoomDescriptors(80, 10).size(), 6, int, "%d");
+}
+
+#ifdef HAVE_SOCI
+static void add_synthetic_chat_rooms (const char *dbPath, int count) {
+	const int capabilities = int(AbstractChatRoom::CapabilitiesMask({ AbstractChatRoom::Capabilities::Basic, AbstractChatRoom::Capabilities::OneToOne }));
+
+	soci::session sql("sqlite3", dbPath);
+	sql.begin();
+	sql << "INSERT INTO sip_address (value) VALUES ('sip:synthetic-local@sip.example.org')";
+	sql << "INSERT INTO sip_address (value)"
+		" WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < :count)"
+		" SELECT 'sip:synthetic-' || i || '@sip.example.org' FROM n", soci::use(count);
+	sql << "INSERT INTO chat_room (peer_sip_address_id, local_sip_address_id, creation_time, last_update_time, capabilities, subject)"
+		" SELECT peer.id, local.id, datetime('now'), datetime('now', '-' || peer.id || ' seconds'), :capabilities, 'Synthetic'"
+		" FROM sip_address AS peer, sip_address AS local"
+		" WHERE peer.value LIKE 'sip:synthetic-%' AND local.value = 'sip:synthetic-local@sip.example.org'"
+		" AND peer.id <> local.id", soci::use(capabilities);
+	sql.commit();
+}
+
+static LinphoneCoreManager *start_core_with_chat_rooms (const char *dbPath, bool lazyLoading, long long &startupTime) {
+	LinphoneCoreManager *coreManager = linphone_core_manager_create("empty_rc");
+	LinphoneConfig *config = linphone_core_get_config(coreManager->lc);
+	linphone_config_set_string(config, "storage", "uri", dbPath);
+	linphone_config_set_int(config, "misc", "chat_rooms_lazy_loading", lazyLoading);
+
+	MSTimeSpec start;
+	liblinphone_tester_clock_start(&start);
+	linphone_core_manager_start(coreManager, false);
+	startupTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+	return coreManager;
+}
+#endif
+
+static void load_chat_rooms_lazily (void) {
+#ifdef HAVE_SOCI
+	const int syntheticCount = 10000;
+	char *roDbPath = bc_tester_res("db/chatrooms.db");
+	char *dbPath = bc_tester_file("lazy-chatrooms.db");
+	BC_ASSERT_FALSE(liblinphone_tester_copy_file(roDbPath, dbPath));
+	bc_free(roDbPath);
+	add_synthetic_chat_rooms(dbPath, syntheticCount);
+
+	long long eagerStartupTime;
+	LinphoneCoreManager *coreManager = start_core_with_chat_rooms(dbPath, false, eagerStartupTime);
+	const int eagerLoadedCount = L_GET_PRIVATE(coreManager->lc->cppPtr)->getLoadedChatRoomCount();
+	BC_ASSERT_GREATER_STRICT(eagerLoadedCount, syntheticCount, int, "%d");
+	BC_ASSERT_FALSE(L_GET_PRIVATE(coreManager->lc->cppPtr)->hasLazyChatRooms());
+	linphone_core_manager_destroy(coreManager);
+
+	long long lazyStartupTime;
+	coreManager = start_core_with_chat_rooms(dbPath, true, lazyStartupTime);
+	ms_message(
+		"Core startup with %d synthetic chat rooms: %lld ms (eager), %lld ms (lazy)",
+		syntheticCount, eagerStartupTime, lazyStartupTime
+	);
+
+	// Only the group chat rooms that subscribe to their conference are loaded, the synthetic ones are described.
+	shared_ptr<Core> core = coreManager->lc->cppPtr;
+	BC_ASSERT_LOWER(L_GET_PRIVATE(core)->getLoadedChatRoomCount(), eagerLoadedCount - syntheticCount, int, "%d");
+	BC_ASSERT_EQUAL(
+		L_GET_PRIVATE(core)->getLoadedChatRoomCount() + L_GET_PRIVATE(core)->getLazyChatRoomCount(),
+		eagerLoadedCount, int, "%d"
+	);
+
+	MainDb &mainDb = *L_GET_PRIVATE(core)->mainDb;
+	list<MainDb::ChatRoomDescriptor> descriptors = mainDb.getChatRoomDescriptors(0, 10);
+	BC_ASSERT_EQUAL((int)descriptors.size(), 10, int, "%d");
+
+	// A chat room is loaded on first access, once.
+	const ConferenceId conferenceId = descriptors.back().conferenceId;
+	const int lazyCount = L_GET_PRIVATE(core)->getLazyChatRoomCount();
+	shared_ptr<AbstractChatRoom> chatRoom = core->findChatRoom(conferenceId);
+	if (BC_ASSERT_PTR_NOT_NULL(chatRoom)) {
+		BC_ASSERT_TRUE(chatRoom->getConferenceId() == conferenceId);
+		BC_ASSERT_PTR_EQUAL(core->findChatRoom(conferenceId).get(), chatRoom.get());
+	}
+	BC_ASSERT_EQUAL(L_GET_PRIVATE(core)->getLazyChatRoomCount(), lazyCount - 1, int, "%d");
+
+	// Pages are registered in the core.
+	list<shared_ptr<AbstractChatRoom>> page = core->getChatRooms(100, 20);
+	BC_ASSERT_EQUAL((int)page.size(), 20, int, "%d");
+	for (const auto &chatRoom : page)
+		BC_ASSERT_PTR_EQUAL(core->findChatRoom(chatRoom->getConferenceId()).get(), chatRoom.get());
+
+	linphone_core_manager_destroy(coreManager);
+	bc_free(dbPath);
+#endif
+}
+
+static void find_chat_rooms_among_a_lot_of_chat_rooms (void) {
+#ifdef HAVE_SOCI
+	const int syntheticCount = 50000;
+	const int lookupCount = 200;
+	char *roDbPath = bc_tester_res("db/chatrooms.db");
+	char *dbPath = bc_tester_file("indexed-chatrooms.db");
+	BC_ASSERT_FALSE(liblinphone_tester_copy_file(roDbPath, dbPath));
+	bc_free(roDbPath);
+	add_synthetic_chat_rooms(dbPath, syntheticCount);
+
+	long long startupTime;
+	LinphoneCoreManager *coreManager = start_core_with_chat_rooms(dbPath, false, startupTime);
+	shared_ptr<Core> core = coreManager->lc->cppPtr;
+	const IdentityAddress localAddress("sip:synthetic-local@sip.example.org");
+	list<IdentityAddress> peerAddresses;
+	for (int i = 0; i < lookupCount; i++)
+		peerAddresses.push_back(IdentityAddress("sip:synthetic-" + to_string(1 + i * (syntheticCount / lookupCount)) + "@sip.example.org"));
+
+	// Reference: the scan of every chat room that one to one lookups used to do.
+	list<shared_ptr<AbstractChatRoom>> chatRooms = L_GET_PRIVATE(core)->mainDb->getChatRooms();
+	BC_ASSERT_TRUE((int)chatRooms.size() > syntheticCount);
+	list<ConferenceId> scannedIds;
+	MSTimeSpec start;
+	liblinphone_tester_clock_start(&start);
+	for (const auto &peerAddress : peerAddresses) {
+		ConferenceId conferenceId;
+		for (const auto &chatRoom : chatRooms) {
+			if ((chatRoom->getCapabilities() & AbstractChatRoom::Capabilities::Basic)
+				&& localAddress.getAddressWithoutGruu() == chatRoom->getLocalAddress().getAddressWithoutGruu()
+				&& peerAddress.getAddressWithoutGruu() == chatRoom->getPeerAddress().getAddressWithoutGruu()) {
+				conferenceId = chatRoom->getConferenceId();
+				break;
+			}
+		}
+		scannedIds.push_back(conferenceId);
+	}
+	long long scanTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+
+	list<ConferenceId> indexedIds;
+	liblinphone_tester_clock_start(&start);
+	for (const auto &peerAddress : peerAddresses) {
+		shared_ptr<AbstractChatRoom> chatRoom = core->findOneToOneChatRoom(localAddress, peerAddress, true, false, false);
+		indexedIds.push_back(chatRoom ? chatRoom->getConferenceId() : ConferenceId());
+		BC_ASSERT_EQUAL((int)core->findChatRooms(peerAddress).size(), 1, int, "%d");
+	}
+	long long indexedTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+
+	ms_message(
+		"%d one to one chat room lookups among %d chat rooms: %lld ms (scan), %lld ms (indexed)",
+		lookupCount, (int)chatRooms.size(), scanTime, indexedTime
+	);
+	// Every synthetic chat room is found, and it is the one the scan finds.
+	BC_ASSERT_EQUAL((int)count_if(indexedIds.cbegin(), indexedIds.cend(), [](const ConferenceId &id) { return id.isValid(); }), lookupCount, int, "%d");
+	BC_ASSERT_TRUE(indexedIds == scannedIds);
+
+	// Indexes follow deletions and insertions.
+	const IdentityAddress &peerAddress = peerAddresses.front();
+	shared_ptr<AbstractChatRoom> chatRoom = core->findOneToOneChatRoom(localAddress, peerAddress, true, false, false);
+	if (BC_ASSERT_PTR_NOT_NULL(chatRoom)) {
+		Core::deleteChatRoom(chatRoom);
+		BC_ASSERT_PTR_NULL(core->findOneToOneChatRoom(localAddress, peerAddress, true, false, false));
+		BC_ASSERT_TRUE(core->findChatRooms(peerAddress).empty());
+
+		chatRoom = core->getOrCreateBasicChatRoom(localAddress, peerAddress);
+		BC_ASSERT_PTR_EQUAL(core->findOneToOneChatRoom(localAddress, peerAddress, true, false, false).get(), chatRoom.get());
+		BC_ASSERT_EQUAL((int)core->findChatRooms(peerAddress).size(), 1, int, "%d");
+	}
+	chatRooms.clear();
+
+	linphone_core_manager_destroy(coreManager);
+	bc_free(dbPath);
+#endif
+}
+
+#ifdef HAVE_SOCI
+static void add_synthetic_ephemeral_messages (const char *dbPath, const string &peerAddress, int count) {
+	const int type = int(EventLog::Type::ConferenceChatMessage);
+	const int state = int(ChatMessage::State::Displayed);
+	const int direction = int(ChatMessage::Direction::Incoming);
+	long long chatRoomId;
+	long long peerSipAddressId;
+	long long localSipAddressId;
+	long long lastEventId;
+
+	soci::session sql("sqlite3", dbPath);
+	sql.begin();
+	sql << "SELECT id, peer_sip_address_id, local_sip_address_id FROM chat_room"
+		" WHERE peer_sip_address_id = (SELECT id FROM sip_address WHERE value = :peerAddress)",
+		soci::use(peerAddress), soci::into(chatRoomId), soci::into(peerSipAddressId), soci::into(localSipAddressId);
+	sql << "SELECT IFNULL(MAX(id), 0) FROM event", soci::into(lastEventId);
+	sql << "INSERT INTO event (type, creation_time)"
+		" WITH RECURSIVE n(i) AS (SELECT 1 UNION ALL SELECT i + 1 FROM n WHERE i < :count)"
+		" SELECT :type, datetime('now', '-2 days') FROM n", soci::use(count), soci::use(type);
+	sql << "INSERT INTO conference_event (event_id, chat_room_id)"
+		" SELECT id, :chatRoomId FROM event WHERE id > :lastEventId", soci::use(chatRoomId), soci::use(lastEventId);
+	sql << "INSERT INTO conference_chat_message_event (event_id, from_sip_address_id, to_sip_address_id, time, imdn_message_id, state, direction, is_secured)"
+		" SELECT id, :peerSipAddressId, :localSipAddressId, datetime('now', '-2 days'), 'ephemeral-' || id, :state, :direction, 0"
+		" FROM event WHERE id > :lastEventId",
+		soci::use(peerSipAddressId), soci::use(localSipAddressId), soci::use(state), soci::use(direction), soci::use(lastEventId);
+	// All of them expired one day ago.
+	sql << "INSERT INTO chat_message_ephemeral_event (event_id, ephemeral_lifetime, expired_time)"
+		" SELECT id, 86400, datetime('now', '-1 day') FROM event WHERE id > :lastEventId", soci::use(lastEventId);
+	sql.commit();
+}
+#endif
+
+static void delete_a_lot_of_expired_ephemeral_messages (void) {
+#ifdef HAVE_SOCI
+	const int ephemeralCount = 100000;
+	const string peerAddress = "sip:synthetic-1@sip.example.org";
+	char *roDbPath = bc_tester_res("db/chatrooms.db");
+	char *dbPath = bc_tester_file("ephemeral-chatrooms.db");
+	BC_ASSERT_FALSE(liblinphone_tester_copy_file(roDbPath, dbPath));
+	bc_free(roDbPath);
+	add_synthetic_chat_rooms(dbPath, 1);
+	add_synthetic_ephemeral_messages(dbPath, peerAddress, ephemeralCount);
+
+	// Expired messages are loaded by pages at startup and deleted on the first timer expiry.
+	long long startupTime;
+	LinphoneCoreManager *coreManager = start_core_with_chat_rooms(dbPath, false, startupTime);
+	shared_ptr<Core> core = coreManager->lc->cppPtr;
+	MainDb &mainDb = *L_GET_PRIVATE(core)->mainDb;
+	list<shared_ptr<AbstractChatRoom>> chatRooms = core->findChatRooms(IdentityAddress(peerAddress));
+	BC_ASSERT_EQUAL((int)chatRooms.size(), 1, int, "%d");
+	if (!chatRooms.empty()) {
+		const ConferenceId conferenceId = chatRooms.front()->getConferenceId();
+		BC_ASSERT_EQUAL(mainDb.getChatMessageCount(conferenceId), ephemeralCount, int, "%d");
+
+		MSTimeSpec start;
+		liblinphone_tester_clock_start(&start);
+		for (int i = 0; i < 100 && mainDb.getChatMessageCount(conferenceId) > 0; i++)
+			wait_for_until(coreManager->lc, NULL, NULL, 0, 100);
+		ms_message(
+			"%d expired ephemeral messages deleted in %lld ms",
+			ephemeralCount, liblinphone_tester_clock_get_elapsed_ms(&start)
+		);
+		BC_ASSERT_EQUAL(mainDb.getChatMessageCount(conferenceId), 0, int, "%d");
+		BC_ASSERT_PTR_NULL(mainDb.getLastChatMessage(conferenceId));
+		BC_ASSERT_TRUE(mainDb.getEphemeralMessageEvents(EPHEMERAL_MESSAGE_TASKS_MAX_NB).empty());
+	}
+	chatRooms.clear();
+
+	linphone_core_manager_destroy(coreManager);
+	bc_free(dbPath);
+#endif
+}
+
 test_t main_db_tests[] = {
 	TEST_NO_TAG("Get events count", get_events_count),
 	TEST_NO_TAG("Get messages count", get_messages_count),
@@ -289,7 +647,14 @@ test_t main_db_tests[] = {
 	TEST_NO_TAG("Get history", get_history),
 	TEST_NO_TAG("Get conference events", get_conference_notified_events),
 	TEST_NO_TAG("Get chat rooms", get_chat_rooms),
-	TEST_NO_TAG("Load a lot of chatrooms", load_a_lot_of_chatrooms)
+	TEST_NO_TAG("Load a lot of chatrooms", load_a_lot_of_chatrooms),
+	TEST_NO_TAG("Add a burst of chat messages", add_a_burst_of_chat_messages),
+	TEST_ONE_TAG("Add a large burst of chat messages", add_a_large_burst_of_chat_messages, "Benchmark"),
+	TEST_NO_TAG("Interned ids cache", interned_ids_cache),
+	TEST_NO_TAG("Get chat rooms page", get_chat_rooms_page),
+	TEST_NO_TAG("Load chat rooms lazily", load_chat_rooms_lazily),
+	TEST_NO_TAG("Find chat rooms among a lot of chat rooms", find_chat_rooms_among_a_lot_of_chat_rooms),
+	TEST_NO_TAG("Delete a lot of expired ephemeral messages", delete_a_lot_of_expired_ephemeral_messages)
 };
 
 test_suite_t main_db_test_suite = {
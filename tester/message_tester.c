@@ -1676,6 +1676,75 @@ static void transfer_message_from_history(void) {
 	transfer_message_base(FALSE, FALSE, TRUE, TRUE, TRUE, TRUE, -1, FALSE, FALSE);
 }
 
+/* Measures upload and download throughput of a file transfer, streamed from and to files or through callbacks. */
+static void transfer_message_throughput_base(bool_t use_file_body_handler) {
+	if (!transport_supported(LinphoneTransportTls)) return;
+
+	LinphoneCoreManager* marie = linphone_core_manager_new("marie_rc");
+	LinphoneCoreManager* pauline = linphone_core_manager_new("pauline_tcp_rc");
+	const char *file_path = "sounds/sintel_trailer_opus_h264.mkv";
+	char *send_filepath = bc_tester_res(file_path);
+	char *receive_filepath = bc_tester_file("receive_file.dump");
+	LinphoneChatMessage *msg;
+	LinphoneChatMessageCbs *cbs;
+	MSTimeSpec start;
+	long long upload_time = 0, download_time = 0;
+	size_t file_size;
+
+	linphone_core_set_file_transfer_server(pauline->lc, file_transfer_url);
+	LinphoneChatRoom *chat_room = linphone_core_get_chat_room(pauline->lc, marie->identity);
+	if (use_file_body_handler) {
+		msg = create_file_transfer_message_from_file(chat_room, file_path, "sintel_trailer_opus_h264.mkv");
+	} else {
+		msg = create_message_from_sintel_trailer(chat_room);
+	}
+	file_size = linphone_content_get_file_size((LinphoneContent *)bctbx_list_get_data(linphone_chat_message_get_contents(msg)));
+
+	liblinphone_tester_clock_start(&start);
+	linphone_chat_message_send(msg);
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &pauline->stat.number_of_LinphoneMessageFileTransferDone, 1, 60000));
+	upload_time = liblinphone_tester_clock_get_elapsed_ms(&start);
+
+	BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneMessageReceivedWithFile, 1, 60000));
+	if (marie->stat.last_received_chat_message) {
+		LinphoneChatMessage *recv_msg = marie->stat.last_received_chat_message;
+		cbs = linphone_chat_message_get_callbacks(recv_msg);
+		linphone_chat_message_cbs_set_msg_state_changed(cbs, liblinphone_tester_chat_message_msg_state_changed);
+		if (use_file_body_handler) {
+			linphone_chat_message_set_file_transfer_filepath(recv_msg, receive_filepath);
+		} else {
+			linphone_chat_message_cbs_set_file_transfer_recv(cbs, file_transfer_received);
+		}
+
+		liblinphone_tester_clock_start(&start);
+		linphone_chat_message_download_file(recv_msg);
+		if (BC_ASSERT_TRUE(wait_for_until(pauline->lc, marie->lc, &marie->stat.number_of_LinphoneFileTransferDownloadSuccessful, 1, 60000))) {
+			download_time = liblinphone_tester_clock_get_elapsed_ms(&start);
+			compare_files(send_filepath, linphone_chat_message_get_file_transfer_filepath(recv_msg));
+			remove(linphone_chat_message_get_file_transfer_filepath(recv_msg));
+		}
+	}
+
+	ms_message("File transfer of %zu bytes %s: upload in %lld ms (%.1f MB/s), download in %lld ms (%.1f MB/s)",
+		file_size, use_file_body_handler ? "streamed from/to files" : "through callbacks",
+		upload_time, upload_time ? (double)file_size / 1000. / (double)upload_time : 0.,
+		download_time, download_time ? (double)file_size / 1000. / (double)download_time : 0.);
+
+	linphone_chat_message_unref(msg);
+	bc_free(send_filepath);
+	bc_free(receive_filepath);
+	linphone_core_manager_destroy(pauline);
+	linphone_core_manager_destroy(marie);
+}
+
+static void transfer_message_throughput(void) {
+	transfer_message_throughput_base(FALSE);
+}
+
+static void transfer_message_throughput_with_file_body_handler(void) {
+	transfer_message_throughput_base(TRUE);
+}
+
 static void transfer_message_with_upload_io_error(void) {
 	transfer_message_base(TRUE, FALSE, FALSE, FALSE, FALSE, TRUE, -1, FALSE, FALSE);
 }
@@ -4230,6 +4299,8 @@ test_t message_tests[] = {
 	TEST_NO_TAG("Transfer message auto download existing file", transfer_message_auto_download_existing_file),
 	TEST_NO_TAG("Transfer messages same file auto download", transfer_message_auto_download_two_files_same_name_same_time),
 	TEST_NO_TAG("Transfer message from history", transfer_message_from_history),
+	TEST_NO_TAG("Transfer message throughput", transfer_message_throughput),
+	TEST_NO_TAG("Transfer message throughput with file body handler", transfer_message_throughput_with_file_body_handler),
 	TEST_NO_TAG("Transfer message with http proxy", file_transfer_with_http_proxy),
 	TEST_NO_TAG("Transfer message with upload io error", transfer_message_with_upload_io_error),
 	TEST_NO_TAG("Transfer message with download io error", transfer_message_with_download_io_error),
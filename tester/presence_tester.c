@@ -410,6 +410,180 @@ static void simple_subscribe_with_friend_from_rc(void) {
 	linphone_core_manager_destroy(pauline);
 }
 
+#define LARGE_NOTIFY_BOUNDARY "---------------------------14737809831466499882746641449"
+
+typedef struct _LargeNotifyBody {
+	char *data;
+	size_t length;
+	size_t capacity;
+} LargeNotifyBody;
+
+/* Appends to a buffer growing geometrically, the body being several megabytes long. */
+static void large_notify_body_append(LargeNotifyBody *body, const char *fmt, ...) {
+	va_list args;
+	int written;
+
+	va_start(args, fmt);
+	written = vsnprintf(body->data + body->length, body->capacity - body->length, fmt, args);
+	va_end(args);
+	if (written < 0) return;
+	if ((size_t)written >= body->capacity - body->length) {
+		while ((size_t)written >= body->capacity - body->length)
+			body->capacity *= 2;
+		body->data = (char *)ms_realloc(body->data, body->capacity);
+		va_start(args, fmt);
+		vsnprintf(body->data + body->length, body->capacity - body->length, fmt, args);
+		va_end(args);
+	}
+	body->length += (size_t)written;
+}
+
+static LinphoneContent *create_large_multipart_presence_notify(LinphoneCore *lc, int resource_count, int version) {
+	LinphoneContent *content = linphone_core_create_content(lc);
+	LargeNotifyBody body;
+	int i, j;
+
+	body.capacity = 4096;
+	body.length = 0;
+	body.data = (char *)ms_malloc(body.capacity);
+	large_notify_body_append(&body, "--" LARGE_NOTIFY_BOUNDARY "\r\n"
+		"Content-Type: application/rlmi+xml;charset=\"UTF-8\"\r\n\r\n"
+		"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>\n"
+		"<list xmlns=\"urn:ietf:params:xml:ns:rlmi\" fullState=\"true\" uri=\"sip:rls@sip.example.org\" version=\"%d\">\n", version);
+	for (i = 0; i < resource_count; i++) {
+		large_notify_body_append(&body,
+			"\t<resource uri=\"sip:friend%d@sip.example.org;gr=urn:uuid:%08d\">\n"
+			"\t\t<name>Friend %d</name>\n"
+			"\t\t<instance cid=\"cid%d@sip.example.org\" id=\"1\" state=\"active\"/>\n"
+			"\t</resource>\n", i, i, i, i);
+	}
+	large_notify_body_append(&body, "</list>\r\n");
+
+	for (i = 0; i < resource_count; i++) {
+		large_notify_body_append(&body, "--" LARGE_NOTIFY_BOUNDARY "\r\n"
+			"Content-Type: application/pidf+xml;charset=\"UTF-8\"\r\n"
+			"Content-Id: cid%d@sip.example.org\r\n\r\n"
+			"<?xml version=\"1.0\" encoding=\"UTF-8\" standalone=\"no\" ?>\n"
+			"<presence xmlns=\"urn:ietf:params:xml:ns:pidf\" entity=\"sip:friend%d@sip.example.org\" xmlns:dm=\"urn:ietf:params:xml:ns:pidf:data-model\""
+			" xmlns:rpid=\"urn:ietf:params:xml:ns:pidf:rpid\" xmlns:pidfonline=\"http://www.linphone.org/xsds/pidfonline.xsd\""
+			" xmlns:oma-pres=\"urn:oma:xml:prs:pidf:oma-pres\">\n", i, i);
+		/* Several tuples per resource, this is what made the XPath based parser quadratic. */
+		for (j = 0; j < 8; j++) {
+			large_notify_body_append(&body,
+				"\t<tuple id=\"t%d-%d\">\n"
+				"\t\t<status><basic>%s</basic>%s</status>\n"
+				"\t\t<oma-pres:service-description><oma-pres:service-id>groupchat</oma-pres:service-id><oma-pres:version>1.%d</oma-pres:version></oma-pres:service-description>\n"
+				"\t\t<contact>sip:friend%d@sip.example.org;device=%d</contact>\n"
+				"\t\t<note xml:lang=\"en\">Device &amp; %d</note>\n"
+				"\t\t<timestamp>2017-10-25T13:18:%02d</timestamp>\n"
+				"\t</tuple>\n",
+				i, j, (i + j) % 3 ? "open" : "closed", (i % 2) ? "<pidfonline:online/>" : "", j, i, j, j, j);
+		}
+		large_notify_body_append(&body,
+			"\t<dm:person id=\"p%d\">\n"
+			"\t\t<rpid:activities><rpid:%s/><rpid:note xml:lang=\"fr\">Note %d</rpid:note></rpid:activities>\n"
+			"\t\t<dm:note>Person note %d</dm:note>\n"
+			"\t</dm:person>\n"
+			"\t<note>Model note %d</note>\n"
+			"</presence>\r\n", i, (i % 2) ? "away" : "on-the-phone", i, i, i);
+	}
+	large_notify_body_append(&body, "--" LARGE_NOTIFY_BOUNDARY "--\r\n");
+
+	linphone_content_set_type(content, "multipart");
+	linphone_content_set_subtype(content, "related");
+	linphone_content_add_content_type_parameter(content, "boundary", LARGE_NOTIFY_BOUNDARY);
+	linphone_content_set_utf8_text(content, body.data);
+	ms_free(body.data);
+	return content;
+}
+
+static char *describe_friend_presence(LinphoneFriend *lf) {
+	const LinphonePresenceModel *model = linphone_friend_get_presence_model(lf);
+	LinphonePresenceActivity *activity;
+	LinphonePresenceNote *note;
+	char *contact;
+	char *description;
+
+	if (!model) return ms_strdup("none");
+	activity = linphone_presence_model_get_activity(model);
+	note = linphone_presence_model_get_note(model, "fr");
+	contact = linphone_presence_model_get_contact(model);
+	description = ms_strdup_printf("%s|%d|%d|%u|%d|%s|%s|%s|%.1f|%u",
+		linphone_friend_get_name(lf),
+		linphone_presence_model_get_basic_status(model),
+		activity ? (int)linphone_presence_activity_get_type(activity) : -1,
+		linphone_presence_model_get_nb_services(model),
+		linphone_presence_model_is_online(model),
+		contact ? contact : "",
+		note ? linphone_presence_note_get_content(note) : "",
+		note ? linphone_presence_note_get_lang(note) : "",
+		linphone_presence_model_get_capability_version(model, LinphoneFriendCapabilityGroupChat),
+		linphone_presence_model_get_nb_persons(model));
+	if (contact) ms_free(contact);
+	return description;
+}
+
+static void large_multipart_presence_notify_benchmark(void) {
+	LinphoneCoreManager *manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_create_friend_list(manager->lc);
+	const int resource_count = 2000;
+	LinphoneFriend **friends = (LinphoneFriend **)ms_malloc0(resource_count * sizeof(LinphoneFriend *));
+	char **xpath_descriptions = (char **)ms_malloc0(resource_count * sizeof(char *));
+	LinphoneContent *notify;
+	MSTimeSpec start;
+	long long xpath_ms, streamed_ms;
+	int mismatches = 0;
+	int i;
+
+	for (i = 0; i < resource_count; i++) {
+		char uri[64];
+		snprintf(uri, sizeof(uri), "sip:friend%d@sip.example.org", i);
+		friends[i] = linphone_core_create_friend_with_address(manager->lc, uri);
+		linphone_friend_list_add_local_friend(lfl, friends[i]);
+	}
+
+	/* Reference run with the libxml2 XPath parsers. */
+	linphone_config_set_bool(linphone_core_get_config(manager->lc), "misc", "xml_streaming_codec", FALSE);
+	notify = create_large_multipart_presence_notify(manager->lc, resource_count, 0);
+	liblinphone_tester_clock_start(&start);
+	linphone_friend_list_notify_presence_received(lfl, NULL, notify);
+	xpath_ms = liblinphone_tester_clock_get_elapsed_ms(&start);
+	linphone_content_unref(notify);
+	for (i = 0; i < resource_count; i++) {
+		xpath_descriptions[i] = describe_friend_presence(friends[i]);
+	}
+
+	/* Same notification read by the single pass parsers, the models must be the same. */
+	linphone_config_set_bool(linphone_core_get_config(manager->lc), "misc", "xml_streaming_codec", TRUE);
+	notify = create_large_multipart_presence_notify(manager->lc, resource_count, 1);
+	liblinphone_tester_clock_start(&start);
+	linphone_friend_list_notify_presence_received(lfl, NULL, notify);
+	streamed_ms = liblinphone_tester_clock_get_elapsed_ms(&start);
+	linphone_content_unref(notify);
+	for (i = 0; i < resource_count; i++) {
+		char *description = describe_friend_presence(friends[i]);
+		if (strcmp(description, xpath_descriptions[i]) != 0) {
+			if (mismatches == 0) ms_error("Presence of friend %d differs: [%s] instead of [%s]", i, description, xpath_descriptions[i]);
+			mismatches++;
+		}
+		ms_free(description);
+	}
+
+	ms_message("multipart/related presence NOTIFY with %d resources: %lld ms with XPath, %lld ms streamed", resource_count, xpath_ms, streamed_ms);
+	BC_ASSERT_EQUAL(mismatches, 0, int, "%d");
+	BC_ASSERT_STRING_EQUAL(xpath_descriptions[1], "Friend 1|0|1|8|1|sip:friend1@sip.example.org;device=0|Note 1|fr|1.7|1");
+	BC_ASSERT_EQUAL(linphone_friend_list_get_expected_notification_version(lfl), 2, int, "%d");
+
+	for (i = 0; i < resource_count; i++) {
+		ms_free(xpath_descriptions[i]);
+		linphone_friend_unref(friends[i]);
+	}
+	ms_free(xpath_descriptions);
+	ms_free(friends);
+	linphone_friend_list_unref(lfl);
+	linphone_core_manager_destroy(manager);
+}
+
 test_t presence_tests[] = {
 	TEST_ONE_TAG("Simple Subscribe", simple_subscribe,"presence"),
 	TEST_ONE_TAG("Simple Subscribe with early NOTIFY", simple_subscribe_with_early_notify,"presence"),
@@ -417,6 +591,7 @@ test_t presence_tests[] = {
 	/*TEST_ONE_TAG("Call with presence", call_with_presence, "LeaksMemory"),*/
 	TEST_NO_TAG("Unsubscribe while subscribing", unsubscribe_while_subscribing),
 	TEST_NO_TAG("Presence information", presence_information),
+	TEST_ONE_TAG("Large multipart presence NOTIFY benchmark", large_multipart_presence_notify_benchmark, "Benchmark"),
 	TEST_ONE_TAG("App managed presence failure", subscribe_failure_handle_by_app,"presence"),
 	TEST_NO_TAG("Presence SUBSCRIBE forked", subscribe_presence_forked),
 	TEST_NO_TAG("Presence SUBSCRIBE expired", subscribe_presence_expired),
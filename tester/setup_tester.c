@@ -172,6 +172,67 @@ static void core_init_test(void) {
 	}
 }
 
+/*
+ * Logs the wakeups of an idle core with 1000 accounts, when linphone_core_iterate() is called
+ * every 20ms and when the core waits for events with linphone_core_wait_for_events().
+ */
+static void core_idle_iterate_benchmark(void) {
+	const int account_count = 1000;
+	const int duration_ms = 1000;
+	LinphoneConfig *config = linphone_factory_create_config_with_factory(linphone_factory_get(), NULL, liblinphone_tester_get_empty_rc());
+	LinphoneCore *lc;
+	MSTimeSpec start;
+	long long polled_time, waited_time;
+	int polled_wakeups = 0, waited_wakeups = 0;
+	int i;
+
+	for (i = 0; i < account_count; i++) {
+		char section[32];
+		char *identity = bctbx_strdup_printf("sip:idle-%d@sip.example.org", i);
+		snprintf(section, sizeof(section), "proxy_%d", i);
+		linphone_config_set_string(config, section, "reg_proxy", "<sip:sip.example.org;transport=tls>");
+		linphone_config_set_string(config, section, "reg_identity", identity);
+		linphone_config_set_int(config, section, "reg_sendregister", 0);
+		bctbx_free(identity);
+	}
+	lc = linphone_factory_create_core_with_config_3(linphone_factory_get(), config, system_context);
+	linphone_config_unref(config);
+	if (!BC_ASSERT_PTR_NOT_NULL(lc)) return;
+	linphone_core_start(lc);
+	BC_ASSERT_EQUAL((int)bctbx_list_size(linphone_core_get_account_list(lc)), account_count, int, "%d");
+
+	/* Let the startup tasks complete: an idle core has nothing to do immediately. */
+	liblinphone_tester_clock_start(&start);
+	while (linphone_core_get_next_iterate_delay(lc) == 0 && !liblinphone_tester_clock_elapsed(&start, 3000)) {
+		linphone_core_iterate(lc);
+		ms_usleep(20000);
+	}
+	BC_ASSERT_NOT_EQUAL(linphone_core_get_next_iterate_delay(lc), 0, int, "%d");
+
+	liblinphone_tester_clock_start(&start);
+	while (!liblinphone_tester_clock_elapsed(&start, duration_ms)) {
+		linphone_core_iterate(lc);
+		ms_usleep(20000);
+		polled_wakeups++;
+	}
+	polled_time = liblinphone_tester_clock_get_elapsed_ms(&start);
+
+	liblinphone_tester_clock_start(&start);
+	while (!liblinphone_tester_clock_elapsed(&start, duration_ms)) {
+		linphone_core_wait_for_events(lc, 1000);
+		waited_wakeups++;
+	}
+	waited_time = liblinphone_tester_clock_get_elapsed_ms(&start);
+	/* Waiting did not create any work for the core. */
+	BC_ASSERT_NOT_EQUAL(linphone_core_get_next_iterate_delay(lc), 0, int, "%d");
+
+	ms_message("Idle core with %d accounts: %d wakeups in %lld ms when polled every 20ms, %d wakeups in %lld ms when waiting for events",
+		account_count, polled_wakeups, polled_time, waited_wakeups, waited_time);
+
+	linphone_core_stop(lc);
+	linphone_core_unref(lc);
+}
+
 static void core_init_test_2(void) {
 	LinphoneCore* lc;
 	char* rc_path = bc_tester_res("rcfiles/chloe_rc");
@@ -490,6 +551,138 @@ static void linphone_lpconfig_from_file_zerolen_value(void){
 	linphone_config_destroy(conf);
 }
 
+static void linphone_lpconfig_indexed_lookups(void){
+	const char* buffer = "[sip]\nsip_port=5060\n# comment\nhex_value=0x10\n[rtp]\naudio_rtp_port=7078\n";
+	LpConfig* conf = linphone_config_new_from_buffer(buffer);
+
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "sip", "sip_port", 0), 5060, int, "%d");
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "sip", "hex_value", 0), 16, int, "%d");
+	BC_ASSERT_TRUE(linphone_config_get_bool(conf, "sip", "hex_value", FALSE));
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "sip", "unknown", -1), -1, int, "%d");
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "unknown", "sip_port", -1), -1, int, "%d");
+
+	/* Cached values follow the changes. */
+	linphone_config_set_int(conf, "sip", "sip_port", 5070);
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "sip", "sip_port", 0), 5070, int, "%d");
+	linphone_config_set_string(conf, "sip", "sip_port", NULL);
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "sip", "sip_port", -1), -1, int, "%d");
+	linphone_config_set_bool(conf, "new_section", "enabled", TRUE);
+	BC_ASSERT_TRUE(linphone_config_get_bool(conf, "new_section", "enabled", FALSE));
+	linphone_config_clean_entry(conf, "rtp", "audio_rtp_port");
+	BC_ASSERT_FALSE(linphone_config_has_entry(conf, "rtp", "audio_rtp_port"));
+	linphone_config_clean_section(conf, "new_section");
+	BC_ASSERT_FALSE(linphone_config_has_section(conf, "new_section"));
+	BC_ASSERT_TRUE(linphone_config_get_bool(conf, "new_section", "enabled", TRUE));
+
+	/* Serialization keeps the order of the sections and items. */
+	char *dump = linphone_config_dump(conf);
+	BC_ASSERT_STRING_EQUAL(dump, "[sip]\n\thex_value=0x10\n[rtp]\n");
+	ms_free(dump);
+
+	linphone_config_destroy(conf);
+}
+
+/*
+ * Reads keys of a linphonerc of 2000 entries, as done by the core during call setup and in linphone_core_iterate().
+ */
+static void linphone_lpconfig_get_int_benchmark(void){
+	const int section_count = 100;
+	const int key_count = 20;
+	const int lookups = 1000000;
+	char *buffer = NULL;
+	char section[32], key[32];
+	MSTimeSpec start;
+	long long elapsed, sum = 0;
+	LpConfig *conf;
+	int i;
+
+	for (i = 0; i < section_count; i++) {
+		int j;
+		buffer = ms_strcat_printf(buffer, "[section_%d]\n", i);
+		for (j = 0; j < key_count; j++)
+			buffer = ms_strcat_printf(buffer, "a_rather_long_key_name_%d=%d\n", j, i * key_count + j);
+	}
+	conf = linphone_config_new_from_buffer(buffer);
+	ms_free(buffer);
+
+	liblinphone_tester_clock_start(&start);
+	for (i = 0; i < lookups; i++) {
+		/* Mostly found keys, in the last sections, as with a list these were the slowest. */
+		const int index = (i * 7919) % (section_count * key_count);
+		snprintf(section, sizeof(section), "section_%d", section_count - 1 - index / key_count);
+		snprintf(key, sizeof(key), "a_rather_long_key_name_%d", (i % 10 == 0) ? key_count : index % key_count);
+		sum += linphone_config_get_int(conf, section, key, 0);
+	}
+	elapsed = liblinphone_tester_clock_get_elapsed_ms(&start);
+	ms_message("linphone_config_get_int(): %d lookups in a %d keys config in %lld ms (%.1f ns per lookup, key formatting included)",
+		lookups, section_count * key_count, elapsed, (double)elapsed * 1000000.0 / lookups);
+	BC_ASSERT_TRUE(sum > 0);
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "section_99", "a_rather_long_key_name_19", 0), 1999, int, "%d");
+	BC_ASSERT_EQUAL(linphone_config_get_int(conf, "section_0", "a_rather_long_key_name_0", -1), 0, int, "%d");
+
+	linphone_config_destroy(conf);
+}
+
+/*
+ * Syncs a config many times in a row, as linphone_core_iterate() does while it is modified: with the background sync,
+ * the syncs do not wait for the file writes and the snapshots that are overwritten before being written are skipped.
+ */
+static void linphone_lpconfig_background_sync(void){
+	char *rc_path = bc_tester_file("background_sync_rc");
+	const int sync_count = 200;
+	MSTimeSpec start;
+	long long sync_time, background_time;
+	LpConfig *conf, *read_conf;
+	int i;
+
+	unlink(rc_path);
+	conf = linphone_config_new(rc_path);
+	if (!BC_ASSERT_PTR_NOT_NULL(conf)) goto end;
+	BC_ASSERT_FALSE(linphone_config_background_sync_enabled(conf));
+
+	liblinphone_tester_clock_start(&start);
+	for (i = 0; i < sync_count; i++) {
+		linphone_config_set_int(conf, "test", "value", i);
+		BC_ASSERT_EQUAL(linphone_config_sync(conf), 0, int, "%d");
+	}
+	sync_time = liblinphone_tester_clock_get_elapsed_ms(&start);
+
+	linphone_config_enable_background_sync(conf, TRUE);
+	BC_ASSERT_TRUE(linphone_config_background_sync_enabled(conf));
+	liblinphone_tester_clock_start(&start);
+	for (i = 0; i < sync_count; i++) {
+		linphone_config_set_int(conf, "test", "value", sync_count + i);
+		BC_ASSERT_EQUAL(linphone_config_sync(conf), 0, int, "%d");
+	}
+	background_time = liblinphone_tester_clock_get_elapsed_ms(&start);
+	BC_ASSERT_FALSE(linphone_config_needs_commit(conf));
+	linphone_config_flush(conf);
+	ms_message("%d syncs: %lld ms when writing the file, %lld ms with the background sync (%d syncs coalesced)",
+		sync_count, sync_time, background_time, linphone_config_get_coalesced_sync_count(conf));
+	BC_ASSERT_GREATER_STRICT(linphone_config_get_coalesced_sync_count(conf), 0, int, "%d");
+
+	/* The last snapshot is on disk after the flush. */
+	read_conf = linphone_config_new(rc_path);
+	if (BC_ASSERT_PTR_NOT_NULL(read_conf)) {
+		BC_ASSERT_EQUAL(linphone_config_get_int(read_conf, "test", "value", -1), 2 * sync_count - 1, int, "%d");
+		linphone_config_destroy(read_conf);
+	}
+
+	/* Destroying the config writes what is pending. */
+	linphone_config_set_int(conf, "test", "value", 0);
+	linphone_config_sync(conf);
+	linphone_config_destroy(conf);
+	read_conf = linphone_config_new(rc_path);
+	if (BC_ASSERT_PTR_NOT_NULL(read_conf)) {
+		BC_ASSERT_EQUAL(linphone_config_get_int(read_conf, "test", "value", -1), 0, int, "%d");
+		linphone_config_destroy(read_conf);
+	}
+
+end:
+	unlink(rc_path);
+	bc_free(rc_path);
+}
+
 void linphone_lpconfig_invalid_friend(void) {
 	LinphoneCoreManager* mgr = linphone_core_manager_new_with_proxies_check("invalid_friends_rc",FALSE);
 	LinphoneFriendList *friendList = linphone_core_get_default_friend_list(mgr->lc);
@@ -1422,6 +1615,83 @@ static void search_friend_with_phone_number_2(void) {
 	linphone_core_manager_destroy(manager);
 }
 
+/*
+ * Looks phone numbers up in a large friend list, as done for each incoming presence NOTIFY: the list keeps an index of the
+ * normalized numbers, updated when friends or their numbers change.
+ */
+static void find_friend_by_phone_number_in_large_list(void) {
+	LinphoneCoreManager* manager = linphone_core_manager_new_with_proxies_check("chloe_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_create_friend_list(manager->lc);
+	LinphoneAccount *account = linphone_core_get_default_account(manager->lc);
+	const int friend_count = 20000;
+	const int lookup_count = 2000;
+	LinphoneFriend **friends = (LinphoneFriend **)ms_malloc0(friend_count * sizeof(LinphoneFriend *));
+	LinphoneFriend *lf;
+	MSTimeSpec start;
+	long long elapsed_ms;
+	int found = 0;
+	int i;
+
+	if (!linphone_core_vcard_supported()) goto end;
+	if (BC_ASSERT_PTR_NOT_NULL(account)) {
+		LinphoneAccountParams *params = linphone_account_params_clone(linphone_account_get_params(account));
+		linphone_account_params_set_international_prefix(params, "33");
+		linphone_account_set_params(account, params);
+		linphone_account_params_unref(params);
+	}
+
+	for (i = 0; i < friend_count; i++) {
+		char name[32];
+		char number[32];
+		snprintf(name, sizeof(name), "Friend %d", i);
+		snprintf(number, sizeof(number), "06%08d", i);
+		friends[i] = linphone_core_create_friend(manager->lc);
+		linphone_friend_create_vcard(friends[i], name);
+		linphone_friend_add_phone_number(friends[i], number);
+		linphone_friend_list_add_local_friend(lfl, friends[i]);
+	}
+
+	liblinphone_tester_clock_start(&start);
+	for (i = 0; i < lookup_count; i++) {
+		char number[32];
+		int index = (i * 7919) % friend_count;
+		snprintf(number, sizeof(number), "+336%08d", index);
+		lf = linphone_friend_list_find_friend_by_phone_number(lfl, number);
+		if (lf == friends[index]) found++;
+	}
+	elapsed_ms = liblinphone_tester_clock_get_elapsed_ms(&start);
+	ms_message("%d phone number lookups in a list of %d friends: %lld ms, index build included", lookup_count, friend_count, elapsed_ms);
+	BC_ASSERT_EQUAL(found, lookup_count, int, "%d");
+	/* Numbers that are not in the list are not found. */
+	BC_ASSERT_PTR_NULL(linphone_friend_list_find_friend_by_phone_number(lfl, "+33799999999"));
+
+	/* The index follows the changes of the friends. */
+	linphone_friend_add_phone_number(friends[0], "0699999999");
+	BC_ASSERT_PTR_EQUAL(linphone_friend_list_find_friend_by_phone_number(lfl, "+33699999999"), friends[0]);
+	linphone_friend_remove_phone_number(friends[0], "0699999999");
+	BC_ASSERT_PTR_NULL(linphone_friend_list_find_friend_by_phone_number(lfl, "+33699999999"));
+	linphone_friend_list_remove_friend(lfl, friends[1]);
+	BC_ASSERT_PTR_NULL(linphone_friend_list_find_friend_by_phone_number(lfl, "0600000001"));
+
+	/* And the changes of the accounts. */
+	if (account) {
+		LinphoneAccountParams *params = linphone_account_params_clone(linphone_account_get_params(account));
+		linphone_account_params_set_international_prefix(params, "358");
+		linphone_account_set_params(account, params);
+		linphone_account_params_unref(params);
+	}
+	BC_ASSERT_PTR_EQUAL(linphone_friend_list_find_friend_by_phone_number(lfl, "+358600000002"), friends[2]);
+	BC_ASSERT_PTR_NULL(linphone_friend_list_find_friend_by_phone_number(lfl, "+33600000002"));
+
+end:
+	for (i = 0; i < friend_count; i++) {
+		if (friends[i]) linphone_friend_unref(friends[i]);
+	}
+	ms_free(friends);
+	linphone_friend_list_unref(lfl);
+	linphone_core_manager_destroy(manager);
+}
+
 static void search_friend_with_presence(void) {
 	LinphoneMagicSearch *magicSearch = NULL;
 	bctbx_list_t *resultList = NULL;
@@ -2014,6 +2284,152 @@ static void search_friend_large_database(void) {
 	bc_free(dbPath);
 }
 
+static int _count_search_results(LinphoneMagicSearch *magicSearch, const char *filter, int sourceFlags) {
+	bctbx_list_t *resultList = linphone_magic_search_get_contacts_list(magicSearch, filter, "", sourceFlags, LinphoneMagicSearchAggregationNone);
+	int size = (int)bctbx_list_size(resultList);
+	bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+	return size;
+}
+
+static void search_friend_index_follows_changes(void) {
+	LinphoneCoreManager* manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_get_default_friend_list(manager->lc);
+	LinphoneMagicSearch *magicSearch = NULL;
+	LinphoneMagicSearch *unindexedMagicSearch = NULL;
+	LinphoneAddress *ronanAddress = linphone_address_new("sip:ronan@sip.example.org");
+	LinphoneAddress *chuckAddress = linphone_address_new("sip:chuck@sip.example.org");
+	LinphoneFriend *fr;
+
+	_create_friends_from_tab(manager->lc, lfl, sFriends, sSizeFriend);
+
+	magicSearch = linphone_magic_search_new(manager->lc);
+	linphone_config_set_bool(linphone_core_get_config(manager->lc), "magic_search", "use_index", FALSE);
+	unindexedMagicSearch = linphone_magic_search_new(manager->lc);
+
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "ch", LinphoneMagicSearchSourceFriends), 2, int, "%d");
+
+	// A friend added after the first search.
+	fr = linphone_core_create_friend_with_address(manager->lc, "sip:charlie@sip.example.org");
+	linphone_friend_enable_subscribes(fr, FALSE);
+	linphone_friend_list_add_friend(lfl, fr);
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "ch", LinphoneMagicSearchSourceFriends), 3, int, "%d");
+
+	// Its name changes.
+	linphone_friend_edit(fr);
+	linphone_friend_set_name(fr, "Lord Wellington");
+	linphone_friend_done(fr);
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "wellington", LinphoneMagicSearchSourceFriends), 1, int, "%d");
+	BC_ASSERT_EQUAL(_count_search_results(unindexedMagicSearch, "wellington", LinphoneMagicSearchSourceFriends), 1, int, "%d");
+
+	// Its address changes.
+	linphone_friend_edit(fr);
+	linphone_friend_set_address(fr, ronanAddress);
+	linphone_friend_done(fr);
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "ch", LinphoneMagicSearchSourceFriends), 2, int, "%d");
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "ronan", LinphoneMagicSearchSourceFriends), 1, int, "%d");
+
+	// It is removed.
+	linphone_friend_list_remove_friend(lfl, fr);
+	linphone_friend_unref(fr);
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "ronan", LinphoneMagicSearchSourceFriends), 0, int, "%d");
+
+	// Call logs are synchronized at each search.
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "chuck", LinphoneMagicSearchSourceCallLogs), 0, int, "%d");
+	_create_call_log(manager->lc, ronanAddress, chuckAddress, LinphoneCallOutgoing);
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "chuck", LinphoneMagicSearchSourceCallLogs), 1, int, "%d");
+	BC_ASSERT_EQUAL(_count_search_results(unindexedMagicSearch, "chuck", LinphoneMagicSearchSourceCallLogs), 1, int, "%d");
+	linphone_core_clear_call_logs(manager->lc);
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "chuck", LinphoneMagicSearchSourceCallLogs), 0, int, "%d");
+
+	_remove_friends_from_list(lfl, sFriends, sSizeFriend);
+
+	linphone_address_unref(ronanAddress);
+	linphone_address_unref(chuckAddress);
+	linphone_magic_search_unref(unindexedMagicSearch);
+	linphone_magic_search_unref(magicSearch);
+	linphone_core_manager_destroy(manager);
+}
+
+static long long _replay_typed_search(LinphoneMagicSearch *magicSearch, const char *typed, int *lastSize) {
+	MSTimeSpec start;
+	long long time = 0;
+	char subBuff[64];
+	size_t len = strlen(typed);
+
+	for (size_t i = 1; i <= len && i < sizeof(subBuff); i++) {
+		memcpy(subBuff, typed, i);
+		subBuff[i] = '\0';
+		liblinphone_tester_clock_start(&start);
+		*lastSize = _count_search_results(magicSearch, subBuff, LinphoneMagicSearchSourceFriends);
+		time += liblinphone_tester_clock_get_elapsed_ms(&start);
+	}
+	return time / (long long)len;
+}
+
+static void search_friend_index_large_directory(void) {
+	static const char *firstNames[] = { "john", "jane", "pierre", "marie", "paul", "laure", "ronan", "chloe" };
+	static const char *lastNames[] = { "smith", "martin", "durand", "dupont", "moreau", "simon", "laurent", "michel" };
+	const int directorySize = 50000;
+	LinphoneCoreManager* manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneFriendList *lfl = linphone_core_get_default_friend_list(manager->lc);
+	LinphoneMagicSearch *magicSearch = NULL;
+	LinphoneMagicSearch *unindexedMagicSearch = NULL;
+	int indexedSize = 0, unindexedSize = 0;
+	long long indexedTime, unindexedTime;
+	bctbx_list_t *indexedResults, *unindexedResults;
+	const bctbx_list_t *it, *unindexedIt;
+
+	linphone_config_set_int(linphone_core_get_config(manager->lc), "misc", "store_friends", 0);
+	for (int i = 0; i < directorySize; i++) {
+		char uri[64], name[64], refKey[16];
+		snprintf(uri, sizeof(uri), "sip:user%d@sip.example.org", i);
+		snprintf(name, sizeof(name), "%s %s%d", firstNames[i % 8], lastNames[(i / 8) % 8], i / 64);
+		snprintf(refKey, sizeof(refKey), "%d", i);
+		LinphoneFriend *fr = linphone_core_create_friend_with_address(manager->lc, uri);
+		linphone_friend_enable_subscribes(fr, FALSE);
+		linphone_friend_set_name(fr, name);
+		// Avoid the linear lookup done for friends without reference key.
+		linphone_friend_set_ref_key(fr, refKey);
+		linphone_friend_list_add_friend(lfl, fr);
+		linphone_friend_unref(fr);
+	}
+
+	magicSearch = linphone_magic_search_new(manager->lc);
+	linphone_magic_search_set_limited_search(magicSearch, FALSE);
+	linphone_config_set_bool(linphone_core_get_config(manager->lc), "magic_search", "use_index", FALSE);
+	unindexedMagicSearch = linphone_magic_search_new(manager->lc);
+	linphone_magic_search_set_limited_search(unindexedMagicSearch, FALSE);
+
+	indexedTime = _replay_typed_search(magicSearch, "john smith7", &indexedSize);
+	unindexedTime = _replay_typed_search(unindexedMagicSearch, "john smith7", &unindexedSize);
+	ms_message("Average searching time in %d friends: %lld ms with index, %lld ms without", directorySize, indexedTime, unindexedTime);
+	// "john smithN" friends are every 64th one: N is 7, 70 to 79 and 700 to 781.
+	BC_ASSERT_EQUAL(indexedSize, 93, int, "%d");
+	BC_ASSERT_EQUAL(unindexedSize, 93, int, "%d");
+
+	// Results come in the same order.
+	indexedResults = linphone_magic_search_get_contacts_list(magicSearch, "john smith7", "", LinphoneMagicSearchSourceFriends, LinphoneMagicSearchAggregationNone);
+	unindexedResults = linphone_magic_search_get_contacts_list(unindexedMagicSearch, "john smith7", "", LinphoneMagicSearchSourceFriends, LinphoneMagicSearchAggregationNone);
+	BC_ASSERT_EQUAL((int)bctbx_list_size(indexedResults), (int)bctbx_list_size(unindexedResults), int, "%d");
+	for (it = indexedResults, unindexedIt = unindexedResults; it && unindexedIt; it = bctbx_list_next(it), unindexedIt = bctbx_list_next(unindexedIt)) {
+		BC_ASSERT_PTR_EQUAL(
+			linphone_search_result_get_friend((LinphoneSearchResult *)bctbx_list_get_data(it)),
+			linphone_search_result_get_friend((LinphoneSearchResult *)bctbx_list_get_data(unindexedIt))
+		);
+	}
+	bctbx_list_free_with_data(indexedResults, (bctbx_list_free_func)linphone_search_result_unref);
+	bctbx_list_free_with_data(unindexedResults, (bctbx_list_free_func)linphone_search_result_unref);
+
+	// The friends of a removed list are no longer indexed.
+	linphone_core_remove_friend_list(manager->lc, lfl);
+	linphone_magic_search_reset_search_cache(magicSearch);
+	BC_ASSERT_EQUAL(_count_search_results(magicSearch, "john smith7", LinphoneMagicSearchSourceFriends), 0, int, "%d");
+
+	linphone_magic_search_unref(unindexedMagicSearch);
+	linphone_magic_search_unref(magicSearch);
+	linphone_core_manager_destroy(manager);
+}
+
 static void search_friend_get_capabilities(void) {
 	LinphoneMagicSearch *magicSearch = NULL;
 	bctbx_list_t *resultList = NULL;
@@ -2291,6 +2707,12 @@ void _onMagicSearchResultsReceived(LinphoneMagicSearch* magic_search) {
 	stats * stat = (stats*)linphone_magic_search_cbs_get_user_data(linphone_magic_search_get_current_callbacks(magic_search));
 	++stat->number_of_LinphoneMagicSearchResultReceived;
 }
+void _onMagicSearchPartialResultsReceived(LinphoneMagicSearch* magic_search, const bctbx_list_t *partial_results) {
+	stats * stat = (stats*)linphone_magic_search_cbs_get_user_data(linphone_magic_search_get_current_callbacks(magic_search));
+	// Partial results are only streamed before the final results.
+	BC_ASSERT_EQUAL(stat->number_of_LinphoneMagicSearchResultReceived, 0, int, "%d");
+	++stat->number_of_LinphoneMagicSearchPartialResultsReceived;
+}
 void _onMagicSearchLdapHaveMoreResults(LinphoneMagicSearch* magic_search, LinphoneLdap* ldap) {
 	stats * stat = (stats*)linphone_magic_search_cbs_get_user_data(linphone_magic_search_get_current_callbacks(magic_search));
 	++stat->number_of_LinphoneMagicSearchLdapHaveMoreResults;
@@ -2515,6 +2937,50 @@ static void async_search_friend_in_sources(void){
 	linphone_core_manager_destroy(manager);
 }
 
+static void async_search_partial_results(void){
+	LinphoneCoreManager* manager = linphone_core_manager_new("marie_rc");
+	LinphoneLdap * ldap;
+	prepare_friends(manager, &ldap);
+
+	LinphoneMagicSearchCbs * searchHandler = linphone_factory_create_magic_search_cbs(linphone_factory_get());
+	linphone_magic_search_cbs_set_search_results_received(searchHandler, _onMagicSearchResultsReceived);
+	linphone_magic_search_cbs_set_search_partial_results_received(searchHandler, _onMagicSearchPartialResultsReceived);
+	LinphoneMagicSearch *magicSearch = linphone_magic_search_new(manager->lc);
+	linphone_magic_search_add_callbacks(magicSearch, searchHandler);
+	stats *stat = get_stats(manager->lc);
+	linphone_magic_search_cbs_set_user_data(searchHandler, stat);
+
+	int localSources = LinphoneMagicSearchSourceFriends | LinphoneMagicSearchSourceCallLogs | LinphoneMagicSearchSourceChatRooms;
+	bctbx_list_t *expectedList = linphone_magic_search_get_contacts_list(magicSearch, "", "", localSources, LinphoneMagicSearchAggregationNone);
+
+	// One batch per ended source, except the last one that is notified as the final results.
+	linphone_magic_search_get_contacts_list_async(magicSearch, "", "", localSources, LinphoneMagicSearchAggregationNone);
+	BC_ASSERT_TRUE(wait_for(manager->lc, NULL, &stat->number_of_LinphoneMagicSearchResultReceived, 1));
+	BC_ASSERT_EQUAL(stat->number_of_LinphoneMagicSearchPartialResultsReceived, 2, int, "%d");
+	bctbx_list_t *resultList = linphone_magic_search_get_last_search(magicSearch);
+	BC_ASSERT_EQUAL((int)bctbx_list_size(resultList), (int)bctbx_list_size(expectedList), int, "%d");
+	bctbx_list_free_with_data(resultList, (bctbx_list_free_func)linphone_search_result_unref);
+	bctbx_list_free_with_data(expectedList, (bctbx_list_free_func)linphone_search_result_unref);
+
+	// Changing the filter cancels the pending sources of the previous search.
+	stat->number_of_LinphoneMagicSearchResultReceived = 0;
+	stat->number_of_LinphoneMagicSearchPartialResultsReceived = 0;
+	linphone_magic_search_get_contacts_list_async(magicSearch, "", "", localSources, LinphoneMagicSearchAggregationNone);
+	linphone_magic_search_get_contacts_list_async(magicSearch, "u", "", localSources, LinphoneMagicSearchAggregationNone);
+	BC_ASSERT_TRUE(wait_for(manager->lc, NULL, &stat->number_of_LinphoneMagicSearchResultReceived, 1));
+	wait_for_until(manager->lc, NULL, NULL, 0, 500);
+	BC_ASSERT_EQUAL(stat->number_of_LinphoneMagicSearchResultReceived, 1, int, "%d");
+	BC_ASSERT_EQUAL(stat->number_of_LinphoneMagicSearchPartialResultsReceived, 2, int, "%d");
+
+	linphone_magic_search_cbs_unref(searchHandler);
+	linphone_magic_search_unref(magicSearch);
+	if(ldap) {
+		linphone_core_clear_ldaps(manager->lc);
+		linphone_ldap_unref(ldap);
+	}
+	linphone_core_manager_destroy(manager);
+}
+
 static void ldap_search(void){
 // Prepare datas : Friends, Call logs, Chat rooms, ldap
 	LinphoneCoreManager* manager = linphone_core_manager_new("marie_rc");
@@ -3221,6 +3687,7 @@ test_t setup_tests[] = {
 	TEST_NO_TAG("Linphone core init/stop/uninit", core_init_stop_test),
 	TEST_NO_TAG("Linphone core init/unref", core_init_unref_test),
 	TEST_NO_TAG("Linphone core init/stop/start/uninit", core_init_stop_start_test),
+	TEST_ONE_TAG("Linphone core idle iterate benchmark", core_idle_iterate_benchmark, "Benchmark"),
 	TEST_NO_TAG("Linphone core set user agent", core_set_user_agent),
 	TEST_NO_TAG("Linphone random transport port",core_sip_transport_test),
 	TEST_NO_TAG("Linphone interpret url", linphone_interpret_url_test),
@@ -3228,6 +3695,9 @@ test_t setup_tests[] = {
 	TEST_NO_TAG("LPConfig zero_len value from buffer", linphone_lpconfig_from_buffer_zerolen_value),
 	TEST_NO_TAG("LPConfig zero_len value from file", linphone_lpconfig_from_file_zerolen_value),
 	TEST_NO_TAG("LPConfig zero_len value from XML", linphone_lpconfig_from_xml_zerolen_value),
+	TEST_NO_TAG("LPConfig indexed lookups", linphone_lpconfig_indexed_lookups),
+	TEST_NO_TAG("LPConfig get_int benchmark", linphone_lpconfig_get_int_benchmark),
+	TEST_NO_TAG("LPConfig background sync", linphone_lpconfig_background_sync),
 	TEST_NO_TAG("LPConfig invalid friend", linphone_lpconfig_invalid_friend),
 	TEST_NO_TAG("LPConfig invalid friend remote provisoning", linphone_lpconfig_invalid_friend_remote_provisioning),
 	TEST_NO_TAG("Chat room", chat_room_test),
@@ -3247,6 +3717,7 @@ test_t setup_tests[] = {
 	TEST_ONE_TAG("Multiple looking for friends with cache resetting", search_friend_research_estate_reset, "MagicSearch"),
 	TEST_ONE_TAG("Search friend with phone number", search_friend_with_phone_number, "MagicSearch"),
 	TEST_NO_TAG("Search friend with phone number 2", search_friend_with_phone_number_2),
+	TEST_NO_TAG("Find friend by phone number in large list", find_friend_by_phone_number_in_large_list),
 	TEST_ONE_TAG("Search friend and find it with its presence", search_friend_with_presence, "MagicSearch"),
 	TEST_ONE_TAG("Search friend in call log", search_friend_in_call_log, "MagicSearch"),
 	TEST_ONE_TAG("Search friend in call log but don't add address which already exist", search_friend_in_call_log_already_exist, "MagicSearch"),
@@ -3257,10 +3728,13 @@ test_t setup_tests[] = {
 	TEST_ONE_TAG("Search friend with multiple sip address", search_friend_with_multiple_sip_address, "MagicSearch"),
 	TEST_ONE_TAG("Search friend with same address", search_friend_with_same_address, "MagicSearch"),
 	TEST_ONE_TAG("Search friend in large friends database", search_friend_large_database, "MagicSearch"),
+	TEST_ONE_TAG("Search friend index follows changes", search_friend_index_follows_changes, "MagicSearch"),
+	TEST_ONE_TAG("Search friend index in large directory", search_friend_index_large_directory, "MagicSearch"),
 	TEST_ONE_TAG("Search friend result has capabilities", search_friend_get_capabilities, "MagicSearch"),
 	TEST_ONE_TAG("Search friend result chat room remote", search_friend_chat_room_remote, "MagicSearch"),
 	TEST_ONE_TAG("Search friend in non default friend list", search_friend_non_default_list, "MagicSearch"),
 	TEST_ONE_TAG("Async search friend in sources", async_search_friend_in_sources, "MagicSearch"),
+	TEST_ONE_TAG("Async search partial results", async_search_partial_results, "MagicSearch"),
 	TEST_ONE_TAG("Ldap search", ldap_search, "MagicSearch"),
 	TEST_ONE_TAG("Ldap features delay", ldap_features_delay, "MagicSearch"),
 	TEST_ONE_TAG("Ldap features min characters", ldap_features_min_characters, "MagicSearch"),
@@ -157,13 +157,17 @@ void liblinphone_tester_clock_start(MSTimeSpec *start){
 }
 
 bool_t liblinphone_tester_clock_elapsed(const MSTimeSpec *start, int value_ms){
-	MSTimeSpec current;
-	ms_get_cur_time(&current);
-	if ((((current.tv_sec-start->tv_sec)*1000LL) + ((current.tv_nsec-start->tv_nsec)/1000000LL))>=value_ms)
+	if (liblinphone_tester_clock_get_elapsed_ms(start)>=value_ms)
 		return TRUE;
 	return FALSE;
 }
 
+long long liblinphone_tester_clock_get_elapsed_ms(const MSTimeSpec *start){
+	MSTimeSpec current;
+	ms_get_cur_time(&current);
+	return ((current.tv_sec-start->tv_sec)*1000LL) + ((current.tv_nsec-start->tv_nsec)/1000000LL);
+}
+
 LinphoneAddress * create_linphone_address(const char * domain) {
 	return create_linphone_address_for_algo(domain,NULL);
 }
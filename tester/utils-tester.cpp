@@ -18,10 +18,20 @@
  * along with this program. If not, see <http://www.gnu.org/licenses/>.
  */
 
+#include <chrono>
+#include <list>
+#include <unordered_map>
+
 #include "linphone/utils/utils.h"
 
 #include "bctoolbox/utils.hh"
 
+#include "address/address.h"
+#include "address/identity-address.h"
+#include "address/identity-address-parser.h"
+#include "containers/lru-cache.h"
+#include "containers/sharded-lru-cache.h"
+
 #include "liblinphone_tester.h"
 #include "tester_utils.h"
 
@@ -104,11 +114,245 @@ static void parse_capabilities(void){
 	BC_ASSERT_TRUE(caps["ephemeral"] == Version(1, 0));
 }
 
+static void lru_cache_eviction (void) {
+	LruCache<int, int> cache(10);
+	for (int i = 0; i < 10; ++i)
+		cache.insert(i, i * 2);
+	BC_ASSERT_EQUAL(cache.getSize(), 10, int, "%d");
+
+	// Touch the oldest entry: the next eviction must remove the second one.
+	BC_ASSERT_PTR_NOT_NULL(cache[0]);
+	cache.insert(10, 20);
+	BC_ASSERT_EQUAL(cache.getSize(), 10, int, "%d");
+	BC_ASSERT_PTR_NOT_NULL(cache[0]);
+	BC_ASSERT_PTR_NULL(cache[1]);
+	BC_ASSERT_PTR_NOT_NULL(cache[10]);
+
+	// Replacing a value refreshes the entry.
+	cache.insert(2, 42);
+	cache.insert(11, 22);
+	BC_ASSERT_PTR_NULL(cache[3]);
+	int *value = cache[2];
+	if (BC_ASSERT_PTR_NOT_NULL(value))
+		BC_ASSERT_EQUAL(*value, 42, int, "%d");
+
+	BC_ASSERT_TRUE(cache.erase(2));
+	BC_ASSERT_FALSE(cache.erase(2));
+	BC_ASSERT_EQUAL(cache.getSize(), 9, int, "%d");
+
+	cache.clear();
+	BC_ASSERT_EQUAL(cache.getSize(), 0, int, "%d");
+	BC_ASSERT_PTR_NULL(cache[0]);
+
+	// Capacity is clamped to the minimum.
+	using IntCache = LruCache<int, int>;
+	BC_ASSERT_EQUAL(IntCache(1).getCapacity(), IntCache::MinCapacity, int, "%d");
+
+	// Erased and evicted values are released at once.
+	LruCache<int, shared_ptr<int>> sharedCache(10);
+	shared_ptr<int> shared = make_shared<int>(0);
+	sharedCache.insert(0, shared);
+	BC_ASSERT_EQUAL((int)shared.use_count(), 2, int, "%d");
+	sharedCache.erase(0);
+	BC_ASSERT_EQUAL((int)shared.use_count(), 1, int, "%d");
+	sharedCache.insert(0, shared);
+	for (int i = 1; i <= 10; ++i)
+		sharedCache.insert(i, make_shared<int>(i));
+	BC_ASSERT_EQUAL((int)shared.use_count(), 1, int, "%d");
+}
+
+static void lru_cache_string_lookup (void) {
+	LruCache<string, string> cache(10);
+	cache.insert("sip:alice@sip.example.org", "alice");
+	string *value = cache["sip:alice@sip.example.org"];
+	if (BC_ASSERT_PTR_NOT_NULL(value))
+		BC_ASSERT_STRING_EQUAL(value->c_str(), "alice");
+	BC_ASSERT_PTR_NULL(cache["sip:bob@sip.example.org"]);
+	BC_ASSERT_PTR_NOT_NULL(cache[string("sip:alice@sip.example.org")]);
+}
+
+static void sharded_lru_cache (void) {
+	ShardedLruCache<string, int> cache(64, 4);
+	BC_ASSERT_EQUAL(cache.getCapacity(), 64, int, "%d");
+	for (int i = 0; i < 1000; ++i)
+		cache.insert("sip:user-" + Utils::toString(i) + "@sip.example.org", i);
+	BC_ASSERT_EQUAL(cache.getSize(), 64, int, "%d");
+
+	int value = -1;
+	BC_ASSERT_TRUE(cache.get("sip:user-999@sip.example.org", value));
+	BC_ASSERT_EQUAL(value, 999, int, "%d");
+	BC_ASSERT_FALSE(cache.get("sip:user-0@sip.example.org", value));
+
+	// The shards are rounded up, setting the configured capacity again keeps the entries.
+	cache.setCapacity(100);
+	BC_ASSERT_EQUAL(cache.getCapacity(), 100, int, "%d");
+	cache.insert("sip:alice@sip.example.org", 1);
+	cache.setCapacity(100);
+	BC_ASSERT_TRUE(cache.get("sip:alice@sip.example.org", value));
+
+	cache.clear();
+	BC_ASSERT_EQUAL(cache.getSize(), 0, int, "%d");
+}
+
+static double run_address_parse_benchmark (const vector<string> &uris, int rounds) {
+	chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+	int valid = 0;
+	for (int round = 0; round < rounds; ++round) {
+		for (const auto &uri : uris) {
+			if (Address(uri).isValid() && IdentityAddress(uri).isValid())
+				++valid;
+		}
+	}
+	chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+	BC_ASSERT_EQUAL(valid, int(uris.size()) * rounds, int, "%d");
+	return double(chrono::duration_cast<chrono::microseconds>(end - start).count()) / 1000.0;
+}
+
+/*
+ * Parses a working set of device addresses as a server does on every request, with the address caches disabled,
+ * big enough to hold the working set, then smaller than it.
+ */
+static void address_cache_benchmark (void) {
+	LinphoneCoreManager *marie = linphone_core_manager_new("marie_rc");
+
+	// The capacities are read from the configuration when the core starts.
+	LinphoneCoreAddressCacheStats sipStats;
+	LinphoneCoreAddressCacheStats identityStats;
+	linphone_core_get_address_cache_stats(marie->lc, &sipStats, &identityStats);
+	BC_ASSERT_EQUAL(sipStats.capacity, Address::DefaultSipAddressesCacheCapacity, int, "%d");
+	BC_ASSERT_EQUAL(identityStats.capacity, IdentityAddressParser::DefaultCacheCapacity, int, "%d");
+
+	const int rounds = 20;
+	vector<string> uris;
+	for (int i = 0; i < 2000; ++i)
+		uris.push_back("sip:user-" + Utils::toString(i) + "@sip.example.org;gr=urn:uuid:" + Utils::toString(i));
+
+	IdentityAddressParser *parser = IdentityAddressParser::getInstance();
+	Address::setSipAddressesCacheCapacity(0);
+	parser->setCacheCapacity(0);
+	const double uncachedTime = run_address_parse_benchmark(uris, rounds);
+
+	Address::setSipAddressesCacheCapacity(4000);
+	parser->setCacheCapacity(4000);
+	linphone_core_reset_address_cache_stats(marie->lc);
+	const double cachedTime = run_address_parse_benchmark(uris, rounds);
+	linphone_core_get_address_cache_stats(marie->lc, &sipStats, &identityStats);
+	BC_ASSERT_EQUAL(sipStats.size, int(uris.size()), int, "%d");
+	BC_ASSERT_EQUAL((int)sipStats.misses, int(uris.size()), int, "%d");
+	BC_ASSERT_EQUAL((int)sipStats.hits, int(uris.size()) * (rounds - 1), int, "%d");
+	BC_ASSERT_EQUAL((int)sipStats.evictions, 0, int, "%d");
+	BC_ASSERT_EQUAL((int)identityStats.misses, int(uris.size()), int, "%d");
+	BC_ASSERT_EQUAL((int)identityStats.hits, int(uris.size()) * (rounds - 1), int, "%d");
+
+	// Addresses are looked up in order: a cache smaller than the working set always misses, and stays bounded.
+	Address::setSipAddressesCacheCapacity(1000);
+	parser->setCacheCapacity(1000);
+	linphone_core_reset_address_cache_stats(marie->lc);
+	const double thrashedTime = run_address_parse_benchmark(uris, rounds);
+	linphone_core_get_address_cache_stats(marie->lc, &sipStats, &identityStats);
+	BC_ASSERT_LOWER(sipStats.size, 1000, int, "%d");
+	BC_ASSERT_LOWER(identityStats.size, 1000, int, "%d");
+	BC_ASSERT_GREATER_STRICT((int)sipStats.evictions, 0, int, "%d");
+	BC_ASSERT_GREATER_STRICT((int)identityStats.evictions, 0, int, "%d");
+
+	ms_message("Address parsing benchmark, %d addresses x %d rounds: %g ms without cache, %g ms with cache, %g ms with a cache smaller than the working set",
+		int(uris.size()), rounds, uncachedTime, cachedTime, thrashedTime);
+
+	Address::setSipAddressesCacheCapacity(Address::DefaultSipAddressesCacheCapacity);
+	parser->setCacheCapacity(IdentityAddressParser::DefaultCacheCapacity);
+	linphone_core_manager_destroy(marie);
+}
+
+namespace {
+	// Previous LruCache implementation, kept as a reference for the benchmark.
+	template<typename Key, typename Value>
+	class ListLruCache {
+	public:
+		ListLruCache (int capacity) : mCapacity(capacity) {}
+
+		Value *operator[] (const Key &key) {
+			auto it = mKeyToPair.find(key);
+			return it == mKeyToPair.end() ? nullptr : &it->second.second;
+		}
+
+		void insert (const Key &key, const Value &value) {
+			auto it = mKeyToPair.find(key);
+			if (it != mKeyToPair.end()) {
+				mKeys.erase(it->second.first);
+				mKeyToPair.erase(it);
+			} else if (int(mKeyToPair.size()) == mCapacity) {
+				Key lastKey = mKeys.back();
+				mKeys.pop_back();
+				mKeyToPair.erase(lastKey);
+			}
+
+			mKeys.push_front(key);
+			mKeyToPair.insert({ key, { mKeys.begin(), value } });
+		}
+
+	private:
+		const int mCapacity;
+		list<Key> mKeys;
+		unordered_map<Key, pair<typename list<Key>::iterator, Value>> mKeyToPair;
+	};
+
+	template<typename Cache>
+	double run_lru_cache_benchmark (Cache &cache, const vector<string> &hotKeys, const vector<string> &coldKeys, int rounds, int &hits) {
+		chrono::high_resolution_clock::time_point start = chrono::high_resolution_clock::now();
+		hits = 0;
+		size_t coldIndex = 0;
+		const auto lookup = [&cache, &hits](const string &key, long long value) {
+			if (cache[key])
+				++hits;
+			else
+				cache.insert(key, value);
+		};
+		for (int round = 0; round < rounds; ++round) {
+			for (size_t i = 0; i < hotKeys.size(); ++i) {
+				lookup(hotKeys[i], (long long)i);
+				if (i % 10 == 0)
+					lookup(coldKeys[coldIndex++ % coldKeys.size()], (long long)coldIndex);
+			}
+		}
+		chrono::high_resolution_clock::time_point end = chrono::high_resolution_clock::now();
+		return double(chrono::duration_cast<chrono::microseconds>(end - start).count()) / 1000.0;
+	}
+}
+
+static void lru_cache_benchmark (void) {
+	// Same size as the MainDb sip address cache: 5000 entries.
+	// 4000 hot addresses are looked up at each round, interleaved with cold ones that are never reused before
+	// being evicted: after the first round, a LRU cache hits on every hot address and misses on every cold one.
+	const int capacity = 5000;
+	const int rounds = 50;
+	vector<string> hotKeys;
+	vector<string> coldKeys;
+	for (int i = 0; i < capacity * 4 / 5; ++i)
+		hotKeys.push_back("sip:user-" + Utils::toString(i) + "@sip.example.org");
+	for (int i = 0; i < capacity * 2 / 5; ++i)
+		coldKeys.push_back("sip:cold-user-" + Utils::toString(i) + "@sip.example.org");
+
+	int listHits = 0;
+	int hits = 0;
+	ListLruCache<string, long long> listCache(capacity);
+	LruCache<string, long long> cache(capacity);
+	const double listTime = run_lru_cache_benchmark(listCache, hotKeys, coldKeys, rounds, listHits);
+	const double time = run_lru_cache_benchmark(cache, hotKeys, coldKeys, rounds, hits);
+	BC_ASSERT_EQUAL(hits, int(hotKeys.size()) * (rounds - 1), int, "%d");
+	BC_ASSERT_EQUAL(cache.getSize(), capacity, int, "%d");
+	ms_message("LruCache benchmark: %g ms, %d hits (list based implementation: %g ms, %d hits)", time, hits, listTime, listHits);
+}
+
 test_t utils_tests[] = {
 	TEST_NO_TAG("split", split),
 	TEST_NO_TAG("trim", trim),
 	TEST_NO_TAG("Version comparisons", version_comparisons),
-	TEST_NO_TAG("Parse capabilities", parse_capabilities)
+	TEST_NO_TAG("Parse capabilities", parse_capabilities),
+	TEST_NO_TAG("LRU cache eviction", lru_cache_eviction),
+	TEST_NO_TAG("LRU cache string lookup", lru_cache_string_lookup),
+	TEST_NO_TAG("Sharded LRU cache", sharded_lru_cache),
+	TEST_NO_TAG("LRU cache benchmark", lru_cache_benchmark),
+	TEST_NO_TAG("Address cache benchmark", address_cache_benchmark)
 };
 
 test_suite_t utils_test_suite = {
@@ -431,6 +431,98 @@ static void friends_sqlite_store_lot_of_friends(void) {
 	linphone_core_unref(lc);
 }
 
+static void friends_sqlite_add_lot_of_friends(LinphoneCore *lc, LinphoneFriendList *lfl, int count) {
+	int i;
+	for (i = 0; i < count; i++) {
+		char uri[64];
+		LinphoneFriend *lf;
+
+		snprintf(uri, sizeof(uri), "sip:friend%i@sip.example.org", i);
+		lf = linphone_core_create_friend_with_address(lc, uri);
+		BC_ASSERT_EQUAL(linphone_friend_list_add_friend(lfl, lf), LinphoneFriendListOK, int, "%i");
+		linphone_friend_unref(lf);
+	}
+}
+
+static unsigned int friends_sqlite_count_stored_friends(LinphoneCore *lc, LinphoneFriendList *lfl) {
+	bctbx_list_t *friends_from_db = linphone_core_fetch_friends_from_db(lc, lfl);
+	unsigned int count = (unsigned int)bctbx_list_size(friends_from_db);
+	bctbx_list_free_with_data(friends_from_db, (void (*)(void *))linphone_friend_unref);
+	return count;
+}
+
+static int friends_sqlite_count_commit(void *data) {
+	(*(unsigned int *)data)++;
+	return 0;
+}
+
+static void friends_sqlite_batched_import_of_lot_of_friends(void) {
+	LinphoneCoreManager* manager = linphone_core_manager_new_with_proxies_check("empty_rc", FALSE);
+	LinphoneCore *lc = manager->lc;
+	LinphoneFriendList *imported = linphone_core_create_friend_list(lc);
+	LinphoneFriendList *unbatched = linphone_core_create_friend_list(lc);
+	LinphoneFriendList *batched = linphone_core_create_friend_list(lc);
+	char *import_filepath = bc_tester_res("vcards/thousand_vcards.vcf");
+	char *friends_db = bc_tester_file("friends.db");
+	MSTimeSpec start;
+	long long import_elapsed, unbatched_elapsed, batched_elapsed;
+	unsigned int commit_count = 0;
+	unsigned int previous_commit_count;
+	sqlite3 *db;
+
+	unlink(friends_db);
+	linphone_core_set_friends_database_path(lc, friends_db);
+	db = linphone_core_get_friends_db(lc);
+	if (!BC_ASSERT_PTR_NOT_NULL(db)) goto end;
+	/* Counts the transactions actually committed by sqlite on the friends database. */
+	sqlite3_commit_hook(db, friends_sqlite_count_commit, &commit_count);
+
+	linphone_friend_list_set_display_name(imported, "Imported");
+	linphone_core_add_friend_list(lc, imported);
+	linphone_friend_list_set_display_name(unbatched, "Unbatched");
+	linphone_core_add_friend_list(lc, unbatched);
+	linphone_friend_list_set_display_name(batched, "Batched");
+	linphone_core_add_friend_list(lc, batched);
+
+	/* The vCard import runs in a single transaction on its own. */
+	previous_commit_count = commit_count;
+	liblinphone_tester_clock_start(&start);
+	linphone_friend_list_import_friends_from_vcard4_file(imported, import_filepath);
+	import_elapsed = liblinphone_tester_clock_get_elapsed_ms(&start);
+	BC_ASSERT_EQUAL(commit_count - previous_commit_count, 1, unsigned int, "%u");
+	BC_ASSERT_EQUAL(friends_sqlite_count_stored_friends(lc, imported), 1000, unsigned int, "%u");
+	ms_message("Imported and stored a thousand of vCards in %lld ms", import_elapsed);
+
+	/* Each friend added outside of a batch is written in its own transaction. */
+	previous_commit_count = commit_count;
+	liblinphone_tester_clock_start(&start);
+	friends_sqlite_add_lot_of_friends(lc, unbatched, 1000);
+	unbatched_elapsed = liblinphone_tester_clock_get_elapsed_ms(&start);
+	BC_ASSERT_GREATER(commit_count - previous_commit_count, 1000, unsigned int, "%u");
+	BC_ASSERT_EQUAL(friends_sqlite_count_stored_friends(lc, unbatched), 1000, unsigned int, "%u");
+
+	previous_commit_count = commit_count;
+	liblinphone_tester_clock_start(&start);
+	linphone_core_friends_storage_begin_batch(lc);
+	friends_sqlite_add_lot_of_friends(lc, batched, 1000);
+	linphone_core_friends_storage_end_batch(lc);
+	batched_elapsed = liblinphone_tester_clock_get_elapsed_ms(&start);
+	BC_ASSERT_EQUAL(commit_count - previous_commit_count, 1, unsigned int, "%u");
+	BC_ASSERT_EQUAL(friends_sqlite_count_stored_friends(lc, batched), 1000, unsigned int, "%u");
+
+	ms_message("Stored a thousand of friends in %lld ms one by one, in %lld ms in a batch", unbatched_elapsed, batched_elapsed);
+	sqlite3_commit_hook(db, NULL, NULL);
+
+end:
+	linphone_friend_list_unref(imported);
+	linphone_friend_list_unref(unbatched);
+	linphone_friend_list_unref(batched);
+	unlink(friends_db);
+	bc_free(friends_db);
+	bc_free(import_filepath);
+	linphone_core_manager_destroy(manager);
+}
+
 static void friends_sqlite_find_friend_in_lot_of_friends(void) {
 	LinphoneCore* lc = linphone_factory_create_core_2(linphone_factory_get(), NULL, NULL, liblinphone_tester_get_empty_rc(), NULL, system_context);
 	sqlite3 *db;
@@ -1027,6 +1119,7 @@ test_t vcard_tests[] = {
 	TEST_NO_TAG("Friends working if no db set", friends_if_no_db_set),
 	TEST_NO_TAG("Friends storage in sqlite database", friends_sqlite_storage),
 	TEST_NO_TAG("20000 Friends storage in sqlite database", friends_sqlite_store_lot_of_friends),
+	TEST_NO_TAG("Batched storage of a lot of friends in sqlite database", friends_sqlite_batched_import_of_lot_of_friends),
 	TEST_NO_TAG("Find friend in database of 20000 objects", friends_sqlite_find_friend_in_lot_of_friends),
 	TEST_NO_TAG("CardDAV clean", carddav_clean), // This is to ensure the content of the test addressbook is in the correct state for the following tests
 	TEST_NO_TAG("CardDAV synchronization", carddav_sync),
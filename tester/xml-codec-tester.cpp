@@ -0,0 +1,176 @@
+/*
+ * Copyright (c) 2010-2022 Belledonne Communications SARL.
+ *
+ * This file is part of Liblinphone 
+ * (see https://gitlab.linphone.org/BC/public/liblinphone).
+ *
+ * This program is free software: you can redistribute it and/or modify
+ * it under the terms of the GNU Affero General Public License as
+ * published by the Free Software Foundation, either version 3 of the
+ * License, or (at your option) any later version.
+ *
+ * This program is distributed in the hope that it will be useful,
+ * but WITHOUT ANY WARRANTY; without even the implied warranty of
+ * MERCHANTABILITY or FITNESS FOR A PARTICULAR PURPOSE.  See the
+ * GNU Affero General Public License for more details.
+ *
+ * You should have received a copy of the GNU Affero General Public License
+ * along with this program. If not, see <http://www.gnu.org/licenses/>.
+ */
+
+
+#include "chat/notification/imdn.h"
+#include "chat/notification/is-composing.h"
+// TODO: Remove me later.
+#include "private.h"
+
+#include "liblinphone_tester.h"
+#include "tester_utils.h"
+
+// =============================================================================
+
+using namespace std;
+
+using namespace LinphonePrivate;
+
+static const time_t imdnTime = 1600000000;
+
+static void check_imdn (const string &messageId, Imdn::Type type, LinphoneReason reason) {
+	const string xsdXml = Imdn::createXml(messageId, imdnTime, type, reason, false);
+	const string streamedXml = Imdn::createXml(messageId, imdnTime, type, reason, true);
+	BC_ASSERT_STRING_EQUAL(streamedXml.c_str(), xsdXml.c_str());
+
+	Imdn::Notification xsdNotification;
+	Imdn::Notification streamedNotification;
+	BC_ASSERT_TRUE(Imdn::parseXml(xsdXml, xsdNotification, false));
+	BC_ASSERT_TRUE(Imdn::parseXml(xsdXml, streamedNotification, true));
+	BC_ASSERT_STRING_EQUAL(streamedNotification.messageId.c_str(), xsdNotification.messageId.c_str());
+	BC_ASSERT_STRING_EQUAL(streamedNotification.messageId.c_str(), messageId.c_str());
+	BC_ASSERT_EQUAL(streamedNotification.isDelivery, xsdNotification.isDelivery, bool, "%d");
+	BC_ASSERT_EQUAL(streamedNotification.isDisplay, xsdNotification.isDisplay, bool, "%d");
+	BC_ASSERT_EQUAL(streamedNotification.delivered, xsdNotification.delivered, bool, "%d");
+	BC_ASSERT_EQUAL(streamedNotification.displayed, xsdNotification.displayed, bool, "%d");
+	BC_ASSERT_EQUAL(streamedNotification.failed, xsdNotification.failed, bool, "%d");
+	BC_ASSERT_EQUAL(streamedNotification.error, xsdNotification.error, bool, "%d");
+	BC_ASSERT_EQUAL(streamedNotification.hasReason, xsdNotification.hasReason, bool, "%d");
+	BC_ASSERT_EQUAL(streamedNotification.reasonCode, xsdNotification.reasonCode, int, "%d");
+}
+
+static void imdn_delivered () {
+	check_imdn("abcd1234", Imdn::Type::Delivery, LinphoneReasonNone);
+}
+
+static void imdn_failed_with_reason () {
+	check_imdn("abcd1234", Imdn::Type::Delivery, LinphoneReasonNotAcceptable);
+	Imdn::Notification notification;
+	BC_ASSERT_TRUE(Imdn::parseXml(Imdn::createXml("abcd1234", imdnTime, Imdn::Type::Delivery, LinphoneReasonNotAcceptable, true), notification, true));
+	BC_ASSERT_TRUE(notification.failed);
+	BC_ASSERT_TRUE(notification.hasReason);
+	BC_ASSERT_EQUAL(notification.reasonCode, 488, int, "%d");
+}
+
+static void imdn_displayed () {
+	check_imdn("abcd1234", Imdn::Type::Display, LinphoneReasonNone);
+}
+
+static void imdn_escaped_message_id () {
+	check_imdn("<a&b\"c'>", Imdn::Type::Display, LinphoneReasonNone);
+}
+
+static void imdn_parse_foreign_document () {
+	// Prefixed namespaces, whitespaces, comments and unknown elements as another implementation may send them.
+	const string xml = "<?xml version=\"1.0\" encoding=\"UTF-8\"?>\r\n"
+		"<!-- sent by another client -->\r\n"
+		"<i:imdn xmlns:i=\"urn:ietf:params:xml:ns:imdn\" xmlns:o=\"urn:example:other\">\r\n"
+		"  <i:message-id>\r\n  34jk324j  </i:message-id>\r\n"
+		"  <i:datetime>2008-04-04T12:16:49-05:00</i:datetime>\r\n"
+		"  <i:display-notification>\r\n"
+		"    <i:status><i:displayed/></i:status>\r\n"
+		"  </i:display-notification>\r\n"
+		"  <o:extension><i:displayed/></o:extension>\r\n"
+		"</i:imdn>\r\n";
+
+	Imdn::Notification xsdNotification;
+	Imdn::Notification streamedNotification;
+	BC_ASSERT_TRUE(Imdn::parseXml(xml, xsdNotification, false));
+	BC_ASSERT_TRUE(Imdn::parseXml(xml, streamedNotification, true));
+	BC_ASSERT_STRING_EQUAL(streamedNotification.messageId.c_str(), "34jk324j");
+	BC_ASSERT_STRING_EQUAL(streamedNotification.messageId.c_str(), xsdNotification.messageId.c_str());
+	BC_ASSERT_TRUE(streamedNotification.isDisplay);
+	BC_ASSERT_TRUE(streamedNotification.displayed);
+	BC_ASSERT_FALSE(streamedNotification.isDelivery);
+}
+
+static void imdn_parse_invalid_document () {
+	Imdn::Notification notification;
+	BC_ASSERT_FALSE(Imdn::parseXml("<imdn xmlns=\"urn:ietf:params:xml:ns:imdn\"><message-id>abcd", notification, true));
+	BC_ASSERT_FALSE(Imdn::parseXml("not xml at all", notification, true));
+}
+
+static void check_is_composing (bool isComposing) {
+	const string xsdXml = IsComposing::createXml(isComposing, 60, false);
+	const string streamedXml = IsComposing::createXml(isComposing, 60, true);
+	BC_ASSERT_STRING_EQUAL(streamedXml.c_str(), xsdXml.c_str());
+
+	string xsdState;
+	string streamedState;
+	unsigned long long xsdRefresh = 0;
+	unsigned long long streamedRefresh = 0;
+	BC_ASSERT_TRUE(IsComposing::parseXml(xsdXml, xsdState, xsdRefresh, false));
+	BC_ASSERT_TRUE(IsComposing::parseXml(xsdXml, streamedState, streamedRefresh, true));
+	BC_ASSERT_STRING_EQUAL(streamedState.c_str(), xsdState.c_str());
+	BC_ASSERT_STRING_EQUAL(streamedState.c_str(), isComposing ? "active" : "idle");
+	BC_ASSERT_EQUAL(streamedRefresh, xsdRefresh, unsigned long long, "%llu");
+	BC_ASSERT_EQUAL(streamedRefresh, isComposing ? 60ULL : 0ULL, unsigned long long, "%llu");
+}
+
+static void is_composing_active () {
+	check_is_composing(true);
+}
+
+static void is_composing_idle () {
+	check_is_composing(false);
+}
+
+static int benchmark_imdn (bool streamed, int count, long long &elapsedTime) {
+	int parsed = 0;
+	MSTimeSpec start;
+	liblinphone_tester_clock_start(&start);
+	for (int i = 0; i < count; i++) {
+		const string xml = Imdn::createXml("abcd1234", imdnTime, Imdn::Type::Delivery, LinphoneReasonNone, streamed);
+		Imdn::Notification notification;
+		if (Imdn::parseXml(xml, notification, streamed) && (notification.messageId == "abcd1234"))
+			parsed++;
+	}
+	elapsedTime = liblinphone_tester_clock_get_elapsed_ms(&start);
+	return parsed;
+}
+
+/*
+ * Writes and reads back delivery notifications with both codecs, as done for every received message of a chat room.
+ */
+static void imdn_codec_benchmark () {
+	const int count = 2000;
+	long long xsdTime = 0;
+	long long streamedTime = 0;
+	BC_ASSERT_EQUAL(benchmark_imdn(false, count, xsdTime), count, int, "%d");
+	BC_ASSERT_EQUAL(benchmark_imdn(true, count, streamedTime), count, int, "%d");
+	ms_message("IMDN codec: %d documents written and parsed, DOM: %lld ms, streamed: %lld ms", count, xsdTime, streamedTime);
+}
+
+test_t xml_codec_tests[] = {
+	TEST_NO_TAG("IMDN delivered", imdn_delivered),
+	TEST_NO_TAG("IMDN failed with reason", imdn_failed_with_reason),
+	TEST_NO_TAG("IMDN displayed", imdn_displayed),
+	TEST_NO_TAG("IMDN escaped message id", imdn_escaped_message_id),
+	TEST_NO_TAG("IMDN parse foreign document", imdn_parse_foreign_document),
+	TEST_NO_TAG("IMDN parse invalid document", imdn_parse_invalid_document),
+	TEST_NO_TAG("Is composing active", is_composing_active),
+	TEST_NO_TAG("Is composing idle", is_composing_idle),
+	TEST_NO_TAG("IMDN codec benchmark", imdn_codec_benchmark),
+};
+
+test_suite_t xml_codec_test_suite = {
+	"XML codecs", NULL, NULL, liblinphone_tester_before_each, liblinphone_tester_after_each,
+	sizeof(xml_codec_tests) / sizeof(xml_codec_tests[0]), xml_codec_tests
+};